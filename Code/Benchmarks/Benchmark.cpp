@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstdlib>  // std::malloc, std::free
+#include <new>
+
+#include "Library/OS.h"
+
+#include "Benchmark.h"
+
+// seconds
+#define BENCHMARK_MIN_DURATION 0.2
+
+#define BENCHMARK_MAX_COUNT 0x40000000
+
+static volatile long g_allocationCount;
+static volatile std::size_t g_consumed;
+
+void* operator new(std::size_t size)
+{
+	OS::Atomic::Increment(&g_allocationCount);
+
+	void* result = std::malloc((size) ? size : 1);
+	if (!result)
+	{
+		throw std::bad_alloc();
+	}
+
+	return result;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* address)
+{
+	std::free(address);
+}
+
+void operator delete[](void* address)
+{
+	std::free(address);
+}
+
+void Benchmark::Run(const char* name, Function function, void* param)
+{
+	// lazy initialization and cold caches are not measured
+	function(1, param);
+
+	const double frequency = static_cast<double>(OS::GetPerformanceFrequency());
+
+	unsigned int count = 1;
+	double duration = 0;
+	long allocationCount = 0;
+
+	while (true)
+	{
+		const long initialAllocationCount = g_allocationCount;
+		const unsigned __int64 startTime = OS::GetPerformanceCounter();
+
+		function(count, param);
+
+		duration = (OS::GetPerformanceCounter() - startTime) / frequency;
+		allocationCount = g_allocationCount - initialAllocationCount;
+
+		if (duration >= BENCHMARK_MIN_DURATION || count >= BENCHMARK_MAX_COUNT)
+		{
+			break;
+		}
+
+		// aim a bit above the minimum duration, but grow at least twice and at most hundred times
+		double nextCount = (duration > 0) ? (count * BENCHMARK_MIN_DURATION * 1.5) / duration : count * 100.0;
+
+		if (nextCount < count * 2.0)
+		{
+			nextCount = count * 2.0;
+		}
+		else if (nextCount > count * 100.0)
+		{
+			nextCount = count * 100.0;
+		}
+
+		count = (nextCount < BENCHMARK_MAX_COUNT) ? static_cast<unsigned int>(nextCount) : BENCHMARK_MAX_COUNT;
+	}
+
+	std::printf("%-40s %12.1f ns/op %10.3f allocs/op %12u ops\n", name, (duration * 1000000000) / count,
+	            static_cast<double>(allocationCount) / count, count);
+	std::fflush(stdout);
+}
+
+void Benchmark::Consume(std::size_t value)
+{
+	g_consumed += value;
+}
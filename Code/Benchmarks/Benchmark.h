@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Minimal microbenchmark runner.
+ *
+ * Each benchmark is repeated with a growing number of operations until a single run takes long enough to be measured
+ * reliably. Heap allocations of all threads are counted by the global operator new of the benchmark executable.
+ */
+namespace Benchmark
+{
+	// performs the measured operation count times
+	typedef void (*Function)(unsigned int count, void* param);
+
+	// prints the time and the number of heap allocations per operation
+	void Run(const char* name, Function function, void* param = NULL);
+
+	// keeps the compiler from dropping unused results
+	void Consume(std::size_t value);
+}
+
+void RunStringBenchmarks();
+void RunLoggerBenchmarks();
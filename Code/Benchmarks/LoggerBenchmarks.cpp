@@ -0,0 +1,207 @@
+#include <cstdarg>
+
+#include "CryCommon/CrySystem/ISystem.h"
+#include "Launcher/HeadlessServer/LogPrefix.h"
+#include "Launcher/HeadlessServer/Logger.h"
+#include "Library/OS.h"
+#include "Library/StringView.h"
+
+#include "Benchmark.h"
+#include "MockConsole.h"
+
+#define BENCHMARK_LOG_FILE "Benchmark.log"
+#define BENCHMARK_LOG_PREFIX "%F %T.%N [%t]"
+#define BENCHMARK_QUEUE_SIZE 4096
+
+// the main thread drains the messages of other threads once per frame
+#define MESSAGES_PER_FRAME 64
+
+#define PRODUCER_THREAD_COUNT 4
+
+struct LoggerConfig
+{
+	const char* message;  // gets the message number
+	const char* flushPolicy;  // NULL means no log file
+	bool isAsync;
+	bool hasPrefix;
+	unsigned int threadCount;  // zero means the main thread
+};
+
+static void RenderPrefix(unsigned int count, void* param)
+{
+	LogPrefix* pFormat = LogPrefix::Parse(BENCHMARK_LOG_PREFIX);
+	const OS::DateTime time = OS::GetCurrentDateTimeLocal();
+	const unsigned long threadID = OS::GetCurrentThreadID();
+
+	std::string result;
+	std::vector<std::size_t> millisecondPositions;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		result.clear();
+		millisecondPositions.clear();
+
+		pFormat->Render(result, millisecondPositions, time, threadID);
+	}
+
+	delete pFormat;
+
+	Benchmark::Consume(result.length());
+}
+
+static void LogAlways(Logger& logger, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	logger.LogV(ILog::eAlways, format, args);
+	va_end(args);
+}
+
+static void SetUpLogger(Logger& logger, const LoggerConfig& config)
+{
+	if (config.flushPolicy)
+	{
+		// an empty log file is not backed up
+		OS::File file;
+		if (file.Open(BENCHMARK_LOG_FILE, OS::File::WRITE_ONLY_CREATE))
+		{
+			file.Resize(0);
+		}
+
+		file.Close();
+
+		logger.OpenFile(BENCHMARK_LOG_FILE);
+		logger.SetFlushPolicy(config.flushPolicy);
+	}
+
+	if (config.isAsync)
+	{
+		logger.StartAsyncWriter(BENCHMARK_QUEUE_SIZE, Logger::OVERFLOW_BLOCK);
+	}
+
+	if (config.hasPrefix)
+	{
+		logger.SetPrefix(BENCHMARK_LOG_PREFIX);
+	}
+}
+
+struct Producer
+{
+	Logger* pLogger;
+	const char* message;
+	unsigned int count;
+	volatile long* pDoneCount;
+};
+
+static void ProducerThread(void* param)
+{
+	Producer& producer = *static_cast<Producer*>(param);
+
+	for (unsigned int i = 0; i < producer.count; i++)
+	{
+		LogAlways(*producer.pLogger, producer.message, i);
+	}
+
+	OS::Atomic::Increment(producer.pDoneCount);
+}
+
+static void LogFromThreads(Logger& logger, const LoggerConfig& config, unsigned int count)
+{
+	Producer producers[PRODUCER_THREAD_COUNT];
+	OS::Thread threads[PRODUCER_THREAD_COUNT];
+	volatile long doneCount = 0;
+
+	const unsigned int threadCount = (config.threadCount < PRODUCER_THREAD_COUNT)
+	                               ? config.threadCount
+	                               : PRODUCER_THREAD_COUNT;
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		producers[i].pLogger = &logger;
+		producers[i].message = config.message;
+		producers[i].count = (count / threadCount) + ((i < (count % threadCount)) ? 1 : 0);
+		producers[i].pDoneCount = &doneCount;
+
+		threads[i].Start(&ProducerThread, &producers[i]);
+	}
+
+	while (doneCount < static_cast<long>(threadCount))
+	{
+		logger.OnUpdate();
+		OS::YieldCurrentThread();
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		threads[i].Join();
+	}
+}
+
+static void LogMessages(unsigned int count, void* param)
+{
+	const LoggerConfig& config = *static_cast<const LoggerConfig*>(param);
+
+	// must outlive the logger
+	MockConsole console;
+	SSystemGlobalEnvironment env;
+	env.pConsole = &console;
+	gEnv = &env;
+
+	Logger logger;
+
+	// the logger registers its cvars in the mock console, so the prefix is set the same way as in the engine
+	env.pLog = &logger;
+	logger.RegisterConsoleVariables();
+
+	SetUpLogger(logger, config);
+
+	if (config.threadCount > 0)
+	{
+		LogFromThreads(logger, config, count);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			LogAlways(logger, config.message, i);
+
+			if ((i % MESSAGES_PER_FRAME) == 0)
+			{
+				logger.OnUpdate();
+			}
+		}
+	}
+
+	// the destructor writes everything that is left
+	logger.OnUpdate();
+
+	env.pLog = NULL;
+	gEnv = NULL;
+}
+
+#define PLAIN_MESSAGE "Player Nomad (%u) connected from 192.168.0.1:64087"
+#define COLORED_MESSAGE "$3Player $5Nomad$3 (%u) connected from $8192.168.0.1:64087"
+
+void RunLoggerBenchmarks()
+{
+	static const LoggerConfig NO_FILE       = { PLAIN_MESSAGE,   NULL,    false, false, 0 };
+	static const LoggerConfig NO_FILE_PREFIX = { PLAIN_MESSAGE,   NULL,    false, true,  0 };
+	static const LoggerConfig LINE          = { PLAIN_MESSAGE,   "line",  false, false, 0 };
+	static const LoggerConfig FRAME         = { PLAIN_MESSAGE,   "frame", false, false, 0 };
+	static const LoggerConfig FRAME_COLORED = { COLORED_MESSAGE, "frame", false, false, 0 };
+	static const LoggerConfig FRAME_PREFIX  = { PLAIN_MESSAGE,   "frame", false, true,  0 };
+	static const LoggerConfig ASYNC         = { PLAIN_MESSAGE,   "frame", true,  false, 0 };
+	static const LoggerConfig THREADS       = { PLAIN_MESSAGE,   "frame", false, false, PRODUCER_THREAD_COUNT };
+	static const LoggerConfig THREADS_ASYNC = { PLAIN_MESSAGE,   "frame", true,  false, PRODUCER_THREAD_COUNT };
+
+	Benchmark::Run("Logger prefix rendering", &RenderPrefix);
+	Benchmark::Run("Logger formatting without file", &LogMessages, const_cast<LoggerConfig*>(&NO_FILE));
+	Benchmark::Run("Logger formatting with prefix", &LogMessages, const_cast<LoggerConfig*>(&NO_FILE_PREFIX));
+	Benchmark::Run("Logger file, line flush", &LogMessages, const_cast<LoggerConfig*>(&LINE));
+	Benchmark::Run("Logger file, frame flush", &LogMessages, const_cast<LoggerConfig*>(&FRAME));
+	Benchmark::Run("Logger file, color codes", &LogMessages, const_cast<LoggerConfig*>(&FRAME_COLORED));
+	Benchmark::Run("Logger file, prefix", &LogMessages, const_cast<LoggerConfig*>(&FRAME_PREFIX));
+	Benchmark::Run("Logger file, async writer", &LogMessages, const_cast<LoggerConfig*>(&ASYNC));
+	Benchmark::Run("Logger file, 4 producer threads", &LogMessages, const_cast<LoggerConfig*>(&THREADS));
+	Benchmark::Run("Logger file, 4 producers, async writer", &LogMessages, const_cast<LoggerConfig*>(&THREADS_ASYNC));
+}
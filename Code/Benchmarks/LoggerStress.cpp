@@ -0,0 +1,525 @@
+/**
+ * @file
+ * @brief Stress test of the headless server logger with simulated engine threads.
+ *
+ * Producer threads log at a fixed rate while the main thread runs frames at a fixed rate, so the logging modes can be
+ * compared under the same load. Each message carries its producer, sequence number and send time, which are checked
+ * once the message reaches the log file.
+ */
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>  // std::atoi, std::strtoul
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "CryCommon/CrySystem/ISystem.h"
+#include "Launcher/HeadlessServer/Logger.h"
+#include "Library/FramePacer.h"
+#include "Library/OS.h"
+#include "Library/StringTools.h"
+#include "Project.h"
+
+#include "MockConsole.h"
+
+#define DEFAULT_THREAD_COUNT "4"
+#define DEFAULT_MESSAGE_RATE "1000"
+#define DEFAULT_FRAME_RATE "30"
+#define DEFAULT_FRAME_LOAD "10000"
+#define DEFAULT_DURATION "10"
+#define DEFAULT_LOG_FILE_NAME "LoggerStress.log"
+#define DEFAULT_LOG_FLUSH_POLICY "frame"
+#define DEFAULT_LOG_QUEUE_SIZE "4096"
+#define DEFAULT_LOG_OVERFLOW_POLICY "block"
+#define MAX_THREAD_COUNT 64
+#define MAX_FRAME_RATE 1000
+#define MAX_DURATION 3600
+
+// how long the remaining messages may take to arrive after the producers are done
+#define DRAIN_TIMEOUT 5000
+
+// producers check whether the next message is due once per tick
+#define PRODUCER_TICK_MICROSECONDS 1000
+
+#define MESSAGE_TAG "Stress "
+#define MESSAGE_FORMAT MESSAGE_TAG "%u %lu %lu: Player Nomad connected from 192.168.0.1:64087"
+
+////////////////////////////////////////////////////////////////////////////////
+
+const char* const PROJECT_BANNER = "C1-Launcher Logger Stress Test " PROJECT_VERSION_STRING " " PROJECT_BUILD_BITS;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static unsigned int GetUnsignedArg(const char* arg, const char* defaultValue, unsigned int maxValue)
+{
+	const char* value = OS::CmdLine::GetArgValue(arg, defaultValue);
+
+	char* end = NULL;
+	const unsigned long result = std::strtoul(value, &end, 10);
+
+	if (end == value || *end != '\0' || result > maxValue)
+	{
+		throw StringTools::Error("Invalid %s value \"%s\"!\nUse a number from 0 to %u.", arg, value, maxValue);
+	}
+
+	return static_cast<unsigned int>(result);
+}
+
+static void PrintPercentiles(const char* name, std::vector<unsigned long>& values)
+{
+	if (values.empty())
+	{
+		std::printf("%-12s no samples\n", name);
+		return;
+	}
+
+	std::sort(values.begin(), values.end());
+
+	const std::size_t last = values.size() - 1;
+
+	// microseconds to milliseconds
+	std::printf("%-12s p50 %9.3f  p90 %9.3f  p99 %9.3f  p99.9 %9.3f  max %9.3f ms\n", name,
+		values[(last * 500) / 1000] / 1000.0,
+		values[(last * 900) / 1000] / 1000.0,
+		values[(last * 990) / 1000] / 1000.0,
+		values[(last * 999) / 1000] / 1000.0,
+		values[last] / 1000.0
+	);
+}
+
+class StressTest : public ILogCallback
+{
+	struct Config
+	{
+		unsigned int threadCount;
+		unsigned int messageRate;  // per thread per second, zero means as fast as possible
+		unsigned int frameRate;
+		unsigned int frameLoad;  // microseconds of simulated work in each frame
+		unsigned int duration;  // seconds
+	};
+
+	struct Producer
+	{
+		StressTest* pTest;
+		unsigned int index;
+		OS::Thread thread;
+		volatile long sentCount;
+
+		// used only by file callbacks
+		unsigned long receivedCount;
+		unsigned long nextSequence;
+
+		Producer() : pTest(NULL), index(0), sentCount(0), receivedCount(0), nextSequence(0)
+		{
+		}
+	};
+
+	Config m_config;
+
+	// must outlive the logger
+	MockConsole m_console;
+	SSystemGlobalEnvironment m_env;
+
+	Logger m_logger;
+
+	unsigned __int64 m_frequency;
+	unsigned __int64 m_startTime;
+
+	Producer m_producers[MAX_THREAD_COUNT];
+	volatile long m_isStopRequested;
+
+	// updated by file callbacks, which the logger never invokes concurrently
+	volatile long m_receivedCount;
+	volatile long m_reorderedCount;
+	std::vector<unsigned long> m_latencies;
+
+	// main thread only, microseconds
+	std::vector<unsigned long> m_frameTimes;
+	std::vector<unsigned long> m_updateTimes;
+	unsigned __int64 m_backlogSum;
+	unsigned long m_backlogMax;
+	unsigned long m_backlogSampleCount;
+
+	// no copies
+	StressTest(const StressTest&);
+	StressTest& operator=(const StressTest&);
+
+public:
+	StressTest() : m_config(), m_console(), m_env(), m_logger(), m_frequency(OS::GetPerformanceFrequency()),
+	  m_startTime(OS::GetPerformanceCounter()), m_isStopRequested(0), m_receivedCount(0), m_reorderedCount(0),
+	  m_backlogSum(0), m_backlogMax(0), m_backlogSampleCount(0)
+	{
+		m_env.pConsole = &m_console;
+		m_env.pLog = &m_logger;
+
+		gEnv = &m_env;
+	}
+
+	~StressTest()
+	{
+		this->StopProducers();
+
+		m_logger.RemoveCallback(this);
+
+		gEnv = NULL;
+	}
+
+	void Init()
+	{
+		m_config.threadCount = GetUnsignedArg("-threads", DEFAULT_THREAD_COUNT, MAX_THREAD_COUNT);
+		m_config.messageRate = GetUnsignedArg("-rate", DEFAULT_MESSAGE_RATE, 1000000);
+		m_config.frameRate = GetUnsignedArg("-fps", DEFAULT_FRAME_RATE, MAX_FRAME_RATE);
+		m_config.frameLoad = GetUnsignedArg("-frameload", DEFAULT_FRAME_LOAD, 1000000);
+		m_config.duration = GetUnsignedArg("-duration", DEFAULT_DURATION, MAX_DURATION);
+
+		if (m_config.frameRate == 0)
+		{
+			throw StringTools::Error("Invalid -fps value 0!\nUse a number from 1 to %u.", MAX_FRAME_RATE);
+		}
+
+		std::printf("Producer threads: %u\n", m_config.threadCount);
+		std::printf("Message rate: %u per thread per second\n", m_config.messageRate);
+		std::printf("Frame rate: %u Hz with %u us of simulated work\n", m_config.frameRate, m_config.frameLoad);
+		std::printf("Duration: %u s\n", m_config.duration);
+
+		// the logger registers its cvars in the mock console, so everything goes the same way as in the engine
+		m_logger.RegisterConsoleVariables();
+
+		const char* logFileName = OS::CmdLine::GetArgValue("-logfile", DEFAULT_LOG_FILE_NAME);
+		const char* logPrefix = OS::CmdLine::GetArgValue("-logprefix", "");
+		const char* logFlushPolicy = OS::CmdLine::GetArgValue("-logflush", DEFAULT_LOG_FLUSH_POLICY);
+
+		std::printf("Log file: %s\n", logFileName);
+		m_logger.OpenFile(logFileName);
+		m_logger.SetPrefix(logPrefix);
+
+		std::printf("Log flush policy: %s\n", logFlushPolicy);
+		if (!m_logger.SetFlushPolicy(logFlushPolicy))
+		{
+			throw StringTools::Error("Unknown log flush policy \"%s\"!\nUse line, frame or interval:MS.", logFlushPolicy);
+		}
+
+		if (OS::CmdLine::HasArg("-lograte"))
+		{
+			const unsigned int rateLimit = GetUnsignedArg("-lograte", "", 1000000);
+
+			std::printf("Log rate limit: %u\n", rateLimit);
+			m_console.ExecuteString(StringTools::Format("log_RateLimit %u", rateLimit).c_str());
+		}
+
+		const int queueSize = std::atoi(OS::CmdLine::GetArgValue("-logqueuesize", DEFAULT_LOG_QUEUE_SIZE));
+
+		if (queueSize <= 0)
+		{
+			throw StringTools::Error("Invalid log queue size %d!", queueSize);
+		}
+
+		if (OS::CmdLine::HasArg("-logasync"))
+		{
+			const char* overflow = OS::CmdLine::GetArgValue("-logoverflow", DEFAULT_LOG_OVERFLOW_POLICY);
+
+			Logger::OverflowPolicy overflowPolicy;
+			if (!Logger::ParseOverflowPolicy(overflow, overflowPolicy))
+			{
+				throw StringTools::Error("Unknown log overflow policy \"%s\"!\nUse block, dropoldest or drop.", overflow);
+			}
+
+			std::printf("Log writer: asynchronous (queue size %d, overflow policy %s)\n", queueSize, overflow);
+			m_logger.StartAsyncWriter(queueSize, overflowPolicy);
+		}
+		else
+		{
+			std::printf("Log writer: main thread\n");
+		}
+
+		if (OS::CmdLine::HasArg("-logcallbackthread"))
+		{
+			std::printf("Log callbacks: separate thread (queue size %d)\n", queueSize);
+			m_logger.StartCallbackDispatcher(queueSize);
+		}
+
+		m_logger.AddCallback(this);
+
+		const unsigned __int64 expectedCount = static_cast<unsigned __int64>(m_config.threadCount)
+		                                     * m_config.messageRate * m_config.duration;
+
+		// avoid reallocation during the test, but do not reserve gigabytes for unlimited rate
+		m_latencies.reserve(static_cast<std::size_t>(std::min<unsigned __int64>(expectedCount, 16 * 1024 * 1024)));
+		m_frameTimes.reserve(m_config.frameRate * m_config.duration);
+		m_updateTimes.reserve(m_config.frameRate * m_config.duration);
+
+		std::printf("\n");
+		std::fflush(stdout);
+	}
+
+	void Run()
+	{
+		this->StartProducers();
+
+		FramePacer pacer(m_config.frameRate);
+
+		const unsigned long endTime = m_config.duration * 1000000;
+
+		while (this->GetTime() < endTime)
+		{
+			const unsigned long frameStartTime = this->GetTime();
+
+			// the rest of the engine frame
+			while ((this->GetTime() - frameStartTime) < m_config.frameLoad)
+			{
+			}
+
+			const unsigned long updateStartTime = this->GetTime();
+
+			m_logger.OnUpdate();
+
+			const unsigned long frameEndTime = this->GetTime();
+
+			m_updateTimes.push_back(frameEndTime - updateStartTime);
+			m_frameTimes.push_back(frameEndTime - frameStartTime);
+
+			this->SampleBacklog();
+
+			pacer.Wait();
+		}
+
+		this->StopProducers();
+
+		// the remaining messages are not part of the frame statistics
+		const unsigned long drainStartTime = OS::GetTickCount();
+
+		while (this->GetBacklog() > 0 && (OS::GetTickCount() - drainStartTime) < DRAIN_TIMEOUT)
+		{
+			m_logger.OnUpdate();
+			OS::Sleep(1);
+		}
+
+		m_logger.StopAsyncWriter(DRAIN_TIMEOUT);
+		m_logger.StopCallbackDispatcher();
+		m_logger.OnUpdate();
+
+		this->Report(pacer);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// ILogCallback
+	////////////////////////////////////////////////////////////////////////////////
+
+	void OnWriteToConsole(const char* text, bool newLine) override
+	{
+	}
+
+	void OnWriteToFile(const char* text, bool newLine) override
+	{
+		const unsigned long receiveTime = this->GetTime();
+
+		if (std::strncmp(text, MESSAGE_TAG, sizeof MESSAGE_TAG - 1) != 0)
+		{
+			// not sent by a producer
+			return;
+		}
+
+		char* pos = const_cast<char*>(text) + sizeof MESSAGE_TAG - 1;
+
+		const unsigned long index = std::strtoul(pos, &pos, 10);
+		const unsigned long sequence = std::strtoul(pos, &pos, 10);
+		const unsigned long sendTime = std::strtoul(pos, &pos, 10);
+
+		if (index >= m_config.threadCount)
+		{
+			return;
+		}
+
+		Producer& producer = m_producers[index];
+
+		if (sequence < producer.nextSequence)
+		{
+			OS::Atomic::Increment(&m_reorderedCount);
+		}
+		else
+		{
+			producer.nextSequence = sequence + 1;
+		}
+
+		producer.receivedCount++;
+
+		m_latencies.push_back(receiveTime - sendTime);
+
+		OS::Atomic::Increment(&m_receivedCount);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+
+private:
+	// microseconds since start
+	unsigned long GetTime() const
+	{
+		return static_cast<unsigned long>(((OS::GetPerformanceCounter() - m_startTime) * 1000000) / m_frequency);
+	}
+
+	long GetSentCount() const
+	{
+		long count = 0;
+
+		for (unsigned int i = 0; i < m_config.threadCount; i++)
+		{
+			count += m_producers[i].sentCount;
+		}
+
+		return count;
+	}
+
+	// messages sent, but neither received nor dropped yet
+	unsigned long GetBacklog() const
+	{
+		const Logger::Counters counters = m_logger.GetCounters();
+
+		const long doneCount = m_receivedCount + counters.writerDroppedCount + counters.callbackDroppedCount
+		                     + counters.rateLimitedCount + counters.suppressedCount;
+
+		const long backlog = this->GetSentCount() - doneCount;
+
+		return (backlog > 0) ? static_cast<unsigned long>(backlog) : 0;
+	}
+
+	void SampleBacklog()
+	{
+		const unsigned long backlog = this->GetBacklog();
+
+		m_backlogSum += backlog;
+		m_backlogMax = std::max(m_backlogMax, backlog);
+		m_backlogSampleCount++;
+	}
+
+	void StartProducers()
+	{
+		for (unsigned int i = 0; i < m_config.threadCount; i++)
+		{
+			Producer& producer = m_producers[i];
+			producer.pTest = this;
+			producer.index = i;
+
+			if (!producer.thread.Start(&StressTest::ProducerThread, &producer))
+			{
+				throw StringTools::OSError("Failed to start producer thread!");
+			}
+		}
+	}
+
+	void StopProducers()
+	{
+		OS::Atomic::Exchange(&m_isStopRequested, 1);
+
+		for (unsigned int i = 0; i < m_config.threadCount; i++)
+		{
+			m_producers[i].thread.Join();
+		}
+	}
+
+	static void ProducerThread(void* param)
+	{
+		Producer& producer = *static_cast<Producer*>(param);
+
+		producer.pTest->RunProducer(producer);
+	}
+
+	void RunProducer(Producer& producer)
+	{
+		OS::WaitableTimer timer;
+
+		const unsigned long startTime = this->GetTime();
+		unsigned long sequence = 0;
+
+		while (!m_isStopRequested)
+		{
+			if (m_config.messageRate)
+			{
+				const unsigned __int64 elapsed = this->GetTime() - startTime;
+				const unsigned __int64 dueCount = (elapsed * m_config.messageRate) / 1000000;
+
+				if (sequence >= dueCount)
+				{
+					timer.Sleep(PRODUCER_TICK_MICROSECONDS);
+					continue;
+				}
+			}
+
+			// counted first, so the backlog never goes negative
+			OS::Atomic::Increment(&producer.sentCount);
+
+			this->Log(MESSAGE_FORMAT, producer.index, sequence, this->GetTime());
+
+			sequence++;
+		}
+	}
+
+	void Log(const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		m_logger.LogV(ILog::eAlways, format, args);
+		va_end(args);
+	}
+
+	void Report(FramePacer& pacer)
+	{
+		const Logger::Counters counters = m_logger.GetCounters();
+
+		const long sentCount = this->GetSentCount();
+		const long lostCount = sentCount - m_receivedCount;
+		const double duration = m_config.duration;
+
+		std::printf("Frames: %lu (%lu missed)\n", pacer.GetFrameCount(), pacer.GetMissedCount());
+		PrintPercentiles("Frame time", m_frameTimes);
+		PrintPercentiles("OnUpdate", m_updateTimes);
+		PrintPercentiles("Latency", m_latencies);
+
+		std::printf("Backlog:     mean %.1f  max %lu messages\n",
+			(m_backlogSampleCount) ? static_cast<double>(m_backlogSum) / m_backlogSampleCount : 0.0,
+			m_backlogMax
+		);
+
+		std::printf("Messages:    sent %ld (%.0f/s)  received %ld  lost %ld (%.3f%%)  reordered %ld\n",
+			sentCount,
+			sentCount / duration,
+			static_cast<long>(m_receivedCount),
+			lostCount,
+			(sentCount) ? (100.0 * lostCount) / sentCount : 0.0,
+			static_cast<long>(m_reorderedCount)
+		);
+
+		std::printf("Dropped:     writer %ld  callbacks %ld  rate limit %ld  suppressed %ld\n",
+			counters.writerDroppedCount,
+			counters.callbackDroppedCount,
+			counters.rateLimitedCount,
+			counters.suppressedCount
+		);
+
+		std::printf("File writes: %ld\n", counters.fileWriteCount);
+		std::fflush(stdout);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	try
+	{
+		std::printf("%s\n\n", PROJECT_BANNER);
+
+		StressTest test;
+		test.Init();
+		test.Run();
+
+		return 0;
+	}
+	catch (const std::runtime_error& ex)
+	{
+		std::fprintf(stderr, "%s\n", ex.what());
+		std::fflush(stderr);
+		return 1;
+	}
+}
@@ -0,0 +1,38 @@
+/**
+ * @file
+ * @brief Microbenchmarks of the launcher library.
+ */
+
+#include <cstdio>
+#include <stdexcept>
+
+#include "Library/SIMD.h"
+#include "Project.h"
+
+#include "Benchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+const char* const PROJECT_BANNER = "C1-Launcher Benchmarks " PROJECT_VERSION_STRING " " PROJECT_BUILD_BITS;
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	try
+	{
+		std::printf("%s\n", PROJECT_BANNER);
+		std::printf("SIMD kernels: %s\n\n", SIMD::GetLevelName(SIMD::GetLevel()));
+
+		RunStringBenchmarks();
+		RunLoggerBenchmarks();
+
+		return 0;
+	}
+	catch (const std::runtime_error& ex)
+	{
+		std::fprintf(stderr, "%s\n", ex.what());
+		std::fflush(stderr);
+		return 1;
+	}
+}
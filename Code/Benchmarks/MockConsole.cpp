@@ -0,0 +1,422 @@
+#include <cstdlib>  // std::atoi, std::atof
+
+#include "Library/StringTools.h"
+#include "Library/StringView.h"
+
+#include "MockConsole.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// ICVar
+////////////////////////////////////////////////////////////////////////////////
+
+void MockConsole::CVar::Release()
+{
+}
+
+int MockConsole::CVar::GetIVal() const
+{
+	return std::atoi(m_value.c_str());
+}
+
+float MockConsole::CVar::GetFVal() const
+{
+	return static_cast<float>(std::atof(m_value.c_str()));
+}
+
+const char* MockConsole::CVar::GetString()
+{
+	return m_value.c_str();
+}
+
+void MockConsole::CVar::Set(const char* value)
+{
+	m_value = value;
+	m_flags |= VF_MODIFIED;
+
+	if (m_pChangeFunc)
+	{
+		m_pChangeFunc(this);
+	}
+}
+
+void MockConsole::CVar::ForceSet(const char* value)
+{
+	this->Set(value);
+}
+
+void MockConsole::CVar::Set(const float value)
+{
+	this->Set(StringTools::Format("%g", value).c_str());
+}
+
+void MockConsole::CVar::Set(const int value)
+{
+	this->Set(StringTools::Format("%d", value).c_str());
+}
+
+void MockConsole::CVar::ClearFlags(int flags)
+{
+	m_flags &= ~flags;
+}
+
+int MockConsole::CVar::GetFlags()
+{
+	return m_flags;
+}
+
+int MockConsole::CVar::SetFlags(int flags)
+{
+	m_flags = flags;
+
+	return m_flags;
+}
+
+int MockConsole::CVar::GetType()
+{
+	return m_type;
+}
+
+const char* MockConsole::CVar::GetName() const
+{
+	return m_name.c_str();
+}
+
+const char* MockConsole::CVar::GetHelp()
+{
+	return "";
+}
+
+void MockConsole::CVar::SetOnChangeCallback(ConsoleVarFunc pChangeFunc)
+{
+	m_pChangeFunc = pChangeFunc;
+}
+
+void MockConsole::CVar::GetMemoryUsage(ICrySizer* pSizer)
+{
+}
+
+int MockConsole::CVar::GetRealIVal() const
+{
+	return this->GetIVal();
+}
+
+void MockConsole::CVar::DebugLog(const int expectedValue, const EConsoleLogMode mode) const
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MockConsole::MockConsole() : m_lineCount(0)
+{
+}
+
+MockConsole::~MockConsole()
+{
+	for (std::map<std::string, CVar*>::iterator it = m_cvars.begin(); it != m_cvars.end(); ++it)
+	{
+		delete it->second;
+	}
+}
+
+ICVar* MockConsole::AddCVar(const char* name, const std::string& value, int type, int flags,
+                            ConsoleVarFunc pChangeFunc)
+{
+	std::map<std::string, CVar*>::iterator it = m_cvars.find(name);
+
+	if (it != m_cvars.end())
+	{
+		// the engine returns the existing variable as well
+		return it->second;
+	}
+
+	CVar* pCVar = new CVar(name, value, type, flags, pChangeFunc);
+	m_cvars[name] = pCVar;
+
+	return pCVar;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// IConsole
+////////////////////////////////////////////////////////////////////////////////
+
+void MockConsole::Release()
+{
+}
+
+ICVar* MockConsole::RegisterString(const char* name, const char* value, int flags, const char* help,
+                                   ConsoleVarFunc pChangeFunc)
+{
+	return this->AddCVar(name, value, CVAR_STRING, flags, pChangeFunc);
+}
+
+ICVar* MockConsole::RegisterInt(const char* name, int value, int flags, const char* help,
+                                ConsoleVarFunc pChangeFunc)
+{
+	return this->AddCVar(name, StringTools::Format("%d", value), CVAR_INT, flags, pChangeFunc);
+}
+
+ICVar* MockConsole::RegisterFloat(const char* name, float value, int flags, const char* help,
+                                  ConsoleVarFunc pChangeFunc)
+{
+	return this->AddCVar(name, StringTools::Format("%g", value), CVAR_FLOAT, flags, pChangeFunc);
+}
+
+ICVar* MockConsole::Register(const char* name, float* pValue, float defaultValue, int flags, const char* help,
+                             ConsoleVarFunc pChangeFunc)
+{
+	// variables bound to memory are not used by the logger
+	return NULL;
+}
+
+ICVar* MockConsole::Register(const char* name, int* pValue, int defaultValue, int flags, const char* help,
+                             ConsoleVarFunc pChangeFunc)
+{
+	// variables bound to memory are not used by the logger
+	return NULL;
+}
+
+void MockConsole::UnregisterVariable(const char* name, bool remove)
+{
+}
+
+void MockConsole::SetScrollMax(int value)
+{
+}
+
+void MockConsole::AddOutputPrintSink(IOutputPrintSink* pSink)
+{
+}
+
+void MockConsole::RemoveOutputPrintSink(IOutputPrintSink* pSink)
+{
+}
+
+void MockConsole::ShowConsole(bool show, const int requestScrollMax)
+{
+}
+
+void MockConsole::DumpCVars(ICVarDumpSink* pCallback, unsigned int flagsFilter)
+{
+	for (std::map<std::string, CVar*>::iterator it = m_cvars.begin(); it != m_cvars.end(); ++it)
+	{
+		if (!flagsFilter || (it->second->GetFlags() & flagsFilter))
+		{
+			pCallback->OnElementFound(it->second);
+		}
+	}
+}
+
+void MockConsole::CreateKeyBind(const char* cmd, const char* key)
+{
+}
+
+void MockConsole::SetImage(ITexture* pImage, bool removeCurrent)
+{
+}
+
+ITexture* MockConsole::GetImage()
+{
+	return NULL;
+}
+
+void MockConsole::StaticBackground(bool isStatic)
+{
+}
+
+void MockConsole::SetLoadingImage(const char* filename)
+{
+}
+
+bool MockConsole::GetLineNo(const int lineNo, char* buffer, const int bufferSize) const
+{
+	return false;
+}
+
+int MockConsole::GetLineCount() const
+{
+	return static_cast<int>(m_lineCount);
+}
+
+ICVar* MockConsole::GetCVar(const char* name)
+{
+	std::map<std::string, CVar*>::iterator it = m_cvars.find(name);
+
+	return (it != m_cvars.end()) ? it->second : NULL;
+}
+
+char* MockConsole::GetVariable(const char* name, const char* filename, const char* defaultValue)
+{
+	return NULL;
+}
+
+float MockConsole::GetVariable(const char* name, const char* filename, float defaultValue)
+{
+	return defaultValue;
+}
+
+void MockConsole::PrintLine(const char* text)
+{
+	m_lineCount++;
+}
+
+void MockConsole::PrintLinePlus(const char* text)
+{
+}
+
+bool MockConsole::GetStatus()
+{
+	return false;
+}
+
+void MockConsole::Clear()
+{
+}
+
+void MockConsole::Update()
+{
+}
+
+void MockConsole::Draw()
+{
+}
+
+void MockConsole::AddCommand(const char* name, ConsoleCommandFunc func, int flags, const char* help)
+{
+	m_commands[name] = func;
+}
+
+void MockConsole::AddCommand(const char* name, const char* scriptFunc, int flags, const char* help)
+{
+}
+
+void MockConsole::RemoveCommand(const char* name)
+{
+	m_commands.erase(name);
+}
+
+void MockConsole::ExecuteString(const char* command)
+{
+	// only "name value" is supported
+	const StringView line(command);
+
+	std::size_t pos = 0;
+	if (!line.FindEither(' ', '\t', pos))
+	{
+		pos = line.length;
+	}
+
+	StringView value(line);
+	value.RemovePrefix(pos);
+
+	while (value.IsNotEmpty() && (value.Front() == ' ' || value.Front() == '\t'))
+	{
+		value.PopFront();
+	}
+
+	ICVar* pCVar = this->GetCVar(std::string(line.string, pos).c_str());
+
+	if (pCVar)
+	{
+		pCVar->Set(value.ToStdString().c_str());
+	}
+}
+
+void MockConsole::Exit(const char* command, ...)
+{
+}
+
+bool MockConsole::IsOpened()
+{
+	return false;
+}
+
+int MockConsole::GetNumVars()
+{
+	return static_cast<int>(m_cvars.size());
+}
+
+std::size_t MockConsole::GetSortedVars(const char** buffer, std::size_t bufferSize, const char* prefix)
+{
+	return 0;
+}
+
+const char* MockConsole::AutoComplete(const char* substr)
+{
+	return NULL;
+}
+
+const char* MockConsole::AutoCompletePrev(const char* substr)
+{
+	return NULL;
+}
+
+char* MockConsole::ProcessCompletion(const char* input)
+{
+	return NULL;
+}
+
+void MockConsole::RegisterAutoComplete(const char* name, IConsoleArgumentAutoComplete* pArgAutoComplete)
+{
+}
+
+void MockConsole::ResetAutoCompletion()
+{
+}
+
+void MockConsole::GetMemoryUsage(ICrySizer* pSizer)
+{
+}
+
+void MockConsole::ResetProgressBar(int progressRange)
+{
+}
+
+void MockConsole::TickProgressBar()
+{
+}
+
+void MockConsole::SetInputLine(const char* line)
+{
+}
+
+void MockConsole::DumpKeyBinds(IKeyBindDumpSink* pCallback)
+{
+}
+
+const char* MockConsole::FindKeyBind(const char* cmd) const
+{
+	return NULL;
+}
+
+void MockConsole::AddConsoleVarSink(IConsoleVarSink* pSink)
+{
+}
+
+void MockConsole::RemoveConsoleVarSink(IConsoleVarSink* pSink)
+{
+}
+
+const char* MockConsole::GetHistoryElement(const bool isUpOrDown)
+{
+	return NULL;
+}
+
+void MockConsole::AddCommandToHistory(const char* command)
+{
+}
+
+void MockConsole::LoadConfigVar(const char* var, const char* value)
+{
+	ICVar* pCVar = this->GetCVar(var);
+
+	if (pCVar)
+	{
+		pCVar->Set(value);
+	}
+}
+
+void MockConsole::EnableActivationKey(bool enable)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "CryCommon/CrySystem/IConsole.h"
+
+/**
+ * Just enough of the engine console to run the logger outside of the engine.
+ *
+ * Console variables keep their value as a string and invoke their change callback on each Set. Commands are
+ * registered, but only "name value" assignments of variables can be executed. Printed lines are only counted, see GetLineCount.
+ */
+class MockConsole : public IConsole
+{
+	class CVar : public ICVar
+	{
+		std::string m_name;
+		std::string m_value;
+		int m_type;
+		int m_flags;
+		ConsoleVarFunc m_pChangeFunc;
+
+	public:
+		CVar(const char* name, const std::string& value, int type, int flags, ConsoleVarFunc pChangeFunc)
+		: m_name(name), m_value(value), m_type(type), m_flags(flags), m_pChangeFunc(pChangeFunc)
+		{
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// ICVar
+		////////////////////////////////////////////////////////////////////////////////
+
+		void Release() override;
+
+		int GetIVal() const override;
+		float GetFVal() const override;
+		const char* GetString() override;
+
+		void Set(const char* value) override;
+		void ForceSet(const char* value) override;
+		void Set(const float value) override;
+		void Set(const int value) override;
+
+		void ClearFlags(int flags) override;
+		int GetFlags() override;
+		int SetFlags(int flags) override;
+
+		int GetType() override;
+
+		const char* GetName() const override;
+
+		const char* GetHelp() override;
+
+		void SetOnChangeCallback(ConsoleVarFunc pChangeFunc) override;
+
+		void GetMemoryUsage(ICrySizer* pSizer) override;
+
+		int GetRealIVal() const override;
+
+		void DebugLog(const int expectedValue, const EConsoleLogMode mode) const override;
+
+		////////////////////////////////////////////////////////////////////////////////
+	};
+
+	std::map<std::string, CVar*> m_cvars;
+	std::map<std::string, ConsoleCommandFunc> m_commands;
+	unsigned long m_lineCount;
+
+	// no copies
+	MockConsole(const MockConsole&);
+	MockConsole& operator=(const MockConsole&);
+
+	ICVar* AddCVar(const char* name, const std::string& value, int type, int flags, ConsoleVarFunc pChangeFunc);
+
+public:
+	MockConsole();
+	~MockConsole();
+
+	////////////////////////////////////////////////////////////////////////////////
+	// IConsole
+	////////////////////////////////////////////////////////////////////////////////
+
+	void Release() override;
+
+	ICVar* RegisterString(const char* name, const char* value, int flags, const char* help,
+	                      ConsoleVarFunc pChangeFunc) override;
+	ICVar* RegisterInt(const char* name, int value, int flags, const char* help,
+	                   ConsoleVarFunc pChangeFunc) override;
+	ICVar* RegisterFloat(const char* name, float value, int flags, const char* help,
+	                     ConsoleVarFunc pChangeFunc) override;
+	ICVar* Register(const char* name, float* pValue, float defaultValue, int flags, const char* help,
+	                ConsoleVarFunc pChangeFunc) override;
+	ICVar* Register(const char* name, int* pValue, int defaultValue, int flags, const char* help,
+	                ConsoleVarFunc pChangeFunc) override;
+
+	void UnregisterVariable(const char* name, bool remove) override;
+
+	void SetScrollMax(int value) override;
+
+	void AddOutputPrintSink(IOutputPrintSink* pSink) override;
+	void RemoveOutputPrintSink(IOutputPrintSink* pSink) override;
+
+	void ShowConsole(bool show, const int requestScrollMax) override;
+
+	void DumpCVars(ICVarDumpSink* pCallback, unsigned int flagsFilter) override;
+
+	void CreateKeyBind(const char* cmd, const char* key) override;
+
+	void SetImage(ITexture* pImage, bool removeCurrent) override;
+	ITexture* GetImage() override;
+
+	void StaticBackground(bool isStatic) override;
+
+	void SetLoadingImage(const char* filename) override;
+
+	bool GetLineNo(const int lineNo, char* buffer, const int bufferSize) const override;
+	int GetLineCount() const override;
+
+	ICVar* GetCVar(const char* name) override;
+	char* GetVariable(const char* name, const char* filename, const char* defaultValue) override;
+	float GetVariable(const char* name, const char* filename, float defaultValue) override;
+
+	void PrintLine(const char* text) override;
+	void PrintLinePlus(const char* text) override;
+
+	bool GetStatus() override;
+
+	void Clear() override;
+
+	void Update() override;
+
+	void Draw() override;
+
+	void AddCommand(const char* name, ConsoleCommandFunc func, int flags, const char* help) override;
+	void AddCommand(const char* name, const char* scriptFunc, int flags, const char* help) override;
+	void RemoveCommand(const char* name) override;
+
+	void ExecuteString(const char* command) override;
+
+	void Exit(const char* command, ...) override;
+
+	bool IsOpened() override;
+
+	int GetNumVars() override;
+	std::size_t GetSortedVars(const char** buffer, std::size_t bufferSize, const char* prefix) override;
+	const char* AutoComplete(const char* substr) override;
+	const char* AutoCompletePrev(const char* substr) override;
+	char* ProcessCompletion(const char* input) override;
+	void RegisterAutoComplete(const char* name, IConsoleArgumentAutoComplete* pArgAutoComplete) override;
+	void ResetAutoCompletion() override;
+
+	void GetMemoryUsage(ICrySizer* pSizer) override;
+
+	void ResetProgressBar(int progressRange) override;
+	void TickProgressBar() override;
+
+	void SetInputLine(const char* line) override;
+
+	void DumpKeyBinds(IKeyBindDumpSink* pCallback) override;
+	const char* FindKeyBind(const char* cmd) const override;
+
+	void AddConsoleVarSink(IConsoleVarSink* pSink) override;
+	void RemoveConsoleVarSink(IConsoleVarSink* pSink) override;
+
+	const char* GetHistoryElement(const bool isUpOrDown) override;
+	void AddCommandToHistory(const char* command) override;
+
+	void LoadConfigVar(const char* var, const char* value) override;
+
+	void EnableActivationKey(bool enable) override;
+
+	////////////////////////////////////////////////////////////////////////////////
+};
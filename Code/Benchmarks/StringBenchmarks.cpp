@@ -0,0 +1,149 @@
+#include <string>
+
+#include "Library/PathTools.h"
+#include "Library/SIMD.h"
+#include "Library/StringTools.h"
+#include "Library/StringView.h"
+
+#include "Benchmark.h"
+
+#define LONG_TEXT_LENGTH 8000
+#define SCAN_TEXT_LENGTH 4096
+
+static void FormatShort(unsigned int count, void* param)
+{
+	std::string result;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		result.clear();
+		StringTools::FormatTo(result, "Player %s connected from %s:%u", "Nomad", "192.168.0.1", i);
+	}
+
+	Benchmark::Consume(result.length());
+}
+
+static void FormatLong(unsigned int count, void* param)
+{
+	const std::string text(LONG_TEXT_LENGTH, 'x');
+
+	std::string result;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		result.clear();
+		StringTools::FormatTo(result, "<%s>", text.c_str());
+	}
+
+	Benchmark::Consume(result.length());
+}
+
+static void FormatNew(unsigned int count, void* param)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const std::string result = StringTools::Format("Player %s connected from %s:%u", "Nomad", "192.168.0.1", i);
+
+		Benchmark::Consume(result.length());
+	}
+}
+
+static void FormatTime(unsigned int count, void* param)
+{
+	std::string result;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		result.clear();
+		StringTools::FormatTo(result, "%02u:%02u:%02u", i % 24, i % 60, (i / 60) % 60);
+	}
+
+	Benchmark::Consume(result.length());
+}
+
+static void AppendTime(unsigned int count, void* param)
+{
+	std::string result;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		result.clear();
+		StringTools::AppendDecimal(result, i % 24, 2);
+		result += ':';
+		StringTools::AppendDecimal(result, i % 60, 2);
+		result += ':';
+		StringTools::AppendDecimal(result, (i / 60) % 60, 2);
+	}
+
+	Benchmark::Consume(result.length());
+}
+
+static void CompareNoCase(unsigned int count, void* param)
+{
+	const StringView a = "Game/Levels/Multiplayer/IA/Steelmill/Level.pak";
+	const StringView b = "GAME/LEVELS/MULTIPLAYER/IA/STEELMILL/LEVEL.PAK";
+
+	std::size_t equalCount = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		equalCount += a.IsEqualNoCase(b);
+	}
+
+	Benchmark::Consume(equalCount);
+}
+
+static void BaseName(unsigned int count, void* param)
+{
+	const StringView path = "C:\\Program Files (x86)\\Electronic Arts\\Crytek\\Crysis\\Game\\Levels\\Level.pak";
+
+	std::size_t length = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		length += PathTools::BaseName(path).length;
+	}
+
+	Benchmark::Consume(length);
+}
+
+static void Find(unsigned int count, void* param)
+{
+	const std::string text(SCAN_TEXT_LENGTH, 'x');
+
+	std::size_t pos = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		pos += SIMD::Find(text.c_str(), text.length(), '\n');
+	}
+
+	Benchmark::Consume(pos);
+}
+
+static void FindEither(unsigned int count, void* param)
+{
+	const std::string text(SCAN_TEXT_LENGTH, 'x');
+
+	std::size_t pos = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		pos += SIMD::FindEither(text.c_str(), text.length(), '\n', '$');
+	}
+
+	Benchmark::Consume(pos);
+}
+
+void RunStringBenchmarks()
+{
+	Benchmark::Run("StringTools::FormatTo short", &FormatShort);
+	Benchmark::Run("StringTools::FormatTo 8 KiB", &FormatLong);
+	Benchmark::Run("StringTools::Format new string", &FormatNew);
+	Benchmark::Run("StringTools::FormatTo %02u time", &FormatTime);
+	Benchmark::Run("StringTools::AppendDecimal time", &AppendTime);
+	Benchmark::Run("StringView::IsEqualNoCase 46 bytes", &CompareNoCase);
+	Benchmark::Run("PathTools::BaseName", &BaseName);
+	Benchmark::Run("SIMD::Find 4 KiB", &Find);
+	Benchmark::Run("SIMD::FindEither 4 KiB", &FindEither);
+}
@@ -0,0 +1,26 @@
+// Copyright (C) 2001-2008 Crytek GmbH
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Collects memory usage of engine components. Used by the GetMemoryUsage methods.
+ */
+class ICrySizer
+{
+public:
+	virtual void Release() = 0;
+	virtual std::size_t GetTotalSize() = 0;
+	virtual std::size_t GetObjectCount() = 0;
+	virtual void Reset() = 0;
+
+	// the identifier must be unique for each object, the count is used only for statistics
+	// returns false if the object has already been added
+	virtual bool AddObject(const void* pIdentifier, std::size_t size, int count = 1) = 0;
+
+	// component names form a tree shown by DumpMemoryUsageStatistics
+	virtual void Push(const char* componentName) = 0;
+	virtual void PushSubcomponent(const char* subcomponentName) = 0;
+	virtual void Pop() = 0;
+};
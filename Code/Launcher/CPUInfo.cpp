@@ -3,18 +3,21 @@
 #include "CryCommon/CrySystem/ISystem.h"
 #include "Library/CPUID.h"
 #include "Library/OS.h"
+#include "Library/SIMD.h"
 
 #include "CPUInfo.h"
 #include "LauncherCommon.h"
 
-static unsigned int GetCoreCount()
+static unsigned int LimitCoreCount(unsigned int coreCount)
 {
-	unsigned int coreCount = OS::GetLogicalProcessorCount();
-
 	if (coreCount > CPUInfo::MAX_CORE_COUNT)
 	{
 		coreCount = CPUInfo::MAX_CORE_COUNT;
 	}
+	else if (coreCount == 0)
+	{
+		coreCount = 1;
+	}
 
 	return coreCount;
 }
@@ -51,23 +54,48 @@ void CPUInfo::Detect(CPUInfo* self, ISystem* pSystem)
 	// CPU detection is the earliest intercepted stage of CryEngine initialization
 	LauncherCommon::OnEarlyEngineInit(pSystem);
 
-	const unsigned int coreCount = GetCoreCount();
+	const OS::ProcessorTopology topology = OS::GetProcessorTopology();
 	const unsigned int features = GetFeatures();
 
 	std::memset(self, 0, sizeof(CPUInfo));
 
 	// only the following is needed
-	self->coreCountTotal = coreCount;
-	self->coreCountAvailable = coreCount;
-	self->coreCountPhysical = coreCount;
+	// the engine sizes its worker threads by the physical core count, so do not count SMT siblings twice
+	self->coreCountTotal = LimitCoreCount(topology.logicalCount);
+	self->coreCountAvailable = LimitCoreCount(topology.availableLogicalCount);
+	self->coreCountPhysical = LimitCoreCount(topology.availablePhysicalCount);
 	self->cores[0].flags = features;
 
-	CryLogAlways("%s [Count: %u] [Features:%s%s%s%s]",
+	CryLogAlways("%s [Cores: %u] [Threads: %u] [Available: %u cores, %u threads] [Features:%s%s%s%s%s%s%s%s%s%s]",
 		g_cpuid.brand_string,
-		coreCount,
+		topology.physicalCount,
+		topology.logicalCount,
+		topology.availablePhysicalCount,
+		topology.availableLogicalCount,
 		(features & FLAG_MMX)   ? " MMX"    : "",
 		(features & FLAG_3DNOW) ? " 3DNow!" : "",
 		(features & FLAG_SSE)   ? " SSE"    : "",
-		(features & FLAG_SSE2)  ? " SSE2"   : ""
+		(features & FLAG_SSE2)  ? " SSE2"   : "",
+		g_cpuid.HasSSE3()       ? " SSE3"   : "",
+		g_cpuid.HasSSSE3()      ? " SSSE3"  : "",
+		g_cpuid.HasSSE41()      ? " SSE4.1" : "",
+		g_cpuid.HasSSE42()      ? " SSE4.2" : "",
+		g_cpuid.HasAVX()        ? " AVX"    : "",
+		g_cpuid.HasAVX2()       ? " AVX2"   : ""
 	);
+
+	CryLogAlways("Launcher SIMD kernels: %s", SIMD::GetLevelName(SIMD::GetLevel()));
+
+	if (topology.packageCount > 1)
+	{
+		CryLogAlways("CPU packages: %u", topology.packageCount);
+	}
+
+	if (topology.performanceCount > 0)
+	{
+		CryLogAlways("Hybrid CPU: %u performance cores, %u efficiency cores",
+			topology.performanceCount,
+			topology.physicalCount - topology.performanceCount
+		);
+	}
 }
@@ -1,5 +1,6 @@
 #include "Library/CrashLogger.h"
 #include "Library/OS.h"
+#include "Library/StartupTimer.h"
 
 #include "../CPUInfo.h"
 #include "../LauncherCommon.h"
@@ -14,7 +15,8 @@ static std::FILE* OpenLogFile()
 	return LauncherCommon::OpenLogFile(DEFAULT_LOG_FILE_NAME);
 }
 
-DedicatedServerLauncher::DedicatedServerLauncher() : m_pGameStartup(NULL), m_params(), m_dlls()
+DedicatedServerLauncher::DedicatedServerLauncher() : m_pGameStartup(NULL), m_params(), m_dlls(),
+  m_lockedWorkingSetSize(0), m_isWorkingSetLocked(false), m_workingSetError(0), m_largePagesFailure(NULL)
 {
 }
 
@@ -28,48 +30,177 @@ DedicatedServerLauncher::~DedicatedServerLauncher()
 
 int DedicatedServerLauncher::Run()
 {
+	StartupTimer::Start();
+
+	LauncherCommon::LoadConfigFile();
+
 	m_params.hInstance = OS::Module::GetEXE();
 	m_params.logFileName = DEFAULT_LOG_FILE_NAME;
 	m_params.isDedicatedServer = true;
 
 	LauncherCommon::SetParamsCmdLine(m_params, OS::CmdLine::Get());
 
-	CrashLogger::Enable(&OpenLogFile);
+	LauncherCommon::EnableCrashLogger(&OpenLogFile);
+
+	LauncherCommon::SetProcessorAffinity();
+	LauncherCommon::SetProcessPriority();
+
+	const unsigned int timerResolution = LauncherCommon::GetTimerResolution();
+
+	m_lockedWorkingSetSize = LauncherCommon::GetLockedWorkingSetSize();
+
+	if (m_lockedWorkingSetSize)
+	{
+		m_isWorkingSetLocked = LauncherCommon::LockWorkingSet(m_lockedWorkingSetSize);
+		m_workingSetError = (m_isWorkingSetLocked) ? 0 : OS::GetCurrentErrorCode();
+	}
 
 	this->LoadEngine();
 	this->PatchEngine();
 
+	const unsigned int tickRate = LauncherCommon::GetTickRate();
+
 	m_pGameStartup = LauncherCommon::StartEngine(m_dlls.pCryGame, m_params);
 
-	return m_pGameStartup->Run(NULL);
+	this->LogMemorySettings();
+
+	// without the launcher loop, there are no idle ticks to wait for
+	LauncherCommon::StartPakWarm(tickRate != 0);
+
+	if (tickRate)
+	{
+		// finished by the first update
+		StartupTimer::BeginStep("FirstUpdate");
+
+		// the loop shuts down the engine itself
+		IGameStartup* pGameStartup = m_pGameStartup;
+		m_pGameStartup = NULL;
+
+		return LauncherCommon::RunServerLoop(pGameStartup, tickRate);
+	}
+
+	// the engine runs its own loop, so there is no way to see the first update
+	LauncherCommon::FinishStartup();
+
+	return LauncherCommon::RunEngineLoop(m_pGameStartup, timerResolution);
 }
 
 void DedicatedServerLauncher::LoadEngine()
 {
+	StartupTimer::Scope step("LoadEngine");
+
 	m_dlls.pCrySystem = LauncherCommon::LoadModule("CrySystem.dll");
 
+	// runs while the game build is checked and the rest of the engine DLLs are loaded
+	LauncherCommon::StartPrefetch("CryRenderNULL.dll");
+
 	m_dlls.gameBuild = LauncherCommon::GetGameBuild(m_dlls.pCrySystem);
 
 	LauncherCommon::VerifyGameBuild(m_dlls.gameBuild);
 
+	// must be done before any other engine DLL is loaded
+	if (OS::CmdLine::HasArg("-poolalloc") || OS::CmdLine::HasArg("-largepages"))
+	{
+		LauncherCommon::EnablePoolAllocator(m_dlls.pCrySystem);
+
+		if (OS::CmdLine::HasArg("-largepages"))
+		{
+			// normal pages are fine as well
+			m_largePagesFailure = LauncherCommon::EnableLargePages();
+		}
+	}
+
 	m_dlls.pCryGame = LauncherCommon::LoadModule("CryGame.dll");
 	m_dlls.pCryNetwork = LauncherCommon::LoadModule("CryNetwork.dll");
+
+	// same footprint as the headless server, only the console window stays
+	if (OS::CmdLine::HasArg("-lowresource"))
+	{
+		m_dlls.pCryAction = LauncherCommon::LoadModule("CryAction.dll");
+		m_dlls.pCryRenderNULL = LauncherCommon::LoadModule("CryRenderNULL.dll");
+	}
 }
 
 void DedicatedServerLauncher::PatchEngine()
 {
+	StartupTimer::Scope step("PatchEngine");
+
+	const bool isLowResource = OS::CmdLine::HasArg("-lowresource");
+
+	if (m_dlls.pCryAction)
+	{
+		MemoryPatch::Batch patch(m_dlls.pCryAction, "CryAction");
+
+		MemoryPatch::CryAction::DisableGameplayStats(patch, m_dlls.gameBuild);
+
+		patch.Apply();
+	}
+
 	if (m_dlls.pCryNetwork)
 	{
-		MemoryPatch::CryNetwork::EnablePreordered(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::AllowSameCDKeys(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::FixInternetConnect(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::FixFileCheckCrash(m_dlls.pCryNetwork, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryNetwork, "CryNetwork");
+
+		MemoryPatch::CryNetwork::EnablePreordered(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::AllowSameCDKeys(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::FixInternetConnect(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::FixFileCheckCrash(patch, m_dlls.gameBuild);
+
+		if (isLowResource)
+		{
+			MemoryPatch::CryNetwork::DisableServerProfile(patch, m_dlls.gameBuild);
+		}
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCrySystem)
 	{
-		MemoryPatch::CrySystem::UnhandledExceptions(m_dlls.pCrySystem, m_dlls.gameBuild);
-		MemoryPatch::CrySystem::HookCPUDetect(m_dlls.pCrySystem, m_dlls.gameBuild, &CPUInfo::Detect);
-		MemoryPatch::CrySystem::HookError(m_dlls.pCrySystem, m_dlls.gameBuild, &CrashLogger::OnEngineError);
+		MemoryPatch::Batch patch(m_dlls.pCrySystem, "CrySystem");
+
+		MemoryPatch::CrySystem::UnhandledExceptions(patch, m_dlls.gameBuild);
+		MemoryPatch::CrySystem::HookCPUDetect(patch, m_dlls.gameBuild, &CPUInfo::Detect);
+		MemoryPatch::CrySystem::HookError(patch, m_dlls.gameBuild, &CrashLogger::OnEngineError);
+
+		patch.Apply();
+	}
+
+	if (m_dlls.pCryRenderNULL)
+	{
+		MemoryPatch::Batch patch(m_dlls.pCryRenderNULL, "CryRenderNULL");
+
+		MemoryPatch::CryRenderNULL::DisableDebugRenderer(patch, m_dlls.gameBuild);
+
+		patch.Apply();
+	}
+}
+
+/**
+ * The engine log is not open yet when the memory settings are applied, so they are reported afterwards.
+ */
+void DedicatedServerLauncher::LogMemorySettings()
+{
+	if (m_lockedWorkingSetSize)
+	{
+		if (m_isWorkingSetLocked)
+		{
+			CryLogAlways("Working set: %u MiB locked", m_lockedWorkingSetSize);
+		}
+		else
+		{
+			CryLogWarningAlways("Working set: failed to lock %u MiB (error %lu)", m_lockedWorkingSetSize,
+				m_workingSetError);
+		}
+	}
+
+	if (OS::CmdLine::HasArg("-largepages"))
+	{
+		if (m_largePagesFailure)
+		{
+			CryLogWarningAlways("Large pages: disabled (%s)", m_largePagesFailure);
+		}
+		else
+		{
+			CryLogAlways("Large pages: enabled (%u KiB)", static_cast<unsigned int>(OS::GetLargePageSize() / 1024));
+		}
 	}
 }
@@ -11,14 +11,21 @@ class DedicatedServerLauncher
 	struct DLLs
 	{
 		void* pCryGame;
+		void* pCryAction;
 		void* pCryNetwork;
 		void* pCrySystem;
+		void* pCryRenderNULL;
 
 		int gameBuild;
 	};
 
 	DLLs m_dlls;
 
+	unsigned int m_lockedWorkingSetSize;  // MiB, zero if not requested
+	bool m_isWorkingSetLocked;
+	unsigned long m_workingSetError;
+	const char* m_largePagesFailure;  // NULL if large pages are enabled or not requested
+
 public:
 	DedicatedServerLauncher();
 	~DedicatedServerLauncher();
@@ -28,4 +35,6 @@ public:
 private:
 	void LoadEngine();
 	void PatchEngine();
+
+	void LogMemorySettings();
 };
@@ -0,0 +1,81 @@
+#include "CryCommon/CrySystem/ISystem.h"
+#include "Library/OS.h"
+
+#include "FrameLimiter.h"
+
+// milliseconds
+#define FOREGROUND_CHECK_INTERVAL 250
+
+FrameLimiter::FrameLimiter() : m_pacer(1), m_foregroundRate(0), m_backgroundRate(0), m_currentRate(0),
+  m_timerResolution(0), m_checkTime(0), m_isCheckRequested(true), m_isForeground(true)
+{
+}
+
+void FrameLimiter::Init(unsigned int foregroundRate, unsigned int backgroundRate, unsigned int timerResolution)
+{
+	m_foregroundRate = foregroundRate;
+	m_backgroundRate = backgroundRate;
+	m_timerResolution = timerResolution;
+	m_currentRate = 0;
+	m_isCheckRequested = true;
+}
+
+void FrameLimiter::OnUpdate()
+{
+	if (!this->IsEnabled())
+	{
+		return;
+	}
+
+	const unsigned long now = OS::GetTickCount();
+
+	if (m_isCheckRequested || (now - m_checkTime) >= FOREGROUND_CHECK_INTERVAL)
+	{
+		m_isCheckRequested = false;
+		m_checkTime = now;
+
+		const bool isForeground = OS::IsProcessInForeground();
+		const unsigned int rate = (isForeground) ? m_foregroundRate : m_backgroundRate;
+
+		if (isForeground != m_isForeground)
+		{
+			m_isForeground = isForeground;
+
+			const char* state = (isForeground) ? "foreground" : "background";
+
+			if (rate)
+			{
+				CryLog("Frame limiter: %s, %u FPS", state, rate);
+			}
+			else
+			{
+				CryLog("Frame limiter: %s, unlimited", state);
+			}
+		}
+
+		if (rate != m_currentRate)
+		{
+			m_currentRate = rate;
+
+			if (rate)
+			{
+				m_pacer.SetFrameRate(rate);
+			}
+		}
+
+		// long background frames do not need precise sleeps
+		if (isForeground && rate)
+		{
+			m_pacer.RequestTimerResolution(m_timerResolution);
+		}
+		else
+		{
+			m_pacer.ReleaseTimerResolution();
+		}
+	}
+
+	if (m_currentRate)
+	{
+		m_pacer.Wait();
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Library/FramePacer.h"
+
+/**
+ * Caps the frame rate of the game, usually much lower while the game is in background.
+ *
+ * The engine does not tell the launcher when the game window gets or loses focus, so the foreground window is checked
+ * periodically and on each process switch.
+ */
+class FrameLimiter
+{
+	FramePacer m_pacer;
+
+	// zero means unlimited
+	unsigned int m_foregroundRate;
+	unsigned int m_backgroundRate;
+	unsigned int m_currentRate;
+
+	// milliseconds requested while limiting the game in foreground, zero to keep the system default
+	unsigned int m_timerResolution;
+
+	unsigned long m_checkTime;  // OS::GetTickCount of the last foreground check
+	bool m_isCheckRequested;
+	bool m_isForeground;
+
+	// no copies
+	FrameLimiter(const FrameLimiter&);
+	FrameLimiter& operator=(const FrameLimiter&);
+
+public:
+	FrameLimiter();
+
+	void Init(unsigned int foregroundRate, unsigned int backgroundRate, unsigned int timerResolution);
+
+	bool IsEnabled() const
+	{
+		return m_foregroundRate || m_backgroundRate;
+	}
+
+	void OnProcessSwitch()
+	{
+		m_isCheckRequested = true;
+	}
+
+	// called once per frame, waits until the next frame should begin
+	void OnUpdate();
+};
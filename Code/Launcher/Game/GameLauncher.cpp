@@ -1,5 +1,10 @@
+#include <cstdlib>  // std::atoi
+
+#include "CryCommon/CrySystem/ICrySizer.h"
 #include "Library/CrashLogger.h"
 #include "Library/OS.h"
+#include "Library/StartupTimer.h"
+#include "Library/StringTools.h"
 
 #include "../CPUInfo.h"
 #include "../LauncherCommon.h"
@@ -8,13 +13,35 @@
 #include "GameLauncher.h"
 
 #define DEFAULT_LOG_FILE_NAME "Game.log"
+#define MAX_FRAME_RATE_LIMIT 1000
 
 static std::FILE* OpenLogFile()
 {
 	return LauncherCommon::OpenLogFile(DEFAULT_LOG_FILE_NAME);
 }
 
-GameLauncher::GameLauncher() : m_pGameStartup(NULL), m_params(), m_dlls()
+// zero means unlimited
+static unsigned int GetFrameRateLimit(const char* arg, unsigned int defaultValue)
+{
+	const char* value = OS::CmdLine::GetArgValue(arg, NULL);
+
+	if (!value)
+	{
+		return defaultValue;
+	}
+
+	const int frameRate = std::atoi(value);
+
+	if (frameRate < 0 || frameRate > MAX_FRAME_RATE_LIMIT)
+	{
+		throw StringTools::Error("Invalid %s value \"%s\"!\nUse 1 to %d FPS or 0 for unlimited.", arg, value,
+		                         MAX_FRAME_RATE_LIMIT);
+	}
+
+	return frameRate;
+}
+
+GameLauncher::GameLauncher() : m_pGameStartup(NULL), m_params(), m_dlls(), m_frameLimiter()
 {
 }
 
@@ -28,35 +55,70 @@ GameLauncher::~GameLauncher()
 
 int GameLauncher::Run()
 {
+	StartupTimer::Start();
+
+	LauncherCommon::LoadConfigFile();
+
 	m_params.hInstance = OS::Module::GetEXE();
 	m_params.logFileName = DEFAULT_LOG_FILE_NAME;
+	m_params.pUserCallback = this;
 
 	LauncherCommon::SetParamsCmdLine(m_params, OS::CmdLine::Get());
 
-	CrashLogger::Enable(&OpenLogFile);
+	LauncherCommon::EnableCrashLogger(&OpenLogFile);
+
+	LauncherCommon::SetProcessorAffinity();
+	LauncherCommon::SetProcessPriority();
+
+	const unsigned int maxFPS = GetFrameRateLimit("-maxfps", 0);
+	const unsigned int maxBackgroundFPS = GetFrameRateLimit("-maxfps_background", maxFPS);
+
+	const unsigned int timerResolution = LauncherCommon::GetTimerResolution();
+
+	m_frameLimiter.Init(maxFPS, maxBackgroundFPS, timerResolution);
 
 	this->LoadEngine();
 	this->PatchEngine();
 
 	m_pGameStartup = LauncherCommon::StartEngine(m_dlls.pCryGame, m_params);
 
-	return m_pGameStartup->Run(NULL);
+	// finished by the first OnUpdate
+	StartupTimer::BeginStep("FirstUpdate");
+
+	if (m_frameLimiter.IsEnabled())
+	{
+		// the frame limiter requests the timer resolution itself, only while it limits the game in foreground
+		return m_pGameStartup->Run(NULL);
+	}
+
+	return LauncherCommon::RunEngineLoop(m_pGameStartup, timerResolution);
 }
 
 void GameLauncher::LoadEngine()
 {
+	StartupTimer::Scope step("LoadEngine");
+
 	m_dlls.pCrySystem = LauncherCommon::LoadModule("CrySystem.dll");
 
+	const bool isDX10 = !OS::CmdLine::HasArg("-dx9") && (OS::CmdLine::HasArg("-dx10") || OS::IsVistaOrLater());
+
+	// runs while the game build is checked and the rest of the engine DLLs are loaded
+	LauncherCommon::StartPrefetch(isDX10 ? "CryRenderD3D10.dll" : "CryRenderD3D9.dll");
+
 	m_dlls.gameBuild = LauncherCommon::GetGameBuild(m_dlls.pCrySystem);
 
 	LauncherCommon::VerifyGameBuild(m_dlls.gameBuild);
 
+	// must be done before any other engine DLL is loaded
+	if (OS::CmdLine::HasArg("-poolalloc"))
+	{
+		LauncherCommon::EnablePoolAllocator(m_dlls.pCrySystem);
+	}
+
 	m_dlls.pCryGame = LauncherCommon::LoadModule("CryGame.dll");
 	m_dlls.pCryAction = LauncherCommon::LoadModule("CryAction.dll");
 	m_dlls.pCryNetwork = LauncherCommon::LoadModule("CryNetwork.dll");
 
-	const bool isDX10 = !OS::CmdLine::HasArg("-dx9") && (OS::CmdLine::HasArg("-dx10") || OS::IsVistaOrLater());
-
 	if (isDX10)
 	{
 		m_dlls.pCryRenderD3D10 = LauncherCommon::LoadModule("CryRenderD3D10.dll");
@@ -65,42 +127,104 @@ void GameLauncher::LoadEngine()
 
 void GameLauncher::PatchEngine()
 {
+	StartupTimer::Scope step("PatchEngine");
+
 	if (m_dlls.pCryGame)
 	{
-		MemoryPatch::CryGame::CanJoinDX10Servers(m_dlls.pCryGame, m_dlls.gameBuild);
-		MemoryPatch::CryGame::EnableDX10Menu(m_dlls.pCryGame, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryGame, "CryGame");
+
+		MemoryPatch::CryGame::CanJoinDX10Servers(patch, m_dlls.gameBuild);
+		MemoryPatch::CryGame::EnableDX10Menu(patch, m_dlls.gameBuild);
 
 		if (!OS::CmdLine::HasArg("-splash"))
 		{
-			MemoryPatch::CryGame::DisableIntros(m_dlls.pCryGame, m_dlls.gameBuild);
+			MemoryPatch::CryGame::DisableIntros(patch, m_dlls.gameBuild);
 		}
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCryAction)
 	{
-		MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(m_dlls.pCryAction, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryAction, "CryAction");
+
+		MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(patch, m_dlls.gameBuild);
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCryNetwork)
 	{
-		MemoryPatch::CryNetwork::EnablePreordered(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::AllowSameCDKeys(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::FixInternetConnect(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::FixFileCheckCrash(m_dlls.pCryNetwork, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryNetwork, "CryNetwork");
+
+		MemoryPatch::CryNetwork::EnablePreordered(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::AllowSameCDKeys(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::FixInternetConnect(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::FixFileCheckCrash(patch, m_dlls.gameBuild);
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCrySystem)
 	{
-		MemoryPatch::CrySystem::RemoveSecuROM(m_dlls.pCrySystem, m_dlls.gameBuild);
-		MemoryPatch::CrySystem::AllowDX9VeryHighSpec(m_dlls.pCrySystem, m_dlls.gameBuild);
-		MemoryPatch::CrySystem::AllowMultipleInstances(m_dlls.pCrySystem, m_dlls.gameBuild);
-		MemoryPatch::CrySystem::UnhandledExceptions(m_dlls.pCrySystem, m_dlls.gameBuild);
-		MemoryPatch::CrySystem::HookCPUDetect(m_dlls.pCrySystem, m_dlls.gameBuild, &CPUInfo::Detect);
-		MemoryPatch::CrySystem::HookError(m_dlls.pCrySystem, m_dlls.gameBuild, &CrashLogger::OnEngineError);
+		MemoryPatch::Batch patch(m_dlls.pCrySystem, "CrySystem");
+
+		MemoryPatch::CrySystem::RemoveSecuROM(patch, m_dlls.gameBuild);
+		MemoryPatch::CrySystem::AllowDX9VeryHighSpec(patch, m_dlls.gameBuild);
+		MemoryPatch::CrySystem::AllowMultipleInstances(patch, m_dlls.gameBuild);
+		MemoryPatch::CrySystem::UnhandledExceptions(patch, m_dlls.gameBuild);
+		MemoryPatch::CrySystem::HookCPUDetect(patch, m_dlls.gameBuild, &CPUInfo::Detect);
+		MemoryPatch::CrySystem::HookError(patch, m_dlls.gameBuild, &CrashLogger::OnEngineError);
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCryRenderD3D10)
 	{
-		MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(m_dlls.pCryRenderD3D10, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryRenderD3D10, "CryRenderD3D10");
+
+		MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(patch, m_dlls.gameBuild);
+
+		patch.Apply();
 	}
 }
+
+bool GameLauncher::OnError(const char* error)
+{
+	return false;
+}
+
+void GameLauncher::OnSaveDocument()
+{
+}
+
+void GameLauncher::OnProcessSwitch()
+{
+	m_frameLimiter.OnProcessSwitch();
+}
+
+void GameLauncher::OnInitProgress(const char* message)
+{
+}
+
+void GameLauncher::OnInit(ISystem* pSystem)
+{
+}
+
+void GameLauncher::OnShutdown()
+{
+}
+
+void GameLauncher::OnUpdate()
+{
+	LauncherCommon::FinishStartup();
+
+	m_frameLimiter.OnUpdate();
+}
+
+void GameLauncher::GetMemoryUsage(ICrySizer* pSizer)
+{
+	pSizer->Push("Launcher");
+	pSizer->AddObject(this, sizeof(*this));
+	pSizer->Pop();
+}
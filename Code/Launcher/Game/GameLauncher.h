@@ -3,7 +3,9 @@
 #include "CryCommon/CryGame/IGameStartup.h"
 #include "CryCommon/CrySystem/ISystem.h"
 
-class GameLauncher
+#include "FrameLimiter.h"
+
+class GameLauncher : private ISystemUserCallback
 {
 	IGameStartup* m_pGameStartup;
 	SSystemInitParams m_params;
@@ -21,6 +23,8 @@ class GameLauncher
 
 	DLLs m_dlls;
 
+	FrameLimiter m_frameLimiter;
+
 public:
 	GameLauncher();
 	~GameLauncher();
@@ -30,4 +34,14 @@ public:
 private:
 	void LoadEngine();
 	void PatchEngine();
+
+	// ISystemUserCallback
+	bool OnError(const char* error) override;
+	void OnSaveDocument() override;
+	void OnProcessSwitch() override;
+	void OnInitProgress(const char* message) override;
+	void OnInit(ISystem* pSystem) override;
+	void OnShutdown() override;
+	void OnUpdate() override;
+	void GetMemoryUsage(ICrySizer* pSizer) override;
 };
@@ -0,0 +1,107 @@
+#include "CryCommon/CrySystem/IConsole.h"
+
+#include "ConsoleInput.h"
+
+#define CONSOLE_INPUT_BUFFER_SIZE 4096
+
+// longer lines are truncated
+#define CONSOLE_INPUT_MAX_LINE_LENGTH 4096
+
+bool ConsoleInput::Start(unsigned int queueSize)
+{
+	if (m_pReader || queueSize == 0)
+	{
+		return false;
+	}
+
+	Reader* pReader = new Reader;
+	pReader->queue.Init(queueSize);
+
+	if (!pReader->thread.Start(&ConsoleInput::ThreadEntry, pReader))
+	{
+		delete pReader;
+		return false;
+	}
+
+	m_pReader = pReader;
+
+	return true;
+}
+
+unsigned int ConsoleInput::Execute(IConsole* pConsole, unsigned int maxCount)
+{
+	if (!m_pReader)
+	{
+		return 0;
+	}
+
+	unsigned int count = 0;
+
+	while (count < maxCount && m_pReader->queue.Pop(m_line))
+	{
+		pConsole->ExecuteString(m_line.text.c_str());
+		count++;
+	}
+
+	return count;
+}
+
+void ConsoleInput::ThreadEntry(void* param)
+{
+	Run(*static_cast<Reader*>(param));
+}
+
+void ConsoleInput::Run(Reader& reader)
+{
+	char buffer[CONSOLE_INPUT_BUFFER_SIZE];
+	std::string text;
+
+	while (true)
+	{
+		const std::size_t length = OS::ReadStandardInput(buffer, sizeof buffer);
+		if (length == 0)
+		{
+			break;
+		}
+
+		for (std::size_t i = 0; i < length; i++)
+		{
+			const char ch = buffer[i];
+
+			if (ch == '\n')
+			{
+				PushLine(reader, text);
+			}
+			else if (text.length() < CONSOLE_INPUT_MAX_LINE_LENGTH)
+			{
+				text += ch;
+			}
+		}
+	}
+
+	// the last line does not have to be terminated
+	PushLine(reader, text);
+}
+
+void ConsoleInput::PushLine(Reader& reader, std::string& text)
+{
+	// console and Windows tools end lines with CRLF
+	while (!text.empty() && (text[text.length() - 1] == '\r' || text[text.length() - 1] == ' '))
+	{
+		text.erase(text.length() - 1);
+	}
+
+	if (text.empty())
+	{
+		return;
+	}
+
+	Line line;
+	line.text.swap(text);
+
+	// the game thread executes a batch every update
+	while (!reader.queue.Push(line))
+	{
+		OS::Sleep(1);
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+
+#include "Library/BoundedQueue.h"
+#include "Library/OS.h"
+
+struct IConsole;
+
+/**
+ * Executes console commands read from the standard input.
+ *
+ * A background thread reads the input and queues complete lines, so the game thread never waits for it. The queued
+ * commands are executed by the game thread in batches.
+ *
+ * Blocking reads of the standard input cannot be reliably interrupted, so the reader is never stopped. Its state is
+ * intentionally leaked and the thread simply ends with the process.
+ */
+class ConsoleInput
+{
+	struct Line
+	{
+		std::string text;
+
+		void Swap(Line& other)
+		{
+			this->text.swap(other.text);
+		}
+	};
+
+	struct Reader
+	{
+		BoundedQueue<Line> queue;
+		OS::Thread thread;
+	};
+
+	Reader* m_pReader;
+	Line m_line;
+
+	// no copies
+	ConsoleInput(const ConsoleInput&);
+	ConsoleInput& operator=(const ConsoleInput&);
+
+	static void ThreadEntry(void* param);
+	static void Run(Reader& reader);
+	static void PushLine(Reader& reader, std::string& text);
+
+public:
+	ConsoleInput() : m_pReader(NULL)
+	{
+	}
+
+	bool IsStarted() const
+	{
+		return m_pReader != NULL;
+	}
+
+	// the reader waits if the queue is full, so no command is lost
+	bool Start(unsigned int queueSize);
+
+	// executes at most maxCount queued commands, returns the number of executed commands
+	unsigned int Execute(IConsole* pConsole, unsigned int maxCount);
+};
@@ -0,0 +1,177 @@
+#include <cstring>
+
+#include "Library/SIMD.h"
+#include "Library/StringView.h"
+
+#include "ConsoleOutput.h"
+
+#define CONSOLE_OUTPUT_BUFFER_SIZE (64 * 1024)
+
+// thresholds for writing before the end of the frame
+#define CONSOLE_OUTPUT_MAX_LINES 512
+#define CONSOLE_OUTPUT_MAX_DELAY 1000  // milliseconds
+
+ConsoleOutput::ConsoleOutput() : m_stream(NULL), m_lineCount(0), m_firstLineTime(0), m_isStopRequested(0)
+{
+}
+
+ConsoleOutput::~ConsoleOutput()
+{
+	this->Stop();
+	this->Flush();
+}
+
+bool ConsoleOutput::Enable(const char* streamName)
+{
+	const StringView name = streamName;
+
+	if (name.IsEqualNoCase("stdout"))
+	{
+		m_stream = stdout;
+	}
+	else if (name.IsEqualNoCase("stderr"))
+	{
+		m_stream = stderr;
+	}
+	else
+	{
+		return false;
+	}
+
+	m_buffer.reserve(CONSOLE_OUTPUT_BUFFER_SIZE);
+
+	// without the thread, lines are still written at the end of each frame
+	m_thread.Start(&ConsoleOutput::ThreadEntry, this);
+
+	return true;
+}
+
+void ConsoleOutput::Flush()
+{
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	this->Write();
+}
+
+void ConsoleOutput::Print(const char* text)
+{
+	if (!m_stream)
+	{
+		return;
+	}
+
+	const std::size_t length = std::strlen(text);
+
+	OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+	if (m_lineCount == 0)
+	{
+		m_firstLineTime = OS::GetTickCount();
+		m_wakeEvent.Set();
+	}
+
+	std::size_t pos = 0;
+
+	while (pos < length)
+	{
+		// copy everything up to the next color code at once
+		const std::size_t end = pos + SIMD::Find(text + pos, length - pos, '$');
+		m_buffer.append(text + pos, end - pos);
+		pos = end;
+
+		if (pos >= length)
+		{
+			break;
+		}
+
+		// drop color codes
+		pos++;
+
+		// "$$" => "$"
+		if (pos < length && text[pos] == '$')
+		{
+			m_buffer += '$';
+		}
+
+		pos++;
+	}
+
+	m_buffer += '\n';
+	m_lineCount++;
+
+	if (m_buffer.length() >= CONSOLE_OUTPUT_BUFFER_SIZE
+	 || m_lineCount >= CONSOLE_OUTPUT_MAX_LINES
+	 || (OS::GetTickCount() - m_firstLineTime) >= CONSOLE_OUTPUT_MAX_DELAY)
+	{
+		this->Write();
+	}
+}
+
+void ConsoleOutput::Write()
+{
+	if (!m_stream || m_buffer.empty())
+	{
+		return;
+	}
+
+	std::fwrite(m_buffer.c_str(), 1, m_buffer.length(), m_stream);
+	std::fflush(m_stream);
+
+	if (m_buffer.capacity() > CONSOLE_OUTPUT_BUFFER_SIZE * 2)
+	{
+		// drop memory of a single huge line
+		std::string().swap(m_buffer);
+		m_buffer.reserve(CONSOLE_OUTPUT_BUFFER_SIZE);
+	}
+	else
+	{
+		m_buffer.clear();
+	}
+
+	m_lineCount = 0;
+}
+
+void ConsoleOutput::ThreadEntry(void* param)
+{
+	static_cast<ConsoleOutput*>(param)->Run();
+}
+
+void ConsoleOutput::Run()
+{
+	unsigned int timeout = OS::WAIT_FOREVER;
+
+	while (!m_isStopRequested)
+	{
+		m_wakeEvent.Wait(timeout);
+
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		timeout = OS::WAIT_FOREVER;
+
+		if (m_lineCount == 0)
+		{
+			continue;
+		}
+
+		const unsigned long delay = OS::GetTickCount() - m_firstLineTime;
+
+		if (delay >= CONSOLE_OUTPUT_MAX_DELAY)
+		{
+			this->Write();
+		}
+		else
+		{
+			timeout = CONSOLE_OUTPUT_MAX_DELAY - delay;
+		}
+	}
+}
+
+void ConsoleOutput::Stop()
+{
+	if (m_thread.IsStarted())
+	{
+		OS::Atomic::Exchange(&m_isStopRequested, 1);
+		m_wakeEvent.Set();
+		m_thread.Join();
+	}
+}
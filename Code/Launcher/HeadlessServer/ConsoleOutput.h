@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#include "CryCommon/CrySystem/IConsole.h"
+
+#include "Library/OS.h"
+
+/**
+ * Mirrors the engine console output to the standard output or error stream without color codes.
+ *
+ * Lines are collected in a buffer, which is written at once at the end of each frame. The buffer is also written
+ * earlier when it grows too large or its oldest line waits too long, e.g. during level loading. The latter is checked
+ * by a helper thread, so the last lines before a long silence are written too.
+ */
+class ConsoleOutput : public IOutputPrintSink
+{
+	std::FILE* m_stream;
+	std::string m_buffer;
+	unsigned int m_lineCount;
+	unsigned long m_firstLineTime;  // OS::GetTickCount
+	OS::Mutex m_mutex;
+
+	OS::Thread m_thread;
+	OS::Event m_wakeEvent;  // first line buffered or stop requested
+	volatile long m_isStopRequested;
+
+	// no copies
+	ConsoleOutput(const ConsoleOutput&);
+	ConsoleOutput& operator=(const ConsoleOutput&);
+
+	void Write();
+
+	static void ThreadEntry(void* param);
+	void Run();
+
+	void Stop();
+
+public:
+	ConsoleOutput();
+	~ConsoleOutput();
+
+	bool IsEnabled() const
+	{
+		return m_stream != NULL;
+	}
+
+	// accepts stdout or stderr
+	bool Enable(const char* streamName);
+
+	// writes the buffered lines
+	void Flush();
+
+	// IOutputPrintSink
+	void Print(const char* text) override;
+};
@@ -0,0 +1,179 @@
+#include "CryCommon/CrySystem/IConsole.h"
+#include "CryCommon/CrySystem/ISystem.h"
+
+#include "Library/OS.h"
+
+#include "FrameStats.h"
+
+// the engine runs at 30 Hz by default
+#define DEFAULT_TICK_RATE 30
+#define DEFAULT_SUMMARY_INTERVAL 60
+
+// frames longer than this are not frame times anymore, e.g. level loading
+#define MAX_FRAME_TIME_MICROSECONDS (60 * 1000 * 1000)
+
+static const unsigned long METRICS_BUCKET_BOUNDS[FrameStats::METRICS_BUCKET_COUNT] = {
+	5000, 10000, 20000, 35000, 50000, 100000, 250000, 500000, 1000000, 0
+};
+
+FrameStats* FrameStats::s_self;
+
+FrameStats::FrameStats() : m_window(), m_total(), m_metricsSequence(0), m_metrics(),
+  m_frequency(OS::GetPerformanceFrequency()), m_lastFrameTime(0), m_windowStartTime(OS::GetTickCount()),
+  m_budget(1000.0f / DEFAULT_TICK_RATE), m_summaryInterval(DEFAULT_SUMMARY_INTERVAL)
+{
+	s_self = this;
+}
+
+FrameStats::~FrameStats()
+{
+	s_self = NULL;
+}
+
+void FrameStats::SetTickRate(unsigned int tickRate)
+{
+	if (tickRate > 0)
+	{
+		m_budget = 1000.0f / tickRate;
+	}
+}
+
+void FrameStats::RegisterConsoleVariables(IConsole* pConsole)
+{
+	pConsole->Register("server_FrameBudget", &m_budget, m_budget, VF_NOT_NET_SYNCED,
+		"Defines the frame time in milliseconds above which a server frame is counted as over budget.\n"
+		"Usage: server_FrameBudget [ms]\n"
+		"The default value is the tick period (-tickrate or 30 Hz)."
+	);
+
+	pConsole->Register("server_FrameStatsInterval", &m_summaryInterval, m_summaryInterval, VF_NOT_NET_SYNCED,
+		"Defines how often a summary of server frame times is logged in seconds.\n"
+		"Usage: server_FrameStatsInterval [seconds]\n"
+		"The default value is 60. Zero disables the summary."
+	);
+
+	pConsole->AddCommand("server_FrameStats", &FrameStats::OnStatsCommand, VF_NOT_NET_SYNCED,
+		"Shows percentiles of server frame times since the last summary and since the start.\n"
+		"Usage: server_FrameStats"
+	);
+}
+
+void FrameStats::OnUpdate()
+{
+	const unsigned __int64 now = OS::GetPerformanceCounter();
+
+	if (m_lastFrameTime != 0)
+	{
+		const unsigned __int64 frameTime = ((now - m_lastFrameTime) * 1000000) / m_frequency;
+
+		if (frameTime < MAX_FRAME_TIME_MICROSECONDS)
+		{
+			const unsigned long value = static_cast<unsigned long>(frameTime);
+
+			const bool isOverBudget = value > (m_budget * 1000);
+
+			m_window.histogram.Add(value);
+			m_total.histogram.Add(value);
+
+			if (isOverBudget)
+			{
+				m_window.overBudgetCount++;
+				m_total.overBudgetCount++;
+			}
+
+			unsigned int bucket = 0;
+			while (bucket < (METRICS_BUCKET_COUNT - 1) && value > METRICS_BUCKET_BOUNDS[bucket])
+			{
+				bucket++;
+			}
+
+			OS::Atomic::Increment(&m_metricsSequence);
+
+			m_metrics.bucketCounts[bucket]++;
+			m_metrics.frameCount++;
+			m_metrics.overBudgetCount += isOverBudget;
+			m_metrics.totalTime += value;
+
+			OS::Atomic::Increment(&m_metricsSequence);
+		}
+	}
+
+	m_lastFrameTime = now;
+
+	if (m_summaryInterval > 0)
+	{
+		const unsigned long currentTime = OS::GetTickCount();
+		const unsigned long elapsed = currentTime - m_windowStartTime;
+
+		if (elapsed >= static_cast<unsigned long>(m_summaryInterval) * 1000)
+		{
+			LogWindow("last interval", m_window, m_budget);
+
+			m_window.Clear();
+			m_windowStartTime = currentTime;
+		}
+	}
+}
+
+void FrameStats::Dump()
+{
+	LogWindow("last interval", m_window, m_budget);
+	LogWindow("total", m_total, m_budget);
+}
+
+void FrameStats::GetMetrics(Metrics& metrics) const
+{
+	for (;;)
+	{
+		const long sequence = m_metricsSequence;
+
+		if ((sequence & 1) == 0)
+		{
+			metrics = m_metrics;
+
+			// full barrier, so the copy cannot be moved after the check
+			if (OS::Atomic::Add(&m_metricsSequence, 0) == sequence)
+			{
+				break;
+			}
+		}
+
+		OS::YieldCurrentThread();
+	}
+}
+
+unsigned long FrameStats::GetMetricsBucketBound(unsigned int index)
+{
+	return (index < METRICS_BUCKET_COUNT) ? METRICS_BUCKET_BOUNDS[index] : 0;
+}
+
+void FrameStats::LogWindow(const char* name, const Window& window, float budget)
+{
+	const Histogram& histogram = window.histogram;
+
+	if (histogram.GetCount() == 0)
+	{
+		CryLogAlways("Frame times (%s): no frames", name);
+		return;
+	}
+
+	CryLogAlways("Frame times (%s): %lu frames, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms, "
+		"%lu over %.1f ms budget",
+		name,
+		histogram.GetCount(),
+		histogram.GetPercentile(50) / 1000.0,
+		histogram.GetPercentile(95) / 1000.0,
+		histogram.GetPercentile(99) / 1000.0,
+		histogram.GetMax() / 1000.0,
+		window.overBudgetCount,
+		budget
+	);
+}
+
+void FrameStats::OnStatsCommand(IConsoleCmdArgs* pArgs)
+{
+	if (s_self)
+	{
+		s_self->Dump();
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Library/Histogram.h"
+
+struct IConsole;
+struct IConsoleCmdArgs;
+
+/**
+ * Frame time telemetry of the server.
+ *
+ * Frame time is measured between two consecutive engine updates, so it includes any sleeping done by the engine or
+ * the launcher loop. A frame is over budget if it takes longer than the tick period the server is supposed to keep.
+ */
+class FrameStats
+{
+public:
+	enum
+	{
+		METRICS_BUCKET_COUNT = 10,
+	};
+
+	/**
+	 * Counters for monitoring. Unlike the histograms, they are never reset and can be read from any thread.
+	 */
+	struct Metrics
+	{
+		unsigned long bucketCounts[METRICS_BUCKET_COUNT];  // not cumulative, see GetMetricsBucketBound
+		unsigned long frameCount;
+		unsigned long overBudgetCount;
+		unsigned __int64 totalTime;  // microseconds
+
+		Metrics() : frameCount(0), overBudgetCount(0), totalTime(0)
+		{
+			for (unsigned int i = 0; i < METRICS_BUCKET_COUNT; i++)
+			{
+				this->bucketCounts[i] = 0;
+			}
+		}
+	};
+
+private:
+	struct Window
+	{
+		Histogram histogram;  // microseconds
+		unsigned long overBudgetCount;
+
+		Window() : histogram(), overBudgetCount(0)
+		{
+		}
+
+		void Clear()
+		{
+			this->histogram.Clear();
+			this->overBudgetCount = 0;
+		}
+	};
+
+	Window m_window;  // since the last summary
+	Window m_total;
+
+	// seqlock, odd while the game thread is updating the metrics
+	mutable volatile long m_metricsSequence;
+	Metrics m_metrics;
+
+	unsigned __int64 m_frequency;
+	unsigned __int64 m_lastFrameTime;  // OS::GetPerformanceCounter
+	unsigned long m_windowStartTime;  // OS::GetTickCount
+
+	// cvars
+	float m_budget;  // milliseconds
+	int m_summaryInterval;  // seconds
+
+	static void LogWindow(const char* name, const Window& window, float budget);
+
+	static void OnStatsCommand(IConsoleCmdArgs* pArgs);
+
+	static FrameStats* s_self;
+
+public:
+	FrameStats();
+	~FrameStats();
+
+	void SetTickRate(unsigned int tickRate);
+
+	void RegisterConsoleVariables(IConsole* pConsole);
+
+	void OnUpdate();
+
+	void Dump();
+
+	// consistent snapshot, safe to call from any thread
+	void GetMetrics(Metrics& metrics) const;
+
+	// upper bound of the bucket in microseconds, or zero for the last bucket with no upper bound
+	static unsigned long GetMetricsBucketBound(unsigned int index);
+};
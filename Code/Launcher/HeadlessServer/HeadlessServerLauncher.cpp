@@ -1,9 +1,16 @@
 #include <cstdio>
 #include <cstdlib>  // std::atoi
 
+#include "CryCommon/CrySystem/IConsole.h"
+#include "CryCommon/CrySystem/ICrySizer.h"
 #include "Library/CrashLogger.h"
+#include "Library/HotPathTimer.h"
 #include "Library/OS.h"
 #include "Library/PathTools.h"
+#include "Library/PoolAllocator.h"
+#include "Library/StartupTimer.h"
+#include "Library/StringTools.h"
+#include "Library/StringView.h"
 #include "Project.h"
 
 #include "../CPUInfo.h"
@@ -14,27 +21,75 @@
 
 #define DEFAULT_LOG_FILE_NAME "Server.log"
 #define DEFAULT_LOG_VERBOSITY "0"
+#define DEFAULT_LOG_QUEUE_SIZE "4096"
+#define DEFAULT_LOG_OVERFLOW_POLICY "block"
+#define DEFAULT_LOG_FLUSH_POLICY "line"
+#define DEFAULT_LOG_FORMAT "text"
+#define DEFAULT_CONSOLE_OUTPUT "stdout"
+#define DEFAULT_METRICS_ADDRESS "127.0.0.1"
+#define MAX_WATCHDOG_TIMEOUT 3600
+#define DEFAULT_PROFILE_RATE 1000
+#define MAX_PROFILE_RATE 10000
+#define DEFAULT_PROFILE_FILE_NAME "Profile.folded"
+#define CONSOLE_INPUT_QUEUE_SIZE 256
+#define CONSOLE_INPUT_COMMANDS_PER_UPDATE 64
+
+// launcher work done in each frame, see server_HotPathStats
+static HotPathTimer::Section g_launcherUpdateSection("LauncherUpdate");
+static HotPathTimer::Section g_consoleInputSection("LauncherUpdate/ConsoleInput");
+static HotPathTimer::Section g_frameStatsSection("LauncherUpdate/FrameStats");
+static HotPathTimer::Section g_loggerSection("LauncherUpdate/Logger");
+static HotPathTimer::Section g_consoleOutputSection("LauncherUpdate/ConsoleOutput");
+
+static double ToMiB(unsigned __int64 bytes)
+{
+	return static_cast<double>(bytes) / (1024 * 1024);
+}
+
+static unsigned long GetPoolSpanCount()
+{
+	unsigned long spanCount = 0;
+
+	for (unsigned int i = 0; i < PoolAllocator::GetClassCount(); i++)
+	{
+		spanCount += PoolAllocator::GetClassStats(i).spanCount;
+	}
+
+	return spanCount;
+}
 
 static void Print(const char* format, ...)
 {
 	va_list args;
 	va_start(args, format);
-	std::vfprintf(stderr, format, args);
+	std::string line = StringTools::FormatV(format, args);
 	va_end(args);
 
-	std::fputc('\n', stderr);
+	line += '\n';
+
+	// single write, so lines of other processes sharing the stream are not mixed in
+	std::fwrite(line.c_str(), 1, line.length(), stderr);
 	std::fflush(stderr);
 }
 
 HeadlessServerLauncher* HeadlessServerLauncher::s_self;
 
-HeadlessServerLauncher::HeadlessServerLauncher() : m_pGameStartup(NULL), m_params(), m_dlls()
+HeadlessServerLauncher::HeadlessServerLauncher()
+: m_pGameStartup(NULL), m_params(), m_dlls(), m_metricsServer(m_logger, m_frameStats),
+  m_mainThreadID(OS::GetCurrentThreadID())
 {
 	s_self = this;
 }
 
 HeadlessServerLauncher::~HeadlessServerLauncher()
 {
+	// engine shutdown does not call OnUpdate
+	m_watchdog.Stop();
+
+	// the result is logged
+	m_profiler.Stop();
+	m_profiler.Wait();
+
 	if (m_pGameStartup)
 	{
 		m_pGameStartup->Shutdown();
@@ -45,15 +100,26 @@ HeadlessServerLauncher::~HeadlessServerLauncher()
 
 int HeadlessServerLauncher::Run()
 {
+	StartupTimer::Start();
+
 	Print("%s", PROJECT_BANNER);
 	Print("Command line: [%s]", OS::CmdLine::GetOnlyArgs());
 
+	// may set the root folder
+	const std::string configPath = LauncherCommon::LoadConfigFile();
+	if (!configPath.empty())
+	{
+		Print("Launcher config: \"%s\"", configPath.c_str());
+	}
+
 	m_rootFolder = LauncherCommon::GetRootFolderPath();
 	Print("Root folder: \"%s\"", m_rootFolder.c_str());
 
 	const int verbosity = std::atoi(OS::CmdLine::GetArgValue("-verbosity", DEFAULT_LOG_VERBOSITY));
 	const char* logFileName = OS::CmdLine::GetArgValue("-logfile", DEFAULT_LOG_FILE_NAME);
 	const char* logPrefix = OS::CmdLine::GetArgValue("-logprefix", "");
+	const char* logFlushPolicy = OS::CmdLine::GetArgValue("-logflush", DEFAULT_LOG_FLUSH_POLICY);
+	const char* logFormat = OS::CmdLine::GetArgValue("-logformat", DEFAULT_LOG_FORMAT);
 
 	m_params.hInstance = OS::Module::GetEXE();
 	m_params.logFileName = DEFAULT_LOG_FILE_NAME;
@@ -64,7 +130,29 @@ int HeadlessServerLauncher::Run()
 
 	LauncherCommon::SetParamsCmdLine(m_params, OS::CmdLine::Get());
 
-	CrashLogger::Enable(&HeadlessServerLauncher::OpenLogFile);
+	LauncherCommon::EnableCrashLogger(&HeadlessServerLauncher::OpenLogFile);
+
+	LauncherCommon::SetProcessorAffinity();
+	Print("CPU affinity: 0x%IX", OS::GetProcessAffinity());
+
+	LauncherCommon::SetProcessPriority();
+
+	const unsigned int timerResolution = LauncherCommon::GetTimerResolution();
+	Print("%s", LauncherCommon::GetPriorityInfo().c_str());
+
+	const unsigned int workingSetSize = LauncherCommon::GetLockedWorkingSetSize();
+
+	if (workingSetSize)
+	{
+		if (LauncherCommon::LockWorkingSet(workingSetSize))
+		{
+			Print("Working set: %u MiB locked", workingSetSize);
+		}
+		else
+		{
+			Print("Working set: failed to lock %u MiB (error %lu)", workingSetSize, OS::GetCurrentErrorCode());
+		}
+	}
 
 	this->LoadEngine();
 	this->PatchEngine();
@@ -76,23 +164,201 @@ int HeadlessServerLauncher::Run()
 	m_logger.OpenFile(PathTools::Join(m_rootFolder, logFileName).c_str());
 	m_logger.SetPrefix(logPrefix);
 
+	Logger::StructuredFormat structuredFormat;
+	if (!Logger::ParseStructuredFormat(logFormat, structuredFormat))
+	{
+		throw StringTools::Error("Unknown log format \"%s\"!\nUse text, json or binary.", logFormat);
+	}
+
+	if (structuredFormat != Logger::FORMAT_NONE)
+	{
+		std::string structuredFileName;
+		structuredFileName += PathTools::RemoveFileExtension(logFileName);
+		structuredFileName += Logger::GetStructuredFileExtension(structuredFormat);
+
+		Print("Structured log file: %s", structuredFileName.c_str());
+		m_logger.OpenStructuredFile(PathTools::Join(m_rootFolder, structuredFileName).c_str(), structuredFormat);
+	}
+
+	Print("Log flush policy: %s", logFlushPolicy);
+	if (!m_logger.SetFlushPolicy(logFlushPolicy))
+	{
+		throw StringTools::Error("Unknown log flush policy \"%s\"!\nUse line, frame or interval:MS.", logFlushPolicy);
+	}
+
+	if (OS::CmdLine::HasArg("-logasync"))
+	{
+		this->StartAsyncLogWriter();
+	}
+
+	if (OS::CmdLine::HasArg("-logcallbackthread"))
+	{
+		const int queueSize = std::atoi(OS::CmdLine::GetArgValue("-logqueuesize", DEFAULT_LOG_QUEUE_SIZE));
+
+		if (queueSize <= 0)
+		{
+			throw StringTools::Error("Invalid log queue size %d!", queueSize);
+		}
+
+		Print("Log callbacks: separate thread (queue size %d)", queueSize);
+		m_logger.StartCallbackDispatcher(queueSize);
+	}
+
+	if (OS::CmdLine::HasArg("-consoleout"))
+	{
+		const char* consoleOutput = OS::CmdLine::GetArgValue("-consoleout", DEFAULT_CONSOLE_OUTPUT);
+
+		Print("Console output: %s", consoleOutput);
+		if (!m_consoleOutput.Enable(consoleOutput))
+		{
+			throw StringTools::Error("Unknown console output \"%s\"!\nUse stdout or stderr.", consoleOutput);
+		}
+	}
+
+	const unsigned int tickRate = LauncherCommon::GetTickRate();
+	m_frameStats.SetTickRate(tickRate);
+
+	if (OS::CmdLine::HasArg("-metricsport"))
+	{
+		this->StartMetricsServer();
+	}
+
 	Print("Starting CryEngine...");
 	m_pGameStartup = LauncherCommon::StartEngine(m_dlls.pCryGame, m_params);
 
+	// without the launcher loop, there are no idle ticks to wait for
+	LauncherCommon::StartPakWarm(tickRate != 0);
+
+	if (OS::CmdLine::HasArg("-watchdog"))
+	{
+		this->StartWatchdog();
+	}
+
+	if (OS::CmdLine::HasArg("-stdin"))
+	{
+		this->StartConsoleInput();
+	}
+
 	Print("Ready");
 
-	return m_pGameStartup->Run(NULL);
+	// finished by the first OnUpdate
+	StartupTimer::BeginStep("FirstUpdate");
+
+	if (tickRate)
+	{
+		Print("Tick rate: %u Hz", tickRate);
+
+		// the loop shuts down the engine itself
+		IGameStartup* pGameStartup = m_pGameStartup;
+		m_pGameStartup = NULL;
+
+		return LauncherCommon::RunServerLoop(pGameStartup, tickRate);
+	}
+
+	return LauncherCommon::RunEngineLoop(m_pGameStartup, timerResolution);
+}
+
+void HeadlessServerLauncher::StartAsyncLogWriter()
+{
+	const int queueSize = std::atoi(OS::CmdLine::GetArgValue("-logqueuesize", DEFAULT_LOG_QUEUE_SIZE));
+	const char* overflow = OS::CmdLine::GetArgValue("-logoverflow", DEFAULT_LOG_OVERFLOW_POLICY);
+
+	if (queueSize <= 0)
+	{
+		throw StringTools::Error("Invalid log queue size %d!", queueSize);
+	}
+
+	Logger::OverflowPolicy overflowPolicy;
+	if (!Logger::ParseOverflowPolicy(overflow, overflowPolicy))
+	{
+		throw StringTools::Error("Unknown log overflow policy \"%s\"!\nUse block, dropoldest or drop.", overflow);
+	}
+
+	Print("Log writer: asynchronous (queue size %d, overflow policy %s)", queueSize, overflow);
+	m_logger.StartAsyncWriter(queueSize, overflowPolicy);
+}
+
+void HeadlessServerLauncher::StartMetricsServer()
+{
+	const int port = std::atoi(OS::CmdLine::GetArgValue("-metricsport", ""));
+	const char* address = OS::CmdLine::GetArgValue("-metricsaddress", DEFAULT_METRICS_ADDRESS);
+
+	if (port <= 0 || port > 65535)
+	{
+		throw StringTools::Error("Invalid metrics port %d!", port);
+	}
+
+	Print("Metrics: http://%s:%d/metrics", address, port);
+	if (!m_metricsServer.Start(address, static_cast<unsigned short>(port)))
+	{
+		throw StringTools::OSError("Failed to start metrics server on %s:%d!", address, port);
+	}
+}
+
+void HeadlessServerLauncher::StartWatchdog()
+{
+	const int timeout = std::atoi(OS::CmdLine::GetArgValue("-watchdog", ""));
+	const bool isFatal = OS::CmdLine::HasArg("-watchdogexit");
+
+	if (timeout <= 0 || timeout > MAX_WATCHDOG_TIMEOUT)
+	{
+		throw StringTools::Error("Invalid watchdog timeout %d!\nUse 1 to %d seconds.", timeout, MAX_WATCHDOG_TIMEOUT);
+	}
+
+	Print("Watchdog: %d seconds (%s)", timeout, (isFatal) ? "exit on hang" : "report only");
+	if (!m_watchdog.Start(timeout * 1000, isFatal, &HeadlessServerLauncher::OpenHangLogFile,
+		&HeadlessServerLauncher::OnHang))
+	{
+		throw StringTools::OSError("Failed to start watchdog!");
+	}
+
+	m_logger.SetWatchdog(&m_watchdog);
+}
+
+void HeadlessServerLauncher::StartConsoleInput()
+{
+	Print("Console input: standard input");
+	if (!m_consoleInput.Start(CONSOLE_INPUT_QUEUE_SIZE))
+	{
+		throw StringTools::OSError("Failed to start console input reader!");
+	}
 }
 
 void HeadlessServerLauncher::LoadEngine()
 {
+	StartupTimer::Scope step("LoadEngine");
+
 	m_dlls.pCrySystem = LauncherCommon::LoadModule("CrySystem.dll");
 
+	// runs while the game build is checked and the rest of the engine DLLs are loaded
+	LauncherCommon::StartPrefetch("CryRenderNULL.dll");
+
 	m_dlls.gameBuild = LauncherCommon::GetGameBuild(m_dlls.pCrySystem);
 	Print("Game build: %d", m_dlls.gameBuild);
 
 	LauncherCommon::VerifyGameBuild(m_dlls.gameBuild);
 
+	// must be done before any other engine DLL is loaded
+	if (OS::CmdLine::HasArg("-poolalloc") || OS::CmdLine::HasArg("-largepages"))
+	{
+		Print("Memory allocator: pool");
+		LauncherCommon::EnablePoolAllocator(m_dlls.pCrySystem);
+
+		if (OS::CmdLine::HasArg("-largepages"))
+		{
+			const char* failure = LauncherCommon::EnableLargePages();
+
+			if (failure)
+			{
+				Print("Large pages: disabled (%s)", failure);
+			}
+			else
+			{
+				Print("Large pages: enabled (%u KiB)", static_cast<unsigned int>(OS::GetLargePageSize() / 1024));
+			}
+		}
+	}
+
 	m_dlls.pCryGame = LauncherCommon::LoadModule("CryGame.dll");
 	m_dlls.pCryAction = LauncherCommon::LoadModule("CryAction.dll");
 	m_dlls.pCryNetwork = LauncherCommon::LoadModule("CryNetwork.dll");
@@ -101,30 +367,48 @@ void HeadlessServerLauncher::LoadEngine()
 
 void HeadlessServerLauncher::PatchEngine()
 {
+	StartupTimer::Scope step("PatchEngine");
+
 	if (m_dlls.pCryAction)
 	{
-		MemoryPatch::CryAction::DisableGameplayStats(m_dlls.pCryAction, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryAction, "CryAction");
+
+		MemoryPatch::CryAction::DisableGameplayStats(patch, m_dlls.gameBuild);
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCryNetwork)
 	{
-		MemoryPatch::CryNetwork::EnablePreordered(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::AllowSameCDKeys(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::FixInternetConnect(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::FixFileCheckCrash(m_dlls.pCryNetwork, m_dlls.gameBuild);
-		MemoryPatch::CryNetwork::DisableServerProfile(m_dlls.pCryNetwork, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryNetwork, "CryNetwork");
+
+		MemoryPatch::CryNetwork::EnablePreordered(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::AllowSameCDKeys(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::FixInternetConnect(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::FixFileCheckCrash(patch, m_dlls.gameBuild);
+		MemoryPatch::CryNetwork::DisableServerProfile(patch, m_dlls.gameBuild);
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCrySystem)
 	{
-		MemoryPatch::CrySystem::UnhandledExceptions(m_dlls.pCrySystem, m_dlls.gameBuild);
-		MemoryPatch::CrySystem::HookCPUDetect(m_dlls.pCrySystem, m_dlls.gameBuild, &CPUInfo::Detect);
-		MemoryPatch::CrySystem::HookError(m_dlls.pCrySystem, m_dlls.gameBuild, &CrashLogger::OnEngineError);
+		MemoryPatch::Batch patch(m_dlls.pCrySystem, "CrySystem");
+
+		MemoryPatch::CrySystem::UnhandledExceptions(patch, m_dlls.gameBuild);
+		MemoryPatch::CrySystem::HookCPUDetect(patch, m_dlls.gameBuild, &CPUInfo::Detect);
+		MemoryPatch::CrySystem::HookError(patch, m_dlls.gameBuild, &CrashLogger::OnEngineError);
+
+		patch.Apply();
 	}
 
 	if (m_dlls.pCryRenderNULL)
 	{
-		MemoryPatch::CryRenderNULL::DisableDebugRenderer(m_dlls.pCryRenderNULL, m_dlls.gameBuild);
+		MemoryPatch::Batch patch(m_dlls.pCryRenderNULL, "CryRenderNULL");
+
+		MemoryPatch::CryRenderNULL::DisableDebugRenderer(patch, m_dlls.gameBuild);
+
+		patch.Apply();
 	}
 }
 
@@ -147,22 +431,309 @@ void HeadlessServerLauncher::OnInitProgress(const char* message)
 
 void HeadlessServerLauncher::OnInit(ISystem* pSystem)
 {
+	IConsole* pConsole = pSystem->GetIConsole();
+
+	m_frameStats.RegisterConsoleVariables(pConsole);
+
+	if (m_consoleOutput.IsEnabled())
+	{
+		pConsole->AddOutputPrintSink(&m_consoleOutput);
+	}
+
+	if (PoolAllocator::IsInitialized())
+	{
+		pConsole->AddCommand("mem_PoolStats", &HeadlessServerLauncher::OnPoolStatsCommand, VF_NOT_NET_SYNCED,
+			"Shows statistics of the pool allocator enabled with -poolalloc.\n"
+			"Usage: mem_PoolStats"
+		);
+	}
+
+	pConsole->AddCommand("mem_Report", &HeadlessServerLauncher::OnMemoryReportCommand, VF_NOT_NET_SYNCED,
+		"Shows memory usage of the engine, the launcher and the whole process.\n"
+		"Usage: mem_Report [kb]\n"
+		"The engine statistics are shown in MiB unless kb is specified."
+	);
+
+	pConsole->AddCommand("profile_start", &HeadlessServerLauncher::OnProfileStartCommand, VF_NOT_NET_SYNCED,
+		"Starts sampling the main thread.\n"
+		"Usage: profile_start [rate] [file]\n"
+		"The default rate is 1000 Hz. The folded stacks are written to Profile.folded in the root folder by default."
+	);
+
+	pConsole->AddCommand("profile_stop", &HeadlessServerLauncher::OnProfileStopCommand, VF_NOT_NET_SYNCED,
+		"Stops sampling and writes the result in the background.\n"
+		"Usage: profile_stop"
+	);
+
+	pConsole->AddCommand("server_HotPathStats", &HeadlessServerLauncher::OnHotPathStatsCommand, VF_NOT_NET_SYNCED,
+		"Shows time spent in the engine update and in the per-frame work of the launcher.\n"
+		"Usage: server_HotPathStats [reset]\n"
+		"The engine update is measured only with -tickrate.\n"
+		"The statistics are collected since the start or the last reset."
+	);
+
+	// RDTSC measurements are converted using the engine calibration
+	HotPathTimer::SetSecondsPerCycle(pSystem->GetSecondsPerCycle());
 }
 
 void HeadlessServerLauncher::OnShutdown()
 {
+	if (m_consoleOutput.IsEnabled() && gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->RemoveOutputPrintSink(&m_consoleOutput);
+		m_consoleOutput.Flush();
+	}
 }
 
 void HeadlessServerLauncher::OnUpdate()
 {
-	m_logger.OnUpdate();
+	HotPathTimer::Scope updateScope(g_launcherUpdateSection);
+
+	LauncherCommon::FinishStartup();
+
+	{
+		HotPathTimer::Scope scope(g_consoleInputSection);
+
+		// limited, so a flood of input cannot stall the frame
+		m_consoleInput.Execute(gEnv->pConsole, CONSOLE_INPUT_COMMANDS_PER_UPDATE);
+	}
+
+	{
+		HotPathTimer::Scope scope(g_frameStatsSection);
+
+		m_frameStats.OnUpdate();
+	}
+
+	{
+		HotPathTimer::Scope scope(g_loggerSection);
+
+		m_logger.OnUpdate();
+	}
+
+	m_watchdog.Heartbeat();
+
+	{
+		HotPathTimer::Scope scope(g_consoleOutputSection);
+
+		m_consoleOutput.Flush();
+	}
 }
 
 void HeadlessServerLauncher::GetMemoryUsage(ICrySizer* pSizer)
 {
+	pSizer->Push("Launcher");
+	pSizer->AddObject(this, sizeof(*this) + m_rootFolder.capacity());
+
+	pSizer->Push("Logger");
+	pSizer->AddObject(&m_logger, m_logger.GetMemoryUsage());
+	pSizer->Pop();
+
+	pSizer->Push("MetricsServer");
+	pSizer->AddObject(&m_metricsServer, m_metricsServer.GetMemoryUsage());
+	pSizer->Pop();
+
+	pSizer->Pop();
+}
+
+void HeadlessServerLauncher::OnMemoryReportCommand(IConsoleCmdArgs* pArgs)
+{
+	const bool useKB = pArgs->GetArgCount() > 1 && StringView(pArgs->GetArg(1)).IsEqualNoCase("kb");
+
+	CryLogAlways("$3Memory report:");
+
+	if (gEnv && gEnv->pSystem)
+	{
+		CryLogAlways("Engine: %.1f MiB used", ToMiB(gEnv->pSystem->GetUsedMemory()));
+	}
+
+	OS::MemoryUsage usage;
+	if (OS::GetMemoryUsage(usage))
+	{
+		CryLogAlways("Process: %.1f MiB working set (peak %.1f MiB), %.1f MiB committed",
+			ToMiB(usage.workingSet),
+			ToMiB(usage.peakWorkingSet),
+			ToMiB(usage.privateBytes)
+		);
+
+		CryLogAlways("Address space: %.1f MiB of %.1f MiB available",
+			ToMiB(usage.availableVirtual),
+			ToMiB(usage.totalVirtual)
+		);
+
+		CryLogAlways("Physical memory: %.1f MiB of %.1f MiB available",
+			ToMiB(usage.availablePhysical),
+			ToMiB(usage.totalPhysical)
+		);
+	}
+
+	if (s_self)
+	{
+		CryLogAlways("Launcher: %.1f KiB logger, %.1f KiB metrics server",
+			s_self->m_logger.GetMemoryUsage() / 1024.0,
+			s_self->m_metricsServer.GetMemoryUsage() / 1024.0
+		);
+	}
+
+	if (PoolAllocator::IsInitialized())
+	{
+		const PoolAllocator::LargeStats large = PoolAllocator::GetLargeStats();
+
+		CryLogAlways("Pool allocator: %.1f MiB spans, %.1f MiB large blocks, %.1f MiB large pages",
+			(GetPoolSpanCount() * (PoolAllocator::SPAN_SIZE / 1024)) / 1024.0,
+			large.totalKiB / 1024.0,
+			large.largePageKiB / 1024.0
+		);
+	}
+
+	if (gEnv && gEnv->pSystem && s_self)
+	{
+		// walks all engine objects, which can take longer than the watchdog timeout
+		Watchdog::SuspendScope suspend(s_self->m_watchdog);
+
+		gEnv->pSystem->DumpMemoryUsageStatistics(useKB);
+	}
+}
+
+void HeadlessServerLauncher::OnPoolStatsCommand(IConsoleCmdArgs* pArgs)
+{
+	CryLogAlways("$3Pool allocator statistics:");
+
+	for (unsigned int i = 0; i < PoolAllocator::GetClassCount(); i++)
+	{
+		const PoolAllocator::ClassStats stats = PoolAllocator::GetClassStats(i);
+
+		if (stats.spanCount > 0)
+		{
+			CryLogAlways("%6u bytes: %lu spans, %lu used, %lu free",
+				static_cast<unsigned int>(stats.blockSize),
+				stats.spanCount,
+				stats.usedCount,
+				stats.freeCount
+			);
+		}
+	}
+
+	const PoolAllocator::LargeStats large = PoolAllocator::GetLargeStats();
+
+	CryLogAlways("Spans: %.1f MiB", (GetPoolSpanCount() * (PoolAllocator::SPAN_SIZE / 1024)) / 1024.0);
+	CryLogAlways("Large blocks: %lu (%.1f MiB)", large.blockCount, large.totalKiB / 1024.0);
+	CryLogAlways("Large block arenas: %.1f MiB", large.arenaKiB / 1024.0);
 }
 
 std::FILE* HeadlessServerLauncher::OpenLogFile()
 {
 	return (s_self) ? s_self->m_logger.ReleaseFile() : NULL;
 }
+
+std::FILE* HeadlessServerLauncher::OpenHangLogFile()
+{
+	// the hung main thread might be holding the logger lock, so the logger itself must not be touched
+	return (s_self) ? s_self->m_logger.OpenAppendStream() : NULL;
+}
+
+void HeadlessServerLauncher::OnHotPathStatsCommand(IConsoleCmdArgs* pArgs)
+{
+	if (pArgs->GetArgCount() > 1 && StringView(pArgs->GetArg(1)).IsEqualNoCase("reset"))
+	{
+		HotPathTimer::Reset();
+		CryLogAlways("Hot path statistics reset");
+		return;
+	}
+
+	std::vector<HotPathTimer::Result> results;
+	HotPathTimer::Collect(results);
+
+	const double elapsedTime = HotPathTimer::GetElapsedTime();
+	const double microsecondsPerCycle = HotPathTimer::GetSecondsPerCycle() * 1000000;
+
+	CryLogAlways("$3Hot path statistics of the last %.1f s:", elapsedTime);
+
+	for (std::size_t i = 0; i < results.size(); i++)
+	{
+		const HotPathTimer::Result& result = results[i];
+
+		const double totalTime = result.totalCycles * microsecondsPerCycle;
+		const double share = (elapsedTime > 0) ? totalTime / (elapsedTime * 10000) : 0;
+
+		CryLogAlways("%-30s thread %5lu: %8lu calls, %8.2f us avg, %8.1f us max, %5.2f%% of time",
+			result.name,
+			result.threadID,
+			result.count,
+			totalTime / result.count,
+			result.maxCycles * microsecondsPerCycle,
+			share
+		);
+	}
+
+	if (results.empty())
+	{
+		CryLogAlways("Nothing measured yet");
+	}
+}
+
+void HeadlessServerLauncher::OnProfileStartCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self)
+	{
+		return;
+	}
+
+	if (s_self->m_profiler.IsRunning())
+	{
+		CryLogWarningAlways("Profiler: already running");
+		return;
+	}
+
+	const int rate = (pArgs->GetArgCount() > 1) ? std::atoi(pArgs->GetArg(1)) : DEFAULT_PROFILE_RATE;
+	const StringView fileName = (pArgs->GetArgCount() > 2) ? pArgs->GetArg(2) : DEFAULT_PROFILE_FILE_NAME;
+
+	if (rate <= 0 || rate > MAX_PROFILE_RATE)
+	{
+		CryLogWarningAlways("Profiler: invalid rate %d, use 1 to %d Hz", rate, MAX_PROFILE_RATE);
+		return;
+	}
+
+	const std::string path = PathTools::Join(s_self->m_rootFolder, fileName);
+
+	if (!s_self->m_profiler.Start(s_self->m_mainThreadID, rate, path, &HeadlessServerLauncher::OnProfileDone))
+	{
+		CryLogWarningAlways("Profiler: failed to start (error code %lu)", OS::GetCurrentErrorCode());
+		return;
+	}
+
+	CryLogAlways("Profiler: sampling the main thread at %d Hz", rate);
+}
+
+void HeadlessServerLauncher::OnProfileStopCommand(IConsoleCmdArgs* pArgs)
+{
+	if (!s_self || !s_self->m_profiler.IsRunning())
+	{
+		CryLogWarningAlways("Profiler: not running");
+		return;
+	}
+
+	s_self->m_profiler.Stop();
+}
+
+void HeadlessServerLauncher::OnProfileDone(const std::string& path, bool isWritten, const Profiler::Stats& stats)
+{
+	CryLogAlways("Profiler: %u samples (%u failed) in %.1f s, %u unique stacks",
+		stats.sampleCount, stats.failedCount, stats.duration, stats.stackCount);
+	CryLogAlways("Profiler: main thread suspended for %.1f us per sample (%.2f%% overhead)",
+		stats.averageSuspendTime, stats.overhead);
+
+	if (isWritten)
+	{
+		CryLogAlways("Profiler: written to %s", path.c_str());
+	}
+	else
+	{
+		CryLogWarningAlways("Profiler: failed to write %s", path.c_str());
+	}
+}
+
+void HeadlessServerLauncher::OnHang(const std::string& report)
+{
+	// the log file already has the report, this copy bypasses the C stream lock the hung main thread might hold
+	OS::WriteStandardError(report.c_str(), report.length());
+}
@@ -4,10 +4,18 @@
 
 #include "CryCommon/CryGame/IGameStartup.h"
 #include "CryCommon/CrySystem/ISystem.h"
+#include "Library/Profiler.h"
+#include "Library/Watchdog.h"
 
+#include "ConsoleInput.h"
+#include "ConsoleOutput.h"
+#include "FrameStats.h"
 #include "Logger.h"
+#include "MetricsServer.h"
 #include "NullValidator.h"
 
+struct IConsoleCmdArgs;
+
 class HeadlessServerLauncher : private ISystemUserCallback
 {
 	IGameStartup* m_pGameStartup;
@@ -28,6 +36,13 @@ class HeadlessServerLauncher : private ISystemUserCallback
 
 	Logger m_logger;
 	NullValidator m_validator;
+	FrameStats m_frameStats;
+	MetricsServer m_metricsServer;
+	Watchdog m_watchdog;
+	Profiler m_profiler;
+	ConsoleInput m_consoleInput;
+	ConsoleOutput m_consoleOutput;
+	unsigned long m_mainThreadID;
 
 	std::string m_rootFolder;
 
@@ -38,6 +53,10 @@ public:
 	int Run();
 
 private:
+	void StartAsyncLogWriter();
+	void StartMetricsServer();
+	void StartWatchdog();
+	void StartConsoleInput();
 	void LoadEngine();
 	void PatchEngine();
 
@@ -51,6 +70,15 @@ private:
 	void OnUpdate() override;
 	void GetMemoryUsage(ICrySizer* pSizer) override;
 
+	static void OnPoolStatsCommand(IConsoleCmdArgs* pArgs);
+	static void OnMemoryReportCommand(IConsoleCmdArgs* pArgs);
+	static void OnHotPathStatsCommand(IConsoleCmdArgs* pArgs);
+	static void OnProfileStartCommand(IConsoleCmdArgs* pArgs);
+	static void OnProfileStopCommand(IConsoleCmdArgs* pArgs);
+	static void OnProfileDone(const std::string& path, bool isWritten, const Profiler::Stats& stats);
+
 	static HeadlessServerLauncher* s_self;
 	static std::FILE* OpenLogFile();
+	static std::FILE* OpenHangLogFile();
+	static void OnHang(const std::string& report);
 };
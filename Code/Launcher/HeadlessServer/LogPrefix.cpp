@@ -0,0 +1,170 @@
+#include "Library/StringTools.h"
+#include "Library/StringView.h"
+
+#include "LogPrefix.h"
+
+static void AppendTimeZoneOffset(std::string& result)
+{
+	long bias = OS::GetCurrentTimeZoneBias();
+
+	if (bias == 0)
+	{
+		result += 'Z';  // UTC
+	}
+	else
+	{
+		char sign = '-';
+
+		if (bias < 0)
+		{
+			bias = -bias;
+			sign = '+';
+		}
+
+		result += sign;
+		StringTools::AppendDecimal(result, bias / 60, 2);
+		StringTools::AppendDecimal(result, bias % 60, 2);
+	}
+}
+
+/**
+ * Renders the prefix except milliseconds, which are only reserved. Their positions are stored instead.
+ */
+void LogPrefix::Render(std::string& result, std::vector<std::size_t>& millisecondPositions,
+                       const OS::DateTime& time, unsigned long threadID) const
+{
+	const std::size_t initialLength = result.length();
+
+	for (std::size_t i = 0; i < ops.size(); i++)
+	{
+		const Op& op = ops[i];
+
+		switch (op.specifier)
+		{
+			case '\0':
+			{
+				result += op.text;
+				break;
+			}
+			case '%':
+			{
+				result += '%';
+				break;
+			}
+			case 't':
+			{
+				StringTools::AppendHex(result, threadID, 4);
+				break;
+			}
+			case 'd':
+			{
+				StringTools::AppendDecimal(result, time.day, 2);
+				break;
+			}
+			case 'm':
+			{
+				StringTools::AppendDecimal(result, time.month, 2);
+				break;
+			}
+			case 'Y':
+			{
+				StringTools::AppendDecimal(result, time.year, 4);
+				break;
+			}
+			case 'F':
+			{
+				StringTools::AppendDecimal(result, time.year, 4);
+				result += '-';
+				StringTools::AppendDecimal(result, time.month, 2);
+				result += '-';
+				StringTools::AppendDecimal(result, time.day, 2);
+				break;
+			}
+			case 'H':
+			{
+				StringTools::AppendDecimal(result, time.hour, 2);
+				break;
+			}
+			case 'M':
+			{
+				StringTools::AppendDecimal(result, time.minute, 2);
+				break;
+			}
+			case 'S':
+			{
+				StringTools::AppendDecimal(result, time.second, 2);
+				break;
+			}
+			case 'T':
+			{
+				StringTools::AppendDecimal(result, time.hour, 2);
+				result += ':';
+				StringTools::AppendDecimal(result, time.minute, 2);
+				result += ':';
+				StringTools::AppendDecimal(result, time.second, 2);
+				break;
+			}
+			case 'N':
+			{
+				millisecondPositions.push_back(result.length() - initialLength);
+				result += "000";
+				break;
+			}
+			case 'z':
+			{
+				AppendTimeZoneOffset(result);
+				break;
+			}
+		}
+	}
+
+	if (result.length() > initialLength)
+	{
+		result += ' ';
+	}
+}
+
+LogPrefix* LogPrefix::Parse(const StringView& prefix)
+{
+	// empty string or "0" means log prefix is disabled
+	if (prefix.IsEmpty() || prefix == "0")
+	{
+		return NULL;
+	}
+
+	LogPrefix* pFormat = new LogPrefix();
+
+	Op text;
+	text.specifier = '\0';
+
+	for (std::size_t i = 0; i < prefix.length; i++)
+	{
+		if (prefix[i] == '%')
+		{
+			if ((i + 1) < prefix.length)
+			{
+				if (!text.text.empty())
+				{
+					pFormat->ops.push_back(text);
+					text.text.clear();
+				}
+
+				Op specifier;
+				specifier.specifier = prefix[++i];
+
+				pFormat->ops.push_back(specifier);
+			}
+		}
+		else
+		{
+			text.text += prefix[i];
+		}
+	}
+
+	if (!text.text.empty())
+	{
+		pFormat->ops.push_back(text);
+	}
+
+	return pFormat;
+}
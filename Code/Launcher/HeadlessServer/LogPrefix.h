@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Library/OS.h"
+
+struct StringView;
+
+/**
+ * Log prefix format compiled from the log_Prefix cvar.
+ */
+struct LogPrefix
+{
+	struct Op
+	{
+		char specifier;  // zero means normal text
+		std::string text;
+	};
+
+	std::vector<Op> ops;
+
+	static LogPrefix* Parse(const StringView& prefix);  // NULL if disabled
+
+	// thread ID is the one of the thread that logged the message, which is not always the current one
+	void Render(std::string& result, std::vector<std::size_t>& millisecondPositions, const OS::DateTime& time,
+	            unsigned long threadID) const;
+};
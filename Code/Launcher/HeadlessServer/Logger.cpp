@@ -1,33 +1,116 @@
 #include <algorithm>
+#include <cstdlib>  // std::strtoul
+#include <stdexcept>
 
 #include "CryCommon/CrySystem/CryColorCode.h"
 #include "CryCommon/CrySystem/IConsole.h"
 #include "CryCommon/CrySystem/ISystem.h"
 
 #include "Library/PathTools.h"
+#include "Library/SIMD.h"
 #include "Library/StringTools.h"
 #include "Library/StringView.h"
+#include "Library/Watchdog.h"
 
+#include "LogPrefix.h"
 #include "Logger.h"
 
-Logger::Logger() : m_verbosity(0), m_cvars(), m_mainThreadID(OS::GetCurrentThreadID())
+// initial capacity of each message, StringTools::FormatToV formats directly into it
+// longer messages take the slow path, which counts the characters first and grows the message
+#define MESSAGE_RESERVED_SIZE 1024
+// release memory of huge messages
+#define MESSAGE_MAX_KEPT_SIZE (64 * 1024)
+// lines are collected here and written to the log file at once
+#define WRITE_BUFFER_SIZE (64 * 1024)
+
+Logger* Logger::s_self;
+
+Logger::Logger() : m_verbosity(0), m_fileVerbosity(0), m_flushPolicy("line"), m_cvars(), m_pPrefixFormat(NULL),
+  m_mainThreadID(OS::GetCurrentThreadID()), m_flushPolicyType(FLUSH_LINE), m_flushInterval(0),
+  m_suppressWindow(0), m_rateLimit(0), m_pWatchdog(NULL)
 {
+	m_fileBuffer.reserve(MESSAGE_RESERVED_SIZE + OS_NEWLINE_LENGTH);
+	m_writeBuffer.data.reserve(WRITE_BUFFER_SIZE);
+
+	s_self = this;
 }
 
 Logger::~Logger()
 {
+	StopAsyncWriter();
+	FinishFile();
+	StopCallbackDispatcher();
+
+	for (std::size_t i = 0; i < m_threadMessages.size(); i++)
+	{
+		delete m_threadMessages[i];
+	}
+
+	for (std::size_t i = 0; i < m_prefixFormats.size(); i++)
+	{
+		delete m_prefixFormats[i];
+	}
+
+	s_self = NULL;
 }
 
 void Logger::OnUpdate()
 {
-	OS::LockGuard<OS::Mutex> lock(m_mutex);
+	{
+		// hold the lock only for the swap, so other threads never wait for the messages being written
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		m_drainedMessages.Swap(m_queuedMessages);
+	}
+
+	for (std::size_t i = 0; i < m_drainedMessages.count; i++)
+	{
+		Message& message = m_drainedMessages.messages[i];
+
+		WriteMessage(message);
+
+		message.Clear();
+	}
+
+	m_drainedMessages.count = 0;
+
+	// threads report their repeats with their next message, so silent ones are reported here
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		const unsigned long now = OS::GetTickCount();
+
+		for (std::size_t i = 0; i < m_threadMessages.size(); i++)
+		{
+			RepeatState& repeat = m_threadMessages[i]->repeat;
+
+			if (repeat.count > 0 && (now - repeat.time) >= static_cast<unsigned long>(m_suppressWindow))
+			{
+				m_expiredRepeats.push_back(&repeat);
+			}
+		}
+	}
 
-	for (std::size_t i = 0; i < m_messages.size(); i++)
+	// thread messages are never deleted, so the pointers stay valid without the lock
+	for (std::size_t i = 0; i < m_expiredRepeats.size(); i++)
 	{
-		WriteMessage(m_messages[i]);
+		ReportForeignRepeats(*m_expiredRepeats[i]);
 	}
 
-	m_messages.clear();
+	m_expiredRepeats.clear();
+
+	if (IsAsyncWriterRunning())
+	{
+		if (m_flushPolicyType == FLUSH_FRAME)
+		{
+			m_async.isFlushRequested = 1;
+			WakeAsyncWriter();
+		}
+	}
+	else if (IsFlushDue(true))
+	{
+		FlushWriteBuffer();
+	}
 }
 
 static StringView ExtractBackupNameAttachment(StringView header)
@@ -60,8 +143,51 @@ static StringView ExtractBackupNameAttachment(StringView header)
 	}
 }
 
-static void BackupLogFile(OS::File& file, const char* filePath)
+static std::string GetLogBackupPath(const char* filePath, const StringView& nameAttachment)
+{
+	std::string backupPath;
+
+	backupPath += PathTools::DirName(filePath);
+	backupPath += OS_PATH_SLASH;
+	backupPath += "LogBackups";
+
+	if (!OS::Directory::Create(backupPath.c_str()))
+	{
+		throw StringTools::OSError("Failed to create log backup directory!\n=> %s", backupPath.c_str());
+	}
+
+	backupPath += OS_PATH_SLASH;
+	backupPath += PathTools::RemoveFileExtension(PathTools::BaseName(filePath));
+	backupPath += nameAttachment;
+	backupPath += PathTools::GetFileExtension(filePath);
+
+	return backupPath;
+}
+
+static std::string GetLogGenerationPath(const char* filePath, unsigned int generation)
+{
+	char attachment[16];
+	StringTools::FormatTo(attachment, sizeof attachment, ".%u", generation);
+
+	return GetLogBackupPath(filePath, attachment);
+}
+
+/**
+ * Moves the existing log file away.
+ *
+ * @return True if the log file is gone, false if it was copied and still needs to be cleared.
+ */
+static bool BackupLogFile(const char* filePath)
 {
+	OS::File file;
+
+	if (!file.Open(filePath, OS::File::READ_ONLY))
+	{
+		// no existing log file
+		// any other problem is reported when the log file is opened for writing
+		return true;
+	}
+
 	bool readError;
 	char buffer[256];
 	const StringView header(buffer, file.Read(buffer, sizeof buffer, &readError));
@@ -71,30 +197,23 @@ static void BackupLogFile(OS::File& file, const char* filePath)
 		throw StringTools::OSError("Failed to read the existing log file!");
 	}
 
+	file.Close();
+
 	if (header.IsEmpty())
 	{
 		// the existing log file is empty, so no backup is needed
-		return;
+		return false;
 	}
 
-	const StringView backupNameAttachment = ExtractBackupNameAttachment(header);
-
-	std::string backupPath;
-
-	backupPath += PathTools::DirName(filePath);
-	backupPath += OS_PATH_SLASH;
-	backupPath += "LogBackups";
+	const std::string backupPath = GetLogBackupPath(filePath, ExtractBackupNameAttachment(header));
 
-	if (!OS::Directory::Create(backupPath.c_str()))
+	// renaming is instant no matter how big the file is
+	if (OS::File::Move(filePath, backupPath.c_str()))
 	{
-		throw StringTools::OSError("Failed to create log backup directory!\n=> %s", backupPath.c_str());
+		return true;
 	}
 
-	backupPath += OS_PATH_SLASH;
-	backupPath += PathTools::RemoveFileExtension(PathTools::BaseName(filePath));
-	backupPath += backupNameAttachment;
-	backupPath += PathTools::GetFileExtension(filePath);
-
+	// someone else has the file open
 	if (!OS::File::Copy(filePath, backupPath.c_str()))
 	{
 		throw StringTools::OSError("Failed to copy the existing log file!\n<= %s\n=> %s",
@@ -102,10 +221,83 @@ static void BackupLogFile(OS::File& file, const char* filePath)
 			backupPath.c_str()
 		);
 	}
+
+	return false;
+}
+
+/**
+ * Shifts all generations of the log file, so the current log file becomes the first one.
+ *
+ * @return True if the log file was moved or copied, false if its content is not in the first generation.
+ */
+static bool RotateLogFile(const char* filePath, unsigned int generationCount)
+{
+	// the oldest generation is replaced
+	for (unsigned int generation = generationCount; generation > 1; generation--)
+	{
+		const std::string olderPath = GetLogGenerationPath(filePath, generation);
+		const std::string newerPath = GetLogGenerationPath(filePath, generation - 1);
+
+		OS::File::Move(newerPath.c_str(), olderPath.c_str());
+	}
+
+	const std::string firstPath = GetLogGenerationPath(filePath, 1);
+
+	if (OS::File::Move(filePath, firstPath.c_str()))
+	{
+		return true;
+	}
+
+	// someone else has the file open
+	return OS::File::Copy(filePath, firstPath.c_str());
+}
+
+/**
+ * Rotates the closed log file and opens a new one in its place.
+ *
+ * @return False if the file cannot be opened again.
+ */
+static bool ReopenRotatedFile(OS::File& file, const char* filePath, unsigned int generationCount, bool& isEmpty)
+{
+	bool isRotated = false;
+
+	try
+	{
+		isRotated = RotateLogFile(filePath, generationCount);
+	}
+	catch (const std::runtime_error&)
+	{
+		// no backup directory, so keep writing to the same file
+	}
+
+	bool created = false;
+
+	if (!file.Open(filePath, OS::File::READ_WRITE_CREATE, &created))
+	{
+		return false;
+	}
+
+	isEmpty = created;
+
+	if (!created && isRotated)
+	{
+		// the content was copied, so the file would grow without limit otherwise
+		isEmpty = file.Resize(0);
+	}
+
+	if (!isEmpty)
+	{
+		// keep the existing content
+		file.Seek(OS::File::END);
+	}
+
+	return true;
 }
 
 void Logger::OpenFile(const char* filePath)
 {
+	const bool isMoved = BackupLogFile(filePath);
+
 	bool created = false;
 	OS::File file;
 
@@ -114,10 +306,8 @@ void Logger::OpenFile(const char* filePath)
 		throw StringTools::OSError("Failed to open log file!\n=> %s", filePath);
 	}
 
-	if (!created)
+	if (!created && !isMoved)
 	{
-		BackupLogFile(file, filePath);
-
 		if (!file.Resize(0))
 		{
 			throw StringTools::OSError("Failed to clear the existing log file!\n=> %s", filePath);
@@ -126,173 +316,472 @@ void Logger::OpenFile(const char* filePath)
 
 	m_file.Swap(file);
 	m_filePath = filePath;
+	m_writeBuffer.isNewlinePending = false;
+	m_rotation.fileSize = 0;
+	m_rotation.fileOpenTime = OS::GetTickCount();
 }
 
 void Logger::CloseFile()
 {
+	StopAsyncWriter();
+	FinishFile();
+
+	m_structured.file.Close();
 	m_file.Close();
 	m_filePath.clear();
 }
 
 std::FILE* Logger::ReleaseFile()
 {
-	if (m_file.IsOpen())
-	{
-		// we have exclusive write access
-		m_file.Close();
+	// write all queued messages before the crash logger takes over the file
+	// do not wait forever because the writer thread itself might be the one that crashed
+	const bool isWriterStopped = StopAsyncWriter(2000);
 
-		std::FILE* file = std::fopen(m_filePath.c_str(), "a");
-
-		m_filePath.clear();
-
-		return file;
+	// a stuck writer thread might still be using the write buffer
+	if (isWriterStopped || IsAsyncWriterThread())
+	{
+		FinishFile();
 	}
-	else
+
+	if (!m_file.IsOpen())
 	{
 		return NULL;
 	}
-}
 
-void Logger::SetPrefix(const char* prefix)
-{
-	if (m_cvars.prefix)
+	if (!isWriterStopped && !IsAsyncWriterThread())
 	{
-		m_cvars.prefix->Set(prefix);
+		// the stuck writer thread might be in the middle of a write, so neither file can be closed under it
+		return m_file.OpenAppendStream();
 	}
 
-	m_prefix = prefix;
-}
+	m_structured.file.Close();
 
-void Logger::LogV(ILog::ELogType type, const char* format, va_list args)
-{
-	PushMessageV(type, Message::FLAG_FILE | Message::FLAG_CONSOLE, format, args);
-}
+	// we have exclusive write access
+	m_file.Close();
 
-void Logger::Log(const char* format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	LogV(ILog::eMessage, format, args);
-	va_end(args);
-}
+	std::FILE* file = std::fopen(m_filePath.c_str(), "a");
 
-void Logger::LogWarning(const char* format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	LogV(ILog::eWarning, format, args);
-	va_end(args);
-}
+	m_filePath.clear();
 
-void Logger::LogError(const char* format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	LogV(ILog::eError, format, args);
-	va_end(args);
+	return file;
 }
 
-void Logger::Release()
+std::FILE* Logger::OpenAppendStream() const
 {
-	// don't let the engine to delete us
+	return m_file.OpenAppendStream();
 }
 
-bool Logger::SetFileName(const char* fileName)
+void Logger::SetPrefix(const char* prefix)
 {
-	// don't let the engine to mess with the log file name
-	return true;
-}
+	m_prefix = prefix;
 
-const char* Logger::GetFileName()
-{
-	return PathTools::BaseName(m_filePath).string;
-}
+	if (m_cvars.prefix)
+	{
+		m_cvars.prefix->Set(prefix);
 
-void Logger::LogPlus(const char* format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	PushMessageV(ILog::eMessage, Message::FLAG_FILE | Message::FLAG_CONSOLE | Message::FLAG_APPEND, format, args);
-	va_end(args);
+		CompilePrefix();
+	}
 }
 
-void Logger::LogToFile(const char* format, ...)
+void Logger::StartAsyncWriter(std::size_t queueSize, OverflowPolicy overflowPolicy)
 {
-	va_list args;
-	va_start(args, format);
-	PushMessageV(ILog::eMessage, Message::FLAG_FILE, format, args);
-	va_end(args);
-}
+	if (IsAsyncWriterRunning())
+	{
+		return;
+	}
 
-void Logger::LogToFilePlus(const char* format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	PushMessageV(ILog::eMessage, Message::FLAG_FILE | Message::FLAG_APPEND, format, args);
-	va_end(args);
-}
+	m_async.queue.Init(queueSize);
+	m_async.overflowPolicy = overflowPolicy;
+	m_async.isStopRequested = 0;
+	m_async.isRunning = 1;
 
-void Logger::LogToConsole(const char* format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	PushMessageV(ILog::eMessage, Message::FLAG_CONSOLE, format, args);
-	va_end(args);
+	if (!m_async.thread.Start(&Logger::AsyncWriterThread, this))
+	{
+		m_async.isRunning = 0;
+
+		throw StringTools::OSError("Failed to start the log writer thread!");
+	}
 }
 
-void Logger::LogToConsolePlus(const char* format, ...)
+bool Logger::StopAsyncWriter(unsigned int timeoutMilliseconds)
 {
-	va_list args;
-	va_start(args, format);
-	PushMessageV(ILog::eMessage, Message::FLAG_CONSOLE | Message::FLAG_APPEND, format, args);
-	va_end(args);
+	if (!IsAsyncWriterRunning())
+	{
+		return true;
+	}
+
+	m_async.isStopRequested = 1;
+	m_async.wakeEvent.Set();
+
+	if (!m_async.thread.Join(timeoutMilliseconds))
+	{
+		// the writer thread is stuck or we are the writer thread
+		return false;
+	}
+
+	m_async.isRunning = 0;
+
+	// messages pushed while the writer thread was exiting
+	DrainAsyncWriter();
+
+	return true;
 }
 
-void Logger::UpdateLoadingScreen(const char* format, ...)
+void Logger::StartCallbackDispatcher(std::size_t queueSize)
 {
-	va_list args;
-	va_start(args, format);
-	LogV(ILog::eMessage, format, args);
-	va_end(args);
+	if (m_dispatcher.isRunning)
+	{
+		return;
+	}
+
+	m_dispatcher.queue.Init(queueSize);
+	m_dispatcher.isStopRequested = 0;
+	m_dispatcher.isRunning = 1;
+
+	if (!m_dispatcher.thread.Start(&Logger::CallbackDispatcherThread, this))
+	{
+		m_dispatcher.isRunning = 0;
 
-	// server has no loading screen, so nothing to do here
+		throw StringTools::OSError("Failed to start the log callback thread!");
+	}
 }
 
-void Logger::RegisterConsoleVariables()
+void Logger::StopCallbackDispatcher()
 {
-	if (!gEnv)
+	if (!m_dispatcher.isRunning)
 	{
 		return;
 	}
 
-	IConsole* pConsole = gEnv->pConsole;
+	m_dispatcher.isStopRequested = 1;
+	m_dispatcher.wakeEvent.Set();
 
-	if (!pConsole)
+	if (!m_dispatcher.thread.Join())
 	{
 		return;
 	}
 
-	m_cvars.verbosity = pConsole->RegisterInt("log_Verbosity", m_verbosity, VF_DUMPTODISK,
-		"Defines the verbosity level for console log messages (use log_FileVerbosity for file logging).\n"
-		"Usage: log_Verbosity [-1/0/1/2/3/4]\n"
-		" -1 = Suppress all logs (including eAlways).\n"
-		"  0 = Suppress all logs (except eAlways).\n"
-		"  1 = Additional errors.\n"
-		"  2 = Additional warnings.\n"
-		"  3 = Additional messages.\n"
-		"  4 = Additional comments."
-	);
+	m_dispatcher.isRunning = 0;
 
-	m_cvars.fileVerbosity = pConsole->RegisterInt("log_FileVerbosity", m_verbosity, VF_DUMPTODISK,
-		"Defines the verbosity level for file log messages (if log_Verbosity is higher, this one is used).\n"
-		"Usage: log_FileVerbosity [-1/0/1/2/3/4]\n"
-		" -1 = Suppress all logs (including eAlways).\n"
-		"  0 = Suppress all logs (except eAlways).\n"
-		"  1 = Additional errors.\n"
-		"  2 = Additional warnings.\n"
-		"  3 = Additional messages.\n"
-		"  4 = Additional comments."
-	);
+	DrainCallbackDispatcher();
+}
+
+bool Logger::ParseOverflowPolicy(const char* name, OverflowPolicy& result)
+{
+	const StringView policy = name;
+
+	if (policy.IsEqualNoCase("block"))
+	{
+		result = OVERFLOW_BLOCK;
+	}
+	else if (policy.IsEqualNoCase("dropoldest"))
+	{
+		result = OVERFLOW_DROP_OLDEST;
+	}
+	else if (policy.IsEqualNoCase("drop"))
+	{
+		result = OVERFLOW_DROP;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void Logger::OpenStructuredFile(const char* filePath, StructuredFormat format)
+{
+	if (format == FORMAT_NONE)
+	{
+		return;
+	}
+
+	bool created = false;
+	OS::File file;
+
+	if (!file.Open(filePath, OS::File::READ_WRITE_CREATE, &created))
+	{
+		throw StringTools::OSError("Failed to open structured log file!\n=> %s", filePath);
+	}
+
+	// records are self-delimiting, so new ones are simply appended to the existing file
+	unsigned __int64 size = 0;
+	if (!file.Seek(OS::File::END, 0, &size))
+	{
+		throw StringTools::OSError("Failed to seek in structured log file!\n=> %s", filePath);
+	}
+
+	m_structured.file.Swap(file);
+	m_structured.filePath = filePath;
+	m_structured.format = format;
+
+	if (size == 0)
+	{
+		WriteStructuredFileHeader();
+	}
+}
+
+void Logger::SetWatchdog(Watchdog* pWatchdog)
+{
+	m_pWatchdog = pWatchdog;
+}
+
+bool Logger::ParseStructuredFormat(const char* name, StructuredFormat& result)
+{
+	const StringView format = name;
+
+	if (format.IsEqualNoCase("text"))
+	{
+		result = FORMAT_NONE;
+	}
+	else if (format.IsEqualNoCase("json"))
+	{
+		result = FORMAT_JSON;
+	}
+	else if (format.IsEqualNoCase("binary"))
+	{
+		result = FORMAT_BINARY;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+const char* Logger::GetStructuredFileExtension(StructuredFormat format)
+{
+	switch (format)
+	{
+		case FORMAT_NONE:   return "";
+		case FORMAT_JSON:   return ".jsonl";
+		case FORMAT_BINARY: return ".bin";
+	}
+
+	return "";
+}
+
+bool Logger::SetFlushPolicy(const char* policy)
+{
+	if (!ApplyFlushPolicy(policy))
+	{
+		return false;
+	}
+
+	if (m_cvars.flushPolicy)
+	{
+		m_cvars.flushPolicy->Set(policy);
+	}
+
+	return true;
+}
+
+bool Logger::ApplyFlushPolicy(const char* policy)
+{
+	FlushPolicy type;
+	unsigned int interval;
+
+	if (!ParseFlushPolicy(policy, type, interval))
+	{
+		return false;
+	}
+
+	m_flushPolicy = policy;
+
+	// the writer thread reads these without locking
+	m_flushInterval = interval;
+	m_flushPolicyType = type;
+
+	return true;
+}
+
+bool Logger::ParseFlushPolicy(const char* name, FlushPolicy& result, unsigned int& intervalMilliseconds)
+{
+	StringView policy = name;
+
+	const StringView intervalPrefix = "interval:";
+
+	if (policy.IsEqualNoCase("line"))
+	{
+		result = FLUSH_LINE;
+		intervalMilliseconds = 0;
+	}
+	else if (policy.IsEqualNoCase("frame"))
+	{
+		result = FLUSH_FRAME;
+		intervalMilliseconds = 0;
+	}
+	else if (policy.StartsWithNoCase(intervalPrefix))
+	{
+		policy.RemovePrefix(intervalPrefix.length);
+
+		if (policy.IsEmpty())
+		{
+			return false;
+		}
+
+		char* end = NULL;
+		const unsigned long interval = std::strtoul(policy.string, &end, 10);
+
+		if (end != policy.string + policy.length || interval == 0 || interval > 60000)
+		{
+			return false;
+		}
+
+		result = FLUSH_INTERVAL;
+		intervalMilliseconds = static_cast<unsigned int>(interval);
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void Logger::LogV(ILog::ELogType type, const char* format, va_list args)
+{
+	PushMessageV(type, Message::FLAG_FILE | Message::FLAG_CONSOLE, format, args);
+}
+
+void Logger::Log(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(ILog::eMessage, format, args);
+	va_end(args);
+}
+
+void Logger::LogWarning(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(ILog::eWarning, format, args);
+	va_end(args);
+}
+
+void Logger::LogError(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(ILog::eError, format, args);
+	va_end(args);
+}
+
+void Logger::Release()
+{
+	// don't let the engine to delete us
+}
+
+bool Logger::SetFileName(const char* fileName)
+{
+	// don't let the engine to mess with the log file name
+	return true;
+}
+
+const char* Logger::GetFileName()
+{
+	return PathTools::BaseName(m_filePath).string;
+}
+
+void Logger::LogPlus(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, Message::FLAG_FILE | Message::FLAG_CONSOLE | Message::FLAG_APPEND, format, args);
+	va_end(args);
+}
+
+void Logger::LogToFile(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, Message::FLAG_FILE, format, args);
+	va_end(args);
+}
+
+void Logger::LogToFilePlus(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, Message::FLAG_FILE | Message::FLAG_APPEND, format, args);
+	va_end(args);
+}
+
+void Logger::LogToConsole(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, Message::FLAG_CONSOLE, format, args);
+	va_end(args);
+}
+
+void Logger::LogToConsolePlus(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PushMessageV(ILog::eMessage, Message::FLAG_CONSOLE | Message::FLAG_APPEND, format, args);
+	va_end(args);
+}
+
+void Logger::UpdateLoadingScreen(const char* format, ...)
+{
+	// the engine also calls it without any message just to report progress
+	if (format)
+	{
+		va_list args;
+		va_start(args, format);
+		LogV(ILog::eMessage, format, args);
+		va_end(args);
+	}
+
+	if (m_pWatchdog && OS::GetCurrentThreadID() == m_mainThreadID)
+	{
+		m_pWatchdog->Heartbeat();
+	}
+
+	// server has no loading screen, so nothing else to do here
+}
+
+void Logger::RegisterConsoleVariables()
+{
+	if (!gEnv)
+	{
+		return;
+	}
+
+	IConsole* pConsole = gEnv->pConsole;
+
+	if (!pConsole)
+	{
+		return;
+	}
+
+	m_cvars.verbosity = pConsole->RegisterInt("log_Verbosity", m_verbosity, VF_DUMPTODISK,
+		"Defines the verbosity level for console log messages (use log_FileVerbosity for file logging).\n"
+		"Usage: log_Verbosity [-1/0/1/2/3/4]\n"
+		" -1 = Suppress all logs (including eAlways).\n"
+		"  0 = Suppress all logs (except eAlways).\n"
+		"  1 = Additional errors.\n"
+		"  2 = Additional warnings.\n"
+		"  3 = Additional messages.\n"
+		"  4 = Additional comments.",
+		&Logger::OnVerbosityChange
+	);
+
+	m_cvars.fileVerbosity = pConsole->RegisterInt("log_FileVerbosity", m_verbosity, VF_DUMPTODISK,
+		"Defines the verbosity level for file log messages (if log_Verbosity is higher, this one is used).\n"
+		"Usage: log_FileVerbosity [-1/0/1/2/3/4]\n"
+		" -1 = Suppress all logs (including eAlways).\n"
+		"  0 = Suppress all logs (except eAlways).\n"
+		"  1 = Additional errors.\n"
+		"  2 = Additional warnings.\n"
+		"  3 = Additional messages.\n"
+		"  4 = Additional comments.",
+		&Logger::OnFileVerbosityChange
+	);
 
 	m_cvars.prefix = pConsole->RegisterString("log_Prefix", m_prefix.c_str(), VF_NOT_NET_SYNCED,
 		"Defines prefix of each message written to the log file.\n"
@@ -309,7 +798,72 @@ void Logger::RegisterConsoleVariables()
 		"  %z = Offset from UTC (time zone) in the ISO 8601 format (e.g. +0100)\n"
 		"  %F = Equivalent to \"%Y-%m-%d\" (the ISO 8601 date format)\n"
 		"  %T = Equivalent to \"%H:%M:%S\" (the ISO 8601 time format)\n"
-		"  %t = Thread ID where the message was logged"
+		"  %t = Thread ID where the message was logged",
+		&Logger::OnPrefixChange
+	);
+
+	m_cvars.flushPolicy = pConsole->RegisterString("log_FlushPolicy", m_flushPolicy.c_str(), VF_NOT_NET_SYNCED,
+		"Defines when messages are written to the log file.\n"
+		"Usage: log_FlushPolicy [line/frame/interval:MS]\n"
+		"  line        = Write each message immediately.\n"
+		"  frame       = Write all messages at the end of each frame.\n"
+		"  interval:MS = Write all messages at most MS milliseconds (1..60000) after the oldest one.\n"
+		"Messages are also written when the buffer is full and before a crash report.",
+		&Logger::OnFlushPolicyChange
+	);
+
+	m_cvars.maxFileSize = pConsole->RegisterInt("log_MaxFileSize", 0, VF_NOT_NET_SYNCED,
+		"Defines maximum size of the log file in MiB before it is rotated.\n"
+		"Usage: log_MaxFileSize [MiB]\n"
+		"Rotated files are kept in the LogBackups directory. See log_RotateCount.\n"
+		"The default value is 0, which disables size-based rotation.",
+		&Logger::OnRotationChange
+	);
+
+	m_cvars.rotateInterval = pConsole->RegisterInt("log_RotateInterval", 0, VF_NOT_NET_SYNCED,
+		"Defines how often the log file is rotated in seconds.\n"
+		"Usage: log_RotateInterval [seconds]\n"
+		"Rotated files are kept in the LogBackups directory. See log_RotateCount.\n"
+		"The default value is 0, which disables time-based rotation.",
+		&Logger::OnRotationChange
+	);
+
+	m_cvars.rotateCount = pConsole->RegisterInt("log_RotateCount", 5, VF_NOT_NET_SYNCED,
+		"Defines how many rotated log files are kept.\n"
+		"Usage: log_RotateCount [1..99]\n"
+		"The newest one has number 1 and the oldest one is replaced on each rotation.\n"
+		"The structured log file is rotated together with the log file.",
+		&Logger::OnRotationChange
+	);
+
+	m_cvars.suppressWindow = pConsole->RegisterInt("log_SuppressWindow", 0, VF_NOT_NET_SYNCED,
+		"Defines how long repeats of the same message are collapsed in milliseconds.\n"
+		"Usage: log_SuppressWindow [ms]\n"
+		"Repeats are replaced by \"Last message repeated N times\".\n"
+		"The default value is 0, which disables duplicate suppression.",
+		&Logger::OnSuppressWindowChange
+	);
+
+	m_cvars.rateLimit = pConsole->RegisterInt("log_RateLimit", 0, VF_NOT_NET_SYNCED,
+		"Defines maximum number of messages per second of each log type.\n"
+		"Usage: log_RateLimit [count]\n"
+		"Only errors, warnings, messages and comments are limited.\n"
+		"The default value is 0, which disables rate limiting.",
+		&Logger::OnRateLimitChange
+	);
+
+	// the values might have been changed by a config file before the cvars were registered
+	OnVerbosityChange(m_cvars.verbosity);
+	OnFileVerbosityChange(m_cvars.fileVerbosity);
+	OnPrefixChange(m_cvars.prefix);
+	OnFlushPolicyChange(m_cvars.flushPolicy);
+	OnRotationChange(NULL);
+	OnSuppressWindowChange(m_cvars.suppressWindow);
+	OnRateLimitChange(m_cvars.rateLimit);
+
+	pConsole->AddCommand("log_Stats", &Logger::OnStatsCommand, VF_NOT_NET_SYNCED,
+		"Shows statistics of the logger.\n"
+		"Usage: log_Stats"
 	);
 }
 
@@ -320,6 +874,9 @@ void Logger::UnregisterConsoleVariables()
 
 void Logger::SetVerbosity(int verbosity)
 {
+	m_verbosity = verbosity;
+	m_fileVerbosity = verbosity;
+
 	if (m_cvars.verbosity)
 	{
 		m_cvars.verbosity->Set(verbosity);
@@ -329,377 +886,1548 @@ void Logger::SetVerbosity(int verbosity)
 	{
 		m_cvars.fileVerbosity->Set(verbosity);
 	}
+}
+
+int Logger::GetVerbosityLevel()
+{
+	// updated by OnVerbosityChange, so no need to query the cvar
+	return m_verbosity;
+}
+
+void Logger::AddCallback(ILogCallback* pCallback)
+{
+	OS::LockGuard<OS::Mutex> lock(m_callbacksMutex);
+
+	if (pCallback && std::count(m_callbacks.begin(), m_callbacks.end(), pCallback) == 0)
+	{
+		Callback callback;
+		callback.pCallback = pCallback;
+
+		m_callbacks.push_back(callback);
+	}
+}
+
+void Logger::RemoveCallback(ILogCallback* pCallback)
+{
+	OS::LockGuard<OS::Mutex> lock(m_callbacksMutex);
+
+	m_callbacks.erase(std::remove(m_callbacks.begin(), m_callbacks.end(), pCallback), m_callbacks.end());
+}
+
+void Logger::PushMessage(ILog::ELogType type, unsigned int flags, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PushMessageV(type, flags, format, args);
+	va_end(args);
+}
+
+void Logger::PushMessageV(ILog::ELogType type, unsigned int flags, const char* format, va_list args)
+{
+	PushMessageAsV(OS::GetCurrentThreadID(), type, flags, format, args);
+}
+
+void Logger::PushMessageAs(unsigned long threadID, ILog::ELogType type, unsigned int flags, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PushMessageAsV(threadID, type, flags, format, args);
+	va_end(args);
+}
+
+void Logger::PushMessageAsV(unsigned long threadID, ILog::ELogType type, unsigned int flags, const char* format,
+	va_list args)
+{
+	if (!format)
+	{
+		// drop messages with null format
+		return;
+	}
+
+	const int currentVerbosity = GetVerbosityLevel();
+	const int requiredVerbosity = GetRequiredVerbosity(type);
+
+	if (currentVerbosity < requiredVerbosity)
+	{
+		// drop messages above the current verbosity level
+		return;
+	}
+
+	const int currentFileVerbosity = m_fileVerbosity;
+
+	if (currentFileVerbosity < requiredVerbosity)
+	{
+		flags &= ~Message::FLAG_FILE;
+	}
+
+	const bool isFiltered = (flags & Message::FLAG_UNFILTERED) == 0;
+	flags &= ~Message::FLAG_UNFILTERED;
+
+	if (isFiltered && !AcquireRateLimitToken(type))
+	{
+		OS::Atomic::Increment(&m_stats.rateLimitedCount);
+		return;
+	}
+
+	// nested logging from callbacks cannot use the thread message
+	ThreadMessage* pThreadMessage = AcquireThreadMessage();
+	Message localMessage;
+
+	Message& message = (pThreadMessage) ? pThreadMessage->message : localMessage;
+	message.type = type;
+	message.flags = flags;
+	message.threadID = threadID;
+	message.time = (m_structured.format != FORMAT_NONE) ? OS::GetCurrentUnixTimeMilliseconds() : 0;
+
+	BuildMessagePrefix(message, (pThreadMessage) ? &pThreadMessage->prefixCache : NULL);
+	message.prefixLength = message.text.length();
+	BuildMessageContent(message, format, args);
+
+	if (isFiltered && pThreadMessage && SuppressDuplicate(pThreadMessage->repeat, format, message))
+	{
+		OS::Atomic::Increment(&m_stats.suppressedCount);
+		ReleaseThreadMessage(pThreadMessage);
+		return;
+	}
+
+	OS::Atomic::Increment(&m_stats.messageCount);
+
+	if (message.text.length() > MESSAGE_RESERVED_SIZE)
+	{
+		OS::Atomic::Increment(&m_stats.oversizedCount);
+	}
+
+	if (OS::GetCurrentThreadID() == m_mainThreadID)
+	{
+		WriteMessage(message);
+	}
+	else
+	{
+		QueueMessage(message);
+	}
+
+	if (pThreadMessage)
+	{
+		ReleaseThreadMessage(pThreadMessage);
+	}
+}
+
+Logger::ThreadMessage* Logger::AcquireThreadMessage()
+{
+	ThreadMessage* pThreadMessage = static_cast<ThreadMessage*>(m_threadMessage.Get());
+
+	if (!pThreadMessage)
+	{
+		pThreadMessage = new ThreadMessage();
+		pThreadMessage->message.text.reserve(MESSAGE_RESERVED_SIZE);
+
+		{
+			OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+			m_threadMessages.push_back(pThreadMessage);
+		}
+
+		m_threadMessage.Set(pThreadMessage);
+	}
+
+	if (pThreadMessage->isInUse)
+	{
+		return NULL;
+	}
+
+	pThreadMessage->isInUse = true;
+
+	return pThreadMessage;
+}
+
+void Logger::ReleaseThreadMessage(ThreadMessage* pThreadMessage)
+{
+	Message& message = pThreadMessage->message;
+
+	message.Clear();
+
+	// queues give back the memory of previously written messages, so this settles quickly
+	if (message.text.capacity() > MESSAGE_MAX_KEPT_SIZE)
+	{
+		std::string().swap(message.text);
+		message.text.reserve(MESSAGE_RESERVED_SIZE);
+	}
+	else if (message.text.capacity() < MESSAGE_RESERVED_SIZE)
+	{
+		message.text.reserve(MESSAGE_RESERVED_SIZE);
+	}
+
+	pThreadMessage->isInUse = false;
+}
+
+int Logger::GetRequiredVerbosity(ILog::ELogType type)
+{
+	switch (type)
+	{
+		case ILog::eAlways:
+		case ILog::eWarningAlways:
+		case ILog::eErrorAlways:
+		case ILog::eInput:
+		case ILog::eInputResponse:
+		{
+			return 0;
+		}
+		case ILog::eError:
+		{
+			return 1;
+		}
+		case ILog::eWarning:
+		{
+			return 2;
+		}
+		case ILog::eMessage:
+		{
+			return 3;
+		}
+		case ILog::eComment:
+		{
+			return 4;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Token bucket of each log type. Messages logged regardless of verbosity are never limited.
+ */
+bool Logger::AcquireRateLimitToken(ILog::ELogType type)
+{
+	const long rateLimit = m_rateLimit;
+
+	if (rateLimit <= 0 || GetRequiredVerbosity(type) == 0)
+	{
+		return true;
+	}
+
+	if (static_cast<unsigned int>(type) > ILog::eComment)
+	{
+		return true;
+	}
+
+	const unsigned long now = OS::GetTickCount();
+	long droppedCount = 0;
+
+	{
+		OS::LockGuard<OS::Mutex> lock(m_rateLimitMutex);
+
+		RateLimitBucket& bucket = m_rateLimitBuckets[type];
+
+		// the bucket holds one second worth of messages
+		const long capacity = rateLimit * 1000;
+		const unsigned long elapsed = now - bucket.time;
+
+		if (bucket.time == 0 || elapsed >= 1000)
+		{
+			bucket.tokens = capacity;
+		}
+		else
+		{
+			bucket.tokens = std::min(bucket.tokens + static_cast<long>(elapsed) * rateLimit, capacity);
+		}
+
+		bucket.time = now;
+
+		if (bucket.tokens < 1000)
+		{
+			bucket.droppedCount++;
+			return false;
+		}
+
+		bucket.tokens -= 1000;
+
+		droppedCount = bucket.droppedCount;
+		bucket.droppedCount = 0;
+	}
+
+	if (droppedCount > 0)
+	{
+		PushMessage(ILog::eWarningAlways, Message::FLAG_FILE | Message::FLAG_CONSOLE | Message::FLAG_UNFILTERED,
+			"Log rate limit: %ld messages dropped", droppedCount
+		);
+	}
+
+	return true;
+}
+
+/**
+ * FNV-1a
+ */
+static unsigned long HashText(const char* text, std::size_t length)
+{
+	unsigned long hash = 2166136261UL;
+
+	for (std::size_t i = 0; i < length; i++)
+	{
+		hash ^= static_cast<unsigned char>(text[i]);
+		hash *= 16777619UL;
+	}
+
+	return hash & 0xFFFFFFFF;
+}
+
+/**
+ * Collapses repeats of the same message logged within the suppression window.
+ *
+ * @return True if the message should be dropped.
+ */
+bool Logger::SuppressDuplicate(RepeatState& repeat, const char* format, const Message& message)
+{
+	const long window = m_suppressWindow;
+
+	if (window <= 0 || (message.flags & Message::FLAG_APPEND))
+	{
+		ReportRepeats(repeat);
+		repeat.format = NULL;
+		return false;
+	}
+
+	const unsigned long now = OS::GetTickCount();
+
+	// comparing the format pointer first makes most different messages cheap to tell apart
+	if (repeat.format == format && repeat.type == message.type && repeat.flags == message.flags
+	 && (now - repeat.time) < static_cast<unsigned long>(window))
+	{
+		const unsigned long hash = HashText(message.GetContent(), message.GetContentLength());
+
+		if (repeat.hash == hash)
+		{
+			OS::Atomic::Increment(&repeat.count);
+			return true;
+		}
+
+		ReportRepeats(repeat);
+		repeat.hash = hash;
+	}
+	else
+	{
+		ReportRepeats(repeat);
+
+		// the main thread might still be reading the previous values
+		while (repeat.isClaimed)
+		{
+			OS::Sleep(0);
+		}
+
+		repeat.format = format;
+		repeat.hash = HashText(message.GetContent(), message.GetContentLength());
+		repeat.type = message.type;
+		repeat.flags = message.flags;
+		repeat.threadID = message.threadID;
+	}
+
+	repeat.time = now;
+
+	return false;
+}
+
+/**
+ * Called by the owning thread, which is the only one changing the type and flags.
+ */
+void Logger::ReportRepeats(RepeatState& repeat)
+{
+	if (repeat.count <= 0)
+	{
+		return;
+	}
+
+	const long count = OS::Atomic::Exchange(&repeat.count, 0);
+
+	if (count > 0)
+	{
+		PushMessageAs(repeat.threadID, repeat.type, repeat.flags | Message::FLAG_UNFILTERED,
+			"Last message repeated %ld times", count);
+	}
+}
+
+/**
+ * Called by the main thread for a thread that went silent. Only one of them gets the count.
+ *
+ * The owning thread changes the type and flags only after taking the count itself. If the count is still there once
+ * the slot is claimed, the owning thread has not started changing them yet, and it waits until the claim is released.
+ */
+void Logger::ReportForeignRepeats(RepeatState& repeat)
+{
+	if (repeat.count <= 0)
+	{
+		return;
+	}
+
+	OS::Atomic::Exchange(&repeat.isClaimed, 1);
+
+	const long count = OS::Atomic::Exchange(&repeat.count, 0);
+
+	if (count <= 0)
+	{
+		// the owning thread was faster
+		OS::Atomic::Exchange(&repeat.isClaimed, 0);
+		return;
+	}
+
+	const ILog::ELogType type = repeat.type;
+	const unsigned int flags = repeat.flags | Message::FLAG_UNFILTERED;
+	const unsigned long threadID = repeat.threadID;
+
+	OS::Atomic::Exchange(&repeat.isClaimed, 0);
+
+	PushMessageAs(threadID, type, flags, "Last message repeated %ld times", count);
+}
+
+static bool IsSameSecond(const OS::DateTime& a, const OS::DateTime& b)
+{
+	return a.second == b.second
+	    && a.minute == b.minute
+	    && a.hour == b.hour
+	    && a.day == b.day
+	    && a.month == b.month
+	    && a.year == b.year;
+}
+
+static void FillMilliseconds(char* buffer, unsigned int millisecond)
+{
+	buffer[0] = static_cast<char>('0' + (millisecond / 100) % 10);
+	buffer[1] = static_cast<char>('0' + (millisecond / 10) % 10);
+	buffer[2] = static_cast<char>('0' + millisecond % 10);
+}
+
+void Logger::CompilePrefix()
+{
+	if (!m_cvars.prefix)
+	{
+		return;
+	}
+
+	const char* prefix = m_cvars.prefix->GetString();
+
+	// SetPrefix changes the cvar, which calls this as well
+	if (m_prefixFormatSource == prefix)
+	{
+		return;
+	}
+
+	m_prefixFormatSource = prefix;
+
+	LogPrefix* pFormat = LogPrefix::Parse(prefix);
+
+	if (pFormat)
+	{
+		// other threads might still be using the previous format, so all formats are kept until the logger dies
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		m_prefixFormats.push_back(pFormat);
+	}
+
+	m_pPrefixFormat = pFormat;
+}
+
+void Logger::BuildMessagePrefix(Message& message, PrefixCache* pCache)
+{
+	const LogPrefix* pFormat = m_pPrefixFormat;
+
+	if (!pFormat)
+	{
+		// no log prefix until cvars are registered in the engine
+		return;
+	}
+
+	const OS::DateTime currentTime = OS::GetCurrentDateTimeLocal();
+
+	PrefixCache localCache;
+
+	if (!pCache)
+	{
+		pCache = &localCache;
+	}
+
+	// everything except milliseconds is rendered at most once per second
+	// repeats of other threads are reported by the main thread, so the thread ID changes as well
+	if (pCache->pFormat != pFormat || !IsSameSecond(pCache->time, currentTime) || pCache->threadID != message.threadID)
+	{
+		pCache->text.clear();
+		pCache->millisecondPositions.clear();
+
+		pFormat->Render(pCache->text, pCache->millisecondPositions, currentTime, message.threadID);
+
+		pCache->pFormat = pFormat;
+		pCache->time = currentTime;
+		pCache->threadID = message.threadID;
+	}
+
+	const std::size_t offset = message.text.length();
+
+	message.text += pCache->text;
+
+	for (std::size_t i = 0; i < pCache->millisecondPositions.size(); i++)
+	{
+		FillMilliseconds(&message.text[offset + pCache->millisecondPositions[i]], currentTime.millisecond);
+	}
+}
+
+void Logger::BuildMessageContent(Message& message, const char* format, va_list args)
+{
+	switch (message.type)
+	{
+		case ILog::eWarning:
+		case ILog::eWarningAlways:
+		{
+			message.text += CRY_COLOR_CODE_YELLOW_STRING "[Warning] ";
+			break;
+		}
+		case ILog::eError:
+		case ILog::eErrorAlways:
+		{
+			message.text += CRY_COLOR_CODE_RED_STRING "[Error] ";
+			break;
+		}
+		case ILog::eComment:
+		{
+			message.text += CRY_COLOR_CODE_GRAY_STRING;
+			break;
+		}
+		case ILog::eMessage:
+		case ILog::eAlways:
+		case ILog::eInput:
+		case ILog::eInputResponse:
+		{
+			break;
+		}
+	}
+
+	StringTools::FormatToV(message.text, format, args);
+}
+
+void Logger::WriteMessage(Message& message)
+{
+	const bool isAsyncFile = (message.flags & Message::FLAG_FILE) && IsAsyncWriterRunning();
+
+	if ((message.flags & Message::FLAG_FILE) && !isAsyncFile)
+	{
+		WriteMessageToFile(message);
+	}
+
+	if (message.flags & Message::FLAG_CONSOLE)
+	{
+		WriteMessageToConsole(message);
+	}
+
+	if (isAsyncFile)
+	{
+		// moves the message content, so it must be done last
+		PushToAsyncWriter(message);
+	}
+}
+
+void Logger::QueueMessage(Message& message)
+{
+	if ((message.flags & Message::FLAG_FILE) && IsAsyncWriterRunning())
+	{
+		// the writer thread takes care of the file, so only the console part is left for the main thread
+		if (message.flags & Message::FLAG_CONSOLE)
+		{
+			OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+			m_queuedMessages.PushCopy(message);
+			m_queuedMessages.messages[m_queuedMessages.count - 1].flags &= ~Message::FLAG_FILE;
+		}
+
+		message.flags &= ~Message::FLAG_CONSOLE;
+
+		PushToAsyncWriter(message);
+	}
+	else
+	{
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		m_queuedMessages.Push(message);
+	}
+}
+
+bool Logger::IsAsyncWriterRunning() const
+{
+	return m_async.isRunning != 0;
+}
+
+bool Logger::IsAsyncWriterThread() const
+{
+	return m_async.thread.GetID() == OS::GetCurrentThreadID();
+}
+
+void Logger::PushToAsyncWriter(Message& message)
+{
+	if (IsAsyncWriterThread())
+	{
+		// message logged by a callback invoked from the writer thread
+		WriteMessageToFile(message);
+		return;
+	}
+
+	while (!m_async.queue.Push(message))
+	{
+		switch (m_async.overflowPolicy)
+		{
+			case OVERFLOW_BLOCK:
+			{
+				if (m_invokingCallbacks.Get())
+				{
+					// the writer might be waiting for the callbacks lock held by this thread
+					OS::Atomic::Increment(&m_async.droppedCount);
+					return;
+				}
+
+				WakeAsyncWriter();
+				OS::YieldCurrentThread();
+				break;
+			}
+			case OVERFLOW_DROP_OLDEST:
+			{
+				Message oldestMessage;
+
+				if (m_async.queue.Pop(oldestMessage))
+				{
+					OS::Atomic::Increment(&m_async.droppedCount);
+					OS::Atomic::Increment(&m_async.completedCount);
+				}
+
+				break;
+			}
+			case OVERFLOW_DROP:
+			{
+				OS::Atomic::Increment(&m_async.droppedCount);
+				return;
+			}
+		}
+	}
+
+	OS::Atomic::Increment(&m_async.pushedCount);
+
+	WakeAsyncWriter();
+}
+
+void Logger::WakeAsyncWriter()
+{
+	// avoid the syscall when the writer thread is busy anyway
+	if (OS::Atomic::Exchange(&m_async.isIdle, 0))
+	{
+		m_async.wakeEvent.Set();
+	}
+}
+
+void Logger::DrainAsyncWriter()
+{
+	Message message;
+
+	while (m_async.queue.Pop(message))
+	{
+		WriteMessageToFile(message);
+
+		message.Clear();
+
+		OS::Atomic::Increment(&m_async.completedCount);
+	}
+}
+
+void Logger::RunAsyncWriter()
+{
+	// log writes must not compete with the game thread for the disk
+	const OS::IOPriority ioPriority = OS::GetProcessIOPriority();
+
+	if (ioPriority > OS::IO_PRIORITY_VERY_LOW)
+	{
+		OS::SetCurrentThreadIOPriority(static_cast<OS::IOPriority>(ioPriority - 1));
+	}
+
+	long reportedDroppedCount = 0;
+
+	for (;;)
+	{
+		DrainAsyncWriter();
+
+		const long droppedCount = m_async.droppedCount;
+
+		if (droppedCount != reportedDroppedCount)
+		{
+			PushMessage(ILog::eWarningAlways, Message::FLAG_FILE, "Log queue overflow: %ld messages dropped",
+				droppedCount - reportedDroppedCount
+			);
+
+			reportedDroppedCount = droppedCount;
+		}
+
+		if (IsFlushDue(OS::Atomic::Exchange(&m_async.isFlushRequested, 0) != 0))
+		{
+			FlushWriteBuffer();
+		}
+
+		if (m_async.isStopRequested && m_async.queue.IsEmpty())
+		{
+			break;
+		}
+
+		OS::Atomic::Exchange(&m_async.isIdle, 1);
+
+		// check again to not miss any message pushed just before going idle
+		if (m_async.queue.IsEmpty() && !m_async.isStopRequested && !m_async.isFlushRequested)
+		{
+			m_async.wakeEvent.Wait(GetFlushTimeout(1000));
+		}
+
+		OS::Atomic::Exchange(&m_async.isIdle, 0);
+	}
+}
+
+void Logger::AsyncWriterThread(void* param)
+{
+	static_cast<Logger*>(param)->RunAsyncWriter();
+}
+
+void Logger::WriteMessageToFile(const Message& message)
+{
+	if (!m_file.IsOpen())
+	{
+		return;
+	}
+
+	const bool isAppend = (message.flags & Message::FLAG_APPEND) != 0;
+
+	// rotate only between lines, so appended text stays with its line
+	// done before the structured record is written, so the record goes to the same generation as its line
+	if (!isAppend && IsRotationDue())
+	{
+		RotateFile();
+	}
+
+	const char* content = message.GetContent();
+	const std::size_t contentLength = message.GetContentLength();
+
+	// reuse the same buffer for all messages
+	std::string& buffer = m_fileBuffer;
+	buffer.clear();
+
+	// newlines may grow the message, but it is rare enough to not care about reallocation
+	const std::size_t requiredSize = message.text.length();
+	if (buffer.capacity() < requiredSize)
+	{
+		buffer.reserve(requiredSize);
+	}
+
+	if (!isAppend)
+	{
+		buffer.append(message.text, 0, message.prefixLength);
+	}
+
+	std::size_t pos = 0;
+
+	while (pos < contentLength)
+	{
+		// copy everything up to the next special character at once
+		const std::size_t runLength = SIMD::FindEither(content + pos, contentLength - pos, '\n', '$');
+		buffer.append(content + pos, runLength);
+		pos += runLength;
+
+		if (pos >= contentLength)
+		{
+			break;
+		}
+
+		if (content[pos] == '\n')
+		{
+			buffer += OS_NEWLINE;
+			pos++;
+		}
+		else
+		{
+			// drop color codes
+			pos++;
+
+			// "$$" => "$"
+			if (pos < contentLength && content[pos] == '$')
+			{
+				buffer += '$';
+			}
+
+			pos++;
+		}
+	}
+
+	// must be done first, so both files are flushed together
+	if (m_structured.format != FORMAT_NONE)
+	{
+		WriteStructuredRecord(message);
+	}
+
+	WriteToFile(buffer, isAppend);
+
+	if (buffer.capacity() > MESSAGE_MAX_KEPT_SIZE)
+	{
+		std::string().swap(buffer);
+	}
+
+	DispatchCallbacks(message, Message::FLAG_FILE);
+}
+
+void Logger::WriteToFile(const std::string& data, bool isAppend)
+{
+	std::string& buffer = m_writeBuffer.data;
+
+	// newline of the previous line is written only when a new line begins, so appending needs no seeking
+	const bool isNewline = m_writeBuffer.isNewlinePending && !isAppend;
+	const std::size_t length = data.length() + ((isNewline) ? OS_NEWLINE_LENGTH : 0);
+
+	if (!buffer.empty() && (buffer.length() + length) > WRITE_BUFFER_SIZE)
+	{
+		FlushWriteBuffer();
+	}
+
+	if (buffer.empty())
+	{
+		m_writeBuffer.firstLineTime = OS::GetTickCount();
+	}
+
+	if (isNewline)
+	{
+		buffer += OS_NEWLINE;
+	}
+
+	buffer += data;
+
+	m_writeBuffer.isNewlinePending = true;
+
+	if (IsFlushDue(false))
+	{
+		FlushWriteBuffer();
+	}
+}
+
+static const char* GetLogTypeName(ILog::ELogType type)
+{
+	switch (type)
+	{
+		case ILog::eMessage:        return "message";
+		case ILog::eWarning:        return "warning";
+		case ILog::eError:          return "error";
+		case ILog::eAlways:         return "always";
+		case ILog::eWarningAlways:  return "warning_always";
+		case ILog::eErrorAlways:    return "error_always";
+		case ILog::eInput:          return "input";
+		case ILog::eInputResponse:  return "input_response";
+		case ILog::eComment:        return "comment";
+	}
+
+	return "unknown";
+}
+
+static void AppendLittleEndian(std::string& result, unsigned __int64 value, unsigned int size)
+{
+	for (unsigned int i = 0; i < size; i++)
+	{
+		result += static_cast<char>((value >> (i * 8)) & 0xFF);
+	}
+}
+
+/**
+ * Drops color codes and escapes the rest. Bytes above 127 are treated as Latin-1 to always get valid JSON.
+ */
+static void AppendJSONString(std::string& result, const char* text, std::size_t length)
+{
+	result += '"';
+
+	for (std::size_t i = 0; i < length; i++)
+	{
+		const unsigned char ch = static_cast<unsigned char>(text[i]);
+
+		switch (ch)
+		{
+			case '$':
+			{
+				i++;
+
+				// "$$" => "$"
+				if (i < length && text[i] == '$')
+				{
+					result += '$';
+				}
+
+				break;
+			}
+			case '"':  result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\r': result += "\\r"; break;
+			case '\t': result += "\\t"; break;
+			default:
+			{
+				if (ch < 0x20 || ch > 0x7F)
+				{
+					result += "\\u00";
+					StringTools::AppendHex(result, ch, 2);
+				}
+				else
+				{
+					result += static_cast<char>(ch);
+				}
+
+				break;
+			}
+		}
+	}
+
+	result += '"';
+}
+
+static void AppendWithoutColorCodes(std::string& result, const char* text, std::size_t length)
+{
+	const StringView content(text, length);
+
+	std::size_t pos = 0;
+
+	while (pos < length)
+	{
+		std::size_t codePos = pos;
+
+		if (!content.Find('$', codePos))
+		{
+			result.append(text + pos, length - pos);
+			break;
+		}
+
+		// copy everything up to the color code at once
+		result.append(text + pos, codePos - pos);
+		pos = codePos + 1;
+
+		// "$$" => "$"
+		if (pos < length && text[pos] == '$')
+		{
+			result += '$';
+		}
+
+		pos++;
+	}
+}
+
+/**
+ * JSON Lines:
+ *   {"time":<ms since 1970>,"thread":<ID>,"type":"<type>","append":<bool>,"text":"<content>"}
+ *
+ * Binary, all numbers in little-endian:
+ *   file header: "C1LG" u32 version
+ *   record:      u32 size of the rest, u64 time, u32 thread ID, u8 type, u8 flags (1 = append), content
+ */
+void Logger::WriteStructuredRecord(const Message& message)
+{
+	std::string& buffer = m_structured.buffer;
+
+	const bool isAppend = (message.flags & Message::FLAG_APPEND) != 0;
+
+	const char* content = message.GetContent();
+	const std::size_t contentLength = message.GetContentLength();
+
+	switch (m_structured.format)
+	{
+		case FORMAT_NONE:
+		{
+			break;
+		}
+		case FORMAT_JSON:
+		{
+			buffer += "{\"time\":";
+			StringTools::AppendDecimal64(buffer, message.time);
+			buffer += ",\"thread\":";
+			StringTools::AppendDecimal(buffer, message.threadID);
+			buffer += ",\"type\":\"";
+			buffer += GetLogTypeName(message.type);
+			buffer += (isAppend) ? "\",\"append\":true,\"text\":" : "\",\"append\":false,\"text\":";
+			AppendJSONString(buffer, content, contentLength);
+			buffer += "}\n";
+			break;
+		}
+		case FORMAT_BINARY:
+		{
+			const std::size_t sizePos = buffer.length();
+			AppendLittleEndian(buffer, 0, 4);
+
+			AppendLittleEndian(buffer, message.time, 8);
+			AppendLittleEndian(buffer, message.threadID, 4);
+			AppendLittleEndian(buffer, static_cast<unsigned int>(message.type), 1);
+			AppendLittleEndian(buffer, (isAppend) ? 1 : 0, 1);
+			AppendWithoutColorCodes(buffer, content, contentLength);
+
+			const std::size_t size = buffer.length() - sizePos - 4;
+			for (unsigned int i = 0; i < 4; i++)
+			{
+				buffer[sizePos + i] = static_cast<char>((size >> (i * 8)) & 0xFF);
+			}
+
+			break;
+		}
+	}
+}
+
+void Logger::WriteStructuredFileHeader()
+{
+	if (m_structured.format == FORMAT_BINARY)
+	{
+		// magic and version
+		m_structured.buffer.append("C1LG\x01\x00\x00\x00", 8);
+	}
+}
+
+void Logger::FlushWriteBuffer()
+{
+	if (!m_structured.buffer.empty())
+	{
+		if (m_structured.file.IsOpen())
+		{
+			m_structured.file.Write(m_structured.buffer.c_str(), m_structured.buffer.length());
+		}
+
+		m_structured.buffer.clear();
+
+		if (m_structured.buffer.capacity() > (WRITE_BUFFER_SIZE + MESSAGE_MAX_KEPT_SIZE))
+		{
+			std::string().swap(m_structured.buffer);
+		}
+	}
+
+	std::string& buffer = m_writeBuffer.data;
+
+	if (buffer.empty())
+	{
+		return;
+	}
+
+	if (m_file.IsOpen())
+	{
+		m_file.Write(buffer.c_str(), buffer.length());
+		m_rotation.fileSize += buffer.length();
+
+		OS::Atomic::Increment(&m_stats.fileWriteCount);
+	}
+
+	buffer.clear();
+
+	// huge messages may grow the buffer
+	if (buffer.capacity() > (WRITE_BUFFER_SIZE + MESSAGE_MAX_KEPT_SIZE))
+	{
+		std::string().swap(buffer);
+		buffer.reserve(WRITE_BUFFER_SIZE);
+	}
+}
+
+/**
+ * Writes everything including newline of the last line. Used before the log file is closed.
+ */
+void Logger::FinishFile()
+{
+	if (m_writeBuffer.isNewlinePending && m_file.IsOpen())
+	{
+		if (m_writeBuffer.data.empty())
+		{
+			m_writeBuffer.firstLineTime = OS::GetTickCount();
+		}
+
+		m_writeBuffer.data += OS_NEWLINE;
+		m_writeBuffer.isNewlinePending = false;
+	}
+
+	FlushWriteBuffer();
+}
+
+bool Logger::IsRotationDue() const
+{
+	if (m_rotation.generationCount <= 0 || !m_file.IsOpen())
+	{
+		return false;
+	}
+
+	const long maxFileSize = m_rotation.maxFileSize;
+
+	if (maxFileSize > 0)
+	{
+		const unsigned __int64 maxBytes = static_cast<unsigned __int64>(maxFileSize) * 1024 * 1024;
+
+		if ((m_rotation.fileSize + m_writeBuffer.data.length()) >= maxBytes)
+		{
+			return true;
+		}
+	}
+
+	const long interval = m_rotation.interval;
+
+	if (interval > 0)
+	{
+		const unsigned long elapsed = OS::GetTickCount() - m_rotation.fileOpenTime;
+
+		if (elapsed >= static_cast<unsigned long>(interval) * 1000)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Logger::RotateFile()
+{
+	FinishFile();
+
+	const unsigned int generationCount = m_rotation.generationCount;
+
+	bool isEmpty = false;
+
+	// the structured file goes with the log file, so both cover the same time
+	if (m_structured.file.IsOpen())
+	{
+		// the file must be closed to be renamed
+		m_structured.file.Close();
+
+		if (ReopenRotatedFile(m_structured.file, m_structured.filePath.c_str(), generationCount, isEmpty) && isEmpty)
+		{
+			WriteStructuredFileHeader();
+		}
+	}
+
+	m_file.Close();
+
+	if (!ReopenRotatedFile(m_file, m_filePath.c_str(), generationCount, isEmpty))
+	{
+		// nothing else can be done here
+		return;
+	}
+
+	// a failed rotation keeps the existing content, which is not counted, so it is not retried with every line
+	m_rotation.fileSize = 0;
+	m_rotation.fileOpenTime = OS::GetTickCount();
+
+	OS::Atomic::Increment(&m_stats.rotationCount);
+}
+
+bool Logger::IsFlushDue(bool isEndOfFrame) const
+{
+	const std::string& buffer = m_writeBuffer.data;
+
+	if (buffer.empty())
+	{
+		return false;
+	}
+
+	if (buffer.length() >= WRITE_BUFFER_SIZE || m_structured.buffer.length() >= WRITE_BUFFER_SIZE)
+	{
+		return true;
+	}
+
+	switch (m_flushPolicyType)
+	{
+		case FLUSH_LINE:
+		{
+			return true;
+		}
+		case FLUSH_FRAME:
+		{
+			return isEndOfFrame;
+		}
+		case FLUSH_INTERVAL:
+		{
+			const unsigned long elapsed = OS::GetTickCount() - m_writeBuffer.firstLineTime;
+
+			return elapsed >= static_cast<unsigned long>(m_flushInterval);
+		}
+	}
 
-	m_verbosity = verbosity;
+	return true;
 }
 
-int Logger::GetVerbosityLevel()
+/**
+ * How long the writer thread can sleep without delaying buffered lines more than the flush interval allows.
+ */
+unsigned int Logger::GetFlushTimeout(unsigned int maxTimeout) const
 {
-	return (m_cvars.verbosity) ? m_cvars.verbosity->GetIVal() : m_verbosity;
-}
+	if (m_writeBuffer.data.empty() || m_flushPolicyType != FLUSH_INTERVAL)
+	{
+		return maxTimeout;
+	}
 
-void Logger::AddCallback(ILogCallback* pCallback)
-{
-	if (pCallback && std::count(m_callbacks.begin(), m_callbacks.end(), pCallback) == 0)
+	const unsigned long elapsed = OS::GetTickCount() - m_writeBuffer.firstLineTime;
+	const unsigned long interval = static_cast<unsigned long>(m_flushInterval);
+
+	if (elapsed >= interval)
 	{
-		m_callbacks.push_back(pCallback);
+		return 0;
 	}
-}
 
-void Logger::RemoveCallback(ILogCallback* pCallback)
-{
-	m_callbacks.erase(std::remove(m_callbacks.begin(), m_callbacks.end(), pCallback), m_callbacks.end());
-}
+	const unsigned long remaining = interval - elapsed;
 
-void Logger::PushMessage(ILog::ELogType type, unsigned int flags, const char* format, ...)
-{
-	va_list args;
-	va_start(args, format);
-	PushMessageV(type, flags, format, args);
-	va_end(args);
+	return (remaining < maxTimeout) ? static_cast<unsigned int>(remaining) : maxTimeout;
 }
 
-void Logger::PushMessageV(ILog::ELogType type, unsigned int flags, const char* format, va_list args)
+void Logger::WriteMessageToConsole(const Message& message)
 {
-	if (!format)
+	if (!gEnv)
 	{
-		// drop messages with null format
 		return;
 	}
 
-	const int currentVerbosity = GetVerbosityLevel();
-	const int requiredVerbosity = GetRequiredVerbosity(type);
+	IConsole* pConsole = gEnv->pConsole;
 
-	if (currentVerbosity < requiredVerbosity)
+	if (!pConsole)
 	{
-		// drop messages above the current verbosity level
 		return;
 	}
 
-	const int currentFileVerbosity = (m_cvars.fileVerbosity) ? m_cvars.fileVerbosity->GetIVal() : currentVerbosity;
+	const bool isAppend = (message.flags & Message::FLAG_APPEND) != 0;
 
-	if (currentFileVerbosity < requiredVerbosity)
+	if (isAppend)
 	{
-		flags &= ~Message::FLAG_FILE;
+		pConsole->PrintLinePlus(message.GetContent());
+	}
+	else
+	{
+		pConsole->PrintLine(message.GetContent());
 	}
 
-	Message message;
-	message.type = type;
-	message.flags = flags;
+	DispatchCallbacks(message, Message::FLAG_CONSOLE);
+}
 
-	BuildMessagePrefix(message);
-	BuildMessageContent(message, format, args);
+void Logger::DispatchCallbacks(const Message& message, unsigned int kind)
+{
+	const bool isAppend = (message.flags & Message::FLAG_APPEND) != 0;
 
-	if (OS::GetCurrentThreadID() == m_mainThreadID)
+	if (!m_dispatcher.isRunning)
 	{
-		WriteMessage(message);
+		InvokeCallbacks(kind, message.GetContent(), isAppend);
+		return;
 	}
-	else
+
+	// file and console output are written by different threads
+	Message& event = (kind == Message::FLAG_FILE) ? m_dispatcher.fileEvent : m_dispatcher.consoleEvent;
+	event.type = message.type;
+	event.flags = kind | (message.flags & Message::FLAG_APPEND);
+	event.prefixLength = 0;
+	event.text.assign(message.GetContent(), message.GetContentLength());
+
+	// never wait for slow callbacks
+	if (!m_dispatcher.queue.Push(event))
 	{
-		OS::LockGuard<OS::Mutex> lock(m_mutex);
+		OS::Atomic::Increment(&m_dispatcher.droppedCount);
+		return;
+	}
 
-		m_messages.push_back(message);
+	if (OS::Atomic::Exchange(&m_dispatcher.isIdle, 0))
+	{
+		m_dispatcher.wakeEvent.Set();
 	}
 }
 
-int Logger::GetRequiredVerbosity(ILog::ELogType type)
+void Logger::InvokeCallbacks(unsigned int kind, const char* content, bool isAppend)
 {
-	switch (type)
+	OS::LockGuard<OS::Mutex> lock(m_callbacksMutex);
+
+	// nested calls come from callbacks logging something
+	const bool isNested = m_invokingCallbacks.Get() != NULL;
+	m_invokingCallbacks.Set(this);
+
+	std::size_t i = 0;
+
+	while (i < m_callbacks.size())
 	{
-		case ILog::eAlways:
-		case ILog::eWarningAlways:
-		case ILog::eErrorAlways:
-		case ILog::eInput:
-		case ILog::eInputResponse:
-		{
-			return 0;
-		}
-		case ILog::eError:
-		{
-			return 1;
-		}
-		case ILog::eWarning:
+		ILogCallback* pCallback = m_callbacks[i].pCallback;
+
+		const unsigned __int64 startTime = OS::GetPerformanceCounter();
+
+		if (kind == Message::FLAG_FILE)
 		{
-			return 2;
+			pCallback->OnWriteToFile(content, !isAppend);
 		}
-		case ILog::eMessage:
+		else
 		{
-			return 3;
+			pCallback->OnWriteToConsole(content, !isAppend);
 		}
-		case ILog::eComment:
+
+		const unsigned __int64 duration = OS::GetPerformanceCounter() - startTime;
+
+		// the callback might have removed itself, so the next one is already in its place
+		if (i < m_callbacks.size() && m_callbacks[i].pCallback == pCallback)
 		{
-			return 4;
+			m_callbacks[i].totalTime += duration;
+			m_callbacks[i].callCount++;
+			i++;
 		}
 	}
 
-	return 0;
+	if (!isNested)
+	{
+		m_invokingCallbacks.Set(NULL);
+	}
 }
 
-static void AddTimeZoneOffset(std::string& result)
+void Logger::DrainCallbackDispatcher()
 {
-	long bias = OS::GetCurrentTimeZoneBias();
+	Message event;
 
-	if (bias == 0)
-	{
-		result += 'Z';  // UTC
-	}
-	else
+	while (m_dispatcher.queue.Pop(event))
 	{
-		char sign = '-';
+		const unsigned int kind = event.flags & (Message::FLAG_FILE | Message::FLAG_CONSOLE);
+		const bool isAppend = (event.flags & Message::FLAG_APPEND) != 0;
 
-		if (bias < 0)
-		{
-			bias = -bias;
-			sign = '+';
-		}
+		InvokeCallbacks(kind, event.GetContent(), isAppend);
 
-		StringTools::FormatTo(result, "%c%02u%02u", sign, bias / 60, bias % 60);
+		event.Clear();
 	}
 }
 
-static void ExpandMessagePrefixSpecifier(std::string& result, const OS::DateTime& time, char specifier)
+void Logger::RunCallbackDispatcher()
 {
-	switch (specifier)
+	for (;;)
 	{
-		case '%':
-		{
-			result += '%';
-			break;
-		}
-		case 't':
-		{
-			StringTools::FormatTo(result, "%04x", OS::GetCurrentThreadID());
-			break;
-		}
-		case 'd':
-		{
-			StringTools::FormatTo(result, "%02u", time.day);
-			break;
-		}
-		case 'm':
-		{
-			StringTools::FormatTo(result, "%02u", time.month);
-			break;
-		}
-		case 'Y':
-		{
-			StringTools::FormatTo(result, "%04u", time.year);
-			break;
-		}
-		case 'F':
-		{
-			StringTools::FormatTo(result, "%04u-%02u-%02u", time.year, time.month, time.day);
-			break;
-		}
-		case 'H':
-		{
-			StringTools::FormatTo(result, "%02u", time.hour);
-			break;
-		}
-		case 'M':
-		{
-			StringTools::FormatTo(result, "%02u", time.minute);
-			break;
-		}
-		case 'S':
-		{
-			StringTools::FormatTo(result, "%02u", time.second);
-			break;
-		}
-		case 'T':
-		{
-			StringTools::FormatTo(result, "%02u:%02u:%02u", time.hour, time.minute, time.second);
-			break;
-		}
-		case 'N':
+		DrainCallbackDispatcher();
+
+		if (m_dispatcher.isStopRequested && m_dispatcher.queue.IsEmpty())
 		{
-			StringTools::FormatTo(result, "%03u", time.millisecond);
 			break;
 		}
-		case 'z':
+
+		OS::Atomic::Exchange(&m_dispatcher.isIdle, 1);
+
+		// check again to not miss any event pushed just before going idle
+		if (m_dispatcher.queue.IsEmpty() && !m_dispatcher.isStopRequested)
 		{
-			AddTimeZoneOffset(result);
-			break;
+			m_dispatcher.wakeEvent.Wait(1000);
 		}
+
+		OS::Atomic::Exchange(&m_dispatcher.isIdle, 0);
 	}
 }
 
-void Logger::BuildMessagePrefix(Message& message)
+void Logger::CallbackDispatcherThread(void* param)
 {
-	if (!m_cvars.prefix)
-	{
-		// no log prefix until cvars are registered in the engine
-		return;
-	}
+	static_cast<Logger*>(param)->RunCallbackDispatcher();
+}
 
-	const StringView prefix = m_cvars.prefix->GetString();
+Logger::Counters Logger::GetCounters() const
+{
+	Counters counters;
+	counters.messageCount = m_stats.messageCount;
+	counters.fileWriteCount = m_stats.fileWriteCount;
+	counters.rotationCount = m_stats.rotationCount;
+	counters.suppressedCount = m_stats.suppressedCount;
+	counters.rateLimitedCount = m_stats.rateLimitedCount;
+	counters.writerDroppedCount = m_async.droppedCount;
+	counters.callbackDroppedCount = m_dispatcher.droppedCount;
+
+	return counters;
+}
 
-	if (prefix.IsEmpty() || prefix == "0")
-	{
-		// empty string or "0" means log prefix is disabled
-		return;
-	}
+std::size_t Logger::GetMemoryUsage()
+{
+	std::size_t size = 0;
 
-	const OS::DateTime currentTime = OS::GetCurrentDateTimeLocal();
+	size += m_filePath.capacity();
+	size += m_prefix.capacity();
+	size += m_flushPolicy.capacity();
 
-	for (std::size_t i = 0; i < prefix.length; i++)
 	{
-		if (prefix[i] == '%')
+		OS::LockGuard<OS::Mutex> lock(m_mutex);
+
+		size += m_prefixFormats.capacity() * sizeof(LogPrefix*);
+
+		for (std::size_t i = 0; i < m_prefixFormats.size(); i++)
 		{
-			if ((i + 1) < prefix.length)
-			{
-				const char specifier = prefix[++i];
+			const LogPrefix* pFormat = m_prefixFormats[i];
 
-				ExpandMessagePrefixSpecifier(message.prefix, currentTime, specifier);
+			size += sizeof(LogPrefix) + pFormat->ops.capacity() * sizeof(LogPrefix::Op);
+
+			for (std::size_t j = 0; j < pFormat->ops.size(); j++)
+			{
+				size += pFormat->ops[j].text.capacity();
 			}
 		}
-		else
+
+		size += m_queuedMessages.GetMemoryUsage();
+
+		size += m_threadMessages.capacity() * sizeof(ThreadMessage*);
+
+		for (std::size_t i = 0; i < m_threadMessages.size(); i++)
 		{
-			message.prefix += prefix[i];
+			const ThreadMessage* pThreadMessage = m_threadMessages[i];
+
+			size += sizeof(ThreadMessage);
+			size += pThreadMessage->message.GetMemoryUsage();
+			size += pThreadMessage->prefixCache.text.capacity();
+			size += pThreadMessage->prefixCache.millisecondPositions.capacity() * sizeof(std::size_t);
 		}
 	}
 
-	if (!message.prefix.empty())
+	size += m_drainedMessages.GetMemoryUsage();
+
+	// owned by the thread writing to the log file
+	size += m_fileBuffer.capacity();
+	size += m_writeBuffer.data.capacity();
+	size += m_structured.buffer.capacity();
+
 	{
-		message.prefix += ' ';
+		OS::LockGuard<OS::Mutex> lock(m_callbacksMutex);
+
+		size += m_callbacks.capacity() * sizeof(Callback);
 	}
+
+	size += m_dispatcher.queue.GetMemoryUsage();
+	size += m_dispatcher.fileEvent.GetMemoryUsage();
+	size += m_dispatcher.consoleEvent.GetMemoryUsage();
+
+	size += m_async.queue.GetMemoryUsage();
+
+	return size;
 }
 
-void Logger::BuildMessageContent(Message& message, const char* format, va_list args)
+void Logger::DumpStats()
 {
-	switch (message.type)
+	const unsigned int flags = Message::FLAG_FILE | Message::FLAG_CONSOLE;
+
+	PushMessage(ILog::eAlways, flags, "$3Log statistics:");
+	PushMessage(ILog::eAlways, flags, "Messages: %ld", m_stats.messageCount);
+	PushMessage(ILog::eAlways, flags, "Oversized messages (slow path): %ld", m_stats.oversizedCount);
+	PushMessage(ILog::eAlways, flags, "File writes: %ld (flush policy %s)", m_stats.fileWriteCount,
+		m_flushPolicy.c_str()
+	);
+	PushMessage(ILog::eAlways, flags, "File rotations: %ld", m_stats.rotationCount);
+	PushMessage(ILog::eAlways, flags, "Suppressed duplicates: %ld", m_stats.suppressedCount);
+	PushMessage(ILog::eAlways, flags, "Dropped by rate limit: %ld", m_stats.rateLimitedCount);
+
+	if (m_dispatcher.isRunning)
 	{
-		case ILog::eWarning:
-		case ILog::eWarningAlways:
-		{
-			message.content += CRY_COLOR_CODE_YELLOW_STRING "[Warning] ";
-			break;
-		}
-		case ILog::eError:
-		case ILog::eErrorAlways:
-		{
-			message.content += CRY_COLOR_CODE_RED_STRING "[Error] ";
-			break;
-		}
-		case ILog::eComment:
-		{
-			message.content += CRY_COLOR_CODE_GRAY_STRING;
-			break;
-		}
-		case ILog::eMessage:
-		case ILog::eAlways:
-		case ILog::eInput:
-		case ILog::eInputResponse:
-		{
-			break;
-		}
+		PushMessage(ILog::eAlways, flags, "Callback queue: %u/%u (%ld dropped)",
+			static_cast<unsigned int>(m_dispatcher.queue.GetCount()),
+			static_cast<unsigned int>(m_dispatcher.queue.GetCapacity()),
+			m_dispatcher.droppedCount
+		);
 	}
 
-	StringTools::FormatToV(message.content, format, args);
-}
+	std::vector<Callback> callbacks;
 
-void Logger::WriteMessage(const Message& message)
-{
-	if (message.flags & Message::FLAG_FILE)
 	{
-		WriteMessageToFile(message);
+		// do not log with the lock held, the writer thread might need it to make progress
+		OS::LockGuard<OS::Mutex> lock(m_callbacksMutex);
+
+		callbacks = m_callbacks;
 	}
 
-	if (message.flags & Message::FLAG_CONSOLE)
+	const double frequency = static_cast<double>(OS::GetPerformanceFrequency());
+
+	for (std::size_t i = 0; i < callbacks.size(); i++)
 	{
-		WriteMessageToConsole(message);
+		const Callback& callback = callbacks[i];
+		const double totalMilliseconds = (static_cast<double>(callback.totalTime) * 1000) / frequency;
+		const double averageMicroseconds = (callback.callCount > 0) ? (totalMilliseconds * 1000) / callback.callCount : 0;
+
+		PushMessage(ILog::eAlways, flags, "Callback %p: %ld calls, %.3f ms total, %.3f us average",
+			callback.pCallback,
+			callback.callCount,
+			totalMilliseconds,
+			averageMicroseconds
+		);
 	}
-}
 
-void Logger::WriteMessageToFile(const Message& message)
-{
-	if (!m_file.IsOpen())
+	if (IsAsyncWriterRunning())
 	{
-		return;
+		PushMessage(ILog::eAlways, flags, "Writer queue: %u/%u (%ld dropped)",
+			static_cast<unsigned int>(m_async.queue.GetCount()),
+			static_cast<unsigned int>(m_async.queue.GetCapacity()),
+			m_async.droppedCount
+		);
 	}
+}
 
-	const bool isAppend = (message.flags & Message::FLAG_APPEND) != 0;
-
-	std::string buffer;
-	buffer.reserve(message.prefix.length() + message.content.length() + OS_NEWLINE_LENGTH);
-
-	if (!isAppend)
+void Logger::OnStatsCommand(IConsoleCmdArgs* pArgs)
+{
+	if (s_self)
 	{
-		buffer += message.prefix;
+		s_self->DumpStats();
 	}
+}
 
-	for (std::size_t i = 0; i < message.content.length(); i++)
+void Logger::OnVerbosityChange(ICVar* pCVar)
+{
+	if (s_self && pCVar)
 	{
-		switch (message.content[i])
-		{
-			case '\n':
-			{
-				buffer += OS_NEWLINE;
-				break;
-			}
-			case '$':
-			{
-				// drop color codes
-				i++;
-
-				// "$$" => "$"
-				if (i < message.content.length() && message.content[i] == '$')
-				{
-					buffer += '$';
-				}
-
-				break;
-			}
-			default:
-			{
-				buffer += message.content[i];
-				break;
-			}
-		}
+		s_self->m_verbosity = pCVar->GetIVal();
 	}
+}
 
-	buffer += OS_NEWLINE;
-
-	if (isAppend)
+void Logger::OnFileVerbosityChange(ICVar* pCVar)
+{
+	if (s_self && pCVar)
 	{
-		m_file.Seek(OS::File::END, -OS_NEWLINE_LENGTH);
+		s_self->m_fileVerbosity = pCVar->GetIVal();
 	}
+}
 
-	m_file.Write(buffer.c_str(), buffer.length());
-
-	for (std::size_t i = 0; i < m_callbacks.size(); i++)
+void Logger::OnPrefixChange(ICVar* pCVar)
+{
+	if (s_self)
 	{
-		m_callbacks[i]->OnWriteToFile(message.content.c_str(), !isAppend);
+		s_self->CompilePrefix();
 	}
 }
 
-void Logger::WriteMessageToConsole(const Message& message)
+void Logger::OnRotationChange(ICVar* pCVar)
 {
-	if (!gEnv)
+	if (!s_self)
 	{
 		return;
 	}
 
-	IConsole* pConsole = gEnv->pConsole;
+	const CVars& cvars = s_self->m_cvars;
+	Rotation& rotation = s_self->m_rotation;
 
-	if (!pConsole)
+	if (cvars.maxFileSize)
 	{
-		return;
+		rotation.maxFileSize = std::max(cvars.maxFileSize->GetIVal(), 0);
 	}
 
-	const bool isAppend = (message.flags & Message::FLAG_APPEND) != 0;
+	if (cvars.rotateInterval)
+	{
+		// keep the milliseconds within the range of OS::GetTickCount
+		rotation.interval = std::min(std::max(cvars.rotateInterval->GetIVal(), 0), 30 * 24 * 60 * 60);
+	}
 
-	if (isAppend)
+	if (cvars.rotateCount)
 	{
-		pConsole->PrintLinePlus(message.content.c_str());
+		rotation.generationCount = std::min(std::max(cvars.rotateCount->GetIVal(), 1), 99);
 	}
-	else
+}
+
+void Logger::OnSuppressWindowChange(ICVar* pCVar)
+{
+	if (s_self && pCVar)
+	{
+		s_self->m_suppressWindow = std::max(pCVar->GetIVal(), 0);
+	}
+}
+
+void Logger::OnRateLimitChange(ICVar* pCVar)
+{
+	if (s_self && pCVar)
 	{
-		pConsole->PrintLine(message.content.c_str());
+		// keep the tokens within the range of long
+		s_self->m_rateLimit = std::min(std::max(pCVar->GetIVal(), 0), 1000000);
 	}
+}
 
-	for (std::size_t i = 0; i < m_callbacks.size(); i++)
+void Logger::OnFlushPolicyChange(ICVar* pCVar)
+{
+	if (s_self && pCVar)
 	{
-		m_callbacks[i]->OnWriteToConsole(message.content.c_str(), !isAppend);
+		const char* policy = pCVar->GetString();
+
+		if (!s_self->ApplyFlushPolicy(policy))
+		{
+			s_self->LogWarning("Invalid log flush policy \"%s\", keeping \"%s\"", policy, s_self->m_flushPolicy.c_str());
+
+			pCVar->Set(s_self->m_flushPolicy.c_str());
+		}
 	}
 }
@@ -1,17 +1,45 @@
 #pragma once
 
+#include <algorithm>  // std::swap
 #include <cstdio>
 #include <string>
 #include <vector>
 
 #include "CryCommon/CrySystem/ILog.h"
 
+#include "Library/BoundedQueue.h"
 #include "Library/OS.h"
 
 struct ICVar;
+struct IConsoleCmdArgs;
+struct LogPrefix;
+class Watchdog;
 
 class Logger : public ILog
 {
+public:
+	enum OverflowPolicy
+	{
+		OVERFLOW_BLOCK,        // wait until the writer thread makes some space
+		OVERFLOW_DROP_OLDEST,  // drop the oldest queued message
+		OVERFLOW_DROP,         // drop the new message
+	};
+
+	enum FlushPolicy
+	{
+		FLUSH_LINE,      // write each line immediately
+		FLUSH_FRAME,     // write all lines at the end of each frame
+		FLUSH_INTERVAL,  // write all lines at most after the specified number of milliseconds
+	};
+
+	enum StructuredFormat
+	{
+		FORMAT_NONE,
+		FORMAT_JSON,    // JSON Lines
+		FORMAT_BINARY,  // length-prefixed records, see WriteBinaryRecord
+	};
+
+private:
 	struct Message
 	{
 		enum Flags
@@ -19,33 +47,366 @@ class Logger : public ILog
 			FLAG_FILE    = (1 << 0),
 			FLAG_CONSOLE = (1 << 1),
 			FLAG_APPEND  = (1 << 2),
+			FLAG_UNFILTERED = (1 << 3),  // skip duplicate suppression and rate limiting
 		};
 
 		ILog::ELogType type;
 		unsigned int flags;
-		std::string prefix;
-		std::string content;
+		unsigned long threadID;
+		unsigned __int64 time;  // milliseconds since 1970, only with structured output
+		std::size_t prefixLength;
+		std::string text;  // prefix followed by content
+
+		Message() : type(ILog::eMessage), flags(0), threadID(0), time(0), prefixLength(0)
+		{
+		}
+
+		const char* GetContent() const
+		{
+			return this->text.c_str() + this->prefixLength;
+		}
+
+		std::size_t GetContentLength() const
+		{
+			return this->text.length() - this->prefixLength;
+		}
+
+		void Clear()
+		{
+			// keep the allocated memory for reuse
+			this->prefixLength = 0;
+			this->text.clear();
+		}
+
+		void Assign(const Message& other)
+		{
+			this->type = other.type;
+			this->flags = other.flags;
+			this->threadID = other.threadID;
+			this->time = other.time;
+			this->prefixLength = other.prefixLength;
+			this->text.assign(other.text);
+		}
+
+		void Swap(Message& other)
+		{
+			std::swap(this->type, other.type);
+			std::swap(this->flags, other.flags);
+			std::swap(this->threadID, other.threadID);
+			std::swap(this->time, other.time);
+			std::swap(this->prefixLength, other.prefixLength);
+			this->text.swap(other.text);
+		}
+
+		// heap memory only
+		std::size_t GetMemoryUsage() const
+		{
+			return this->text.capacity();
+		}
+	};
+
+	/**
+	 * Message buffer that keeps its elements around to reuse their memory.
+	 */
+	struct MessageQueue
+	{
+		std::vector<Message> messages;
+		std::size_t count;
+
+		MessageQueue() : count(0)
+		{
+		}
+
+		void Push(Message& message)
+		{
+			if (this->count == this->messages.size())
+			{
+				this->messages.push_back(Message());
+			}
+
+			this->messages[this->count++].Swap(message);
+		}
+
+		void PushCopy(const Message& message)
+		{
+			if (this->count == this->messages.size())
+			{
+				this->messages.push_back(Message());
+			}
+
+			this->messages[this->count++].Assign(message);
+		}
+
+		void Swap(MessageQueue& other)
+		{
+			this->messages.swap(other.messages);
+			std::swap(this->count, other.count);
+		}
+
+		std::size_t GetMemoryUsage() const
+		{
+			std::size_t size = this->messages.capacity() * sizeof(Message);
+
+			for (std::size_t i = 0; i < this->messages.size(); i++)
+			{
+				size += this->messages[i].GetMemoryUsage();
+			}
+
+			return size;
+		}
 	};
 
-	int m_verbosity;
+	volatile int m_verbosity;
+	volatile int m_fileVerbosity;
 	OS::File m_file;
 	std::string m_filePath;
 	std::string m_prefix;
+	std::string m_flushPolicy;
 
 	struct CVars
 	{
 		ICVar* verbosity;
 		ICVar* fileVerbosity;
 		ICVar* prefix;
+		ICVar* flushPolicy;
+		ICVar* maxFileSize;
+		ICVar* rotateInterval;
+		ICVar* rotateCount;
+		ICVar* suppressWindow;
+		ICVar* rateLimit;
 	};
 
 	CVars m_cvars;
 
+	const LogPrefix* volatile m_pPrefixFormat;  // NULL if disabled
+	std::string m_prefixFormatSource;  // used only by the main thread
+	std::vector<LogPrefix*> m_prefixFormats;  // protected by m_mutex
+
+	/**
+	 * Log prefix rendered for the current second, so only milliseconds need to be filled in.
+	 */
+	struct PrefixCache
+	{
+		const LogPrefix* pFormat;
+		OS::DateTime time;
+		unsigned long threadID;
+		std::string text;
+		std::vector<std::size_t> millisecondPositions;
+
+		PrefixCache() : pFormat(NULL), time(), threadID(0)
+		{
+		}
+	};
+
 	OS::Mutex m_mutex;
 	unsigned long m_mainThreadID;
-	std::vector<Message> m_messages;
+	MessageQueue m_queuedMessages;  // filled by other threads, protected by m_mutex
+	MessageQueue m_drainedMessages;  // used only by the main thread
+
+	/**
+	 * The last written message of a thread and how many times it has been repeated since then.
+	 *
+	 * Only the owning thread modifies it, except for the count, which the main thread takes once the thread goes silent.
+	 * The main thread reads the type, flags and thread ID of the taken count while isClaimed is set, and the owning
+	 * thread does not change them meanwhile.
+	 */
+	struct RepeatState
+	{
+		const char* format;
+		unsigned long hash;
+		ILog::ELogType type;
+		unsigned int flags;
+		unsigned long threadID;
+		volatile unsigned long time;  // OS::GetTickCount
+		volatile long count;
+		volatile long isClaimed;
+
+		RepeatState() : format(NULL), hash(0), type(ILog::eMessage), flags(0), threadID(0), time(0), count(0),
+		  isClaimed(0)
+		{
+		}
+	};
+
+	// reusable message of each thread, so there is no heap allocation in steady state
+	struct ThreadMessage
+	{
+		Message message;
+		PrefixCache prefixCache;
+		RepeatState repeat;
+		bool isInUse;
+
+		ThreadMessage() : message(), prefixCache(), repeat(), isInUse(false)
+		{
+		}
+	};
+
+	OS::ThreadLocalPointer m_threadMessage;
+	std::vector<ThreadMessage*> m_threadMessages;  // protected by m_mutex
+	std::vector<RepeatState*> m_expiredRepeats;  // used only by the main thread
+
+	// used only by the thread writing to the log file
+	std::string m_fileBuffer;
+
+	/**
+	 * Lines not yet written to the log file. Used only by the thread writing to the log file.
+	 */
+	struct WriteBuffer
+	{
+		std::string data;
+		unsigned long firstLineTime;  // OS::GetTickCount of the oldest line in the buffer
+		bool isNewlinePending;  // the last line is written without newline, so it can be appended to
+
+		WriteBuffer() : firstLineTime(0), isNewlinePending(false)
+		{
+		}
+	};
+
+	WriteBuffer m_writeBuffer;
+
+	/**
+	 * Optional machine-readable copy of the log file. Written together with the log file.
+	 */
+	struct StructuredSink
+	{
+		StructuredFormat format;  // set before any other thread starts logging
+		OS::File file;
+		std::string filePath;
+		std::string buffer;  // used only by the thread writing to the log file
+
+		StructuredSink() : format(FORMAT_NONE)
+		{
+		}
+	};
+
+	StructuredSink m_structured;
+
+	volatile long m_flushPolicyType;
+	volatile long m_flushInterval;  // milliseconds
+
+	struct Rotation
+	{
+		// set by cvars, zero means disabled
+		volatile long maxFileSize;  // MiB
+		volatile long interval;  // seconds
+		volatile long generationCount;
+
+		// used only by the thread writing to the log file
+		unsigned __int64 fileSize;
+		unsigned long fileOpenTime;  // OS::GetTickCount
+
+		Rotation() : maxFileSize(0), interval(0), generationCount(0), fileSize(0), fileOpenTime(0)
+		{
+		}
+	};
+
+	Rotation m_rotation;
+
+	volatile long m_suppressWindow;  // milliseconds, zero means disabled
+	volatile long m_rateLimit;  // messages per second of each type, zero means disabled
+
+	Watchdog* m_pWatchdog;
+
+	struct RateLimitBucket
+	{
+		long tokens;  // thousandths of a message
+		unsigned long time;  // OS::GetTickCount of the last refill
+		long droppedCount;  // not yet reported
+
+		RateLimitBucket() : tokens(0), time(0), droppedCount(0)
+		{
+		}
+	};
+
+	OS::Mutex m_rateLimitMutex;
+	RateLimitBucket m_rateLimitBuckets[ILog::eComment + 1];  // protected by m_rateLimitMutex
+
+	struct Stats
+	{
+		volatile long messageCount;
+		volatile long oversizedCount;
+		volatile long fileWriteCount;
+		volatile long rotationCount;
+		volatile long suppressedCount;
+		volatile long rateLimitedCount;
+
+		Stats() : messageCount(0), oversizedCount(0), fileWriteCount(0), rotationCount(0), suppressedCount(0),
+		          rateLimitedCount(0)
+		{
+		}
+	};
+
+	Stats m_stats;
+
+	struct Callback
+	{
+		ILogCallback* pCallback;
+		unsigned __int64 totalTime;  // OS::GetPerformanceCounter units
+		long callCount;
+
+		Callback() : pCallback(NULL), totalTime(0), callCount(0)
+		{
+		}
+
+		bool operator==(const ILogCallback* other) const
+		{
+			return this->pCallback == other;
+		}
+	};
+
+	OS::Mutex m_callbacksMutex;
+	std::vector<Callback> m_callbacks;  // protected by m_callbacksMutex
+
+	// non-NULL while the current thread is invoking the callbacks
+	OS::ThreadLocalPointer m_invokingCallbacks;
+
+	/**
+	 * Optional thread invoking the callbacks, so slow callbacks do not stall logging.
+	 */
+	struct CallbackDispatcher
+	{
+		OS::Thread thread;
+		OS::Event wakeEvent;
+		BoundedQueue<Message> queue;  // FLAG_FILE for OnWriteToFile, FLAG_CONSOLE for OnWriteToConsole
+
+		Message fileEvent;  // used only by the thread writing to the log file
+		Message consoleEvent;  // used only by the main thread
 
-	std::vector<ILogCallback*> m_callbacks;
+		volatile long isRunning;
+		volatile long isStopRequested;
+		volatile long isIdle;
+
+		volatile long droppedCount;
+
+		CallbackDispatcher() : isRunning(0), isStopRequested(0), isIdle(0), droppedCount(0)
+		{
+		}
+	};
+
+	CallbackDispatcher m_dispatcher;
+
+	struct AsyncWriter
+	{
+		OS::Thread thread;
+		OS::Event wakeEvent;
+		BoundedQueue<Message> queue;
+		OverflowPolicy overflowPolicy;
+
+		volatile long isRunning;
+		volatile long isStopRequested;
+		volatile long isIdle;
+		volatile long isFlushRequested;
+
+		volatile long pushedCount;
+		volatile long completedCount;
+		volatile long droppedCount;
+
+		AsyncWriter() : overflowPolicy(OVERFLOW_BLOCK), isRunning(0), isStopRequested(0), isIdle(0),
+		                isFlushRequested(0), pushedCount(0), completedCount(0), droppedCount(0)
+		{
+		}
+	};
+
+	AsyncWriter m_async;
 
 public:
 	Logger();
@@ -57,8 +418,52 @@ public:
 	void CloseFile();
 	std::FILE* ReleaseFile();
 
+	// appends to the log file through a duplicate handle without touching the logger, so it does not need its lock
+	std::FILE* OpenAppendStream() const;
+
 	void SetPrefix(const char* prefix);
 
+	void StartAsyncWriter(std::size_t queueSize, OverflowPolicy overflowPolicy);
+	bool StopAsyncWriter(unsigned int timeoutMilliseconds = OS::WAIT_FOREVER);
+
+	static bool ParseOverflowPolicy(const char* name, OverflowPolicy& result);
+
+	void StartCallbackDispatcher(std::size_t queueSize);
+	void StopCallbackDispatcher();
+
+	void OpenStructuredFile(const char* filePath, StructuredFormat format);
+
+	// loading progress of the main thread counts as its heartbeat, the engine does not call OnUpdate during level loading
+	void SetWatchdog(Watchdog* pWatchdog);
+
+	static bool ParseStructuredFormat(const char* name, StructuredFormat& result);
+	static const char* GetStructuredFileExtension(StructuredFormat format);
+
+	bool SetFlushPolicy(const char* policy);
+
+	struct Counters
+	{
+		long messageCount;
+		long fileWriteCount;
+		long rotationCount;
+		long suppressedCount;
+		long rateLimitedCount;
+		long writerDroppedCount;
+		long callbackDroppedCount;
+	};
+
+	// safe to call from any thread
+	Counters GetCounters() const;
+
+	/**
+	 * Heap memory owned by the logger in bytes. Must be called from the main thread.
+	 *
+	 * Buffers of the other threads are only sampled, so the result is approximate.
+	 */
+	std::size_t GetMemoryUsage();
+
+	static bool ParseFlushPolicy(const char* name, FlushPolicy& result, unsigned int& intervalMilliseconds);
+
 	////////////////////////////////////////////////////////////////////////////////
 	// ILog
 	////////////////////////////////////////////////////////////////////////////////
@@ -97,13 +502,66 @@ private:
 	void PushMessage(ILog::ELogType type, unsigned int flags, const char* format, ...);
 	void PushMessageV(ILog::ELogType type, unsigned int flags, const char* format, va_list args);
 
+	// the message is attributed to another thread
+	void PushMessageAs(unsigned long threadID, ILog::ELogType type, unsigned int flags, const char* format, ...);
+	void PushMessageAsV(unsigned long threadID, ILog::ELogType type, unsigned int flags, const char* format,
+		va_list args);
+
 	int GetRequiredVerbosity(ILog::ELogType type);
 
-	void BuildMessagePrefix(Message& message);
+	bool AcquireRateLimitToken(ILog::ELogType type);
+	bool SuppressDuplicate(RepeatState& repeat, const char* format, const Message& message);
+	void ReportRepeats(RepeatState& repeat);
+	void ReportForeignRepeats(RepeatState& repeat);
+
+	ThreadMessage* AcquireThreadMessage();
+	void ReleaseThreadMessage(ThreadMessage* pThreadMessage);
+
+	void CompilePrefix();
+	void BuildMessagePrefix(Message& message, PrefixCache* pCache);
 	void BuildMessageContent(Message& message, const char* format, va_list args);
 
-	void WriteMessage(const Message& message);
+	void WriteMessage(Message& message);
+	void QueueMessage(Message& message);
+
+	bool IsAsyncWriterRunning() const;
+	bool IsAsyncWriterThread() const;
+	void PushToAsyncWriter(Message& message);
+	void WakeAsyncWriter();
+	void DrainAsyncWriter();
+	void RunAsyncWriter();
+	static void AsyncWriterThread(void* param);
+
+	bool ApplyFlushPolicy(const char* policy);
 
 	void WriteMessageToFile(const Message& message);
+	void WriteToFile(const std::string& data, bool isAppend);
+	void WriteStructuredRecord(const Message& message);
+	void WriteStructuredFileHeader();
+	void FlushWriteBuffer();
+	void FinishFile();
+	bool IsRotationDue() const;
+	void RotateFile();
+	bool IsFlushDue(bool isEndOfFrame) const;
+	unsigned int GetFlushTimeout(unsigned int maxTimeout) const;
 	void WriteMessageToConsole(const Message& message);
+
+	void DispatchCallbacks(const Message& message, unsigned int kind);
+	void InvokeCallbacks(unsigned int kind, const char* content, bool isAppend);
+	void DrainCallbackDispatcher();
+	void RunCallbackDispatcher();
+	static void CallbackDispatcherThread(void* param);
+
+	void DumpStats();
+
+	static void OnStatsCommand(IConsoleCmdArgs* pArgs);
+	static void OnVerbosityChange(ICVar* pCVar);
+	static void OnFileVerbosityChange(ICVar* pCVar);
+	static void OnPrefixChange(ICVar* pCVar);
+	static void OnFlushPolicyChange(ICVar* pCVar);
+	static void OnRotationChange(ICVar* pCVar);
+	static void OnSuppressWindowChange(ICVar* pCVar);
+	static void OnRateLimitChange(ICVar* pCVar);
+
+	static Logger* s_self;
 };
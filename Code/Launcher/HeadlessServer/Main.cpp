@@ -9,6 +9,7 @@
 #include "Project.h"
 
 #include "HeadlessServerLauncher.h"
+#include "Supervisor.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -20,6 +21,11 @@ int main()
 {
 	try
 	{
+		if (OS::CmdLine::HasArg("-supervise"))
+		{
+			return Supervisor().Run(OS::CmdLine::GetArgValue("-supervise"));
+		}
+
 		return HeadlessServerLauncher().Run();
 	}
 	catch (const std::runtime_error& ex)
@@ -0,0 +1,238 @@
+#include <string.h>
+
+#include "Library/StringTools.h"
+
+#include "FrameStats.h"
+#include "Logger.h"
+#include "MetricsServer.h"
+
+// how often the thread checks whether to stop
+#define POLL_TIMEOUT 500
+
+#define MAX_REQUEST_LENGTH 4096
+#define REQUEST_TIMEOUT 2000  // whole request
+
+// a restarted server has to wait for the old process to release the port
+#define LISTEN_RETRY_INTERVAL 1000
+
+MetricsServer::MetricsServer(const Logger& logger, const FrameStats& frameStats)
+: m_logger(logger), m_frameStats(frameStats), m_port(0), m_isStopRequested(0), m_startTime(OS::GetPerformanceCounter())
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+	this->Stop();
+}
+
+bool MetricsServer::Start(const char* address, unsigned short port)
+{
+	m_address = address;
+	m_port = port;
+
+	if (!m_listener.Listen(address, port) && !OS::TCPSocket::IsAddressInUseError(OS::GetCurrentErrorCode()))
+	{
+		return false;
+	}
+
+	m_isStopRequested = 0;
+
+	return m_thread.Start(&MetricsServer::ThreadEntry, this);
+}
+
+void MetricsServer::Stop()
+{
+	if (m_thread.IsStarted())
+	{
+		OS::Atomic::Exchange(&m_isStopRequested, 1);
+		m_thread.Join();
+	}
+
+	m_listener.Close();
+}
+
+std::size_t MetricsServer::GetMemoryUsage() const
+{
+	return m_address.capacity() + m_request.capacity() + m_response.capacity() + m_body.capacity();
+}
+
+void MetricsServer::Run()
+{
+	OS::TCPSocket client;
+
+	while (!m_isStopRequested)
+	{
+		if (!m_listener.IsOpen())
+		{
+			if (!m_listener.Listen(m_address.c_str(), m_port))
+			{
+				OS::Sleep(LISTEN_RETRY_INTERVAL);
+			}
+
+			continue;
+		}
+
+		if (m_listener.Accept(client, POLL_TIMEOUT))
+		{
+			this->HandleClient(client);
+			client.Close();
+		}
+	}
+}
+
+bool MetricsServer::ReceiveRequest(OS::TCPSocket& client)
+{
+	m_request.clear();
+
+	// the whole request must arrive in time, so a slow client cannot keep the only thread busy
+	const unsigned long startTime = OS::GetTickCount();
+
+	// only the request line matters, but the rest of the header must be received before closing the connection
+	while (m_request.find("\r\n\r\n") == std::string::npos)
+	{
+		const unsigned long elapsedTime = OS::GetTickCount() - startTime;
+
+		if (m_isStopRequested || elapsedTime >= REQUEST_TIMEOUT)
+		{
+			return false;
+		}
+
+		char buffer[1024];
+		const std::size_t length = client.Receive(buffer, sizeof buffer, REQUEST_TIMEOUT - elapsedTime);
+
+		if (length == 0 || (m_request.length() + length) > MAX_REQUEST_LENGTH)
+		{
+			return false;
+		}
+
+		m_request.append(buffer, length);
+	}
+
+	return true;
+}
+
+void MetricsServer::HandleClient(OS::TCPSocket& client)
+{
+	if (!this->ReceiveRequest(client))
+	{
+		return;
+	}
+
+	const char* request = m_request.c_str();
+
+	m_response.clear();
+	m_body.clear();
+
+	if (strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET / ", 6) == 0)
+	{
+		this->BuildMetrics(m_body);
+
+		m_response += "HTTP/1.0 200 OK\r\n";
+		m_response += "Content-Type: text/plain; version=0.0.4\r\n";
+	}
+	else
+	{
+		m_body += "Not Found\n";
+
+		m_response += "HTTP/1.0 404 Not Found\r\n";
+		m_response += "Content-Type: text/plain\r\n";
+	}
+
+	StringTools::FormatTo(m_response, "Content-Length: %u\r\n", static_cast<unsigned int>(m_body.length()));
+	m_response += "Connection: close\r\n";
+	m_response += "\r\n";
+	m_response += m_body;
+
+	client.Send(m_response.data(), m_response.length());
+}
+
+static void AddMetric(std::string& result, const char* name, const char* type, const char* help, double value)
+{
+	StringTools::FormatTo(result, "# HELP %s %s\n", name, help);
+	StringTools::FormatTo(result, "# TYPE %s %s\n", name, type);
+	StringTools::FormatTo(result, "%s %.17g\n", name, value);
+}
+
+void MetricsServer::BuildMetrics(std::string& result)
+{
+	const double uptime = static_cast<double>(OS::GetPerformanceCounter() - m_startTime)
+	                    / static_cast<double>(OS::GetPerformanceFrequency());
+
+	AddMetric(result, "crysis_uptime_seconds", "gauge", "Time since the launcher started.", uptime);
+
+	FrameStats::Metrics frames;
+	m_frameStats.GetMetrics(frames);
+
+	result += "# HELP crysis_frame_time_seconds Time between two consecutive server frames.\n";
+	result += "# TYPE crysis_frame_time_seconds histogram\n";
+
+	unsigned long cumulativeCount = 0;
+
+	for (unsigned int i = 0; i < FrameStats::METRICS_BUCKET_COUNT; i++)
+	{
+		const unsigned long bound = FrameStats::GetMetricsBucketBound(i);
+
+		cumulativeCount += frames.bucketCounts[i];
+
+		if (bound)
+		{
+			StringTools::FormatTo(result, "crysis_frame_time_seconds_bucket{le=\"%g\"} %lu\n", bound / 1e6,
+				cumulativeCount
+			);
+		}
+		else
+		{
+			StringTools::FormatTo(result, "crysis_frame_time_seconds_bucket{le=\"+Inf\"} %lu\n", cumulativeCount);
+		}
+	}
+
+	StringTools::FormatTo(result, "crysis_frame_time_seconds_sum %.6f\n", static_cast<double>(frames.totalTime) / 1e6);
+	StringTools::FormatTo(result, "crysis_frame_time_seconds_count %lu\n", frames.frameCount);
+
+	AddMetric(result, "crysis_frames_over_budget_total", "counter", "Frames longer than server_FrameBudget.",
+		frames.overBudgetCount
+	);
+
+	const Logger::Counters log = m_logger.GetCounters();
+
+	AddMetric(result, "crysis_log_messages_total", "counter", "Log messages.", log.messageCount);
+	AddMetric(result, "crysis_log_file_writes_total", "counter", "Writes to the log file.", log.fileWriteCount);
+	AddMetric(result, "crysis_log_rotations_total", "counter", "Log file rotations.", log.rotationCount);
+	AddMetric(result, "crysis_log_suppressed_total", "counter", "Suppressed duplicate log messages.",
+		log.suppressedCount
+	);
+	AddMetric(result, "crysis_log_rate_limited_total", "counter", "Log messages dropped by the rate limit.",
+		log.rateLimitedCount
+	);
+	AddMetric(result, "crysis_log_writer_dropped_total", "counter", "Log messages dropped by the writer queue.",
+		log.writerDroppedCount
+	);
+	AddMetric(result, "crysis_log_callback_dropped_total", "counter", "Log callbacks dropped by the callback queue.",
+		log.callbackDroppedCount
+	);
+
+	OS::MemoryUsage memory;
+	if (OS::GetMemoryUsage(memory))
+	{
+		AddMetric(result, "crysis_process_working_set_bytes", "gauge", "Working set of the process.",
+			static_cast<double>(memory.workingSet)
+		);
+		AddMetric(result, "crysis_process_peak_working_set_bytes", "gauge", "Peak working set of the process.",
+			static_cast<double>(memory.peakWorkingSet)
+		);
+		AddMetric(result, "crysis_process_private_bytes", "gauge", "Private memory of the process.",
+			static_cast<double>(memory.privateBytes)
+		);
+		AddMetric(result, "crysis_process_virtual_memory_available_bytes", "gauge",
+			"Unused address space of the process.", static_cast<double>(memory.availableVirtual)
+		);
+		AddMetric(result, "crysis_system_physical_memory_available_bytes", "gauge",
+			"Available physical memory of the system.", static_cast<double>(memory.availablePhysical)
+		);
+	}
+}
+
+void MetricsServer::ThreadEntry(void* param)
+{
+	static_cast<MetricsServer*>(param)->Run();
+}
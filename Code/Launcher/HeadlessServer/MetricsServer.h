@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+
+#include "Library/OS.h"
+#include "Library/TCPSocket.h"
+
+class FrameStats;
+class Logger;
+
+/**
+ * Serves server metrics in the Prometheus text format over HTTP.
+ *
+ * Everything is done by a background thread. The metrics are gathered from counters that are safe to read from any
+ * thread, so the game thread is not involved at all.
+ */
+class MetricsServer
+{
+	const Logger& m_logger;
+	const FrameStats& m_frameStats;
+
+	std::string m_address;
+	unsigned short m_port;
+
+	OS::TCPSocket m_listener;
+	OS::Thread m_thread;
+	volatile long m_isStopRequested;
+
+	unsigned __int64 m_startTime;  // OS::GetPerformanceCounter
+
+	// used only by the thread
+	std::string m_request;
+	std::string m_response;
+	std::string m_body;
+
+	// no copies
+	MetricsServer(const MetricsServer&);
+	MetricsServer& operator=(const MetricsServer&);
+
+	void Run();
+	bool ReceiveRequest(OS::TCPSocket& client);
+	void HandleClient(OS::TCPSocket& client);
+	void BuildMetrics(std::string& result);
+
+	static void ThreadEntry(void* param);
+
+public:
+	MetricsServer(const Logger& logger, const FrameStats& frameStats);
+	~MetricsServer();
+
+	// returns false if the port cannot be used
+	bool Start(const char* address, unsigned short port);
+	void Stop();
+
+	// approximate, the buffers are owned by the thread
+	std::size_t GetMemoryUsage() const;
+};
@@ -0,0 +1,491 @@
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>  // std::atoi
+
+#include "Library/PathTools.h"
+#include "Library/StringTools.h"
+#include "Library/StringView.h"
+#include "Project.h"
+
+#include "../LauncherCommon.h"
+
+#include "Supervisor.h"
+
+#define DEFAULT_SUPERVISOR_STAGGER 10
+#define DEFAULT_SUPERVISOR_BACKOFF 5
+#define DEFAULT_SUPERVISOR_MAX_BACKOFF 300
+#define DEFAULT_SUPERVISOR_STABLE_TIME 300
+#define MAX_SUPERVISOR_TIME 86400
+#define MAX_SUPERVISOR_WATCHDOG_TIMEOUT 3600
+// same limits as the -lockworkingset command line parameter, the 32-bit address space cannot hold more
+#ifdef BUILD_64BIT
+#define MAX_SUPERVISOR_LOCKED_WORKING_SET_SIZE 65536
+#else
+#define MAX_SUPERVISOR_LOCKED_WORKING_SET_SIZE 1536
+#endif
+#define SUPERVISOR_POLL_INTERVAL 100
+
+// milliseconds to seconds
+#define SUPERVISOR_SECONDS(ticks) ((ticks) / 1000)
+
+static void Print(const char* format, ...)
+{
+	const OS::DateTime time = OS::GetCurrentDateTimeLocal();
+
+	std::string line = StringTools::Format("<%02u:%02u:%02u> Supervisor: ", time.hour, time.minute, time.second);
+
+	va_list args;
+	va_start(args, format);
+	StringTools::FormatToV(line, format, args);
+	va_end(args);
+
+	line += '\n';
+
+	// single write, the console is shared with all instances
+	std::fwrite(line.c_str(), 1, line.length(), stderr);
+	std::fflush(stderr);
+}
+
+static unsigned int ParseNumber(const std::string& value, const char* name, unsigned int maxValue)
+{
+	const int number = std::atoi(value.c_str());
+
+	if (value.empty() || number < 0 || static_cast<unsigned int>(number) > maxValue)
+	{
+		throw StringTools::Error("Invalid supervisor setting %s \"%s\"!\nUse 0 to %u.", name, value.c_str(), maxValue);
+	}
+
+	return static_cast<unsigned int>(number);
+}
+
+static void AppendQuotedArg(std::string& cmdLine, const char* name, const std::string& value)
+{
+	cmdLine += ' ';
+	cmdLine += name;
+	cmdLine += " \"";
+	cmdLine += value;
+	cmdLine += '"';
+}
+
+static double ToMiB(unsigned __int64 bytes)
+{
+	return static_cast<double>(bytes) / (1024 * 1024);
+}
+
+Supervisor::Supervisor()
+: m_stagger(DEFAULT_SUPERVISOR_STAGGER),
+  m_backoff(DEFAULT_SUPERVISOR_BACKOFF),
+  m_maxBackoff(DEFAULT_SUPERVISOR_MAX_BACKOFF),
+  m_stableTime(DEFAULT_SUPERVISOR_STABLE_TIME),
+  m_watchdog(0),
+  m_lockedWorkingSetSize(0),
+  m_isPakResident(false),
+  m_isNoJobReported(false)
+{
+}
+
+Supervisor::~Supervisor()
+{
+	// terminates the remaining instances
+	for (std::size_t i = 0; i < m_instances.size(); i++)
+	{
+		delete m_instances[i];
+	}
+
+	m_warmer.Stop();
+}
+
+int Supervisor::Run(const char* configPath)
+{
+	Print("%s", PROJECT_BANNER);
+
+	this->LoadConfig(configPath);
+	this->PrepareInstances();
+
+	Print("Config: \"%s\" with %u instances, stagger %u s, backoff %u-%u s", configPath,
+		static_cast<unsigned int>(m_instances.size()), m_stagger, m_backoff, m_maxBackoff);
+
+	if (m_lockedWorkingSetSize > 0)
+	{
+		if (LauncherCommon::LockWorkingSet(m_lockedWorkingSetSize))
+		{
+			Print("Locked working set: %u MiB", m_lockedWorkingSetSize);
+		}
+		else
+		{
+			Print("Failed to lock working set of %u MiB!", m_lockedWorkingSetSize);
+		}
+	}
+
+	this->StartWarmUp();
+
+	bool hasStarted = false;
+	unsigned long lastStartTime = 0;
+
+	// runs until the supervisor is terminated, which terminates all instances as well
+	for (;;)
+	{
+		const unsigned long now = OS::GetTickCount();
+
+		for (std::size_t i = 0; i < m_instances.size(); i++)
+		{
+			Instance& instance = *m_instances[i];
+
+			if (instance.process.IsStarted() && !instance.process.IsRunning())
+			{
+				this->OnInstanceExit(instance, now);
+			}
+		}
+
+		if (!hasStarted || (now - lastStartTime) >= (m_stagger * 1000))
+		{
+			if (this->StartNextInstance(now))
+			{
+				hasStarted = true;
+				lastStartTime = now;
+			}
+		}
+
+		OS::Sleep(SUPERVISOR_POLL_INTERVAL);
+	}
+}
+
+void Supervisor::LoadConfig(const char* path)
+{
+	const std::string content = LauncherCommon::ReadConfigFile(path, "supervisor config file");
+
+	StringView rest = content;
+	std::string name;
+	std::string value;
+	Instance* pInstance = NULL;
+
+	while (rest.IsNotEmpty())
+	{
+		std::size_t lineLength = 0;
+
+		if (!rest.Find('\n', lineLength))
+		{
+			lineLength = rest.length;
+		}
+
+		const StringView line(rest.string, lineLength);
+
+		rest.RemovePrefix((lineLength < rest.length) ? lineLength + 1 : lineLength);
+
+		if (!LauncherCommon::ParseConfigLine(line, name, value))
+		{
+			continue;
+		}
+
+		if (name == "[instance]")
+		{
+			pInstance = new Instance;
+			m_instances.push_back(pInstance);
+		}
+		else if (pInstance)
+		{
+			this->SetInstanceValue(*pInstance, name, value);
+		}
+		else
+		{
+			this->SetGlobalValue(name, value);
+		}
+	}
+
+	if (m_instances.empty())
+	{
+		throw StringTools::Error("No [instance] in supervisor config file \"%s\"!", path);
+	}
+}
+
+void Supervisor::SetGlobalValue(const std::string& name, const std::string& value)
+{
+	if (name == "stagger")
+	{
+		m_stagger = ParseNumber(value, "stagger", MAX_SUPERVISOR_TIME);
+	}
+	else if (name == "backoff")
+	{
+		m_backoff = ParseNumber(value, "backoff", MAX_SUPERVISOR_TIME);
+	}
+	else if (name == "maxbackoff")
+	{
+		m_maxBackoff = ParseNumber(value, "maxbackoff", MAX_SUPERVISOR_TIME);
+	}
+	else if (name == "stable")
+	{
+		m_stableTime = ParseNumber(value, "stable", MAX_SUPERVISOR_TIME);
+	}
+	else if (name == "watchdog")
+	{
+		m_watchdog = ParseNumber(value, "watchdog", MAX_SUPERVISOR_WATCHDOG_TIMEOUT);
+	}
+	else if (name == "lockworkingset")
+	{
+		m_lockedWorkingSetSize = ParseNumber(value, "lockworkingset", MAX_SUPERVISOR_LOCKED_WORKING_SET_SIZE);
+	}
+	else if (name == "args")
+	{
+		m_args = value;
+	}
+	else if (name == "pakwarm")
+	{
+		m_pakWarm = value;
+	}
+	else if (name == "pakresident")
+	{
+		m_isPakResident = true;
+	}
+	else
+	{
+		throw StringTools::Error("Unknown supervisor setting \"%s\"!", name.c_str());
+	}
+}
+
+void Supervisor::SetInstanceValue(Instance& instance, const std::string& name, const std::string& value)
+{
+	if (name == "name")
+	{
+		instance.name = value;
+	}
+	else if (name == "root")
+	{
+		instance.root = value;
+	}
+	else if (name == "logfile")
+	{
+		instance.logFile = value;
+	}
+	else if (name == "affinity")
+	{
+		instance.affinity = value;
+	}
+	else if (name == "cpuset")
+	{
+		instance.cpuset = value;
+	}
+	else if (name == "watchdog")
+	{
+		instance.watchdog = ParseNumber(value, "watchdog", MAX_SUPERVISOR_WATCHDOG_TIMEOUT);
+	}
+	else if (name == "args")
+	{
+		instance.args = value;
+	}
+	else
+	{
+		throw StringTools::Error("Unknown supervisor instance setting \"%s\"!", name.c_str());
+	}
+}
+
+void Supervisor::PrepareInstances()
+{
+	char buffer[512];
+	const StringView exePath(buffer, OS::Module::GetEXEPath(buffer, sizeof buffer));
+
+	if (exePath.IsEmpty() || exePath.length >= sizeof buffer)
+	{
+		throw StringTools::OSError("Failed to get the executable path!");
+	}
+
+	m_exePath = exePath.ToStdString();
+
+	for (std::size_t i = 0; i < m_instances.size(); i++)
+	{
+		Instance& instance = *m_instances[i];
+
+		if (instance.name.empty())
+		{
+			instance.name = StringTools::Format("%u", static_cast<unsigned int>(i + 1));
+		}
+
+		// instances writing the same log file would break each other
+		for (std::size_t j = 0; j < i; j++)
+		{
+			const Instance& other = *m_instances[j];
+
+			if (other.root == instance.root && other.logFile == instance.logFile)
+			{
+				throw StringTools::Error("Supervised instances \"%s\" and \"%s\" share the same log file!\n"
+					"Use different root or logfile.", other.name.c_str(), instance.name.c_str());
+			}
+		}
+
+		std::string& cmdLine = instance.cmdLine;
+
+		cmdLine += '"';
+		cmdLine += m_exePath;
+		cmdLine += '"';
+
+		if (!instance.root.empty())
+		{
+			AppendQuotedArg(cmdLine, "-root", instance.root);
+		}
+
+		if (!instance.logFile.empty())
+		{
+			AppendQuotedArg(cmdLine, "-logfile", instance.logFile);
+		}
+
+		if (!instance.affinity.empty())
+		{
+			AppendQuotedArg(cmdLine, "-affinity", instance.affinity);
+		}
+
+		if (!instance.cpuset.empty())
+		{
+			AppendQuotedArg(cmdLine, "-cpuset", instance.cpuset);
+		}
+
+		const unsigned int watchdog = (instance.watchdog < 0)
+		                            ? m_watchdog
+		                            : static_cast<unsigned int>(instance.watchdog);
+
+		// a hung instance exits and gets restarted
+		if (watchdog > 0)
+		{
+			StringTools::FormatTo(cmdLine, " -watchdog %u -watchdogexit", watchdog);
+		}
+
+		if (!m_args.empty())
+		{
+			cmdLine += ' ';
+			cmdLine += m_args;
+		}
+
+		if (!instance.args.empty())
+		{
+			cmdLine += ' ';
+			cmdLine += instance.args;
+		}
+	}
+}
+
+void Supervisor::StartWarmUp()
+{
+	std::vector<std::string> paths;
+	std::vector<std::string> unmatched;
+
+	// all DLLs next to the executable, which are the engine and the game
+	LauncherCommon::ExpandPathList("*.dll", PathTools::DirName(m_exePath).ToStdString(), paths, unmatched);
+
+	if (!m_pakWarm.empty())
+	{
+		LauncherCommon::ExpandPathList(m_pakWarm.c_str(), LauncherCommon::GetMainFolderPath(), paths, unmatched);
+	}
+
+	for (std::size_t i = 0; i < unmatched.size(); i++)
+	{
+		Print("Warm-up: no file matches %s", unmatched[i].c_str());
+	}
+
+	for (std::size_t i = 0; i < paths.size(); i++)
+	{
+		m_warmer.Add(paths[i]);
+	}
+
+	if (m_warmer.Start(false, m_isPakResident, &Supervisor::OnWarmUpDone))
+	{
+		Print("Warm-up: started with %u files%s", static_cast<unsigned int>(paths.size()),
+			(m_isPakResident) ? ", resident" : "");
+	}
+}
+
+void Supervisor::OnWarmUpDone(const FileWarmer::Stats& stats)
+{
+	Print("Warm-up: %u files (%.1f MiB) in %.1f ms", stats.fileCount, ToMiB(stats.warmedBytes), stats.duration);
+
+	if (stats.residentBytes > 0)
+	{
+		Print("Warm-up: %.1f MiB kept resident", ToMiB(stats.residentBytes));
+	}
+
+	if (stats.unlockedBytes > 0)
+	{
+		Print("Warm-up: %.1f MiB cannot stay resident, use larger lockworkingset", ToMiB(stats.unlockedBytes));
+	}
+
+	if (stats.failedCount > 0)
+	{
+		Print("Warm-up: %u files failed", stats.failedCount);
+	}
+}
+
+bool Supervisor::StartNextInstance(unsigned long now)
+{
+	for (std::size_t i = 0; i < m_instances.size(); i++)
+	{
+		Instance& instance = *m_instances[i];
+
+		if (instance.process.IsStarted())
+		{
+			continue;
+		}
+
+		if (instance.startCount > 0 && (now - instance.exitTime) < (instance.backoff * 1000))
+		{
+			continue;
+		}
+
+		instance.startCount++;
+		instance.startTime = now;
+
+		if (!instance.process.Start(instance.cmdLine.c_str()))
+		{
+			Print("Instance %s: failed to start (error %lu)", instance.name.c_str(), OS::GetCurrentErrorCode());
+
+			this->OnInstanceExit(instance, now);
+			continue;
+		}
+
+		Print("Instance %s: started as process %lu (start %u)", instance.name.c_str(), instance.process.GetID(),
+			instance.startCount);
+
+		if (!instance.process.IsInJob() && !m_isNoJobReported)
+		{
+			Print("Instances run outside of a job, processes they start are not terminated with them!");
+			m_isNoJobReported = true;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void Supervisor::OnInstanceExit(Instance& instance, unsigned long now)
+{
+	const unsigned int uptime = SUPERVISOR_SECONDS(now - instance.startTime);
+
+	unsigned long exitCode = 0;
+
+	if (instance.process.GetExitCode(exitCode))
+	{
+		Print("Instance %s: exited with code %lu (0x%lX) after %u s", instance.name.c_str(), exitCode, exitCode,
+			uptime);
+	}
+	else if (instance.process.IsStarted())
+	{
+		Print("Instance %s: exited after %u s", instance.name.c_str(), uptime);
+	}
+
+	instance.process.Close();
+	instance.exitTime = now;
+
+	// quick failures are retried less and less often
+	if (instance.startCount > 1 && uptime < m_stableTime)
+	{
+		instance.backoff = (instance.backoff > 0) ? instance.backoff * 2 : m_backoff;
+
+		if (instance.backoff > m_maxBackoff)
+		{
+			instance.backoff = m_maxBackoff;
+		}
+	}
+	else
+	{
+		instance.backoff = m_backoff;
+	}
+
+	Print("Instance %s: restart in %u s", instance.name.c_str(), instance.backoff);
+}
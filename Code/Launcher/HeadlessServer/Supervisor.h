@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Library/FileWarmer.h"
+#include "Library/OS.h"
+
+/**
+ * Runs several server instances as child processes of the headless server executable, see -supervise.
+ *
+ * Each instance has its own root folder, log file and processor affinity. An instance that exits for any reason is
+ * started again after a delay that doubles with each quick failure. Hung instances are detected by their own watchdog,
+ * which makes them exit. Only one instance is started per stagger interval, so they do not compete for the disk.
+ *
+ * The engine DLLs and the game paks are warmed up once by the supervisor, which keeps them in memory for all instances
+ * and their restarts. All instances are terminated together with the supervisor.
+ */
+class Supervisor
+{
+	struct Instance
+	{
+		std::string name;
+		std::string root;
+		std::string logFile;
+		std::string affinity;
+		std::string cpuset;
+		std::string args;
+		int watchdog;  // seconds, negative to use the global value
+
+		std::string cmdLine;
+		OS::ChildProcess process;
+		unsigned long startTime;  // tick count
+		unsigned long exitTime;  // tick count
+		unsigned int backoff;  // seconds to wait after the exit
+		unsigned int startCount;
+
+		Instance() : watchdog(-1), startTime(0), exitTime(0), backoff(0), startCount(0)
+		{
+		}
+	};
+
+	std::vector<Instance*> m_instances;
+	std::string m_exePath;
+	std::string m_args;
+	std::string m_pakWarm;
+	unsigned int m_stagger;
+	unsigned int m_backoff;
+	unsigned int m_maxBackoff;
+	unsigned int m_stableTime;
+	unsigned int m_watchdog;
+	unsigned int m_lockedWorkingSetSize;
+	bool m_isPakResident;
+	bool m_isNoJobReported;
+	FileWarmer m_warmer;
+
+	// no copies
+	Supervisor(const Supervisor&);
+	Supervisor& operator=(const Supervisor&);
+
+	void LoadConfig(const char* path);
+	void SetGlobalValue(const std::string& name, const std::string& value);
+	void SetInstanceValue(Instance& instance, const std::string& name, const std::string& value);
+	void PrepareInstances();
+
+	void StartWarmUp();
+	static void OnWarmUpDone(const FileWarmer::Stats& stats);
+
+	bool StartNextInstance(unsigned long now);
+	void OnInstanceExit(Instance& instance, unsigned long now);
+
+public:
+	Supervisor();
+	~Supervisor();
+
+	int Run(const char* configPath);
+};
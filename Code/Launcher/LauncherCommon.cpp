@@ -1,15 +1,31 @@
+#include <cstdlib>  // std::atoi, std::strtoul
 #include <cstring>
 
 #include "CryCommon/CryGame/IGameStartup.h"
 #include "CryCommon/CrySystem/ISystem.h"
 
+#include "Library/FileWarmer.h"
+#include "Library/FramePacer.h"
+#include "Library/HotPathTimer.h"
 #include "Library/OS.h"
 #include "Library/PathTools.h"
+#include "Library/PoolAllocator.h"
+#include "Library/Prefetcher.h"
+#include "Library/StartupTimer.h"
 #include "Library/StringTools.h"
 #include "Library/StringView.h"
 #include "Project.h"
 
 #include "LauncherCommon.h"
+#include "MemoryPatch.h"
+
+#define DEFAULT_LOCKED_WORKING_SET_SIZE "512"
+
+#ifdef BUILD_64BIT
+#define MAX_LOCKED_WORKING_SET_SIZE 65536
+#else
+#define MAX_LOCKED_WORKING_SET_SIZE 1536
+#endif
 
 std::string LauncherCommon::GetMainFolderPath()
 {
@@ -42,6 +58,136 @@ std::string LauncherCommon::GetRootFolderPath()
 	return rootArg ? std::string(rootArg) : GetMainFolderPath();
 }
 
+#define LAUNCHER_CONFIG_FILE_NAME "launcher.cfg"
+#define MAX_LAUNCHER_CONFIG_FILE_SIZE (1024 * 1024)
+
+static bool IsSpace(char ch)
+{
+	return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+static StringView TrimSpaces(StringView text)
+{
+	while (text.IsNotEmpty() && IsSpace(text.Front()))
+	{
+		text.PopFront();
+	}
+
+	while (text.IsNotEmpty() && IsSpace(text.Back()))
+	{
+		text.PopBack();
+	}
+
+	return text;
+}
+
+bool LauncherCommon::ParseConfigLine(StringView line, std::string& name, std::string& value)
+{
+	line = TrimSpaces(line);
+
+	if (line.IsEmpty() || line.Front() == '#')
+	{
+		return false;
+	}
+
+	std::size_t nameLength = 0;
+
+	while (nameLength < line.length && !IsSpace(line[nameLength]))
+	{
+		nameLength++;
+	}
+
+	name.assign(line.string, nameLength);
+	line.RemovePrefix(nameLength);
+
+	StringView valueView = TrimSpaces(line);
+
+	// allows leading and trailing spaces in the value
+	if (valueView.length >= 2 && valueView.Front() == '"' && valueView.Back() == '"')
+	{
+		valueView.PopFront();
+		valueView.PopBack();
+	}
+
+	value.assign(valueView.string, valueView.length);
+
+	return true;
+}
+
+std::string LauncherCommon::ReadConfigFile(const char* path, const char* kind)
+{
+	OS::File file;
+	if (!file.Open(path, OS::File::READ_ONLY))
+	{
+		throw StringTools::OSError("Failed to open %s \"%s\"!", kind, path);
+	}
+
+	unsigned __int64 fileSize = 0;
+	if (!file.Seek(OS::File::END, 0, &fileSize) || !file.Seek(OS::File::BEGIN))
+	{
+		throw StringTools::OSError("Failed to read %s \"%s\"!", kind, path);
+	}
+
+	if (fileSize > MAX_LAUNCHER_CONFIG_FILE_SIZE)
+	{
+		throw StringTools::Error("The %s \"%s\" is too large!", kind, path);
+	}
+
+	std::string content(static_cast<std::size_t>(fileSize), '\0');
+
+	bool isError = false;
+	if (!content.empty() && (file.Read(&content[0], content.size(), &isError) != content.size() || isError))
+	{
+		throw StringTools::OSError("Failed to read %s \"%s\"!", kind, path);
+	}
+
+	return content;
+}
+
+std::string LauncherCommon::LoadConfigFile()
+{
+	const char* pathArg = OS::CmdLine::GetArgValue("-launchercfg", NULL);
+
+	const std::string path = (pathArg) ? pathArg : PathTools::Join(GetRootFolderPath(), LAUNCHER_CONFIG_FILE_NAME);
+
+	// the default config file is optional
+	if (!pathArg && !OS::File::Exists(path.c_str()))
+	{
+		return std::string();
+	}
+
+	const std::string content = ReadConfigFile(path.c_str(), "launcher config file");
+
+	StringView rest = content;
+	std::string name;
+	std::string value;
+
+	while (rest.IsNotEmpty())
+	{
+		std::size_t lineLength = 0;
+
+		if (!rest.Find('\n', lineLength))
+		{
+			lineLength = rest.length;
+		}
+
+		if (ParseConfigLine(StringView(rest.string, lineLength), name, value))
+		{
+			// the dash is optional
+			if (name[0] != '-')
+			{
+				name.insert(0, 1, '-');
+			}
+
+			OS::CmdLine::AddArg(name.c_str(), (value.empty()) ? NULL : value.c_str());
+		}
+
+		rest.RemovePrefix((lineLength < rest.length) ? lineLength + 1 : lineLength);
+	}
+
+	return path;
+}
+
 std::string LauncherCommon::GetUserFolderPath()
 {
 	char buffer[512];
@@ -58,8 +204,76 @@ std::string LauncherCommon::GetUserFolderPath()
 	return PathTools::Join(documentsPath, userFolder);
 }
 
+static Prefetcher g_prefetcher;
+
+static void AddPakToPrefetch(const char* fileName, void* param)
+{
+	const std::string& folder = *static_cast<const std::string*>(param);
+
+	g_prefetcher.AddFile(PathTools::Join(folder, fileName));
+}
+
+void LauncherCommon::StartPrefetch(const char* rendererName)
+{
+	if (OS::CmdLine::HasArg("-noprefetch"))
+	{
+		return;
+	}
+
+	char buffer[512];
+	const StringView exePath(buffer, OS::Module::GetEXEPath(buffer, sizeof buffer));
+
+	if (exePath.IsEmpty() || exePath.length >= sizeof buffer)
+	{
+		return;
+	}
+
+	const StringView binFolder = PathTools::DirName(exePath);
+
+	// DLLs loaded by the launcher go first, then those loaded by the engine
+	const char* modules[] = {
+		"CryGame.dll",
+		"CryAction.dll",
+		"CryNetwork.dll",
+		rendererName,
+		"CryPhysics.dll",
+		"CryScriptSystem.dll",
+		"CryFont.dll",
+		"CryInput.dll",
+		"CrySoundSystem.dll",
+		"CryEntitySystem.dll",
+		"Cry3DEngine.dll",
+		"CryAnimation.dll",
+		"CryAISystem.dll",
+		"CryMovie.dll",
+	};
+
+	for (std::size_t i = 0; i < (sizeof modules / sizeof modules[0]); i++)
+	{
+		if (modules[i])
+		{
+			g_prefetcher.AddModule(PathTools::Join(binFolder, modules[i]));
+		}
+	}
+
+	if (OS::CmdLine::HasArg("-prefetchpaks"))
+	{
+		std::string gameFolder = PathTools::Join(GetMainFolderPath(), "Game");
+		const std::string pattern = PathTools::Join(gameFolder, "*.pak");
+
+		OS::Directory::ForEachFile(pattern.c_str(), &AddPakToPrefetch, &gameFolder);
+	}
+
+	g_prefetcher.Start();
+}
+
 void* LauncherCommon::LoadModule(const char* name)
 {
+	StartupTimer::Scope step(name);
+
+	// loading a module while it is being prefetched might relocate it
+	g_prefetcher.WaitForModule(name);
+
 	void* mod = OS::Module::Load(name);
 	if (!mod)
 	{
@@ -120,6 +334,176 @@ void LauncherCommon::VerifyGameBuild(int gameBuild)
 	}
 }
 
+// blocks allocated before the hook was installed come from the VS2005 runtime used by all Crysis DLLs
+static void (__cdecl *g_pCrtFree)(void* block);
+static std::size_t (__cdecl *g_pCrtMSize)(void* block);
+
+static void* PoolMalloc(std::size_t size, std::size_t& allocated)
+{
+	void* result = PoolAllocator::Allocate(size);
+	allocated = (result) ? PoolAllocator::GetSize(result) : 0;
+
+	return result;
+}
+
+static void* PoolRealloc(void* block, std::size_t size, std::size_t& allocated)
+{
+	if (block && !PoolAllocator::IsOwned(block))
+	{
+		void* result = NULL;
+
+		if (size > 0)
+		{
+			result = PoolAllocator::Allocate(size);
+
+			if (!result)
+			{
+				// the old block stays valid
+				allocated = 0;
+				return NULL;
+			}
+
+			const std::size_t oldSize = g_pCrtMSize(block);
+			std::memcpy(result, block, (size < oldSize) ? size : oldSize);
+		}
+
+		g_pCrtFree(block);
+
+		allocated = (result) ? PoolAllocator::GetSize(result) : 0;
+
+		return result;
+	}
+
+	void* result = PoolAllocator::Reallocate(block, size);
+	allocated = (result) ? PoolAllocator::GetSize(result) : 0;
+
+	return result;
+}
+
+static std::size_t PoolFree(void* block)
+{
+	if (!block)
+	{
+		return 0;
+	}
+
+	if (!PoolAllocator::IsOwned(block))
+	{
+		const std::size_t size = g_pCrtMSize(block);
+		g_pCrtFree(block);
+
+		return size;
+	}
+
+	const std::size_t size = PoolAllocator::GetSize(block);
+	PoolAllocator::Free(block);
+
+	return size;
+}
+
+static std::size_t PoolGetMemSize(void* block, std::size_t size)
+{
+	if (!block)
+	{
+		return 0;
+	}
+
+	return (PoolAllocator::IsOwned(block)) ? PoolAllocator::GetSize(block) : g_pCrtMSize(block);
+}
+
+void LauncherCommon::EnablePoolAllocator(void* pCrySystem)
+{
+	StartupTimer::Scope step("EnablePoolAllocator");
+
+	void* pCRT = OS::Module::Get("msvcr80.dll");
+
+	if (!pCRT)
+	{
+		throw StringTools::Error("Pool allocator requires msvcr80.dll!");
+	}
+
+	g_pCrtFree = reinterpret_cast<void (__cdecl*)(void*)>(OS::Module::FindSymbol(pCRT, "free"));
+	g_pCrtMSize = reinterpret_cast<std::size_t (__cdecl*)(void*)>(OS::Module::FindSymbol(pCRT, "_msize"));
+
+	if (!g_pCrtFree || !g_pCrtMSize)
+	{
+		throw StringTools::Error("Pool allocator failed to find memory functions in msvcr80.dll!");
+	}
+
+	if (!PoolAllocator::Init())
+	{
+		throw StringTools::Error("Failed to initialize pool allocator!");
+	}
+
+	MemoryPatch::CrySystem::MemoryManager hooks;
+	hooks.pMalloc = &PoolMalloc;
+	hooks.pRealloc = &PoolRealloc;
+	hooks.pFree = &PoolFree;
+	hooks.pGetMemSize = &PoolGetMemSize;
+
+	MemoryPatch::Batch patch(pCrySystem, "CrySystem");
+	MemoryPatch::CrySystem::HookMemoryManager(patch, hooks);
+	patch.Apply();
+}
+
+const char* LauncherCommon::EnableLargePages()
+{
+	const std::size_t largePageSize = OS::GetLargePageSize();
+
+	if (!largePageSize)
+	{
+		return "not supported by the OS";
+	}
+
+	if (!OS::EnableLockMemoryPrivilege())
+	{
+		return "the \"Lock pages in memory\" user right is missing";
+	}
+
+	if (!PoolAllocator::EnableLargePages(largePageSize))
+	{
+		return "not enough contiguous physical memory";
+	}
+
+	return NULL;
+}
+
+unsigned int LauncherCommon::GetLockedWorkingSetSize()
+{
+	if (!OS::CmdLine::HasArg("-lockworkingset"))
+	{
+		return 0;
+	}
+
+	const char* value = OS::CmdLine::GetArgValue("-lockworkingset", DEFAULT_LOCKED_WORKING_SET_SIZE);
+
+	const int size = std::atoi(value);
+
+	if (size <= 0 || size > MAX_LOCKED_WORKING_SET_SIZE)
+	{
+		throw StringTools::Error("Invalid working set size \"%s\"!\nUse 1 to %d MiB.", value,
+			MAX_LOCKED_WORKING_SET_SIZE);
+	}
+
+	return size;
+}
+
+bool LauncherCommon::LockWorkingSet(unsigned int sizeMiB)
+{
+	const unsigned __int64 minSize = static_cast<unsigned __int64>(sizeMiB) * 1024 * 1024;
+
+	// the engine keeps growing after startup, so leave it some room above the minimum
+	const unsigned __int64 maxSize = minSize * 2;
+
+	// would wrap around in 32-bit build
+	if (maxSize > static_cast<std::size_t>(-1))
+	{
+		return false;
+	}
+
+	return OS::SetWorkingSetSize(static_cast<std::size_t>(minSize), static_cast<std::size_t>(maxSize));
+}
+
 void LauncherCommon::SetParamsCmdLine(SSystemInitParams& params, const char* cmdLine)
 {
 	const std::size_t length = std::strlen(cmdLine);
@@ -134,6 +518,16 @@ void LauncherCommon::SetParamsCmdLine(SSystemInitParams& params, const char* cmd
 
 IGameStartup* LauncherCommon::StartEngine(void* pCryGame, SSystemInitParams& params)
 {
+	StartupTimer::Scope step("StartEngine");
+
+	if (g_prefetcher.IsStarted())
+	{
+		// the engine loads the rest of its DLLs
+		StartupTimer::Scope waitStep("WaitForPrefetch");
+
+		g_prefetcher.WaitForAllModules();
+	}
+
 	void* entry = OS::Module::FindSymbol(pCryGame, "CreateGameStartup");
 	if (!entry)
 	{
@@ -151,28 +545,731 @@ IGameStartup* LauncherCommon::StartEngine(void* pCryGame, SSystemInitParams& par
 		throw StringTools::Error("Game initialization failed!");
 	}
 
+	if (OS::CmdLine::HasArg("-preloadsymbols"))
+	{
+		// all engine DLLs are loaded now
+		CrashLogger::PreloadSymbols();
+	}
+
 	return pGameStartup;
 }
 
-void LauncherCommon::OnEarlyEngineInit(ISystem* pSystem)
+static FileWarmer g_pakWarmer;
+
+static double ToMiB(unsigned __int64 bytes)
 {
-	gEnv = pSystem->GetGlobalEnvironment();
+	return static_cast<double>(bytes) / (1024 * 1024);
+}
 
-	CryLogAlways("%s", PROJECT_BANNER);
+static void OnPakWarmDone(const FileWarmer::Stats& stats)
+{
+	// called by the warm-up thread, the engine log is used by other engine threads as well
+	CryLogAlways("Pak warm-up: %u files (%.1f MiB) in %.1f ms", stats.fileCount, ToMiB(stats.warmedBytes),
+		stats.duration);
+
+	if (stats.residentBytes > 0)
+	{
+		CryLogAlways("Pak warm-up: %.1f MiB kept resident", ToMiB(stats.residentBytes));
+	}
+
+	if (stats.unlockedBytes > 0)
+	{
+		CryLogWarningAlways("Pak warm-up: %.1f MiB cannot stay resident, use larger -lockworkingset",
+			ToMiB(stats.unlockedBytes));
+	}
+
+	if (stats.failedCount > 0)
+	{
+		CryLogWarningAlways("Pak warm-up: %u files failed", stats.failedCount);
+	}
 }
 
-std::FILE* LauncherCommon::OpenLogFile(const char* defaultFileName)
+struct ExpandedPathList
 {
-	const StringView fileName = OS::CmdLine::GetArgValue("-logfile", defaultFileName);
+	StringView folder;
+	std::vector<std::string>* pPaths;
+};
 
-	// try root folder first
-	std::FILE* file = std::fopen(PathTools::Join(GetRootFolderPath(), fileName).c_str(), "a");
+static void AddExpandedPath(const char* fileName, void* param)
+{
+	ExpandedPathList& list = *static_cast<ExpandedPathList*>(param);
 
-	if (!file)
+	list.pPaths->push_back(PathTools::Join(list.folder, fileName));
+}
+
+void LauncherCommon::ExpandPathList(const char* list, const std::string& baseFolder, std::vector<std::string>& paths,
+	std::vector<std::string>& unmatched)
+{
+	StringView rest(list);
+
+	while (rest.IsNotEmpty())
 	{
-		// try user folder instead if root folder is not writable
-		file = std::fopen(PathTools::Join(GetUserFolderPath(), fileName).c_str(), "a");
+		std::size_t separatorPos = 0;
+
+		if (!rest.Find(';', separatorPos))
+		{
+			separatorPos = rest.length;
+		}
+
+		const StringView entry(rest.string, separatorPos);
+
+		rest.RemovePrefix((separatorPos < rest.length) ? separatorPos + 1 : separatorPos);
+
+		if (entry.IsEmpty())
+		{
+			continue;
+		}
+
+		const bool isAbsolute = entry.length >= 2 && (entry[1] == ':' || (entry[0] == '\\' && entry[1] == '\\'));
+		const std::string path = (isAbsolute) ? entry.ToStdString() : PathTools::Join(baseFolder, entry);
+
+		if (path.find_first_of("*?") != std::string::npos)
+		{
+			ExpandedPathList expanded;
+			expanded.folder = PathTools::DirName(path);
+			expanded.pPaths = &paths;
+
+			if (!OS::Directory::ForEachFile(path.c_str(), &AddExpandedPath, &expanded))
+			{
+				unmatched.push_back(path);
+			}
+		}
+		else
+		{
+			paths.push_back(path);
+		}
+	}
+}
+
+void LauncherCommon::StartPakWarm(bool isPaced)
+{
+	const char* value = OS::CmdLine::GetArgValue("-pakwarm", NULL);
+
+	if (!value)
+	{
+		return;
 	}
 
-	return file;
+	std::vector<std::string> paths;
+	std::vector<std::string> unmatched;
+
+	ExpandPathList(value, GetMainFolderPath(), paths, unmatched);
+
+	for (std::size_t i = 0; i < unmatched.size(); i++)
+	{
+		CryLogWarningAlways("Pak warm-up: no file matches %s", unmatched[i].c_str());
+	}
+
+	for (std::size_t i = 0; i < paths.size(); i++)
+	{
+		g_pakWarmer.Add(paths[i]);
+	}
+
+	const bool isResident = OS::CmdLine::HasArg("-pakresident");
+
+	if (g_pakWarmer.Start(isPaced, isResident, &OnPakWarmDone))
+	{
+		CryLogAlways("Pak warm-up: started (%s%s)", (isPaced) ? "idle ticks" : "background",
+			(isResident) ? ", resident" : "");
+	}
+}
+
+void LauncherCommon::OnServerIdle()
+{
+	g_pakWarmer.OnIdle();
+}
+
+#define MAX_PROCESSOR_COUNT (sizeof(std::size_t) * 8)
+#define DEFAULT_CPUSET_CORE_COUNT 2
+
+// hexadecimal mask (0x1F) or a list of logical processors (0,2,4-7)
+static std::size_t ParseProcessorMask(const char* value, const char* argName)
+{
+	std::size_t mask = 0;
+
+	if (value[0] == '0' && (value[1] == 'x' || value[1] == 'X'))
+	{
+		char* end = NULL;
+		const unsigned __int64 result = _strtoui64(value + 2, &end, 16);
+
+		if (end != (value + 2) && *end == '\0' && result == static_cast<std::size_t>(result))
+		{
+			mask = static_cast<std::size_t>(result);
+		}
+	}
+	else
+	{
+		const char* pos = value;
+		char* end = NULL;
+
+		for (;;)
+		{
+			const unsigned long first = std::strtoul(pos, &end, 10);
+			unsigned long last = first;
+
+			if (end == pos)
+			{
+				mask = 0;
+				break;
+			}
+
+			if (*end == '-')
+			{
+				pos = end + 1;
+				last = std::strtoul(pos, &end, 10);
+
+				if (end == pos)
+				{
+					mask = 0;
+					break;
+				}
+			}
+
+			if (first > last || last >= MAX_PROCESSOR_COUNT)
+			{
+				mask = 0;
+				break;
+			}
+
+			for (unsigned long i = first; i <= last; i++)
+			{
+				mask |= static_cast<std::size_t>(1) << i;
+			}
+
+			if (*end != ',')
+			{
+				if (*end != '\0')
+				{
+					mask = 0;
+				}
+
+				break;
+			}
+
+			pos = end + 1;
+		}
+	}
+
+	if (!mask)
+	{
+		throw StringTools::Error("Invalid %s \"%s\"!\nUse a mask like 0xF or a list like 0,2,4-7.", argName, value);
+	}
+
+	return mask;
+}
+
+// auto:INDEX[:CORES] selects the INDEX-th block of CORES physical cores including their SMT siblings
+static std::size_t ParseCPUSet(const char* value)
+{
+	const char* prefix = "auto:";
+	const std::size_t prefixLength = std::strlen(prefix);
+
+	unsigned long index = 0;
+	unsigned long coresPerSet = DEFAULT_CPUSET_CORE_COUNT;
+	bool isValid = false;
+
+	if (std::strncmp(value, prefix, prefixLength) == 0)
+	{
+		const char* pos = value + prefixLength;
+		char* end = NULL;
+
+		index = std::strtoul(pos, &end, 10);
+		isValid = (end != pos);
+
+		if (isValid && *end == ':')
+		{
+			pos = end + 1;
+			coresPerSet = std::strtoul(pos, &end, 10);
+			isValid = (end != pos) && coresPerSet > 0;
+		}
+
+		isValid = isValid && *end == '\0';
+	}
+
+	if (!isValid)
+	{
+		throw StringTools::Error("Invalid -cpuset \"%s\"!\nUse auto:INDEX or auto:INDEX:CORES.", value);
+	}
+
+	std::size_t coreMasks[MAX_PROCESSOR_COUNT];
+	const unsigned int coreCount = OS::GetProcessorCoreMasks(coreMasks, MAX_PROCESSOR_COUNT);
+	const unsigned int setCount = coreCount / coresPerSet;
+
+	if (setCount == 0)
+	{
+		throw StringTools::Error("Invalid -cpuset \"%s\"!\nOnly %u cores are available.", value, coreCount);
+	}
+
+	// more instances than sets share the sets
+	const unsigned int firstCore = (index % setCount) * coresPerSet;
+
+	std::size_t mask = 0;
+
+	for (unsigned int i = 0; i < coresPerSet; i++)
+	{
+		mask |= coreMasks[firstCore + i];
+	}
+
+	return mask;
+}
+
+void LauncherCommon::SetProcessorAffinity()
+{
+	const char* affinity = OS::CmdLine::GetArgValue("-affinity", NULL);
+	const char* cpuset = OS::CmdLine::GetArgValue("-cpuset", NULL);
+	const char* mainThreadAffinity = OS::CmdLine::GetArgValue("-mainthreadaffinity", NULL);
+
+	if (affinity && cpuset)
+	{
+		throw StringTools::Error("Use either -affinity or -cpuset, not both!");
+	}
+
+	if (affinity || cpuset)
+	{
+		// threads created later inherit this, so the engine sees only these processors
+		const std::size_t mask = (affinity) ? ParseProcessorMask(affinity, "-affinity") : ParseCPUSet(cpuset);
+
+		if (!OS::SetProcessAffinity(mask))
+		{
+			throw StringTools::OSError("Failed to set process affinity to 0x%IX!", mask);
+		}
+	}
+
+	if (mainThreadAffinity)
+	{
+		const std::size_t mask = ParseProcessorMask(mainThreadAffinity, "-mainthreadaffinity");
+
+		if (!OS::SetCurrentThreadAffinity(mask))
+		{
+			throw StringTools::OSError("Failed to set main thread affinity to 0x%IX!", mask);
+		}
+	}
+}
+
+struct PriorityName
+{
+	const char* name;
+	int value;
+};
+
+static const PriorityName PROCESS_PRIORITY_NAMES[] = {
+	{ "idle",        OS::PROCESS_PRIORITY_IDLE },
+	{ "belownormal", OS::PROCESS_PRIORITY_BELOW_NORMAL },
+	{ "normal",      OS::PROCESS_PRIORITY_NORMAL },
+	{ "abovenormal", OS::PROCESS_PRIORITY_ABOVE_NORMAL },
+	{ "high",        OS::PROCESS_PRIORITY_HIGH },
+};
+
+static const PriorityName IO_PRIORITY_NAMES[] = {
+	{ "verylow", OS::IO_PRIORITY_VERY_LOW },
+	{ "low",     OS::IO_PRIORITY_LOW },
+	{ "normal",  OS::IO_PRIORITY_NORMAL },
+};
+
+#define MAX_TIMER_RESOLUTION 15
+
+// shown in the log once the engine is started, NULL if not changed
+static const char* g_processPriorityName;
+static const char* g_ioPriorityName;
+
+static const PriorityName& ParsePriority(const char* value, const PriorityName* names, std::size_t count,
+	const char* argName)
+{
+	for (std::size_t i = 0; i < count; i++)
+	{
+		if (StringView(value).IsEqualNoCase(names[i].name))
+		{
+			return names[i];
+		}
+	}
+
+	std::string validNames;
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		validNames += (i > 0) ? ", " : "";
+		validNames += names[i].name;
+	}
+
+	throw StringTools::Error("Invalid %s \"%s\"!\nUse %s.", argName, value, validNames.c_str());
+}
+
+void LauncherCommon::SetProcessPriority()
+{
+	const char* priority = OS::CmdLine::GetArgValue("-priority", NULL);
+	const char* ioPriority = OS::CmdLine::GetArgValue("-iopriority", NULL);
+
+	if (priority)
+	{
+		const PriorityName& entry = ParsePriority(priority, PROCESS_PRIORITY_NAMES,
+			sizeof PROCESS_PRIORITY_NAMES / sizeof PROCESS_PRIORITY_NAMES[0], "-priority");
+
+		if (!OS::SetProcessPriority(static_cast<OS::ProcessPriority>(entry.value)))
+		{
+			throw StringTools::OSError("Failed to set process priority to %s!", entry.name);
+		}
+
+		g_processPriorityName = entry.name;
+	}
+
+	if (ioPriority)
+	{
+		const PriorityName& entry = ParsePriority(ioPriority, IO_PRIORITY_NAMES,
+			sizeof IO_PRIORITY_NAMES / sizeof IO_PRIORITY_NAMES[0], "-iopriority");
+
+		if (!OS::SetProcessIOPriority(static_cast<OS::IOPriority>(entry.value)))
+		{
+			throw StringTools::OSError("Failed to set I/O priority to %s!", entry.name);
+		}
+
+		g_ioPriorityName = entry.name;
+	}
+}
+
+/**
+ * @return Milliseconds, zero if -timerres is not used, negative if its value is invalid.
+ */
+static int ParseTimerResolution(const char** pValue)
+{
+	if (!OS::CmdLine::HasArg("-timerres"))
+	{
+		return 0;
+	}
+
+	// the value is optional
+	const char* value = OS::CmdLine::GetArgValue("-timerres", "1");
+	const int resolution = (*value) ? std::atoi(value) : 1;
+
+	if (pValue)
+	{
+		*pValue = value;
+	}
+
+	return (resolution > 0 && resolution <= MAX_TIMER_RESOLUTION) ? resolution : -1;
+}
+
+unsigned int LauncherCommon::GetTimerResolution()
+{
+	const char* value = "";
+	const int resolution = ParseTimerResolution(&value);
+
+	if (resolution < 0)
+	{
+		throw StringTools::Error("Invalid timer resolution \"%s\"!\nUse 1 to %d ms.", value, MAX_TIMER_RESOLUTION);
+	}
+
+	return resolution;
+}
+
+std::string LauncherCommon::GetPriorityInfo()
+{
+	// validated by the launcher before the engine is loaded
+	const int timerResolution = ParseTimerResolution(NULL);
+
+	std::string info = StringTools::Format("Process priority: %s, I/O priority: %s, timer resolution: ",
+		(g_processPriorityName) ? g_processPriorityName : "default",
+		(g_ioPriorityName) ? g_ioPriorityName : "default"
+	);
+
+	if (timerResolution > 0)
+	{
+		StringTools::FormatTo(info, "%d ms while needed", timerResolution);
+	}
+	else
+	{
+		info += "default";
+	}
+
+	return info;
+}
+
+/**
+ * @return Value of the -tickrate command line parameter or zero if the engine should run its own loop.
+ */
+unsigned int LauncherCommon::GetTickRate()
+{
+	const char* value = OS::CmdLine::GetArgValue("-tickrate", NULL);
+
+	if (!value)
+	{
+		return 0;
+	}
+
+	const int tickRate = std::atoi(value);
+
+	if (tickRate <= 0 || tickRate > 1000)
+	{
+		throw StringTools::Error("Invalid tick rate \"%s\"!\nUse 1 to 1000 Hz.", value);
+	}
+
+	return tickRate;
+}
+
+static std::string GetRestartCmdLine(IGameStartup* pGameStartup)
+{
+	char modName[256] = {};
+	const bool isModRestart = pGameStartup->GetRestartMod(modName, sizeof modName);
+
+	char* levelName = NULL;
+	const bool isLevelRestart = pGameStartup->GetRestartLevel(&levelName) && levelName && *levelName;
+
+	if (!isModRestart && !isLevelRestart)
+	{
+		return std::string();
+	}
+
+	char exePath[512];
+	const std::size_t exePathLength = OS::Module::GetEXEPath(exePath, sizeof exePath);
+
+	if (exePathLength == 0 || exePathLength >= sizeof exePath)
+	{
+		throw StringTools::OSError("Failed to get the executable path!");
+	}
+
+	std::string cmdLine;
+	cmdLine += '"';
+	cmdLine += exePath;
+	cmdLine += '"';
+
+	// the engine uses the first occurrence of each parameter, so the new ones must come first
+	if (isModRestart)
+	{
+		cmdLine += " -mod ";
+		cmdLine += modName;
+	}
+
+	if (isLevelRestart)
+	{
+		cmdLine += " +map ";
+		cmdLine += levelName;
+	}
+
+	cmdLine += ' ';
+	cmdLine += OS::CmdLine::GetOnlyArgs();
+
+	return cmdLine;
+}
+
+// includes OnUpdate of the launcher, which is called by the engine
+static HotPathTimer::Section g_engineUpdateSection("EngineUpdate");
+
+/**
+ * The engine sleeps between frames, so it needs the raised timer resolution too. IGameStartup::Run returns only after
+ * the engine is shut down, which is the earliest point the resolution can be restored.
+ */
+int LauncherCommon::RunEngineLoop(IGameStartup* pGameStartup, unsigned int timerResolution)
+{
+	OS::TimerResolution resolution;
+
+	if (timerResolution && resolution.Request(timerResolution))
+	{
+		CryLogAlways("Timer resolution: %u ms", timerResolution);
+	}
+
+	return pGameStartup->Run(NULL);
+}
+
+/**
+ * Replacement of IGameStartup::Run with precise tick pacing.
+ *
+ * Shuts down the engine at the end and restarts the process if the game requested a different mod or level.
+ */
+int LauncherCommon::RunServerLoop(IGameStartup* pGameStartup, unsigned int tickRate)
+{
+	FramePacer pacer(tickRate);
+
+	CryLogAlways("Tick rate: %u Hz (%s timer)", tickRate, (pacer.IsHighResolution()) ? "high-resolution" : "standard");
+
+	// only the standard timer needs it, and only while the loop runs
+	const unsigned int timerResolution = GetTimerResolution();
+
+	if (pacer.RequestTimerResolution(timerResolution))
+	{
+		CryLogAlways("Timer resolution: %u ms", timerResolution);
+	}
+
+	unsigned long reportTime = OS::GetTickCount();
+	unsigned long reportedFrameCount = 0;
+	unsigned long reportedMissedCount = 0;
+
+	for (;;)
+	{
+		if (!OS::PumpWindowMessages())
+		{
+			break;
+		}
+
+		{
+			HotPathTimer::Scope scope(g_engineUpdateSection);
+
+			if (!pGameStartup->Update(true, 0))
+			{
+				break;
+			}
+		}
+
+		LauncherCommon::FinishStartup();
+
+		// the rest of the tick is idle
+		LauncherCommon::OnServerIdle();
+
+		pacer.Wait();
+
+		const unsigned long now = OS::GetTickCount();
+
+		if ((now - reportTime) >= 60000)
+		{
+			const unsigned long frameCount = pacer.GetFrameCount() - reportedFrameCount;
+			const unsigned long missedCount = pacer.GetMissedCount() - reportedMissedCount;
+
+			if (missedCount > 0)
+			{
+				CryLogWarningAlways("Missed %lu of %lu tick deadlines in the last minute", missedCount, frameCount);
+			}
+
+			reportTime = now;
+			reportedFrameCount = pacer.GetFrameCount();
+			reportedMissedCount = pacer.GetMissedCount();
+		}
+	}
+
+	pacer.ReleaseTimerResolution();
+
+	const std::string restartCmdLine = GetRestartCmdLine(pGameStartup);
+
+	pGameStartup->Shutdown();
+
+	if (!restartCmdLine.empty() && !OS::StartProcess(restartCmdLine.c_str()))
+	{
+		throw StringTools::OSError("Failed to restart!\n%s", restartCmdLine.c_str());
+	}
+
+	return 0;
+}
+
+void LauncherCommon::OnEarlyEngineInit(ISystem* pSystem)
+{
+	gEnv = pSystem->GetGlobalEnvironment();
+
+	CryLogAlways("%s", PROJECT_BANNER);
+
+	CryLogAlways("%s", GetPriorityInfo().c_str());
+}
+
+void LauncherCommon::FinishStartup()
+{
+	if (StartupTimer::IsFinished())
+	{
+		return;
+	}
+
+	StartupTimer::Finish();
+
+	const unsigned int stepCount = StartupTimer::GetStepCount();
+
+	CryLogAlways("$3Startup times:");
+
+	for (unsigned int i = 0; i < stepCount; i++)
+	{
+		const StartupTimer::Step step = StartupTimer::GetStep(i);
+
+		CryLogAlways("%*s%s: %.1f ms", static_cast<int>(step.depth * 2), "", step.name, step.duration);
+	}
+
+	CryLogAlways("Total: %.1f ms", StartupTimer::GetTotalTime());
+
+	if (g_prefetcher.IsStarted())
+	{
+		CryLogAlways("Prefetched %u DLLs (%.1f MiB) in %.1f ms", g_prefetcher.GetModuleCount(),
+			g_prefetcher.GetModuleKiB() / 1024.0, g_prefetcher.GetModuleTime());
+
+		if (OS::CmdLine::HasArg("-prefetchpaks"))
+		{
+			// still running
+			CryLogAlways("Prefetched %u paks (%.1f MiB) so far", g_prefetcher.GetFileCount(),
+				g_prefetcher.GetFileKiB() / 1024.0);
+		}
+	}
+
+	if (OS::CmdLine::HasArg("-startupline"))
+	{
+		// single line for log parsers, step names contain no spaces
+		std::string line;
+		StringTools::FormatTo(line, "STARTUP total=%.1f", StartupTimer::GetTotalTime());
+
+		for (unsigned int i = 0; i < stepCount; i++)
+		{
+			const StartupTimer::Step step = StartupTimer::GetStep(i);
+
+			StringTools::FormatTo(line, " %s=%.1f", step.name, step.duration);
+		}
+
+		CryLogAlways("%s", line.c_str());
+	}
+}
+
+std::FILE* LauncherCommon::OpenLogFile(const char* defaultFileName)
+{
+	const StringView fileName = OS::CmdLine::GetArgValue("-logfile", defaultFileName);
+
+	// try root folder first
+	std::FILE* file = std::fopen(PathTools::Join(GetRootFolderPath(), fileName).c_str(), "a");
+
+	if (!file)
+	{
+		// try user folder instead if root folder is not writable
+		file = std::fopen(PathTools::Join(GetUserFolderPath(), fileName).c_str(), "a");
+	}
+
+	return file;
+}
+
+#define DEFAULT_CRASH_TIMEOUT "30"
+
+static CrashLogger::DumpType ParseDumpType(const char* value)
+{
+	const StringView type(value);
+
+	if (type.IsEqualNoCase("none"))
+	{
+		return CrashLogger::DUMP_NONE;
+	}
+	else if (type.IsEqualNoCase("small"))
+	{
+		return CrashLogger::DUMP_SMALL;
+	}
+	else if (type.IsEqualNoCase("normal"))
+	{
+		return CrashLogger::DUMP_NORMAL;
+	}
+	else if (type.IsEqualNoCase("full"))
+	{
+		return CrashLogger::DUMP_FULL;
+	}
+
+	throw StringTools::Error("Invalid -crashdump \"%s\"!\nUse none, small, normal or full.", value);
+}
+
+void LauncherCommon::EnableCrashLogger(CrashLogger::Handler handler)
+{
+	const std::string rootFolder = GetRootFolderPath();
+	const std::string userFolder = GetUserFolderPath();
+
+	const char* timeout = OS::CmdLine::GetArgValue("-crashtimeout", DEFAULT_CRASH_TIMEOUT);
+	const int timeoutSeconds = std::atoi(timeout);
+
+	if (timeoutSeconds < 0 || timeoutSeconds > 3600)
+	{
+		throw StringTools::Error("Invalid crash timeout \"%s\"!\nUse 0 to 3600 seconds, 0 waits forever.", timeout);
+	}
+
+	CrashLogger::Config config;
+	config.handler = handler;
+	config.isReserved = OS::CmdLine::HasArg("-crashreserve");
+	config.dumpType = ParseDumpType(OS::CmdLine::GetArgValue("-crashdump", "none"));
+	config.dumpFolder = rootFolder.c_str();
+	config.dumpFallbackFolder = userFolder.c_str();
+	config.timeout = timeoutSeconds * 1000;
+
+	CrashLogger::Enable(config);
 }
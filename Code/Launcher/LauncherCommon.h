@@ -2,6 +2,10 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
+
+#include "Library/CrashLogger.h"
+#include "Library/StringView.h"
 
 struct IGameStartup;
 struct ISystem;
@@ -13,16 +17,77 @@ namespace LauncherCommon
 	std::string GetRootFolderPath();
 	std::string GetUserFolderPath();
 
+	/**
+	 * Adds launcher settings from launcher.cfg in the root folder or from the file given by -launchercfg.
+	 * Each line is a command line argument optionally followed by its value, lines starting with # are comments.
+	 * The command line has priority over the file. Returns the path of the loaded file or an empty string.
+	 */
+	std::string LoadConfigFile();
+
+	// splits a config file line into the name and the optionally quoted value, false for empty lines and comments
+	bool ParseConfigLine(StringView line, std::string& name, std::string& value);
+
+	// the kind of the file is used in error messages
+	std::string ReadConfigFile(const char* path, const char* kind);
+
+	// prefetches the engine DLLs and optionally the game paks on a background thread, see -noprefetch
+	void StartPrefetch(const char* rendererName);
+
+	// waits for the prefetch of the DLL if needed
 	void* LoadModule(const char* name);
 
 	int GetGameBuild(void* pCrySystem);
 	void VerifyGameBuild(int gameBuild);
 
+	void EnablePoolAllocator(void* pCrySystem);
+
+	// returns NULL on success, otherwise the reason why normal pages are used
+	const char* EnableLargePages();
+
+	// MiB, zero if the -lockworkingset command line parameter is not used
+	unsigned int GetLockedWorkingSetSize();
+	// sizes that do not fit into the address space fail as well
+	bool LockWorkingSet(unsigned int sizeMiB);
+
 	void SetParamsCmdLine(SSystemInitParams& params, const char* cmdLine);
 
 	IGameStartup* StartEngine(void* pCryGame, SSystemInitParams& params);
 
+	// starts warming up the paks listed in the -pakwarm command line parameter
+	// paced warm-up reads only while the server loop is idle, see OnServerIdle
+	void StartPakWarm(bool isPaced);
+
+	// semicolon-separated list of paths relative to the base folder, file names can contain wildcards
+	// wildcard entries without any matching file go to the unmatched list
+	void ExpandPathList(const char* list, const std::string& baseFolder, std::vector<std::string>& paths,
+		std::vector<std::string>& unmatched);
+	void OnServerIdle();
+
+	void SetProcessorAffinity();
+
+	// see -priority and -iopriority command line parameters
+	void SetProcessPriority();
+
+	// milliseconds, zero if the -timerres command line parameter is not used
+	// throws an exception if the value is invalid, so call it before the engine is loaded
+	unsigned int GetTimerResolution();
+
+	// single line with the applied priorities for the log, never throws
+	std::string GetPriorityInfo();
+
+	unsigned int GetTickRate();
+	int RunServerLoop(IGameStartup* pGameStartup, unsigned int tickRate);
+
+	// the engine runs its own loop, the timer resolution stays raised until the engine is shut down
+	int RunEngineLoop(IGameStartup* pGameStartup, unsigned int timerResolution);
+
 	void OnEarlyEngineInit(ISystem* pSystem);
 
+	// logs the startup times, does nothing if already done
+	void FinishStartup();
+
 	std::FILE* OpenLogFile(const char* defaultFileName);
+
+	// see -crashreserve, -crashdump and -crashtimeout command line parameters
+	void EnableCrashLogger(CrashLogger::Handler handler);
 }
@@ -1,40 +1,141 @@
+#include <algorithm>  // std::sort
 #include <cstring>
 
 #include "Library/OS.h"
+#include "Library/StartupTimer.h"
 #include "Library/StringTools.h"
 
 #include "MemoryPatch.h"
 
-// prevent the compiler from inlining certain functions to reduce code size
-#ifdef _MSC_VER
-#define NOINLINE __declspec(noinline)
-#else
-#define NOINLINE
-#endif
+/**
+ * Patch of a single game build.
+ */
+struct Patch
+{
+	int gameBuild;
+	std::size_t offset;
+	std::size_t size;
+	const unsigned char* code;  // NULL means NOPs
+};
 
-static void* ByteOffset(void* base, std::size_t offset)
+/**
+ * Location of a patch with code that is built at runtime.
+ */
+struct PatchSite
 {
-	return static_cast<unsigned char*>(base) + offset;
+	int gameBuild;
+	std::size_t offset;
+};
+
+template<std::size_t N>
+static void AddPatches(MemoryPatch::Batch& batch, int gameBuild, const Patch (&patches)[N])
+{
+	for (std::size_t i = 0; i < N; i++)
+	{
+		const Patch& patch = patches[i];
+
+		if (patch.gameBuild != gameBuild)
+		{
+			continue;
+		}
+
+		if (patch.code)
+		{
+			batch.FillMem(patch.offset, patch.code, patch.size);
+		}
+		else
+		{
+			batch.FillNop(patch.offset, patch.size);
+		}
+	}
 }
 
-static NOINLINE void FillNop(void* base, std::size_t offset, std::size_t size)
+/**
+ * @return Offset of the patch or zero if the game build has no such patch.
+ */
+template<std::size_t N>
+static std::size_t FindPatchSite(int gameBuild, const PatchSite (&sites)[N])
 {
-	void* address = ByteOffset(base, offset);
+	for (std::size_t i = 0; i < N; i++)
+	{
+		if (sites[i].gameBuild == gameBuild)
+		{
+			return sites[i].offset;
+		}
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Batch
+////////////////////////////////////////////////////////////////////////////////
 
-	if (!OS::Hack::FillNop(address, size))
+struct WriteOrder
+{
+	template<class T>
+	bool operator()(const T& a, const T& b) const
 	{
-		throw StringTools::OSError("Failed to apply patch at 0x%IX", reinterpret_cast<std::size_t>(address));
+		return a.offset < b.offset;
 	}
+};
+
+void MemoryPatch::Batch::FillNop(std::size_t offset, std::size_t size)
+{
+	Write write;
+	write.offset = offset;
+	write.dataPos = m_data.size();
+	write.size = size;
+
+	// 0x90 is the opcode of NOP instruction on both x86 and x86-64
+	m_data.insert(m_data.end(), size, static_cast<unsigned char>(0x90));
+	m_writes.push_back(write);
 }
 
-static NOINLINE void FillMem(void* base, std::size_t offset, const void* data, std::size_t dataSize)
+void MemoryPatch::Batch::FillMem(std::size_t offset, const void* data, std::size_t size)
 {
-	void* address = ByteOffset(base, offset);
+	Write write;
+	write.offset = offset;
+	write.dataPos = m_data.size();
+	write.size = size;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	m_data.insert(m_data.end(), bytes, bytes + size);
+	m_writes.push_back(write);
+}
+
+void MemoryPatch::Batch::Apply()
+{
+	if (m_writes.empty())
+	{
+		return;
+	}
+
+	StartupTimer::Scope step(m_name);
+
+	std::stable_sort(m_writes.begin(), m_writes.end(), WriteOrder());
+
+	std::vector<OS::Hack::Write> writes(m_writes.size());
 
-	if (!OS::Hack::FillMem(address, data, dataSize))
+	for (std::size_t i = 0; i < m_writes.size(); i++)
 	{
-		throw StringTools::OSError("Failed to apply patch at 0x%IX", reinterpret_cast<std::size_t>(address));
+		writes[i].address = static_cast<unsigned char*>(m_base) + m_writes[i].offset;
+		writes[i].data = &m_data[m_writes[i].dataPos];
+		writes[i].size = m_writes[i].size;
 	}
+
+	const std::size_t writtenCount = OS::Hack::WriteMemory(&writes[0], writes.size());
+
+	if (writtenCount < writes.size())
+	{
+		const std::size_t address = reinterpret_cast<std::size_t>(writes[writtenCount].address);
+
+		throw StringTools::OSError("Failed to apply %s patch at 0x%IX", m_name, address);
+	}
+
+	m_writes.clear();
+	m_data.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -44,128 +145,53 @@ static NOINLINE void FillMem(void* base, std::size_t offset, const void* data, s
 /**
  * Allows connecting to DX10 servers with game running in DX9 mode.
  */
-void MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(void* pCryAction, int gameBuild)
+void MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryAction, 0x2AF92D, 0x1E);
-			FillNop(pCryAction, 0x2B24DD, 0x1A);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryAction, 0x2AF6ED, 0x1E);
-			FillNop(pCryAction, 0x2B239D, 0x1A);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryAction, 0x2B349D, 0x1E);
-			FillNop(pCryAction, 0x2B6361, 0x1A);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryAction, 0x2B394D, 0x1E);
-			FillNop(pCryAction, 0x2B6860, 0x1A);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryAction, 0x2B06AD, 0x1E);
-			FillNop(pCryAction, 0x2B3EAA, 0x16);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryAction, 0x2B529D, 0x1E);
-			FillNop(pCryAction, 0x2B7F7A, 0x16);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryAction, 0x2B39FD, 0x1E);
-			FillNop(pCryAction, 0x2B66DA, 0x16);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryAction, 0x2B6F6D, 0x1E);
-			FillNop(pCryAction, 0x2B9C21, 0x16);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryAction, 0x2B6F3D, 0x1E);
-			FillNop(pCryAction, 0x2B9BF1, 0x16);
-			break;
-		}
+		{ 5767, 0x2AF92D, 0x1E, NULL },
+		{ 5767, 0x2B24DD, 0x1A, NULL },
+		{ 5879, 0x2AF6ED, 0x1E, NULL },
+		{ 5879, 0x2B239D, 0x1A, NULL },
+		{ 6115, 0x2B349D, 0x1E, NULL },
+		{ 6115, 0x2B6361, 0x1A, NULL },
+		{ 6156, 0x2B394D, 0x1E, NULL },
+		{ 6156, 0x2B6860, 0x1A, NULL },
+		{ 6566, 0x2B06AD, 0x1E, NULL },
+		{ 6566, 0x2B3EAA, 0x16, NULL },
+		{ 6586, 0x2B529D, 0x1E, NULL },
+		{ 6586, 0x2B7F7A, 0x16, NULL },
+		{ 6627, 0x2B39FD, 0x1E, NULL },
+		{ 6627, 0x2B66DA, 0x16, NULL },
+		{ 6670, 0x2B6F6D, 0x1E, NULL },
+		{ 6670, 0x2B9C21, 0x16, NULL },
+		{ 6729, 0x2B6F3D, 0x1E, NULL },
+		{ 6729, 0x2B9BF1, 0x16, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCryAction, 0x1D4ADA, 0x1A);
-			FillNop(pCryAction, 0x1D6B03, 0x15);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryAction, 0x1D4B0A, 0x1A);
-			FillNop(pCryAction, 0x1D6B33, 0x15);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryAction, 0x1D6EDA, 0x1A);
-			FillNop(pCryAction, 0x1D8F32, 0x15);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryAction, 0x1D698A, 0x1A);
-			FillNop(pCryAction, 0x1D89FC, 0x15);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryAction, 0x1D854A, 0x1A);
-			FillNop(pCryAction, 0x1DA5BC, 0x15);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryAction, 0x1F09AA, 0x1A);
-			FillNop(pCryAction, 0x1F2DEC, 0x15);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryAction, 0x1D81DA, 0x1A);
-			FillNop(pCryAction, 0x1DA1CC, 0x15);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryAction, 0x1D826A, 0x1A);
-			FillNop(pCryAction, 0x1DA25C, 0x15);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryAction, 0x1D9FCA, 0x1A);
-			FillNop(pCryAction, 0x1DBFBC, 0x15);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryAction, 0x1D9F6A, 0x1A);
-			FillNop(pCryAction, 0x1DBF5C, 0x15);
-			break;
-		}
+		{ 5767, 0x1D4ADA, 0x1A, NULL },
+		{ 5767, 0x1D6B03, 0x15, NULL },
+		{ 5879, 0x1D4B0A, 0x1A, NULL },
+		{ 5879, 0x1D6B33, 0x15, NULL },
+		{ 6115, 0x1D6EDA, 0x1A, NULL },
+		{ 6115, 0x1D8F32, 0x15, NULL },
+		{ 6156, 0x1D698A, 0x1A, NULL },
+		{ 6156, 0x1D89FC, 0x15, NULL },
+		{ 6527, 0x1D854A, 0x1A, NULL },
+		{ 6527, 0x1DA5BC, 0x15, NULL },
+		{ 6566, 0x1F09AA, 0x1A, NULL },
+		{ 6566, 0x1F2DEC, 0x15, NULL },
+		{ 6586, 0x1D81DA, 0x1A, NULL },
+		{ 6586, 0x1DA1CC, 0x15, NULL },
+		{ 6627, 0x1D826A, 0x1A, NULL },
+		{ 6627, 0x1DA25C, 0x15, NULL },
+		{ 6670, 0x1D9FCA, 0x1A, NULL },
+		{ 6670, 0x1DBFBC, 0x15, NULL },
+		{ 6729, 0x1D9F6A, 0x1A, NULL },
+		{ 6729, 0x1DBF5C, 0x15, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
@@ -173,10 +199,10 @@ void MemoryPatch::CryAction::AllowDX9ImmersiveMultiplayer(void* pCryAction, int
  *
  * The "dump_stats" console command can still be used to create these files manually.
  */
-void MemoryPatch::CryAction::DisableGameplayStats(void* pCryAction, int gameBuild)
+void MemoryPatch::CryAction::DisableGameplayStats(Batch& batch, int gameBuild)
 {
 #ifdef BUILD_64BIT
-	const unsigned char code[] = {
+	static const unsigned char code[] = {
 		0xC3,  // ret
 		0x90,  // nop
 		0x90,  // nop
@@ -185,62 +211,22 @@ void MemoryPatch::CryAction::DisableGameplayStats(void* pCryAction, int gameBuil
 	};
 #endif
 
-	switch (gameBuild)
-	{
+	// Crysis Wars has no automatically created "gameplaystatsXXX.txt" files
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCryAction, 0x2F21D6, code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryAction, 0x2F59E6, code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryAction, 0x2FA686, code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryAction, 0x2FA976, code, sizeof code);
-			break;
-		}
+		{ 5767, 0x2F21D6, sizeof code, code },
+		{ 5879, 0x2F59E6, sizeof code, code },
+		{ 6115, 0x2FA686, sizeof code, code },
+		{ 6156, 0x2FA976, sizeof code, code },
 #else
-		case 5767:
-		{
-			FillNop(pCryAction, 0x2016ED, 0x7);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryAction, 0x203EBD, 0x7);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryAction, 0x20668D, 0x7);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryAction, 0x20605D, 0x7);
-			break;
-		}
+		{ 5767, 0x2016ED, 0x7, NULL },
+		{ 5879, 0x203EBD, 0x7, NULL },
+		{ 6115, 0x20668D, 0x7, NULL },
+		{ 6156, 0x20605D, 0x7, NULL },
 #endif
-		case 6527:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars has no automatically created "gameplaystatsXXX.txt" files
-			break;
-		}
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -250,227 +236,77 @@ void MemoryPatch::CryAction::DisableGameplayStats(void* pCryAction, int gameBuil
 /**
  * Disables useless startup video ads.
  */
-void MemoryPatch::CryGame::DisableIntros(void* pCryGame, int gameBuild)
+void MemoryPatch::CryGame::DisableIntros(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryGame, 0x2EDF9D, 0x10);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x2ED05D, 0x10);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x2F695D, 0x10);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x2F6F4D, 0x10);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x336402, 0x10);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x3274E2, 0x10);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x3275B2, 0x10);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x327CC2, 0x10);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x3291A2, 0x10);
-			break;
-		}
+		{ 5767, 0x2EDF9D, 0x10, NULL },
+		{ 5879, 0x2ED05D, 0x10, NULL },
+		{ 6115, 0x2F695D, 0x10, NULL },
+		{ 6156, 0x2F6F4D, 0x10, NULL },
+		{ 6566, 0x336402, 0x10, NULL },
+		{ 6586, 0x3274E2, 0x10, NULL },
+		{ 6627, 0x3275B2, 0x10, NULL },
+		{ 6670, 0x327CC2, 0x10, NULL },
+		{ 6729, 0x3291A2, 0x10, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCryGame, 0x21A91D, 0xD);
-			FillNop(pCryGame, 0x21A92B, 0x2);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x21ACDD, 0xD);
-			FillNop(pCryGame, 0x21ACEB, 0x2);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x220CAD, 0xD);
-			FillNop(pCryGame, 0x220CBB, 0x2);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x220BFD, 0xD);
-			FillNop(pCryGame, 0x220C0B, 0x2);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryGame, 0x23C9F0, 0xC);
-			FillNop(pCryGame, 0x23C9FF, 0x2);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x24D101, 0xC);
-			FillNop(pCryGame, 0x24D110, 0x2);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x23D650, 0xC);
-			FillNop(pCryGame, 0x23D65F, 0x2);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x23D250, 0xC);
-			FillNop(pCryGame, 0x23D25F, 0x2);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x23D760, 0xC);
-			FillNop(pCryGame, 0x23D76F, 0x2);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x23EEE0, 0xC);
-			FillNop(pCryGame, 0x23EEEF, 0x2);
-			break;
-		}
+		{ 5767, 0x21A91D, 0xD, NULL },
+		{ 5767, 0x21A92B, 0x2, NULL },
+		{ 5879, 0x21ACDD, 0xD, NULL },
+		{ 5879, 0x21ACEB, 0x2, NULL },
+		{ 6115, 0x220CAD, 0xD, NULL },
+		{ 6115, 0x220CBB, 0x2, NULL },
+		{ 6156, 0x220BFD, 0xD, NULL },
+		{ 6156, 0x220C0B, 0x2, NULL },
+		{ 6527, 0x23C9F0, 0xC, NULL },
+		{ 6527, 0x23C9FF, 0x2, NULL },
+		{ 6566, 0x24D101, 0xC, NULL },
+		{ 6566, 0x24D110, 0x2, NULL },
+		{ 6586, 0x23D650, 0xC, NULL },
+		{ 6586, 0x23D65F, 0x2, NULL },
+		{ 6627, 0x23D250, 0xC, NULL },
+		{ 6627, 0x23D25F, 0x2, NULL },
+		{ 6670, 0x23D760, 0xC, NULL },
+		{ 6670, 0x23D76F, 0x2, NULL },
+		{ 6729, 0x23EEE0, 0xC, NULL },
+		{ 6729, 0x23EEEF, 0x2, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
  * Prevents DX10 servers in the server list from being grayed-out when the game is running in DX9 mode.
  */
-void MemoryPatch::CryGame::CanJoinDX10Servers(void* pCryGame, int gameBuild)
+void MemoryPatch::CryGame::CanJoinDX10Servers(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryGame, 0x327B3C, 0xF);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x32689C, 0xF);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x3343C1, 0x18);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x334791, 0x18);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x35BC57, 0x18);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x34B4F7, 0x18);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x34B097, 0x18);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x34B9A7, 0x18);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x34D047, 0x18);
-			break;
-		}
+		{ 5767, 0x327B3C, 0xF, NULL },
+		{ 5879, 0x32689C, 0xF, NULL },
+		{ 6115, 0x3343C1, 0x18, NULL },
+		{ 6156, 0x334791, 0x18, NULL },
+		{ 6566, 0x35BC57, 0x18, NULL },
+		{ 6586, 0x34B4F7, 0x18, NULL },
+		{ 6627, 0x34B097, 0x18, NULL },
+		{ 6670, 0x34B9A7, 0x18, NULL },
+		{ 6729, 0x34D047, 0x18, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCryGame, 0x23A4BC, 0xA);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryGame, 0x23AB5C, 0xA);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryGame, 0x242CAC, 0xF);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryGame, 0x242F1C, 0xF);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryGame, 0x250E10, 0xF);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryGame, 0x262D50, 0xF);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryGame, 0x2514D0, 0xF);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryGame, 0x2510D0, 0xF);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCryGame, 0x251960, 0xF);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryGame, 0x252E10, 0xF);
-			break;
-		}
+		{ 5767, 0x23A4BC, 0xA, NULL },
+		{ 5879, 0x23AB5C, 0xA, NULL },
+		{ 6115, 0x242CAC, 0xF, NULL },
+		{ 6156, 0x242F1C, 0xF, NULL },
+		{ 6527, 0x250E10, 0xF, NULL },
+		{ 6566, 0x262D50, 0xF, NULL },
+		{ 6586, 0x2514D0, 0xF, NULL },
+		{ 6627, 0x2510D0, 0xF, NULL },
+		{ 6670, 0x251960, 0xF, NULL },
+		{ 6729, 0x252E10, 0xF, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
@@ -478,133 +314,58 @@ void MemoryPatch::CryGame::CanJoinDX10Servers(void* pCryGame, int gameBuild)
  *
  * It unlocks DX10 features in "CREATE GAME" menu in DX9 game.
  */
-void MemoryPatch::CryGame::EnableDX10Menu(void* pCryGame, int gameBuild)
+void MemoryPatch::CryGame::EnableDX10Menu(Batch& batch, int gameBuild)
 {
-	const unsigned char code[] = {
+	static const unsigned char code[] = {
 		0xB0, 0x01,  // mov al, 0x1
 		0x90         // nop
 	};
 
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCryGame, 0x2ECE24, code, sizeof code);
-			FillMem(pCryGame, 0x2ED3FE, code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryGame, 0x2EBEE4, code, sizeof code);
-			FillMem(pCryGame, 0x2EC4BE, code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryGame, 0x2F5792, code, sizeof code);
-			FillMem(pCryGame, 0x2F5DBC, code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x2F5D7D, code, sizeof code);
-			FillMem(pCryGame, 0x2F63B7, code, sizeof code);
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryGame, 0x3150C1, code, sizeof code);
-			FillMem(pCryGame, 0x3156F7, code, sizeof code);
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryGame, 0x30AED1, code, sizeof code);
-			FillMem(pCryGame, 0x30B507, code, sizeof code);
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryGame, 0x30AF91, code, sizeof code);
-			FillMem(pCryGame, 0x30B5C7, code, sizeof code);
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCryGame, 0x30B6A1, code, sizeof code);
-			FillMem(pCryGame, 0x30BCD7, code, sizeof code);
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCryGame, 0x30CBA1, code, sizeof code);
-			FillMem(pCryGame, 0x30D1D7, code, sizeof code);
-			break;
-		}
+		{ 5767, 0x2ECE24, sizeof code, code },
+		{ 5767, 0x2ED3FE, sizeof code, code },
+		{ 5879, 0x2EBEE4, sizeof code, code },
+		{ 5879, 0x2EC4BE, sizeof code, code },
+		{ 6115, 0x2F5792, sizeof code, code },
+		{ 6115, 0x2F5DBC, sizeof code, code },
+		{ 6156, 0x2F5D7D, sizeof code, code },
+		{ 6156, 0x2F63B7, sizeof code, code },
+		{ 6566, 0x3150C1, sizeof code, code },
+		{ 6566, 0x3156F7, sizeof code, code },
+		{ 6586, 0x30AED1, sizeof code, code },
+		{ 6586, 0x30B507, sizeof code, code },
+		{ 6627, 0x30AF91, sizeof code, code },
+		{ 6627, 0x30B5C7, sizeof code, code },
+		{ 6670, 0x30B6A1, sizeof code, code },
+		{ 6670, 0x30BCD7, sizeof code, code },
+		{ 6729, 0x30CBA1, sizeof code, code },
+		{ 6729, 0x30D1D7, sizeof code, code },
 #else
-		case 5767:
-		{
-			FillMem(pCryGame, 0x21A00E, code, sizeof code);
-			FillMem(pCryGame, 0x21A401, code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryGame, 0x21A3CE, code, sizeof code);
-			FillMem(pCryGame, 0x21A7C1, code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryGame, 0x22034F, code, sizeof code);
-			FillMem(pCryGame, 0x220789, code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryGame, 0x22029A, code, sizeof code);
-			FillMem(pCryGame, 0x2206E2, code, sizeof code);
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCryGame, 0x22C35E, code, sizeof code);
-			FillMem(pCryGame, 0x22C7A2, code, sizeof code);
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCryGame, 0x23936E, code, sizeof code);
-			FillMem(pCryGame, 0x2397B2, code, sizeof code);
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCryGame, 0x22CEAE, code, sizeof code);
-			FillMem(pCryGame, 0x22D2F2, code, sizeof code);
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCryGame, 0x22C9CE, code, sizeof code);
-			FillMem(pCryGame, 0x22CE12, code, sizeof code);
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCryGame, 0x22CDCE, code, sizeof code);
-			FillMem(pCryGame, 0x22D212, code, sizeof code);
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCryGame, 0x22E64E, code, sizeof code);
-			FillMem(pCryGame, 0x22EA92, code, sizeof code);
-			break;
-		}
+		{ 5767, 0x21A00E, sizeof code, code },
+		{ 5767, 0x21A401, sizeof code, code },
+		{ 5879, 0x21A3CE, sizeof code, code },
+		{ 5879, 0x21A7C1, sizeof code, code },
+		{ 6115, 0x22034F, sizeof code, code },
+		{ 6115, 0x220789, sizeof code, code },
+		{ 6156, 0x22029A, sizeof code, code },
+		{ 6156, 0x2206E2, sizeof code, code },
+		{ 6527, 0x22C35E, sizeof code, code },
+		{ 6527, 0x22C7A2, sizeof code, code },
+		{ 6566, 0x23936E, sizeof code, code },
+		{ 6566, 0x2397B2, sizeof code, code },
+		{ 6586, 0x22CEAE, sizeof code, code },
+		{ 6586, 0x22D2F2, sizeof code, code },
+		{ 6627, 0x22C9CE, sizeof code, code },
+		{ 6627, 0x22CE12, sizeof code, code },
+		{ 6670, 0x22CDCE, sizeof code, code },
+		{ 6670, 0x22D212, sizeof code, code },
+		{ 6729, 0x22E64E, sizeof code, code },
+		{ 6729, 0x22EA92, sizeof code, code },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -616,74 +377,38 @@ void MemoryPatch::CryGame::EnableDX10Menu(void* pCryGame, int gameBuild)
  *
  * This is both server-side and client-side patch.
  */
-void MemoryPatch::CryNetwork::EnablePreordered(void* pCryNetwork, int gameBuild)
+void MemoryPatch::CryNetwork::EnablePreordered(Batch& batch, int gameBuild)
 {
-	unsigned char code[] = {
 #ifdef BUILD_64BIT
+	static const unsigned char code[] = {
 		0xC6, 0x83, 0x70, 0xFA, 0x00, 0x00, 0x01  // mov byte ptr ds:[rbx + 0xFA70], 0x1
+	};
+
+	static const unsigned char code5879[] = {
+		0xC6, 0x83, 0x68, 0xFA, 0x00, 0x00, 0x01  // mov byte ptr ds:[rbx + 0xFA68], 0x1
+	};
 #else
+	static const unsigned char code[] = {
 		0xC6, 0x83, 0xC8, 0xF3, 0x00, 0x00, 0x01  // mov byte ptr ds:[ebx + 0xF3C8], 0x1
-#endif
 	};
+#endif
 
-	switch (gameBuild)
-	{
+	// Crysis Wars does not have pre-ordered version
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCryNetwork, 0x17F0C7, code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			code[2] = 0x68;  // 0xFA68 instead of 0xFA70
-
-			FillMem(pCryNetwork, 0x1765F0, code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryNetwork, 0x17C077, code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryNetwork, 0x17C377, code, sizeof code);
-			break;
-		}
+		{ 5767, 0x17F0C7, sizeof code, code },
+		{ 5879, 0x1765F0, sizeof code5879, code5879 },
+		{ 6115, 0x17C077, sizeof code, code },
+		{ 6156, 0x17C377, sizeof code, code },
 #else
-		case 5767:
-		{
-			FillMem(pCryNetwork, 0x42C10, code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCryNetwork, 0x412FD, code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCryNetwork, 0x430A8, code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCryNetwork, 0x43188, code, sizeof code);
-			break;
-		}
+		{ 5767, 0x42C10, sizeof code, code },
+		{ 5879, 0x412FD, sizeof code, code },
+		{ 6115, 0x430A8, sizeof code, code },
+		{ 6156, 0x43188, sizeof code, code },
 #endif
-		case 6527:
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars does not have pre-ordered version
-			break;
-		}
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
@@ -691,181 +416,67 @@ void MemoryPatch::CryNetwork::EnablePreordered(void* pCryNetwork, int gameBuild)
  *
  * This is a server-side patch.
  */
-void MemoryPatch::CryNetwork::AllowSameCDKeys(void* pCryNetwork, int gameBuild)
+void MemoryPatch::CryNetwork::AllowSameCDKeys(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0xE4858, 0x47);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0xE5628, 0x47);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0xE0188, 0x47);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0xE0328, 0x47);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0xE9034, 0x6B);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryNetwork, 0xE0838, 0x47);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0xDFE48, 0x47);
-			break;
-		}
+		{ 5767, 0xE4858, 0x47, NULL },
+		{ 5879, 0xE5628, 0x47, NULL },
+		{ 6115, 0xE0188, 0x47, NULL },
+		{ 6156, 0xE0328, 0x47, NULL },
+		{ 6566, 0xE9034, 0x6B, NULL },
+		{ 6586, 0xE0838, 0x47, NULL },
+		{ 6627, 0xDFE48, 0x47, NULL },
+		{ 6670, 0xDFE48, 0x47, NULL },
+		{ 6729, 0xDFE48, 0x47, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x608CE, 0x4);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x5DE79, 0x4);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x60EF2, 0x4);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x606A5, 0x4);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryNetwork, 0x60768, 0x4);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0x73F90, 0x4);
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		{
-			FillNop(pCryNetwork, 0x60CFE, 0x4);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x60CF9, 0x4);
-			break;
-		}
+		{ 5767, 0x608CE, 0x4, NULL },
+		{ 5879, 0x5DE79, 0x4, NULL },
+		{ 6115, 0x60EF2, 0x4, NULL },
+		{ 6156, 0x606A5, 0x4, NULL },
+		{ 6527, 0x60768, 0x4, NULL },
+		{ 6566, 0x73F90, 0x4, NULL },
+		{ 6586, 0x60CFE, 0x4, NULL },
+		{ 6627, 0x60CFE, 0x4, NULL },
+		{ 6670, 0x60CFE, 0x4, NULL },
+		{ 6729, 0x60CF9, 0x4, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
  * Allows connecting to Internet servers without GameSpy account.
  */
-void MemoryPatch::CryNetwork::FixInternetConnect(void* pCryNetwork, int gameBuild)
+void MemoryPatch::CryNetwork::FixInternetConnect(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x18C716, 0x18);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x184136, 0x18);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x189596, 0x18);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x189896, 0x18);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0x19602B, 0x18);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryNetwork, 0x18B0A6, 0x18);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x18B0B6, 0x18);
-			break;
-		}
+		{ 5767, 0x18C716, 0x18, NULL },
+		{ 5879, 0x184136, 0x18, NULL },
+		{ 6115, 0x189596, 0x18, NULL },
+		{ 6156, 0x189896, 0x18, NULL },
+		{ 6566, 0x19602B, 0x18, NULL },
+		{ 6586, 0x18B0A6, 0x18, NULL },
+		{ 6627, 0x18B0B6, 0x18, NULL },
+		{ 6670, 0x18B0B6, 0x18, NULL },
+		{ 6729, 0x18B0B6, 0x18, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x3F4B5, 0xD);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x3DBCC, 0xD);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x3FA9C, 0xD);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x3FB7C, 0xD);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryNetwork, 0x3FB77, 0xD);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0x50892, 0xD);
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x3FF87, 0xD);
-			break;
-		}
+		{ 5767, 0x3F4B5, 0xD, NULL },
+		{ 5879, 0x3DBCC, 0xD, NULL },
+		{ 6115, 0x3FA9C, 0xD, NULL },
+		{ 6156, 0x3FB7C, 0xD, NULL },
+		{ 6527, 0x3FB77, 0xD, NULL },
+		{ 6566, 0x50892, 0xD, NULL },
+		{ 6586, 0x3FF87, 0xD, NULL },
+		{ 6627, 0x3FF87, 0xD, NULL },
+		{ 6670, 0x3FF87, 0xD, NULL },
+		{ 6729, 0x3FF87, 0xD, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
@@ -873,26 +484,26 @@ void MemoryPatch::CryNetwork::FixInternetConnect(void* pCryNetwork, int gameBuil
  *
  * Both client and server are affected. Although server is much less prone to crashing. This patch fixes both.
  */
-void MemoryPatch::CryNetwork::FixFileCheckCrash(void* pCryNetwork, int gameBuild)
+void MemoryPatch::CryNetwork::FixFileCheckCrash(Batch& batch, int gameBuild)
 {
 #ifdef BUILD_64BIT
-	const unsigned char codeA[] = {
+	static const unsigned char codeA[] = {
 		0x48, 0x89, 0x0A,  // mov qword ptr ds:[rdx], rcx
 		0x90               // nop
 	};
 
-	const unsigned char codeB[] = {
+	static const unsigned char codeB[] = {
 		0x48, 0x89, 0x4A, 0x08  // mov qword ptr ds:[rdx+0x8], rcx
 	};
 #else
-	const unsigned char clientCode[] = {
+	static const unsigned char clientCode[] = {
 		0x8B, 0x4D, 0xC0,  // mov ecx, dword ptr ss:[ebp-0x40]
 		0xFF, 0x49, 0xF4,  // dec dword ptr ds:[ecx-0xC]
 		0x8B, 0x4D, 0xBC,  // mov ecx, dword ptr ss:[ebp-0x44]
 		0x89, 0x4D, 0xC0   // mov dword ptr ss:[ebp-0x40], ecx
 	};
 
-	const unsigned char serverCode[] = {
+	static const unsigned char serverCode[] = {
 		0x90,              // nop
 		0x90,              // nop
 		0xEB, 0x02,        // jmp -------------------------------+
@@ -907,211 +518,108 @@ void MemoryPatch::CryNetwork::FixFileCheckCrash(void* pCryNetwork, int gameBuild
 	};
 #endif
 
-	switch (gameBuild)
-	{
+	// the first half of each build is the client, the second half is the server
+	// Crysis 1.1 does not have file check
+
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			// client
-			FillMem(pCryNetwork, 0x1540C1, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x1540D9, codeB, sizeof codeB);
-			// server
-			FillMem(pCryNetwork, 0x154411, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x154429, codeB, sizeof codeB);
-			break;
-		}
-		case 5879:
-		{
-			// Crysis 1.1 does not have file check
-			break;
-		}
-		case 6115:
-		{
-			// client
-			FillMem(pCryNetwork, 0x14F151, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x14F169, codeB, sizeof codeB);
-			// server
-			FillMem(pCryNetwork, 0x14F481, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x14F499, codeB, sizeof codeB);
-			break;
-		}
-		case 6156:
-		{
-			// client
-			FillMem(pCryNetwork, 0x14F5B1, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x14F5C9, codeB, sizeof codeB);
-			// server
-			FillMem(pCryNetwork, 0x14F8E1, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x14F8F9, codeB, sizeof codeB);
-			break;
-		}
-		case 6566:
-		{
-			// client
-			FillMem(pCryNetwork, 0x158991, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x1589A9, codeB, sizeof codeB);
-			// server
-			FillMem(pCryNetwork, 0x158CC1, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x158CD9, codeB, sizeof codeB);
-			break;
-		}
-		case 6586:
-		{
-			// client
-			FillMem(pCryNetwork, 0x151571, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x151589, codeB, sizeof codeB);
-			// server
-			FillMem(pCryNetwork, 0x1518A1, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x1518B9, codeB, sizeof codeB);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// client
-			FillMem(pCryNetwork, 0x151301, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x151319, codeB, sizeof codeB);
-			// server
-			FillMem(pCryNetwork, 0x151641, codeA, sizeof codeA);
-			FillMem(pCryNetwork, 0x151659, codeB, sizeof codeB);
-			break;
-		}
+		{ 5767, 0x1540C1, sizeof codeA, codeA },
+		{ 5767, 0x1540D9, sizeof codeB, codeB },
+		{ 5767, 0x154411, sizeof codeA, codeA },
+		{ 5767, 0x154429, sizeof codeB, codeB },
+		{ 6115, 0x14F151, sizeof codeA, codeA },
+		{ 6115, 0x14F169, sizeof codeB, codeB },
+		{ 6115, 0x14F481, sizeof codeA, codeA },
+		{ 6115, 0x14F499, sizeof codeB, codeB },
+		{ 6156, 0x14F5B1, sizeof codeA, codeA },
+		{ 6156, 0x14F5C9, sizeof codeB, codeB },
+		{ 6156, 0x14F8E1, sizeof codeA, codeA },
+		{ 6156, 0x14F8F9, sizeof codeB, codeB },
+		{ 6566, 0x158991, sizeof codeA, codeA },
+		{ 6566, 0x1589A9, sizeof codeB, codeB },
+		{ 6566, 0x158CC1, sizeof codeA, codeA },
+		{ 6566, 0x158CD9, sizeof codeB, codeB },
+		{ 6586, 0x151571, sizeof codeA, codeA },
+		{ 6586, 0x151589, sizeof codeB, codeB },
+		{ 6586, 0x1518A1, sizeof codeA, codeA },
+		{ 6586, 0x1518B9, sizeof codeB, codeB },
+		{ 6627, 0x151301, sizeof codeA, codeA },
+		{ 6670, 0x151301, sizeof codeA, codeA },
+		{ 6729, 0x151301, sizeof codeA, codeA },
+		{ 6627, 0x151319, sizeof codeB, codeB },
+		{ 6670, 0x151319, sizeof codeB, codeB },
+		{ 6729, 0x151319, sizeof codeB, codeB },
+		{ 6627, 0x151641, sizeof codeA, codeA },
+		{ 6670, 0x151641, sizeof codeA, codeA },
+		{ 6729, 0x151641, sizeof codeA, codeA },
+		{ 6627, 0x151659, sizeof codeB, codeB },
+		{ 6670, 0x151659, sizeof codeB, codeB },
+		{ 6729, 0x151659, sizeof codeB, codeB },
 #else
-		case 5767:
-		{
-			// client
-			FillNop(pCryNetwork, 0x49E66, 0xC);
-			FillMem(pCryNetwork, 0x49EB5, clientCode, sizeof clientCode);
-			// server
-			FillNop(pCryNetwork, 0x49A7F, 0xC);
-			FillMem(pCryNetwork, 0x30D62, serverCode, sizeof serverCode);
-			break;
-		}
-		case 5879:
-		{
-			// Crysis 1.1 does not have file check
-			break;
-		}
-		case 6115:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A268, 0xC);
-			FillMem(pCryNetwork, 0x4A2B7, clientCode, sizeof clientCode);
-			// server
-			FillNop(pCryNetwork, 0x49E81, 0xC);
-			FillMem(pCryNetwork, 0x30E1C, serverCode, sizeof serverCode);
-			break;
-		}
-		case 6156:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A34F, 0xC);
-			FillMem(pCryNetwork, 0x4A39E, clientCode, sizeof clientCode);
-			// server
-			FillNop(pCryNetwork, 0x49F68, 0xC);
-			FillMem(pCryNetwork, 0x30E7B, serverCode, sizeof serverCode);
-			break;
-		}
-		case 6527:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A361, 0xC);
-			FillMem(pCryNetwork, 0x4A3B0, clientCode, sizeof clientCode);
-			// server
-			FillNop(pCryNetwork, 0x49F7A, 0xC);
-			FillMem(pCryNetwork, 0x31123, serverCode, sizeof serverCode);
-			break;
-		}
-		case 6566:
-		{
-			// client
-			FillNop(pCryNetwork, 0x5B3A6, 0xC);
-			FillMem(pCryNetwork, 0x5B3F5, clientCode, sizeof clientCode);
-			// server
-			FillNop(pCryNetwork, 0x5ADE1, 0xC);
-			FillMem(pCryNetwork, 0x3D633, serverCode, sizeof serverCode);
-			break;
-		}
-		case 6586:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A9B5, 0xC);
-			FillMem(pCryNetwork, 0x4AA04, clientCode, sizeof clientCode);
-			// server
-			FillNop(pCryNetwork, 0x4A3CB, 0xC);
-			FillMem(pCryNetwork, 0x31333, serverCode, sizeof serverCode);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// client
-			FillNop(pCryNetwork, 0x4A9B5, 0xC);
-			FillMem(pCryNetwork, 0x4AA04, clientCode, sizeof clientCode);
-			// server
-			FillNop(pCryNetwork, 0x4A3CB, 0xC);
-			FillMem(pCryNetwork, 0x3141A, serverCode, sizeof serverCode);
-			break;
-		}
+		{ 5767, 0x49E66, 0xC, NULL },
+		{ 5767, 0x49EB5, sizeof clientCode, clientCode },
+		{ 5767, 0x49A7F, 0xC, NULL },
+		{ 5767, 0x30D62, sizeof serverCode, serverCode },
+		{ 6115, 0x4A268, 0xC, NULL },
+		{ 6115, 0x4A2B7, sizeof clientCode, clientCode },
+		{ 6115, 0x49E81, 0xC, NULL },
+		{ 6115, 0x30E1C, sizeof serverCode, serverCode },
+		{ 6156, 0x4A34F, 0xC, NULL },
+		{ 6156, 0x4A39E, sizeof clientCode, clientCode },
+		{ 6156, 0x49F68, 0xC, NULL },
+		{ 6156, 0x30E7B, sizeof serverCode, serverCode },
+		{ 6527, 0x4A361, 0xC, NULL },
+		{ 6527, 0x4A3B0, sizeof clientCode, clientCode },
+		{ 6527, 0x49F7A, 0xC, NULL },
+		{ 6527, 0x31123, sizeof serverCode, serverCode },
+		{ 6566, 0x5B3A6, 0xC, NULL },
+		{ 6566, 0x5B3F5, sizeof clientCode, clientCode },
+		{ 6566, 0x5ADE1, 0xC, NULL },
+		{ 6566, 0x3D633, sizeof serverCode, serverCode },
+		{ 6586, 0x4A9B5, 0xC, NULL },
+		{ 6586, 0x4AA04, sizeof clientCode, clientCode },
+		{ 6586, 0x4A3CB, 0xC, NULL },
+		{ 6586, 0x31333, sizeof serverCode, serverCode },
+		{ 6627, 0x4A9B5, 0xC, NULL },
+		{ 6670, 0x4A9B5, 0xC, NULL },
+		{ 6729, 0x4A9B5, 0xC, NULL },
+		{ 6627, 0x4AA04, sizeof clientCode, clientCode },
+		{ 6670, 0x4AA04, sizeof clientCode, clientCode },
+		{ 6729, 0x4AA04, sizeof clientCode, clientCode },
+		{ 6627, 0x4A3CB, 0xC, NULL },
+		{ 6670, 0x4A3CB, 0xC, NULL },
+		{ 6729, 0x4A3CB, 0xC, NULL },
+		{ 6627, 0x3141A, sizeof serverCode, serverCode },
+		{ 6670, 0x3141A, sizeof serverCode, serverCode },
+		{ 6729, 0x3141A, sizeof serverCode, serverCode },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
  * Disables creation of the "server_profile.txt" file.
  */
-void MemoryPatch::CryNetwork::DisableServerProfile(void* pCryNetwork, int gameBuild)
+void MemoryPatch::CryNetwork::DisableServerProfile(Batch& batch, int gameBuild)
 {
 #ifdef BUILD_64BIT
 	// already disabled in 64-bit version
 #else
-	switch (gameBuild)
-	{
-		case 5767:
-		{
-			FillNop(pCryNetwork, 0x9F435, 0x5);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryNetwork, 0x9CA81, 0x5);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryNetwork, 0x9C665, 0x5);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryNetwork, 0x9BE2E, 0x5);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryNetwork, 0x9BEE6, 0x5);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryNetwork, 0xB3419, 0x5);
-			break;
-		}
-		case 6586:
-		case 6627:
-		case 6670:
-		{
-			FillNop(pCryNetwork, 0x9C4DC, 0x5);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCryNetwork, 0x9C4D7, 0x5);
-			break;
-		}
-	}
+	static const Patch patches[] = {
+		{ 5767, 0x9F435, 0x5, NULL },
+		{ 5879, 0x9CA81, 0x5, NULL },
+		{ 6115, 0x9C665, 0x5, NULL },
+		{ 6156, 0x9BE2E, 0x5, NULL },
+		{ 6527, 0x9BEE6, 0x5, NULL },
+		{ 6566, 0xB3419, 0x5, NULL },
+		{ 6586, 0x9C4DC, 0x5, NULL },
+		{ 6627, 0x9C4DC, 0x5, NULL },
+		{ 6670, 0x9C4DC, 0x5, NULL },
+		{ 6729, 0x9C4D7, 0x5, NULL },
+	};
+
+	AddPatches(batch, gameBuild, patches);
 #endif
 }
 
@@ -1122,136 +630,50 @@ void MemoryPatch::CryNetwork::DisableServerProfile(void* pCryNetwork, int gameBu
 /**
  * Disables the SecuROM crap in 64-bit CrySystem DLL.
  */
-void MemoryPatch::CrySystem::RemoveSecuROM(void* pCrySystem, int gameBuild)
+void MemoryPatch::CrySystem::RemoveSecuROM(Batch& batch, int gameBuild)
 {
 #ifdef BUILD_64BIT
-	switch (gameBuild)
-	{
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x4659E, 0x16);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x47B6E, 0x16);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x46FFD, 0x16);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x470B9, 0x16);
-			break;
-		}
-		case 6566:
-		case 6586:
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars has no SecuROM crap in its CrySystem DLL
-			break;
-		}
-	}
+	// Crysis Wars has no SecuROM crap in its CrySystem DLL
+	static const Patch patches[] = {
+		{ 5767, 0x4659E, 0x16, NULL },
+		{ 5879, 0x47B6E, 0x16, NULL },
+		{ 6115, 0x46FFD, 0x16, NULL },
+		{ 6156, 0x470B9, 0x16, NULL },
+	};
+
+	AddPatches(batch, gameBuild, patches);
 #endif
 }
 
 /**
  * Allows Very High settings in DX9 mode.
  */
-void MemoryPatch::CrySystem::AllowDX9VeryHighSpec(void* pCrySystem, int gameBuild)
+void MemoryPatch::CrySystem::AllowDX9VeryHighSpec(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	// Crysis Wars 1.4+ allows Very High settings in DX9 mode
+
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x45C31, 0x54);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x47201, 0x54);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x46690, 0x54);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x4674C, 0x54);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x4D7B5, 0x54);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x47DBB, 0x54);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x4A90B, 0x54);
-			break;
-		}
+		{ 5767, 0x45C31, 0x54, NULL },
+		{ 5879, 0x47201, 0x54, NULL },
+		{ 6115, 0x46690, 0x54, NULL },
+		{ 6156, 0x4674C, 0x54, NULL },
+		{ 6566, 0x4D7B5, 0x54, NULL },
+		{ 6586, 0x47DBB, 0x54, NULL },
+		{ 6627, 0x4A90B, 0x54, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x59F08, 0x4B);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x5A488, 0x4B);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x5A268, 0x4B);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x59DA8, 0x4B);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCrySystem, 0x5A778, 0x4B);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x5D1A9, 0x4B);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x5A659, 0x4B);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x5B5E9, 0x4B);
-			break;
-		}
+		{ 5767, 0x59F08, 0x4B, NULL },
+		{ 5879, 0x5A488, 0x4B, NULL },
+		{ 6115, 0x5A268, 0x4B, NULL },
+		{ 6156, 0x59DA8, 0x4B, NULL },
+		{ 6527, 0x5A778, 0x4B, NULL },
+		{ 6566, 0x5D1A9, 0x4B, NULL },
+		{ 6586, 0x5A659, 0x4B, NULL },
+		{ 6627, 0x5B5E9, 0x4B, NULL },
 #endif
-		case 6670:
-		case 6729:
-		{
-			// Crysis Wars 1.4+ allows Very High settings in DX9 mode
-			break;
-		}
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
@@ -1259,252 +681,144 @@ void MemoryPatch::CrySystem::AllowDX9VeryHighSpec(void* pCrySystem, int gameBuil
  *
  * Note that the first check if any instance is already running is normally done in launcher.
  */
-void MemoryPatch::CrySystem::AllowMultipleInstances(void* pCrySystem, int gameBuild)
+void MemoryPatch::CrySystem::AllowMultipleInstances(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x420DF, 0x68);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x436AF, 0x68);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x42B5F, 0x68);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x42BFF, 0x68);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x49D1F, 0x68);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x4420F, 0x68);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x46D5F, 0x68);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x46EEF, 0x68);
-			break;
-		}
+		{ 5767, 0x420DF, 0x68, NULL },
+		{ 5879, 0x436AF, 0x68, NULL },
+		{ 6115, 0x42B5F, 0x68, NULL },
+		{ 6156, 0x42BFF, 0x68, NULL },
+		{ 6566, 0x49D1F, 0x68, NULL },
+		{ 6586, 0x4420F, 0x68, NULL },
+		{ 6627, 0x46D5F, 0x68, NULL },
+		{ 6670, 0x46EEF, 0x68, NULL },
+		{ 6729, 0x46EEF, 0x68, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x57ABF, 0x58);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x5802F, 0x58);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x57E1F, 0x58);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x5794F, 0x58);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCrySystem, 0x5831F, 0x58);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x5AC4F, 0x58);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x5834F, 0x58);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x592DF, 0x58);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCrySystem, 0x595CF, 0x58);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x595DF, 0x58);
-			break;
-		}
+		{ 5767, 0x57ABF, 0x58, NULL },
+		{ 5879, 0x5802F, 0x58, NULL },
+		{ 6115, 0x57E1F, 0x58, NULL },
+		{ 6156, 0x5794F, 0x58, NULL },
+		{ 6527, 0x5831F, 0x58, NULL },
+		{ 6566, 0x5AC4F, 0x58, NULL },
+		{ 6586, 0x5834F, 0x58, NULL },
+		{ 6627, 0x592DF, 0x58, NULL },
+		{ 6670, 0x595CF, 0x58, NULL },
+		{ 6729, 0x595DF, 0x58, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
  * Prevents the engine from installing its own broken unhandled exceptions handler.
  */
-void MemoryPatch::CrySystem::UnhandledExceptions(void* pCrySystem, int gameBuild)
+void MemoryPatch::CrySystem::UnhandledExceptions(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x22986, 0x6);
-			FillNop(pCrySystem, 0x22992, 0x7);
-			FillNop(pCrySystem, 0x45C8A, 0x16);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x232C6, 0x6);
-			FillNop(pCrySystem, 0x232D2, 0x7);
-			FillNop(pCrySystem, 0x4725A, 0x16);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x22966, 0x6);
-			FillNop(pCrySystem, 0x22972, 0x7);
-			FillNop(pCrySystem, 0x466E9, 0x16);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x22946, 0x6);
-			FillNop(pCrySystem, 0x22952, 0x7);
-			FillNop(pCrySystem, 0x467A5, 0x16);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x298AE, 0x6);
-			FillNop(pCrySystem, 0x298BA, 0x7);
-			FillNop(pCrySystem, 0x4D80E, 0x16);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x24026, 0x6);
-			FillNop(pCrySystem, 0x24032, 0x7);
-			FillNop(pCrySystem, 0x47E14, 0x16);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x25183, 0x6);
-			FillNop(pCrySystem, 0x2518F, 0x7);
-			FillNop(pCrySystem, 0x4A964, 0x16);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x253B3, 0x6);
-			FillNop(pCrySystem, 0x253BF, 0x7);
-			FillNop(pCrySystem, 0x4AAA0, 0x16);
-			break;
-		}
+		{ 5767, 0x22986, 0x6, NULL },
+		{ 5767, 0x22992, 0x7, NULL },
+		{ 5767, 0x45C8A, 0x16, NULL },
+		{ 5879, 0x232C6, 0x6, NULL },
+		{ 5879, 0x232D2, 0x7, NULL },
+		{ 5879, 0x4725A, 0x16, NULL },
+		{ 6115, 0x22966, 0x6, NULL },
+		{ 6115, 0x22972, 0x7, NULL },
+		{ 6115, 0x466E9, 0x16, NULL },
+		{ 6156, 0x22946, 0x6, NULL },
+		{ 6156, 0x22952, 0x7, NULL },
+		{ 6156, 0x467A5, 0x16, NULL },
+		{ 6566, 0x298AE, 0x6, NULL },
+		{ 6566, 0x298BA, 0x7, NULL },
+		{ 6566, 0x4D80E, 0x16, NULL },
+		{ 6586, 0x24026, 0x6, NULL },
+		{ 6586, 0x24032, 0x7, NULL },
+		{ 6586, 0x47E14, 0x16, NULL },
+		{ 6627, 0x25183, 0x6, NULL },
+		{ 6627, 0x2518F, 0x7, NULL },
+		{ 6627, 0x4A964, 0x16, NULL },
+		{ 6670, 0x253B3, 0x6, NULL },
+		{ 6729, 0x253B3, 0x6, NULL },
+		{ 6670, 0x253BF, 0x7, NULL },
+		{ 6729, 0x253BF, 0x7, NULL },
+		{ 6670, 0x4AAA0, 0x16, NULL },
+		{ 6729, 0x4AAA0, 0x16, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCrySystem, 0x182B7, 0x5);
-			FillNop(pCrySystem, 0x182C2, 0xC);
-			FillNop(pCrySystem, 0x59F58, 0x13);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCrySystem, 0x18437, 0x5);
-			FillNop(pCrySystem, 0x18442, 0xC);
-			FillNop(pCrySystem, 0x5A4D8, 0x13);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCrySystem, 0x18217, 0x5);
-			FillNop(pCrySystem, 0x18222, 0xC);
-			FillNop(pCrySystem, 0x5A2B8, 0x13);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCrySystem, 0x17D67, 0x5);
-			FillNop(pCrySystem, 0x17D72, 0xC);
-			FillNop(pCrySystem, 0x59DF8, 0x13);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCrySystem, 0x18767, 0x5);
-			FillNop(pCrySystem, 0x18772, 0xC);
-			FillNop(pCrySystem, 0x5A7C8, 0x13);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCrySystem, 0x1AD57, 0x5);
-			FillNop(pCrySystem, 0x1AD62, 0xC);
-			FillNop(pCrySystem, 0x5D1F9, 0x13);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCrySystem, 0x18A27, 0x5);
-			FillNop(pCrySystem, 0x18A32, 0xC);
-			FillNop(pCrySystem, 0x5A6A9, 0x13);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCrySystem, 0x19327, 0x5);
-			FillNop(pCrySystem, 0x19332, 0xC);
-			FillNop(pCrySystem, 0x5B639, 0x13);
-			break;
-		}
-		case 6670:
-		{
-			FillNop(pCrySystem, 0x19607, 0x5);
-			FillNop(pCrySystem, 0x19612, 0xC);
-			FillNop(pCrySystem, 0x5B8DC, 0x13);
-			break;
-		}
-		case 6729:
-		{
-			FillNop(pCrySystem, 0x19617, 0x5);
-			FillNop(pCrySystem, 0x19622, 0xC);
-			FillNop(pCrySystem, 0x5B8EC, 0x13);
-			break;
-		}
+		{ 5767, 0x182B7, 0x5, NULL },
+		{ 5767, 0x182C2, 0xC, NULL },
+		{ 5767, 0x59F58, 0x13, NULL },
+		{ 5879, 0x18437, 0x5, NULL },
+		{ 5879, 0x18442, 0xC, NULL },
+		{ 5879, 0x5A4D8, 0x13, NULL },
+		{ 6115, 0x18217, 0x5, NULL },
+		{ 6115, 0x18222, 0xC, NULL },
+		{ 6115, 0x5A2B8, 0x13, NULL },
+		{ 6156, 0x17D67, 0x5, NULL },
+		{ 6156, 0x17D72, 0xC, NULL },
+		{ 6156, 0x59DF8, 0x13, NULL },
+		{ 6527, 0x18767, 0x5, NULL },
+		{ 6527, 0x18772, 0xC, NULL },
+		{ 6527, 0x5A7C8, 0x13, NULL },
+		{ 6566, 0x1AD57, 0x5, NULL },
+		{ 6566, 0x1AD62, 0xC, NULL },
+		{ 6566, 0x5D1F9, 0x13, NULL },
+		{ 6586, 0x18A27, 0x5, NULL },
+		{ 6586, 0x18A32, 0xC, NULL },
+		{ 6586, 0x5A6A9, 0x13, NULL },
+		{ 6627, 0x19327, 0x5, NULL },
+		{ 6627, 0x19332, 0xC, NULL },
+		{ 6627, 0x5B639, 0x13, NULL },
+		{ 6670, 0x19607, 0x5, NULL },
+		{ 6670, 0x19612, 0xC, NULL },
+		{ 6670, 0x5B8DC, 0x13, NULL },
+		{ 6729, 0x19617, 0x5, NULL },
+		{ 6729, 0x19622, 0xC, NULL },
+		{ 6729, 0x5B8EC, 0x13, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 /**
  * Hooks CryEngine CPU detection.
  */
-void MemoryPatch::CrySystem::HookCPUDetect(void* pCrySystem, int gameBuild, void (*handler)(CPUInfo* info, ISystem* pSystem))
+void MemoryPatch::CrySystem::HookCPUDetect(Batch& batch, int gameBuild, void (*handler)(CPUInfo* info, ISystem* pSystem))
 {
+	static const PatchSite sites[] = {
+#ifdef BUILD_64BIT
+		{ 5767, 0x45851 },
+		{ 5879, 0x46E21 },
+		{ 6115, 0x462B0 },
+		{ 6156, 0x4636C },
+		{ 6566, 0x4D3C8 },
+		{ 6586, 0x479CE },
+		{ 6627, 0x4A51E },
+		{ 6670, 0x4A6AE },
+		{ 6729, 0x4A6AE },
+#else
+		{ 5767, 0x59CD7 },
+		{ 5879, 0x5A257 },
+		{ 6115, 0x5A037 },
+		{ 6156, 0x59B77 },
+		{ 6527, 0x5A547 },
+		{ 6566, 0x5CFC7 },
+		{ 6586, 0x5A477 },
+		{ 6627, 0x5B407 },
+		{ 6670, 0x5B6F7 },
+		{ 6729, 0x5B707 },
+#endif
+	};
+
+	const std::size_t offset = FindPatchSite(gameBuild, sites);
+
+	if (!offset)
+	{
+		return;
+	}
+
 	unsigned char code[] = {
 #ifdef BUILD_64BIT
 		0x48, 0x89, 0x85, 0x28, 0x06, 0x00, 0x00,                    // mov qword ptr ss:[rbp+0x628], rax
@@ -1547,112 +861,53 @@ void MemoryPatch::CrySystem::HookCPUDetect(void* pCrySystem, int gameBuild, void
 	std::memcpy(&code[9], &handler, 4);
 #endif
 
-	switch (gameBuild)
-	{
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCrySystem, 0x45851, &code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCrySystem, 0x46E21, &code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCrySystem, 0x462B0, &code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCrySystem, 0x4636C, &code, sizeof code);
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x4D3C8, &code, sizeof code);
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCrySystem, 0x479CE, &code, sizeof code);
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCrySystem, 0x4A51E, &code, sizeof code);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			code[3] = 0x30;  // 0x630 instead of 0x628
-
-			FillMem(pCrySystem, 0x4A6AE, &code, sizeof code);
-			break;
-		}
-#else
-		case 5767:
-		{
-			FillMem(pCrySystem, 0x59CD7, &code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCrySystem, 0x5A257, &code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCrySystem, 0x5A037, &code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCrySystem, 0x59B77, &code, sizeof code);
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCrySystem, 0x5A547, &code, sizeof code);
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x5CFC7, &code, sizeof code);
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCrySystem, 0x5A477, &code, sizeof code);
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCrySystem, 0x5B407, &code, sizeof code);
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCrySystem, 0x5B6F7, &code, sizeof code);
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCrySystem, 0x5B707, &code, sizeof code);
-			break;
-		}
-#endif
+	if (gameBuild == 6670 || gameBuild == 6729)
+	{
+		code[3] = 0x30;  // 0x630 instead of 0x628
 	}
+#endif
+
+	batch.FillMem(offset, code, sizeof code);
 }
 
 /**
  * Hooks CryEngine fatal error handler.
  */
-void MemoryPatch::CrySystem::HookError(void* pCrySystem, int gameBuild, void (*handler)(const char* format, va_list args))
+void MemoryPatch::CrySystem::HookError(Batch& batch, int gameBuild, void (*handler)(const char* format, va_list args))
 {
+	static const PatchSite sites[] = {
+#ifdef BUILD_64BIT
+		{ 5767, 0x52180 },
+		{ 5879, 0x53850 },
+		{ 6115, 0x52D50 },
+		{ 6156, 0x52D00 },
+		{ 6566, 0x59A90 },
+		{ 6586, 0x543F0 },
+		{ 6627, 0x570E0 },
+		{ 6670, 0x571A0 },
+		{ 6729, 0x571A0 },
+#else
+		{ 5767, 0x655C0 },
+		{ 5879, 0x65C50 },
+		{ 6115, 0x65920 },
+		{ 6156, 0x63290 },
+		{ 6527, 0x63F90 },
+		{ 6566, 0x668A0 },
+		{ 6586, 0x63C90 },
+		{ 6627, 0x64C20 },
+		{ 6670, 0x64D30 },
+		{ 6729, 0x64D40 },
+#endif
+	};
+
+	const std::size_t offset = FindPatchSite(gameBuild, sites);
+
+	if (!offset)
+	{
+		return;
+	}
+
 	// convert thiscall into a normal function call
 	// and call our handler
 #ifdef BUILD_64BIT
@@ -1685,102 +940,60 @@ void MemoryPatch::CrySystem::HookError(void* pCrySystem, int gameBuild, void (*h
 	std::memcpy(&code[11], &handler, 4);
 #endif
 
-	switch (gameBuild)
+	batch.FillMem(offset, code, sizeof code);
+}
+
+/**
+ * Redirects CryEngine memory manager to our functions.
+ *
+ * All modules allocate memory through these functions exported by CrySystem. They are located by name, so this works
+ * with any game build. The original functions are overwritten with a jump, so even callers that already resolved them
+ * are redirected.
+ */
+void MemoryPatch::CrySystem::HookMemoryManager(Batch& batch, const MemoryManager& hooks)
+{
+	const struct { const char* name; const void* handler; } exports[] = {
+		{ "CryMalloc", &hooks.pMalloc },
+		{ "CryRealloc", &hooks.pRealloc },
+		{ "CryFree", &hooks.pFree },
+		{ "CryGetMemSize", &hooks.pGetMemSize },
+	};
+
+	void* functions[sizeof exports / sizeof exports[0]];
+
+	// all or nothing
+	for (unsigned int i = 0; i < (sizeof exports / sizeof exports[0]); i++)
 	{
-#ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillMem(pCrySystem, 0x52180, &code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCrySystem, 0x53850, &code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCrySystem, 0x52D50, &code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCrySystem, 0x52D00, &code, sizeof code);
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x59A90, &code, sizeof code);
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCrySystem, 0x543F0, &code, sizeof code);
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCrySystem, 0x570E0, &code, sizeof code);
-			break;
-		}
-		case 6670:
-		case 6729:
+		functions[i] = OS::Module::FindSymbol(batch.GetBase(), exports[i].name);
+
+		if (!functions[i])
 		{
-			FillMem(pCrySystem, 0x571A0, &code, sizeof code);
-			break;
+			throw StringTools::Error("Failed to find %s in CrySystem!", exports[i].name);
 		}
+	}
+
+	for (unsigned int i = 0; i < (sizeof exports / sizeof exports[0]); i++)
+	{
+		unsigned char code[] = {
+#ifdef BUILD_64BIT
+			0x48, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // mov rax, 0x0
 #else
-		case 5767:
-		{
-			FillMem(pCrySystem, 0x655C0, &code, sizeof code);
-			break;
-		}
-		case 5879:
-		{
-			FillMem(pCrySystem, 0x65C50, &code, sizeof code);
-			break;
-		}
-		case 6115:
-		{
-			FillMem(pCrySystem, 0x65920, &code, sizeof code);
-			break;
-		}
-		case 6156:
-		{
-			FillMem(pCrySystem, 0x63290, &code, sizeof code);
-			break;
-		}
-		case 6527:
-		{
-			FillMem(pCrySystem, 0x63F90, &code, sizeof code);
-			break;
-		}
-		case 6566:
-		{
-			FillMem(pCrySystem, 0x668A0, &code, sizeof code);
-			break;
-		}
-		case 6586:
-		{
-			FillMem(pCrySystem, 0x63C90, &code, sizeof code);
-			break;
-		}
-		case 6627:
-		{
-			FillMem(pCrySystem, 0x64C20, &code, sizeof code);
-			break;
-		}
-		case 6670:
-		{
-			FillMem(pCrySystem, 0x64D30, &code, sizeof code);
-			break;
-		}
-		case 6729:
-		{
-			FillMem(pCrySystem, 0x64D40, &code, sizeof code);
-			break;
-		}
+			0xB8, 0x00, 0x00, 0x00, 0x00,                                // mov eax, 0x0
+#endif
+			0xFF, 0xE0                                                   // jmp rax/eax
+		};
+
+#ifdef BUILD_64BIT
+		std::memcpy(&code[2], exports[i].handler, 8);
+#else
+		std::memcpy(&code[1], exports[i].handler, 4);
 #endif
+
+		const std::size_t offset = static_cast<std::size_t>(
+			static_cast<unsigned char*>(functions[i]) - static_cast<unsigned char*>(batch.GetBase())
+		);
+
+		batch.FillMem(offset, code, sizeof code);
 	}
 }
 
@@ -1793,97 +1006,34 @@ void MemoryPatch::CrySystem::HookError(void* pCrySystem, int gameBuild, void (*h
  *
  * Thanks to Guzz and Vladislav for this patch.
  */
-void MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(void* pCryRenderD3D10, int gameBuild)
+void MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(Batch& batch, int gameBuild)
 {
-	switch (gameBuild)
-	{
+	static const Patch patches[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryRenderD3D10, 0x1C5ED5, 0x4);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D10, 0x1C5DC5, 0x4);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D10, 0x1C8B65, 0x4);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D10, 0x1C8F45, 0x4);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D10, 0x1BAA25, 0x4);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D10, 0x1CA335, 0x4);
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderD3D10, 0x1CA345, 0x4);
-			break;
-		}
+		{ 5767, 0x1C5ED5, 0x4, NULL },
+		{ 5879, 0x1C5DC5, 0x4, NULL },
+		{ 6115, 0x1C8B65, 0x4, NULL },
+		{ 6156, 0x1C8F45, 0x4, NULL },
+		{ 6566, 0x1BAA25, 0x4, NULL },
+		{ 6586, 0x1CA335, 0x4, NULL },
+		{ 6627, 0x1CA345, 0x4, NULL },
+		{ 6670, 0x1CA345, 0x4, NULL },
+		{ 6729, 0x1CA345, 0x4, NULL },
 #else
-		case 5767:
-		{
-			FillNop(pCryRenderD3D10, 0x16CE00, 0x6);
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderD3D10, 0x16E390, 0x6);
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderD3D10, 0x16F470, 0x6);
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderD3D10, 0x16F3E0, 0x6);
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryRenderD3D10, 0x16F290, 0x6);
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderD3D10, 0x1798D0, 0x6);
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderD3D10, 0x16F110, 0x6);
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryRenderD3D10, 0x16F150, 0x6);
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderD3D10, 0x16F170, 0x6);
-			break;
-		}
+		{ 5767, 0x16CE00, 0x6, NULL },
+		{ 5879, 0x16E390, 0x6, NULL },
+		{ 6115, 0x16F470, 0x6, NULL },
+		{ 6156, 0x16F3E0, 0x6, NULL },
+		{ 6527, 0x16F290, 0x6, NULL },
+		{ 6566, 0x1798D0, 0x6, NULL },
+		{ 6586, 0x16F110, 0x6, NULL },
+		{ 6627, 0x16F150, 0x6, NULL },
+		{ 6670, 0x16F170, 0x6, NULL },
+		{ 6729, 0x16F170, 0x6, NULL },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1900,9 +1050,9 @@ void MemoryPatch::CryRenderD3D10::FixLowRefreshRateBug(void* pCryRenderD3D10, in
  * The 3rd FillMem disables the CNULLRenderAuxGeom::BeginFrame call in CNULLRenderer::BeginFrame.
  * The 4th FillMem disables the CNULLRenderAuxGeom::EndFrame call in CNULLRenderer::EndFrame.
  */
-void MemoryPatch::CryRenderNULL::DisableDebugRenderer(void* pCryRenderNULL, int gameBuild)
+void MemoryPatch::CryRenderNULL::DisableDebugRenderer(Batch& batch, int gameBuild)
 {
-	const unsigned char code[] = {
+	static const unsigned char code[] = {
 		0xC3,  // ret
 #ifdef BUILD_64BIT
 		0x90,  // nop
@@ -1914,165 +1064,121 @@ void MemoryPatch::CryRenderNULL::DisableDebugRenderer(void* pCryRenderNULL, int
 		0x90   // nop
 	};
 
-	unsigned int renderAuxGeomVTableOffset = 0;
+	static const Patch patches[] = {
+#ifdef BUILD_64BIT
+		{ 5767, 0xD2B9, 0x175, NULL },
+		{ 5767, 0xD473, 0x35, NULL },
+		{ 5767, 0x16BE, sizeof code, code },
+		{ 5767, 0x16D0, sizeof code, code },
+		{ 5879, 0xD489, 0x175, NULL },
+		{ 5879, 0xD393, 0x35, NULL },
+		{ 5879, 0x16CE, sizeof code, code },
+		{ 5879, 0x16E0, sizeof code, code },
+		{ 6115, 0xD049, 0x175, NULL },
+		{ 6115, 0xD203, 0x35, NULL },
+		{ 6115, 0x16BE, sizeof code, code },
+		{ 6115, 0x16D0, sizeof code, code },
+		{ 6156, 0xD379, 0x175, NULL },
+		{ 6156, 0xD533, 0x35, NULL },
+		{ 6156, 0x16CE, sizeof code, code },
+		{ 6156, 0x16E0, sizeof code, code },
+		{ 6566, 0xC332, 0x175, NULL },
+		{ 6566, 0xC4EC, 0x35, NULL },
+		{ 6566, 0x176E, sizeof code, code },
+		{ 6566, 0x1780, sizeof code, code },
+		{ 6586, 0xCFC9, 0x175, NULL },
+		{ 6586, 0xD183, 0x35, NULL },
+		{ 6586, 0x16FE, sizeof code, code },
+		{ 6586, 0x1710, sizeof code, code },
+		{ 6627, 0xD369, 0x175, NULL },
+		{ 6627, 0xD523, 0x35, NULL },
+		{ 6627, 0x16FE, sizeof code, code },
+		{ 6627, 0x1710, sizeof code, code },
+		{ 6670, 0xD0D9, 0x175, NULL },
+		{ 6729, 0xD0D9, 0x175, NULL },
+		{ 6670, 0xD293, 0x35, NULL },
+		{ 6729, 0xD293, 0x35, NULL },
+		{ 6670, 0x16FE, sizeof code, code },
+		{ 6729, 0x16FE, sizeof code, code },
+		{ 6670, 0x1710, sizeof code, code },
+		{ 6729, 0x1710, sizeof code, code },
+#else
+		{ 5767, 0x1CF3E, 0x101, NULL },
+		{ 5767, 0x1D051, 0xE, NULL },
+		{ 5767, 0x1895, sizeof code, code },
+		{ 5767, 0x18A9, sizeof code, code },
+		{ 5879, 0x1CF78, 0x101, NULL },
+		{ 5879, 0x1CEFE, 0xE, NULL },
+		{ 5879, 0x1895, sizeof code, code },
+		{ 5879, 0x18A9, sizeof code, code },
+		{ 6115, 0x1CF4F, 0x101, NULL },
+		{ 6115, 0x1D062, 0xE, NULL },
+		{ 6115, 0x1895, sizeof code, code },
+		{ 6115, 0x18A9, sizeof code, code },
+		{ 6156, 0x1CEE6, 0x101, NULL },
+		{ 6156, 0x1CFF9, 0xE, NULL },
+		{ 6156, 0x1895, sizeof code, code },
+		{ 6156, 0x18A9, sizeof code, code },
+		{ 6527, 0x1CE41, 0x101, NULL },
+		{ 6527, 0x1CF54, 0xE, NULL },
+		{ 6527, 0x189B, sizeof code, code },
+		{ 6527, 0x18AF, sizeof code, code },
+		{ 6566, 0x1D3D9, 0x10C, NULL },
+		{ 6566, 0x1D4F7, 0xE, NULL },
+		{ 6566, 0x18A0, sizeof code, code },
+		{ 6566, 0x18B4, sizeof code, code },
+		{ 6586, 0x1CF67, 0x101, NULL },
+		{ 6586, 0x1D07A, 0xE, NULL },
+		{ 6586, 0x18A0, sizeof code, code },
+		{ 6586, 0x18B4, sizeof code, code },
+		{ 6627, 0x1CF7C, 0x101, NULL },
+		{ 6670, 0x1CF7C, 0x101, NULL },
+		{ 6729, 0x1CF7C, 0x101, NULL },
+		{ 6627, 0x1D08F, 0xE, NULL },
+		{ 6670, 0x1D08F, 0xE, NULL },
+		{ 6729, 0x1D08F, 0xE, NULL },
+		{ 6627, 0x18AD, sizeof code, code },
+		{ 6670, 0x18AD, sizeof code, code },
+		{ 6729, 0x18AD, sizeof code, code },
+		{ 6627, 0x18C1, sizeof code, code },
+		{ 6670, 0x18C1, sizeof code, code },
+		{ 6729, 0x18C1, sizeof code, code },
+#endif
+	};
 
-	switch (gameBuild)
-	{
+	// CNULLRenderAuxGeom vtable
+	static const PatchSite vtableSites[] = {
 #ifdef BUILD_64BIT
-		case 5767:
-		{
-			FillNop(pCryRenderNULL, 0xD2B9, 0x175);
-			FillNop(pCryRenderNULL, 0xD473, 0x35);
-			FillMem(pCryRenderNULL, 0x16BE, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x16D0, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x97578;
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderNULL, 0xD489, 0x175);
-			FillNop(pCryRenderNULL, 0xD393, 0x35);
-			FillMem(pCryRenderNULL, 0x16CE, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x16E0, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x97538;
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderNULL, 0xD049, 0x175);
-			FillNop(pCryRenderNULL, 0xD203, 0x35);
-			FillMem(pCryRenderNULL, 0x16BE, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x16D0, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x974A8;
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderNULL, 0xD379, 0x175);
-			FillNop(pCryRenderNULL, 0xD533, 0x35);
-			FillMem(pCryRenderNULL, 0x16CE, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x16E0, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x97588;
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderNULL, 0xC332, 0x175);
-			FillNop(pCryRenderNULL, 0xC4EC, 0x35);
-			FillMem(pCryRenderNULL, 0x176E, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x1780, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x98918;
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderNULL, 0xCFC9, 0x175);
-			FillNop(pCryRenderNULL, 0xD183, 0x35);
-			FillMem(pCryRenderNULL, 0x16FE, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x1710, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x984B8;
-			break;
-		}
-		case 6627:
-		{
-			FillNop(pCryRenderNULL, 0xD369, 0x175);
-			FillNop(pCryRenderNULL, 0xD523, 0x35);
-			FillMem(pCryRenderNULL, 0x16FE, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x1710, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x984B8;
-			break;
-		}
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderNULL, 0xD0D9, 0x175);
-			FillNop(pCryRenderNULL, 0xD293, 0x35);
-			FillMem(pCryRenderNULL, 0x16FE, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x1710, code, sizeof code);
-			renderAuxGeomVTableOffset = 0x984B8;
-			break;
-		}
+		{ 5767, 0x97578 },
+		{ 5879, 0x97538 },
+		{ 6115, 0x974A8 },
+		{ 6156, 0x97588 },
+		{ 6566, 0x98918 },
+		{ 6586, 0x984B8 },
+		{ 6627, 0x984B8 },
+		{ 6670, 0x984B8 },
+		{ 6729, 0x984B8 },
 #else
-		case 5767:
-		{
-			FillNop(pCryRenderNULL, 0x1CF3E, 0x101);
-			FillNop(pCryRenderNULL, 0x1D051, 0xE);
-			FillMem(pCryRenderNULL, 0x1895, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18A9, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xA677C;
-			break;
-		}
-		case 5879:
-		{
-			FillNop(pCryRenderNULL, 0x1CF78, 0x101);
-			FillNop(pCryRenderNULL, 0x1CEFE, 0xE);
-			FillMem(pCryRenderNULL, 0x1895, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18A9, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xA6734;
-			break;
-		}
-		case 6115:
-		{
-			FillNop(pCryRenderNULL, 0x1CF4F, 0x101);
-			FillNop(pCryRenderNULL, 0x1D062, 0xE);
-			FillMem(pCryRenderNULL, 0x1895, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18A9, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xA6784;
-			break;
-		}
-		case 6156:
-		{
-			FillNop(pCryRenderNULL, 0x1CEE6, 0x101);
-			FillNop(pCryRenderNULL, 0x1CFF9, 0xE);
-			FillMem(pCryRenderNULL, 0x1895, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18A9, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xA778C;
-			break;
-		}
-		case 6527:
-		{
-			FillNop(pCryRenderNULL, 0x1CE41, 0x101);
-			FillNop(pCryRenderNULL, 0x1CF54, 0xE);
-			FillMem(pCryRenderNULL, 0x189B, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18AF, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xA779C;
-			break;
-		}
-		case 6566:
-		{
-			FillNop(pCryRenderNULL, 0x1D3D9, 0x10C);
-			FillNop(pCryRenderNULL, 0x1D4F7, 0xE);
-			FillMem(pCryRenderNULL, 0x18A0, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18B4, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xB078C;
-			break;
-		}
-		case 6586:
-		{
-			FillNop(pCryRenderNULL, 0x1CF67, 0x101);
-			FillNop(pCryRenderNULL, 0x1D07A, 0xE);
-			FillMem(pCryRenderNULL, 0x18A0, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18B4, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xA779C;
-			break;
-		}
-		case 6627:
-		case 6670:
-		case 6729:
-		{
-			FillNop(pCryRenderNULL, 0x1CF7C, 0x101);
-			FillNop(pCryRenderNULL, 0x1D08F, 0xE);
-			FillMem(pCryRenderNULL, 0x18AD, code, sizeof code);
-			FillMem(pCryRenderNULL, 0x18C1, code, sizeof code);
-			renderAuxGeomVTableOffset = 0xA779C;
-			break;
-		}
+		{ 5767, 0xA677C },
+		{ 5879, 0xA6734 },
+		{ 6115, 0xA6784 },
+		{ 6156, 0xA778C },
+		{ 6527, 0xA779C },
+		{ 6566, 0xB078C },
+		{ 6586, 0xA779C },
+		{ 6627, 0xA779C },
+		{ 6670, 0xA779C },
+		{ 6729, 0xA779C },
 #endif
-	}
+	};
+
+	AddPatches(batch, gameBuild, patches);
+
+	const std::size_t vtableOffset = FindPatchSite(gameBuild, vtableSites);
 
-	if (renderAuxGeomVTableOffset)
+	if (vtableOffset)
 	{
-		void** oldVTable = static_cast<void**>(ByteOffset(pCryRenderNULL, renderAuxGeomVTableOffset));
+		void** oldVTable = reinterpret_cast<void**>(static_cast<unsigned char*>(batch.GetBase()) + vtableOffset);
 
 		// CNULLRenderAuxGeom::SetRenderFlags is empty and returns nothing
 		void* emptyFunc = oldVTable[0];
@@ -2093,6 +1199,6 @@ void MemoryPatch::CryRenderNULL::DisableDebugRenderer(void* pCryRenderNULL, int
 		}
 
 		// install the new vtable
-		FillMem(pCryRenderNULL, renderAuxGeomVTableOffset, newVTable, sizeof newVTable);
+		batch.FillMem(vtableOffset, newVTable, sizeof newVTable);
 	}
 }
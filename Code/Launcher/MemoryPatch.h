@@ -1,51 +1,100 @@
 #pragma once
 
 #include <cstdarg>
+#include <cstddef>
+#include <vector>
 
 struct CPUInfo;
 struct ISystem;
 
 namespace MemoryPatch
 {
+	/**
+	 * Pending patches of a single module.
+	 *
+	 * Nothing is written until Apply is called. All patches are then written at once, so page protection is changed
+	 * only once for each range of pages and the instruction cache is flushed only once.
+	 */
+	class Batch
+	{
+		struct Write
+		{
+			std::size_t offset;
+			std::size_t dataPos;  // in m_data
+			std::size_t size;
+		};
+
+		void* m_base;
+		const char* m_name;  // of the module, also the startup timer step, so it must stay valid
+		std::vector<Write> m_writes;
+		std::vector<unsigned char> m_data;
+
+	public:
+		Batch(void* base, const char* name) : m_base(base), m_name(name)
+		{
+		}
+
+		void* GetBase() const
+		{
+			return m_base;
+		}
+
+		void FillNop(std::size_t offset, std::size_t size);
+		void FillMem(std::size_t offset, const void* data, std::size_t size);
+
+		// throws an exception on failure
+		void Apply();
+	};
+
 	namespace CryAction
 	{
-		void AllowDX9ImmersiveMultiplayer(void* pCryAction, int gameBuild);
-		void DisableGameplayStats(void* pCryAction, int gameBuild);
+		void AllowDX9ImmersiveMultiplayer(Batch& batch, int gameBuild);
+		void DisableGameplayStats(Batch& batch, int gameBuild);
 	}
 
 	namespace CryGame
 	{
-		void DisableIntros(void* pCryGame, int gameBuild);
-		void CanJoinDX10Servers(void* pCryGame, int gameBuild);
-		void EnableDX10Menu(void* pCryGame, int gameBuild);
+		void DisableIntros(Batch& batch, int gameBuild);
+		void CanJoinDX10Servers(Batch& batch, int gameBuild);
+		void EnableDX10Menu(Batch& batch, int gameBuild);
 	}
 
 	namespace CryNetwork
 	{
-		void EnablePreordered(void* pCryNetwork, int gameBuild);
-		void AllowSameCDKeys(void* pCryNetwork, int gameBuild);
-		void FixInternetConnect(void* pCryNetwork, int gameBuild);
-		void FixFileCheckCrash(void* pCryNetwork, int gameBuild);
-		void DisableServerProfile(void* pCryNetwork, int gameBuild);
+		void EnablePreordered(Batch& batch, int gameBuild);
+		void AllowSameCDKeys(Batch& batch, int gameBuild);
+		void FixInternetConnect(Batch& batch, int gameBuild);
+		void FixFileCheckCrash(Batch& batch, int gameBuild);
+		void DisableServerProfile(Batch& batch, int gameBuild);
 	}
 
 	namespace CrySystem
 	{
-		void RemoveSecuROM(void* pCrySystem, int gameBuild);
-		void AllowDX9VeryHighSpec(void* pCrySystem, int gameBuild);
-		void AllowMultipleInstances(void* pCrySystem, int gameBuild);
-		void UnhandledExceptions(void* pCrySystem, int gameBuild);
-		void HookCPUDetect(void* pCrySystem, int gameBuild, void (*handler)(CPUInfo* info, ISystem* pSystem));
-		void HookError(void* pCrySystem, int gameBuild, void (*handler)(const char* format, va_list args));
+		void RemoveSecuROM(Batch& batch, int gameBuild);
+		void AllowDX9VeryHighSpec(Batch& batch, int gameBuild);
+		void AllowMultipleInstances(Batch& batch, int gameBuild);
+		void UnhandledExceptions(Batch& batch, int gameBuild);
+		void HookCPUDetect(Batch& batch, int gameBuild, void (*handler)(CPUInfo* info, ISystem* pSystem));
+		void HookError(Batch& batch, int gameBuild, void (*handler)(const char* format, va_list args));
+
+		struct MemoryManager
+		{
+			void* (*pMalloc)(std::size_t size, std::size_t& allocated);
+			void* (*pRealloc)(void* block, std::size_t size, std::size_t& allocated);
+			std::size_t (*pFree)(void* block);
+			std::size_t (*pGetMemSize)(void* block, std::size_t size);
+		};
+
+		void HookMemoryManager(Batch& batch, const MemoryManager& hooks);
 	}
 
 	namespace CryRenderD3D10
 	{
-		void FixLowRefreshRateBug(void* pCryRenderD3D10, int gameBuild);
+		void FixLowRefreshRateBug(Batch& batch, int gameBuild);
 	}
 
 	namespace CryRenderNULL
 	{
-		void DisableDebugRenderer(void* pCryRenderNULL, int gameBuild);
+		void DisableDebugRenderer(Batch& batch, int gameBuild);
 	}
 }
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstddef>
+
+#include "OS.h"
+
+/**
+ * Bounded lock-free queue with multiple producers and multiple consumers.
+ *
+ * Based on the well-known algorithm by Dmitry Vyukov. Each cell has a sequence number that tells whether the cell is
+ * free or contains a value. No locks are taken and no memory is allocated after initialization.
+ *
+ * Values are exchanged using T::Swap, so no copies are made and any memory owned by the values is recycled.
+ */
+template<class T>
+class BoundedQueue
+{
+	struct Cell
+	{
+		volatile long sequence;
+		T value;
+	};
+
+	Cell* m_cells;
+	unsigned long m_mask;
+
+	// keep producers and consumers on separate cache lines
+	char m_padding1[64];
+	volatile long m_pushPos;
+	char m_padding2[64];
+	volatile long m_popPos;
+	char m_padding3[64];
+
+	// no copies
+	BoundedQueue(const BoundedQueue&);
+	BoundedQueue& operator=(const BoundedQueue&);
+
+	// positions wrap around, so distances must be calculated with unsigned arithmetic
+	static long Distance(long a, long b)
+	{
+		return static_cast<long>(static_cast<unsigned long>(a) - static_cast<unsigned long>(b));
+	}
+
+	static long Next(long pos, unsigned long offset = 1)
+	{
+		return static_cast<long>(static_cast<unsigned long>(pos) + offset);
+	}
+
+public:
+	BoundedQueue() : m_cells(NULL), m_mask(0), m_pushPos(0), m_popPos(0)
+	{
+	}
+
+	~BoundedQueue()
+	{
+		delete [] m_cells;
+	}
+
+	/**
+	 * Allocates the cells. Not thread-safe.
+	 *
+	 * @param capacity Maximum number of values in the queue. Rounded up to the nearest power of two.
+	 */
+	void Init(std::size_t capacity)
+	{
+		std::size_t size = 2;
+
+		while (size < capacity)
+		{
+			size *= 2;
+		}
+
+		delete [] m_cells;
+		m_cells = new Cell[size];
+		m_mask = static_cast<unsigned long>(size - 1);
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			m_cells[i].sequence = static_cast<long>(i);
+		}
+
+		m_pushPos = 0;
+		m_popPos = 0;
+	}
+
+	bool IsInitialized() const
+	{
+		return m_cells != NULL;
+	}
+
+	std::size_t GetCapacity() const
+	{
+		return (m_cells) ? static_cast<std::size_t>(m_mask) + 1 : 0;
+	}
+
+	/**
+	 * Size of the cells in bytes. Memory owned by the values is not included.
+	 */
+	std::size_t GetMemoryUsage() const
+	{
+		return this->GetCapacity() * sizeof(Cell);
+	}
+
+	/**
+	 * Moves the value into the queue.
+	 *
+	 * @return False if the queue is full. The value is left untouched in such case.
+	 */
+	bool Push(T& value)
+	{
+		long pos = m_pushPos;
+
+		for (;;)
+		{
+			Cell& cell = m_cells[pos & m_mask];
+			const long diff = Distance(cell.sequence, pos);
+
+			if (diff == 0)
+			{
+				const long previousPos = OS::Atomic::CompareExchange(&m_pushPos, Next(pos), pos);
+
+				if (previousPos == pos)
+				{
+					cell.value.Swap(value);
+
+					// publish the value
+					cell.sequence = Next(pos);
+
+					return true;
+				}
+
+				pos = previousPos;
+			}
+			else if (diff < 0)
+			{
+				// full
+				return false;
+			}
+			else
+			{
+				// another producer was faster
+				pos = m_pushPos;
+			}
+		}
+	}
+
+	/**
+	 * Moves the oldest value out of the queue.
+	 *
+	 * The previous content of the value is moved into the queue cell and reused later.
+	 *
+	 * @return False if the queue is empty.
+	 */
+	bool Pop(T& value)
+	{
+		long pos = m_popPos;
+
+		for (;;)
+		{
+			Cell& cell = m_cells[pos & m_mask];
+			const long diff = Distance(cell.sequence, Next(pos));
+
+			if (diff == 0)
+			{
+				const long previousPos = OS::Atomic::CompareExchange(&m_popPos, Next(pos), pos);
+
+				if (previousPos == pos)
+				{
+					cell.value.Swap(value);
+
+					// release the cell for the next round
+					cell.sequence = Next(pos, m_mask + 1);
+
+					return true;
+				}
+
+				pos = previousPos;
+			}
+			else if (diff < 0)
+			{
+				// empty
+				return false;
+			}
+			else
+			{
+				// another consumer was faster
+				pos = m_popPos;
+			}
+		}
+	}
+
+	/**
+	 * Approximate number of values in the queue.
+	 */
+	std::size_t GetCount() const
+	{
+		const long count = Distance(m_pushPos, m_popPos);
+
+		return (count > 0) ? static_cast<std::size_t>(count) : 0;
+	}
+
+	bool IsEmpty() const
+	{
+		return this->GetCount() == 0;
+	}
+};
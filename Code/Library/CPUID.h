@@ -19,11 +19,17 @@ struct CPUID
 		unsigned int ecx;
 		unsigned int edx;
 
-		explicit Query(unsigned int leaf)
+		explicit Query(unsigned int leaf, unsigned int subleaf = 0)
 		{
 #ifdef _MSC_VER
 			int regs[4];
+#if _MSC_VER >= 1500
+			__cpuidex(regs, leaf, subleaf);
+#else
+			// VS2005 has no __cpuidex, so leaves with subleaves cannot be queried reliably
 			__cpuid(regs, leaf);
+			static_cast<void>(subleaf);
+#endif
 
 			this->eax = regs[0];
 			this->ebx = regs[1];
@@ -34,12 +40,51 @@ struct CPUID
 			(
 				"cpuid"
 				: "=a" (this->eax), "=b" (this->ebx), "=c" (this->ecx), "=d" (this->edx)
-				: "a" (leaf), "c" (0)
+				: "a" (leaf), "c" (subleaf)
 			);
 #endif
 		}
 	};
 
+	// XCR0, which tells what register state is saved by the OS on context switches
+	static unsigned __int64 GetEnabledXSaveFeatures()
+	{
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219
+		// _xgetbv is available since VS2010 SP1, not in VS2010 RTM
+		return _xgetbv(0);
+#elif defined(_MSC_VER) && !defined(_WIN64)
+		unsigned int low;
+		unsigned int high;
+
+		__asm
+		{
+			xor ecx, ecx
+			_emit 0x0F  // xgetbv
+			_emit 0x01
+			_emit 0xD0
+			mov low, eax
+			mov high, edx
+		}
+
+		return (static_cast<unsigned __int64>(high) << 32) | low;
+#elif defined(_MSC_VER)
+		// 64-bit compilers before VS2010 SP1 have neither _xgetbv nor inline assembly
+		return 0;
+#else
+		unsigned int eax;
+		unsigned int edx;
+
+		__asm__
+		(
+			"xgetbv"
+			: "=a" (eax), "=d" (edx)
+			: "c" (0)
+		);
+
+		return (static_cast<unsigned __int64>(edx) << 32) | eax;
+#endif
+	}
+
 	enum Vendor
 	{
 		VENDOR_UNKNOWN = 0,
@@ -48,13 +93,17 @@ struct CPUID
 	};
 
 	Vendor vendor;
+	std::bitset<32> leaf_1_ecx;
 	std::bitset<32> leaf_1_edx;
+	std::bitset<32> leaf_7_ebx;
 	std::bitset<32> leaf_80000001_edx;
+	bool is_avx_enabled_by_os;
 	char brand_string[48 + 1];
 	char vendor_string[12 + 1];
 
 	SUPPRESS_STUPID_MSVC_WARNING_C4351
-	CPUID() : vendor(VENDOR_UNKNOWN), leaf_1_edx(), leaf_80000001_edx(), brand_string(), vendor_string()
+	CPUID() : vendor(VENDOR_UNKNOWN), leaf_1_ecx(), leaf_1_edx(), leaf_7_ebx(), leaf_80000001_edx(),
+	          is_avx_enabled_by_os(false), brand_string(), vendor_string()
 	{
 		Query query(0x0);
 		const unsigned int maxBasicLeaf = query.eax;
@@ -80,9 +129,25 @@ struct CPUID
 		if (maxBasicLeaf >= 0x1)
 		{
 			query = Query(0x1);
+			this->leaf_1_ecx = query.ecx;
 			this->leaf_1_edx = query.edx;
+
+			// OSXSAVE
+			if (this->leaf_1_ecx[27])
+			{
+				// XMM and YMM state
+				this->is_avx_enabled_by_os = (GetEnabledXSaveFeatures() & 0x6) == 0x6;
+			}
 		}
 
+#if !defined(_MSC_VER) || _MSC_VER >= 1500
+		if (maxBasicLeaf >= 0x7)
+		{
+			query = Query(0x7, 0);
+			this->leaf_7_ebx = query.ebx;
+		}
+#endif
+
 		query = Query(0x80000000);
 		const unsigned int maxExtendedLeaf = query.eax;
 
@@ -122,6 +187,36 @@ struct CPUID
 	{
 		return this->vendor == VENDOR_AMD && this->leaf_80000001_edx[31];
 	}
+
+	bool HasSSE3() const
+	{
+		return this->leaf_1_ecx[0];
+	}
+
+	bool HasSSSE3() const
+	{
+		return this->leaf_1_ecx[9];
+	}
+
+	bool HasSSE41() const
+	{
+		return this->leaf_1_ecx[19];
+	}
+
+	bool HasSSE42() const
+	{
+		return this->leaf_1_ecx[20];
+	}
+
+	bool HasAVX() const
+	{
+		return this->leaf_1_ecx[28] && this->is_avx_enabled_by_os;
+	}
+
+	bool HasAVX2() const
+	{
+		return this->leaf_7_ebx[5] && this->HasAVX();
+	}
 };
 
 extern const CPUID g_cpuid;
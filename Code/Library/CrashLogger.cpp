@@ -1,14 +1,23 @@
+#include <cerrno>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <winternl.h>
+#include <tlhelp32.h>
 #include <dbghelp.h>
 
 #include "Project.h"
 
 #include "CrashLogger.h"
 #include "OS.h"
+#include "PathTools.h"
+#include "PoolAllocator.h"
+#include "StringTools.h"
 
 #ifdef BUILD_64BIT
 #define ADDR_FMT "%016I64X"
@@ -36,6 +45,45 @@ static const char* BaseName(const char* name)
 	return result;
 }
 
+// the crash log file or a string
+struct Output
+{
+	std::FILE* file;
+	std::string* text;
+
+	Output() : file(NULL), text(NULL)
+	{
+	}
+};
+
+static void PrintV(Output& out, const char* format, va_list args)
+{
+	if (out.file)
+	{
+		std::vfprintf(out.file, format, args);
+	}
+	else
+	{
+		StringTools::FormatToV(*out.text, format, args);
+	}
+}
+
+static void Print(Output& out, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	PrintV(out, format, args);
+	va_end(args);
+}
+
+static void Flush(Output& out)
+{
+	if (out.file)
+	{
+		std::fflush(out.file);
+	}
+}
+
 static const char* ExceptionCodeToName(unsigned int code)
 {
 	switch (code)
@@ -65,12 +113,12 @@ static const char* ExceptionCodeToName(unsigned int code)
 	return "Unknown";
 }
 
-static void DumpExceptionInfo(std::FILE* file, const EXCEPTION_RECORD* info)
+static void DumpExceptionInfo(Output& out, const EXCEPTION_RECORD* info)
 {
 	const unsigned int code = info->ExceptionCode;
 	const std::size_t address = reinterpret_cast<std::size_t>(info->ExceptionAddress);
 
-	std::fprintf(file, "%s exception (0x%08X) at 0x" ADDR_FMT "\n", ExceptionCodeToName(code), code, address);
+	Print(out, "%s exception (0x%08X) at 0x" ADDR_FMT "\n", ExceptionCodeToName(code), code, address);
 
 	if (code == EXCEPTION_ACCESS_VIOLATION || code == EXCEPTION_IN_PAGE_ERROR)
 	{
@@ -78,29 +126,29 @@ static void DumpExceptionInfo(std::FILE* file, const EXCEPTION_RECORD* info)
 
 		switch (info->ExceptionInformation[0])
 		{
-			case 0: std::fprintf(file, "Read from 0x"  ADDR_FMT " failed\n", dataAddress); break;
-			case 1: std::fprintf(file, "Write to 0x"   ADDR_FMT " failed\n", dataAddress); break;
-			case 8: std::fprintf(file, "Execute at 0x" ADDR_FMT " failed\n", dataAddress); break;
+			case 0: Print(out, "Read from 0x"  ADDR_FMT " failed\n", dataAddress); break;
+			case 1: Print(out, "Write to 0x"   ADDR_FMT " failed\n", dataAddress); break;
+			case 8: Print(out, "Execute at 0x" ADDR_FMT " failed\n", dataAddress); break;
 		}
 	}
 
-	std::fflush(file);
+	Flush(out);
 }
 
-static void DumpMemoryUsage(std::FILE* file)
+static void DumpMemoryUsage(Output& out)
 {
 	MEMORYSTATUSEX status = {};
 	status.dwLength = sizeof status;
 
 	if (GlobalMemoryStatusEx(&status))
 	{
-		std::fprintf(file, "Physical memory = %.1f MiB (%.1f MiB available, %.1f%% used)\n",
+		Print(out, "Physical memory = %.1f MiB (%.1f MiB available, %.1f%% used)\n",
 			static_cast<double>(status.ullTotalPhys) / (1024 * 1024),
 			static_cast<double>(status.ullAvailPhys) / (1024 * 1024),
 			(100.0 * (status.ullTotalPhys - status.ullAvailPhys)) / status.ullTotalPhys
 		);
 
-		std::fprintf(file, "Virtual memory = %.1f MiB (%.1f MiB available, %.1f%% used)\n",
+		Print(out, "Virtual memory = %.1f MiB (%.1f MiB available, %.1f%% used)\n",
 			static_cast<double>(status.ullTotalVirtual) / (1024 * 1024),
 			static_cast<double>(status.ullAvailVirtual) / (1024 * 1024),
 			(100.0 * (status.ullTotalVirtual - status.ullAvailVirtual)) / status.ullTotalVirtual
@@ -108,15 +156,20 @@ static void DumpMemoryUsage(std::FILE* file)
 	}
 	else
 	{
-		std::fprintf(file, "GlobalMemoryStatusEx failed with error code %u\n", GetLastError());
+		Print(out, "GlobalMemoryStatusEx failed with error code %u\n", GetLastError());
 	}
 
-	std::fflush(file);
+	Flush(out);
+
+	if (out.file)
+	{
+		PoolAllocator::DumpStats(out.file);
+	}
 }
 
-static void DumpRegisters(std::FILE* file, const CONTEXT* context)
+static void DumpRegisters(Output& out, const CONTEXT* context)
 {
-	std::fprintf(file, "Registers:\n"
+	Print(out, "Registers:\n"
 #ifdef BUILD_64BIT
 	  "RIP: %016I64X RSP: %016I64X RBP: %016I64X EFLAGS: %08X\n"
 	  "RAX: %016I64X RBX: %016I64X RCX: %016I64X RDX: %016I64X\n"
@@ -138,15 +191,201 @@ static void DumpRegisters(std::FILE* file, const CONTEXT* context)
 #endif
 	);
 
-	std::fflush(file);
+	Flush(out);
+}
+
+// dbghelp is not thread-safe
+static OS::Mutex g_symbolMutex;
+static unsigned int g_symbolRefCount;
+
+static void RefreshSymbolModules(HANDLE process)
+{
+	typedef BOOL (__stdcall *TSymRefreshModuleList)(HANDLE);
+
+	// not available in the old dbghelp shipped with Windows XP
+	static TSymRefreshModuleList pSymRefreshModuleList = reinterpret_cast<TSymRefreshModuleList>(
+		GetProcAddress(GetModuleHandleA("dbghelp.dll"), "SymRefreshModuleList")
+	);
+
+	if (pSymRefreshModuleList)
+	{
+		pSymRefreshModuleList(process);
+	}
+}
+
+bool CrashLogger::AcquireSymbols()
+{
+	OS::LockGuard<OS::Mutex> lock(g_symbolMutex);
+
+	HANDLE process = GetCurrentProcess();
+
+	if (g_symbolRefCount > 0)
+	{
+		// modules loaded since the initialization
+		RefreshSymbolModules(process);
+
+		g_symbolRefCount++;
+
+		return true;
+	}
+
+	DWORD options = 0;
+	options |= SYMOPT_DEFERRED_LOADS;
+	options |= SYMOPT_EXACT_SYMBOLS;
+	options |= SYMOPT_FAIL_CRITICAL_ERRORS;
+	options |= SYMOPT_LOAD_LINES;
+	options |= SYMOPT_NO_PROMPTS;
+	options |= SYMOPT_UNDNAME;
+
+	SymSetOptions(options);
+
+	if (!SymInitialize(process, NULL, TRUE))
+	{
+		return false;
+	}
+
+	g_symbolRefCount = 1;
+
+	return true;
+}
+
+void CrashLogger::ReleaseSymbols()
+{
+	OS::LockGuard<OS::Mutex> lock(g_symbolMutex);
+
+	if (g_symbolRefCount > 0 && --g_symbolRefCount == 0)
+	{
+		SymCleanup(GetCurrentProcess());
+	}
+}
+
+static void GetModuleBases(std::vector<std::size_t>& bases)
+{
+	HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE, 0);
+
+	if (snapshot == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	MODULEENTRY32 entry = {};
+	entry.dwSize = sizeof entry;
+
+	for (BOOL isValid = Module32First(snapshot, &entry); isValid; isValid = Module32Next(snapshot, &entry))
+	{
+		bases.push_back(reinterpret_cast<std::size_t>(entry.modBaseAddr));
+	}
+
+	CloseHandle(snapshot);
+}
+
+// never deleted, the process may exit while the thread is still running
+static OS::Thread* g_pPreloadSymbolsThread;
+
+static void PreloadSymbolsThread(void*)
+{
+	OS::EnterBackgroundMode();
+
+	// never released, so the symbols stay loaded for the whole process lifetime
+	if (!CrashLogger::AcquireSymbols())
+	{
+		return;
+	}
+
+	std::vector<std::size_t> bases;
+	GetModuleBases(bases);
+
+	HANDLE process = GetCurrentProcess();
+
+	for (std::size_t i = 0; i < bases.size(); i++)
+	{
+		// a crash report waits for one module at most
+		CrashLogger::SymbolLock lock;
+
+		unsigned char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME] = {};
+		SYMBOL_INFO& symbol = *reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+		symbol.SizeOfStruct = sizeof(SYMBOL_INFO);
+		symbol.MaxNameLen = MAX_SYM_NAME;
+		DWORD64 symbolOffset = 0;
+
+		// symbols of each module are loaded on first use because of SYMOPT_DEFERRED_LOADS
+		SymFromAddr(process, bases[i], &symbolOffset, &symbol);
+	}
+}
+
+void CrashLogger::PreloadSymbols()
+{
+	if (g_pPreloadSymbolsThread)
+	{
+		return;
+	}
+
+	g_pPreloadSymbolsThread = new OS::Thread();
+	g_pPreloadSymbolsThread->Start(&PreloadSymbolsThread, NULL);
+}
+
+void CrashLogger::LockSymbols()
+{
+	g_symbolMutex.Lock();
+}
+
+void CrashLogger::UnlockSymbols()
+{
+	g_symbolMutex.Unlock();
+}
+
+// stack of a hanging thread copied while it was suspended
+struct StackSnapshot
+{
+	std::size_t address;
+	std::size_t size;
+	const unsigned char* data;
+};
+
+static const StackSnapshot* g_pStackSnapshot;
+
+#ifdef BUILD_64BIT
+typedef DWORD64 StackWalkAddress;
+#else
+typedef DWORD StackWalkAddress;
+#endif
+
+static BOOL __stdcall ReadStackSnapshot(HANDLE process, StackWalkAddress address, void* buffer, DWORD size,
+                                         DWORD* bytesRead)
+{
+	const StackSnapshot* snapshot = g_pStackSnapshot;
+	const std::size_t offset = static_cast<std::size_t>(address) - snapshot->address;
+
+	if (address >= snapshot->address && size <= snapshot->size && offset <= (snapshot->size - size))
+	{
+		std::memcpy(buffer, snapshot->data + offset, size);
+	}
+	else
+	{
+		// code and other memory not changed by the running thread
+		SIZE_T count = 0;
+
+		if (!ReadProcessMemory(process, reinterpret_cast<void*>(address), buffer, size, &count))
+		{
+			return FALSE;
+		}
+
+		size = static_cast<DWORD>(count);
+	}
+
+	if (bytesRead)
+	{
+		*bytesRead = size;
+	}
+
+	return TRUE;
 }
 
-static void DumpCallStack(std::FILE* file, const CONTEXT* context)
+static void DumpCallStack(Output& out, const CONTEXT* context, HANDLE thread)
 {
-	std::fprintf(file, "Callstack:\n");
+	Print(out, "Callstack:\n");
 
 	HANDLE process = GetCurrentProcess();
-	HANDLE thread = GetCurrentThread();
 
 #ifdef BUILD_64BIT
 	DWORD machine = IMAGE_FILE_MACHINE_AMD64;
@@ -172,24 +411,17 @@ static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 
 	CONTEXT localContext = *context;
 
-	DWORD options = 0;
-	options |= SYMOPT_DEFERRED_LOADS;
-	options |= SYMOPT_EXACT_SYMBOLS;
-	options |= SYMOPT_FAIL_CRITICAL_ERRORS;
-	options |= SYMOPT_LOAD_LINES;
-	options |= SYMOPT_NO_PROMPTS;
-	options |= SYMOPT_UNDNAME;
-
-	SymSetOptions(options);
-
-	if (SymInitialize(process, NULL, TRUE))
+	if (CrashLogger::AcquireSymbols())
 	{
-		while (StackWalk(machine, process, thread, &frame, &localContext, NULL,
+		CrashLogger::SymbolLock lock;
+
+		while (StackWalk(machine, process, thread, &frame, &localContext,
+		                 (g_pStackSnapshot) ? &ReadStackSnapshot : NULL,
 		                 SymFunctionTableAccess, SymGetModuleBase, NULL))
 		{
 			const std::size_t address = frame.AddrPC.Offset;
 
-			std::fprintf(file, ADDR_FMT ":", address);
+			Print(out, ADDR_FMT ":", address);
 
 			unsigned char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME] = {};
 			SYMBOL_INFO& symbol = *reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
@@ -199,11 +431,11 @@ static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 
 			if (SymFromAddr(process, address, &symbolOffset, &symbol))
 			{
-				std::fprintf(file, " %s + 0x%I64X", symbol.Name, symbolOffset);
+				Print(out, " %s + 0x%I64X", symbol.Name, symbolOffset);
 			}
 			else
 			{
-				std::fprintf(file, " ??");
+				Print(out, " ??");
 			}
 
 			IMAGEHLP_LINE line = {};
@@ -212,11 +444,11 @@ static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 
 			if (SymGetLineFromAddr(process, address, &lineOffset, &line))
 			{
-				std::fprintf(file, " (%s:%u)", line.FileName, line.LineNumber);
+				Print(out, " (%s:%u)", line.FileName, line.LineNumber);
 			}
 			else
 			{
-				std::fprintf(file, " ()");
+				Print(out, " ()");
 			}
 
 			IMAGEHLP_MODULE moduleInfo = {};
@@ -224,25 +456,25 @@ static void DumpCallStack(std::FILE* file, const CONTEXT* context)
 
 			if (SymGetModuleInfo(process, address, &moduleInfo))
 			{
-				std::fprintf(file, " in %s\n", BaseName(moduleInfo.ImageName));
+				Print(out, " in %s\n", BaseName(moduleInfo.ImageName));
 			}
 			else
 			{
-				std::fprintf(file, " in ?\n");
+				Print(out, " in ?\n");
 			}
 		}
 
-		SymCleanup(process);
+		CrashLogger::ReleaseSymbols();
 	}
 	else
 	{
-		std::fprintf(file, "SymInitialize failed with error code %u\n", GetLastError());
+		Print(out, "SymInitialize failed with error code %u\n", GetLastError());
 	}
 
-	std::fflush(file);
+	Flush(out);
 }
 
-static void DumpLoadedModules(std::FILE* file)
+static void DumpLoadedModules(Output& out)
 {
 	// old Windows SDKs don't provide complete enough definitions of all required structures
 #ifdef BUILD_64BIT
@@ -284,7 +516,7 @@ static void DumpLoadedModules(std::FILE* file)
 		modCount++;
 	}
 
-	std::fprintf(file, "Modules (%u):\n", modCount);
+	Print(out, "Modules (%u):\n", modCount);
 
 	for (LIST_ENTRY* mod = firstMod; mod != NULL;)
 	{
@@ -295,7 +527,7 @@ static void DumpLoadedModules(std::FILE* file)
 		char name[512] = {};
 		WideCharToMultiByte(CP_UTF8, 0, wideName->Buffer, wideName->Length, name, sizeof name, NULL, NULL);
 
-		std::fprintf(file, ADDR_FMT " - " ADDR_FMT " %s\n", base, base + size, name);
+		Print(out, ADDR_FMT " - " ADDR_FMT " %s\n", base, base + size, name);
 
 		LIST_ENTRY* nextMod = NULL;
 		std::size_t nextModBase = -1;
@@ -314,123 +546,431 @@ static void DumpLoadedModules(std::FILE* file)
 		mod = nextMod;
 	}
 
-	std::fflush(file);
+	Flush(out);
 }
 
-static void DumpCommandLine(std::FILE* file)
+static void DumpCommandLine(Output& out)
 {
-	std::fprintf(file, "Command line:\n");
-	std::fprintf(file, "%s\n", GetCommandLineA());
+	Print(out, "Command line:\n");
+	Print(out, "%s\n", GetCommandLineA());
 
-	std::fflush(file);
+	Flush(out);
 }
 
-static void WriteDumpHeader(std::FILE* file)
+static void WriteDumpHeader(Output& out, bool isHang)
 {
-	std::fprintf(file, "================================ CRASH DETECTED ================================\n");
-	std::fprintf(file, "%s\n", PROJECT_BANNER);
-	std::fflush(file);
+	if (isHang)
+	{
+		Print(out, "================================ HANG DETECTED =================================\n");
+	}
+	else
+	{
+		Print(out, "================================ CRASH DETECTED ================================\n");
+	}
+
+	Print(out, "%s\n", PROJECT_BANNER);
+	Flush(out);
 }
 
-static void WriteDumpFooter(std::FILE* file)
+static void WriteDumpFooter(Output& out)
 {
-	std::fprintf(file, "================================================================================\n");
-	std::fflush(file);
+	Print(out, "================================================================================\n");
+	Flush(out);
 }
 
-static void WriteCrashDump(std::FILE* file, EXCEPTION_POINTERS* exception)
+struct Report
 {
-	WriteDumpHeader(file);
+	EXCEPTION_POINTERS* exception;  // NULL if the error was detected by the CRT or the engine
+	CONTEXT* context;
+	const char* message;
+	const char* format;  // engine error
+	va_list args;
+	HANDLE thread;
+	DWORD threadID;
+};
+
+static void WriteReportInfo(Output& out, const Report& report)
+{
+	if (report.exception)
+	{
+		DumpExceptionInfo(out, report.exception->ExceptionRecord);
+	}
+	else if (report.format)
+	{
+		Print(out, "Engine error: ");
+		Flush(out);
 
-	DumpExceptionInfo(file, exception->ExceptionRecord);
-	DumpMemoryUsage(file);
-	DumpRegisters(file, exception->ContextRecord);
-	DumpCallStack(file, exception->ContextRecord);
-	DumpLoadedModules(file);
-	DumpCommandLine(file);
+		PrintV(out, report.format, report.args);
+		Print(out, "\n");
+		Flush(out);
+	}
+	else
+	{
+		Print(out, "%s\n", report.message);
+		Flush(out);
+	}
 
-	WriteDumpFooter(file);
+	DumpMemoryUsage(out);
+	DumpRegisters(out, report.context);
+	DumpCallStack(out, report.context, report.thread);
+	DumpLoadedModules(out);
+	DumpCommandLine(out);
 }
 
-static void WriteGenericErrorDump(std::FILE* file, CONTEXT* context, const char* message)
+static OS::Mutex g_mutex;
+static CrashLogger::Handler g_handler;
+
+// reserved mode
+static bool g_isReserved;
+static unsigned int g_timeout;
+static void* g_reserve;
+static OS::Thread* g_pHelperThread;  // never deleted, it waits for requests until the process exits
+static HANDLE g_requestEvent;
+static HANDLE g_doneEvent;
+static Report* g_pRequest;
+
+// minidump
+static CrashLogger::DumpType g_dumpType;
+static HANDLE g_dumpFile = INVALID_HANDLE_VALUE;
+static char g_dumpPath[MAX_PATH];
+
+// memory released before writing the report, so it does not fail when the process runs out of memory
+#define CRASH_RESERVE_SIZE (4 * 1024 * 1024)
+
+#define CRASH_HELPER_STACK_SIZE (1024 * 1024)
+
+// larger stacks are truncated in hang reports
+#define CRASH_STACK_SNAPSHOT_SIZE (1024 * 1024)
+
+#ifndef STATUS_FATAL_APP_EXIT
+#define STATUS_FATAL_APP_EXIT 0x40000015
+#endif
+
+// FILE_DISPOSITION_INFO is missing in old Windows SDKs
+struct FileDispositionInfo
+{
+	BOOLEAN deleteFile;
+};
+
+static bool SetDeleteOnClose(HANDLE file, bool isDeleted)
 {
-	WriteDumpHeader(file);
+	typedef BOOL (__stdcall *TSetFileInformationByHandle)(HANDLE, int, void*, DWORD);
 
-	std::fprintf(file, "%s\n", message);
-	std::fflush(file);
+	// not available before Windows Vista
+	static TSetFileInformationByHandle pSetFileInformationByHandle = reinterpret_cast<TSetFileInformationByHandle>(
+		GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetFileInformationByHandle")
+	);
 
-	DumpMemoryUsage(file);
-	DumpRegisters(file, context);
-	DumpCallStack(file, context);
-	DumpLoadedModules(file);
-	DumpCommandLine(file);
+	if (!pSetFileInformationByHandle)
+	{
+		return false;
+	}
 
-	WriteDumpFooter(file);
+	FileDispositionInfo info;
+	info.deleteFile = isDeleted;
+
+	const int FILE_DISPOSITION_INFO_CLASS = 4;
+
+	return pSetFileInformationByHandle(file, FILE_DISPOSITION_INFO_CLASS, &info, sizeof info) != 0;
 }
 
-static void WriteEngineErrorDump(std::FILE* file, CONTEXT* context, const char* format, va_list args)
+static bool PrepareDumpFile(const char* folder)
 {
-	WriteDumpHeader(file);
+	if (!folder)
+	{
+		return false;
+	}
+
+	SYSTEMTIME time = {};
+	GetLocalTime(&time);
 
-	std::fprintf(file, "Engine error: ");
-	std::fflush(file);
+	const std::string fileName = StringTools::Format("Crash-%04u%02u%02u-%02u%02u%02u-%u.dmp",
+		time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, GetCurrentProcessId()
+	);
+
+	const std::string path = PathTools::Join(folder, fileName);
+
+	if (path.length() >= sizeof g_dumpPath)
+	{
+		return false;
+	}
+
+	std::memcpy(g_dumpPath, path.c_str(), path.length() + 1);
 
-	std::vfprintf(file, format, args);
-	std::fputc('\n', file);
-	std::fflush(file);
+	HANDLE file = CreateFileA(g_dumpPath, GENERIC_WRITE | DELETE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+	                          CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	// the file disappears when the process exits without writing the minidump
+	if (!SetDeleteOnClose(file, true))
+	{
+		// the file is created after the crash instead
+		CloseHandle(file);
+		DeleteFileA(g_dumpPath);
+		return true;
+	}
 
-	DumpMemoryUsage(file);
-	DumpRegisters(file, context);
-	DumpCallStack(file, context);
-	DumpLoadedModules(file);
-	DumpCommandLine(file);
+	g_dumpFile = file;
 
-	WriteDumpFooter(file);
+	return true;
 }
 
-static OS::Mutex g_mutex;
-static CrashLogger::Handler g_handler;
+static DWORD DumpTypeToFlags(CrashLogger::DumpType type)
+{
+	switch (type)
+	{
+		case CrashLogger::DUMP_NONE:
+		{
+			break;
+		}
+		case CrashLogger::DUMP_SMALL:
+		{
+			return MiniDumpNormal | MiniDumpWithUnloadedModules;
+		}
+		case CrashLogger::DUMP_NORMAL:
+		{
+			return MiniDumpWithDataSegs
+			     | MiniDumpWithIndirectlyReferencedMemory
+			     | MiniDumpWithProcessThreadData
+			     | MiniDumpWithThreadInfo
+			     | MiniDumpWithUnloadedModules;
+		}
+		case CrashLogger::DUMP_FULL:
+		{
+			return MiniDumpWithFullMemory
+			     | MiniDumpWithFullMemoryInfo
+			     | MiniDumpWithHandleData
+			     | MiniDumpWithThreadInfo
+			     | MiniDumpWithUnloadedModules;
+		}
+	}
 
-static LONG __stdcall CrashHandler(EXCEPTION_POINTERS* exception)
+	return MiniDumpNormal;
+}
+
+static void WriteMiniDump(Output& out, const Report& report)
 {
-	// avoid recursive calls
-	SetUnhandledExceptionFilter(NULL);
+	const bool isPrepared = (g_dumpFile != INVALID_HANDLE_VALUE);
+
+	HANDLE dumpFile = g_dumpFile;
+	g_dumpFile = INVALID_HANDLE_VALUE;
+
+	if (!isPrepared)
+	{
+		dumpFile = CreateFileA(g_dumpPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+		if (dumpFile == INVALID_HANDLE_VALUE)
+		{
+			Print(out, "Failed to create minidump \"%s\" with error code %u\n", g_dumpPath, GetLastError());
+			Flush(out);
+			return;
+		}
+	}
 
-	if (g_handler)
+	EXCEPTION_POINTERS exception = {};
+	EXCEPTION_RECORD record = {};
+
+	if (report.exception)
+	{
+		exception = *report.exception;
+	}
+	else
 	{
-		OS::LockGuard<OS::Mutex> lock(g_mutex);
+		// make the debugger show the context captured by the error handler
+		record.ExceptionCode = STATUS_FATAL_APP_EXIT;
+#ifdef BUILD_64BIT
+		record.ExceptionAddress = reinterpret_cast<void*>(report.context->Rip);
+#else
+		record.ExceptionAddress = reinterpret_cast<void*>(report.context->Eip);
+#endif
+
+		exception.ExceptionRecord = &record;
+		exception.ContextRecord = report.context;
+	}
 
-		std::FILE* file = g_handler();
+	MINIDUMP_EXCEPTION_INFORMATION info = {};
+	info.ThreadId = report.threadID;
+	info.ExceptionPointers = &exception;
+	info.ClientPointers = FALSE;
 
-		if (file)
+	const MINIDUMP_TYPE type = static_cast<MINIDUMP_TYPE>(DumpTypeToFlags(g_dumpType));
+
+	if (MiniDumpWriteDump(GetCurrentProcess(), GetCurrentProcessId(), dumpFile, type, &info, NULL, NULL))
+	{
+		if (isPrepared)
 		{
-			WriteCrashDump(file, exception);
+			SetDeleteOnClose(dumpFile, false);
+		}
 
-			std::fclose(file);
+		CloseHandle(dumpFile);
+
+		Print(out, "Minidump: %s\n", g_dumpPath);
+	}
+	else
+	{
+		Print(out, "MiniDumpWriteDump failed with error code %u\n", GetLastError());
+
+		// prepared file is deleted on close
+		CloseHandle(dumpFile);
+
+		if (!isPrepared)
+		{
+			DeleteFileA(g_dumpPath);
 		}
 	}
 
-	return EXCEPTION_CONTINUE_SEARCH;
+	Flush(out);
 }
 
-static void PureCallHandler()
+static void WriteReport(const Report& report)
 {
-	CONTEXT context = {};
-	RtlCaptureContext(&context);
+	Output out;
+	out.file = g_handler();
 
-	if (g_handler)
+	if (out.file)
 	{
-		OS::LockGuard<OS::Mutex> lock(g_mutex);
+		WriteDumpHeader(out, false);
+		WriteReportInfo(out, report);
+
+		if (g_dumpType != CrashLogger::DUMP_NONE)
+		{
+			WriteMiniDump(out, report);
+		}
+
+		WriteDumpFooter(out);
+
+		std::fclose(out.file);
+	}
+}
+
+static void HelperThread(void*)
+{
+	// the per-thread CRT data used by the report is allocated now rather than after a crash
+	errno = 0;
+	char buffer[32];
+	std::sprintf(buffer, "%d %f", 0, 0.0);
 
-		std::FILE* file = g_handler();
+	SetEvent(g_doneEvent);
 
-		if (file)
+	while (WaitForSingleObject(g_requestEvent, INFINITE) == WAIT_OBJECT_0)
+	{
+		WriteReport(*g_pRequest);
+
+		SetEvent(g_doneEvent);
+	}
+}
+
+static bool Reserve(const CrashLogger::Config& config)
+{
+	g_reserve = VirtualAlloc(NULL, CRASH_RESERVE_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+	if (g_dumpType != CrashLogger::DUMP_NONE)
+	{
+		// if neither folder is writable, the report contains the error
+		if (!PrepareDumpFile(config.dumpFolder))
 		{
-			WriteGenericErrorDump(file, &context, "Pure function call");
+			PrepareDumpFile(config.dumpFallbackFolder);
+		}
+	}
+
+	g_requestEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+	g_doneEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
 
-			std::fclose(file);
+	if (!g_requestEvent || !g_doneEvent)
+	{
+		return false;
+	}
+
+	g_pHelperThread = new OS::Thread();
+
+	if (!g_pHelperThread->Start(&HelperThread, NULL, CRASH_HELPER_STACK_SIZE))
+	{
+		return false;
+	}
+
+	// the helper is ready
+	return WaitForSingleObject(g_doneEvent, INFINITE) == WAIT_OBJECT_0;
+}
+
+static void HandleReport(Report& report)
+{
+	// the helper thread itself failed, so it cannot write the report
+	if (!g_handler || (g_isReserved && GetCurrentThreadId() == g_pHelperThread->GetID()))
+	{
+		return;
+	}
+
+	OS::LockGuard<OS::Mutex> lock(g_mutex);
+
+	report.threadID = GetCurrentThreadId();
+
+	if (g_isReserved)
+	{
+		if (g_reserve)
+		{
+			VirtualFree(g_reserve, 0, MEM_RELEASE);
+			g_reserve = NULL;
 		}
+
+		// the helper thread needs a real handle of the crashing thread
+		DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &report.thread,
+		                0, FALSE, DUPLICATE_SAME_ACCESS);
+
+		g_pRequest = &report;
+		SetEvent(g_requestEvent);
+
+		// the helper thread might get stuck on a lock held by the crashing thread
+		WaitForSingleObject(g_doneEvent, (g_timeout) ? g_timeout : INFINITE);
+	}
+	else
+	{
+		report.thread = GetCurrentThread();
+
+		WriteReport(report);
+	}
+}
+
+static void TerminateIfReserved(unsigned int exitCode)
+{
+	// skip the Windows Error Reporting, which can take a long time, so the server is restarted sooner
+	if (g_isReserved)
+	{
+		TerminateProcess(GetCurrentProcess(), exitCode);
 	}
+}
+
+static LONG __stdcall CrashHandler(EXCEPTION_POINTERS* exception)
+{
+	// avoid recursive calls
+	SetUnhandledExceptionFilter(NULL);
+
+	Report report = {};
+	report.exception = exception;
+	report.context = exception->ContextRecord;
+
+	HandleReport(report);
+
+	TerminateIfReserved(exception->ExceptionRecord->ExceptionCode);
+
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+
+static void PureCallHandler()
+{
+	CONTEXT context = {};
+	RtlCaptureContext(&context);
+
+	Report report = {};
+	report.context = &context;
+	report.message = "Pure function call";
+
+	HandleReport(report);
+
+	TerminateIfReserved(STATUS_FATAL_APP_EXIT);
 
 	std::abort();
 }
@@ -440,19 +980,13 @@ static void InvalidParameterHandler(const wchar_t*, const wchar_t*, const wchar_
 	CONTEXT context = {};
 	RtlCaptureContext(&context);
 
-	if (g_handler)
-	{
-		OS::LockGuard<OS::Mutex> lock(g_mutex);
-
-		std::FILE* file = g_handler();
+	Report report = {};
+	report.context = &context;
+	report.message = "Invalid parameter detected by CRT";
 
-		if (file)
-		{
-			WriteGenericErrorDump(file, &context, "Invalid parameter detected by CRT");
+	HandleReport(report);
 
-			std::fclose(file);
-		}
-	}
+	TerminateIfReserved(STATUS_FATAL_APP_EXIT);
 
 	std::abort();
 }
@@ -462,26 +996,149 @@ void CrashLogger::OnEngineError(const char* format, va_list args)
 	CONTEXT context = {};
 	RtlCaptureContext(&context);
 
-	if (g_handler)
+	Report report = {};
+	report.context = &context;
+	report.format = format;
+	report.args = args;
+
+	HandleReport(report);
+
+	TerminateIfReserved(STATUS_FATAL_APP_EXIT);
+
+	std::abort();
+}
+
+static std::size_t CopyStack(const CONTEXT& context, std::vector<unsigned char>& buffer, StackSnapshot& snapshot)
+{
+#ifdef BUILD_64BIT
+	const std::size_t stackPointer = context.Rsp;
+#else
+	const std::size_t stackPointer = context.Esp;
+#endif
+
+	MEMORY_BASIC_INFORMATION info = {};
+
+	if (!VirtualQuery(reinterpret_cast<void*>(stackPointer), &info, sizeof info) || info.State != MEM_COMMIT)
 	{
-		OS::LockGuard<OS::Mutex> lock(g_mutex);
+		return 0;
+	}
+
+	// the used part of the stack is between the stack pointer and the end of its committed region
+	const std::size_t regionEnd = reinterpret_cast<std::size_t>(info.BaseAddress) + info.RegionSize;
+	const std::size_t size = (regionEnd - stackPointer < buffer.size()) ? regionEnd - stackPointer : buffer.size();
 
-		std::FILE* file = g_handler();
+	std::memcpy(&buffer[0], reinterpret_cast<void*>(stackPointer), size);
 
-		if (file)
+	snapshot.address = stackPointer;
+	snapshot.size = size;
+	snapshot.data = &buffer[0];
+
+	return size;
+}
+
+bool CrashLogger::ReportHang(unsigned long threadID, const char* message, Handler handler, std::string* text)
+{
+	OS::LockGuard<OS::Mutex> lock(g_mutex);
+
+	HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE, threadID);
+
+	if (!thread)
+	{
+		return false;
+	}
+
+	// allocated in advance, the suspended thread might be holding the heap lock
+	std::vector<unsigned char> stackBuffer(CRASH_STACK_SNAPSHOT_SIZE);
+	StackSnapshot snapshot = {};
+
+	CONTEXT context = {};
+	context.ContextFlags = CONTEXT_FULL;
+
+	if (SuspendThread(thread) == static_cast<DWORD>(-1))
+	{
+		CloseHandle(thread);
+		return false;
+	}
+
+	const bool isCaptured = GetThreadContext(thread, &context) && CopyStack(context, stackBuffer, snapshot);
+
+	ResumeThread(thread);
+
+	if (!isCaptured)
+	{
+		CloseHandle(thread);
+		return false;
+	}
+
+	Report report = {};
+	report.context = &context;
+	report.message = message;
+	report.thread = thread;
+	report.threadID = threadID;
+
+	g_pStackSnapshot = &snapshot;
+
+	Output out;
+
+	if (text)
+	{
+		out.text = text;
+
+		WriteDumpHeader(out, true);
+		WriteReportInfo(out, report);
+		WriteDumpFooter(out);
+	}
+	else if (handler)
+	{
+		out.file = handler();
+
+		if (out.file)
 		{
-			WriteEngineErrorDump(file, &context, format, args);
+			WriteDumpHeader(out, true);
+			WriteReportInfo(out, report);
 
-			std::fclose(file);
+			if (g_dumpType != CrashLogger::DUMP_NONE)
+			{
+				WriteMiniDump(out, report);
+			}
+
+			WriteDumpFooter(out);
+
+			std::fclose(out.file);
 		}
 	}
 
-	std::abort();
+	g_pStackSnapshot = NULL;
+
+	CloseHandle(thread);
+
+	return true;
 }
 
 void CrashLogger::Enable(CrashLogger::Handler handler)
 {
-	g_handler = handler;
+	Config config;
+	config.handler = handler;
+
+	Enable(config);
+}
+
+void CrashLogger::Enable(const CrashLogger::Config& config)
+{
+	g_handler = config.handler;
+	g_timeout = config.timeout;
+	g_dumpType = config.dumpType;
+
+	if (config.isReserved || config.dumpType != DUMP_NONE)
+	{
+		g_isReserved = Reserve(config);
+	}
+
+	if (!g_isReserved)
+	{
+		// writing the minidump from the crashing thread is not reliable
+		g_dumpType = DUMP_NONE;
+	}
 
 	SetUnhandledExceptionFilter(&CrashHandler);
 
@@ -1,12 +1,76 @@
 #pragma once
 
 #include <cstdio>
+#include <string>
 
 namespace CrashLogger
 {
 	typedef std::FILE* (*Handler)();
 
+	enum DumpType
+	{
+		DUMP_NONE,
+		DUMP_SMALL,   // stacks of all threads
+		DUMP_NORMAL,  // also global variables and memory referenced by the stacks
+		DUMP_FULL,    // the whole address space
+	};
+
+	/**
+	 * In reserved mode, Enable prepares everything needed for the crash report in advance. The report is written by
+	 * a helper thread while the crashing thread waits, so neither a corrupted heap nor a stack overflow can prevent it.
+	 * The process is terminated once the report is done or the timeout expires.
+	 */
+	struct Config
+	{
+		Handler handler;
+		bool isReserved;
+		DumpType dumpType;  // minidump requires reserved mode
+		const char* dumpFolder;
+		const char* dumpFallbackFolder;  // used if the first folder is not writable
+		unsigned int timeout;  // milliseconds
+
+		Config() : handler(NULL), isReserved(false), dumpType(DUMP_NONE), dumpFolder(NULL), dumpFallbackFolder(NULL),
+		           timeout(0)
+		{
+		}
+	};
+
 	void OnEngineError(const char* format, va_list args);
 
+	/**
+	 * Writes a report with the call stack of a thread that stopped responding.
+	 * The report is appended to the text, or written to the file opened by the handler the same way as a crash if text
+	 * is NULL.
+	 */
+	bool ReportHang(unsigned long threadID, const char* message, Handler handler, std::string* text);
+
 	void Enable(Handler handler);
+	void Enable(const Config& config);
+
+	/**
+	 * The dbghelp symbol handler is shared by crash reports and the profiler.
+	 * It is initialized by the first AcquireSymbols and cleaned up by the last matching ReleaseSymbols.
+	 * Calls of dbghelp functions must be guarded by SymbolLock because dbghelp is not thread-safe.
+	 */
+	bool AcquireSymbols();
+	void ReleaseSymbols();
+
+	// acquires the symbol handler for the rest of the process lifetime and loads symbols of all modules in background
+	void PreloadSymbols();
+
+	void LockSymbols();
+	void UnlockSymbols();
+
+	struct SymbolLock
+	{
+		SymbolLock()
+		{
+			LockSymbols();
+		}
+
+		~SymbolLock()
+		{
+			UnlockSymbols();
+		}
+	};
 }
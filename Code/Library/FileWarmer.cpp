@@ -0,0 +1,165 @@
+#include "FileWarmer.h"
+
+// must be a multiple of the allocation granularity, also limits the address space used at once by non-resident files
+#define FILE_WARMER_VIEW_SIZE (32 * 1024 * 1024)
+
+// work done for each idle tick in paced mode
+#define FILE_WARMER_CHUNK_SIZE (2 * 1024 * 1024)
+
+#define FILE_WARMER_PAGE_SIZE 4096
+
+FileWarmer::FileWarmer() : m_isStopRequested(0), m_isPaced(false), m_isResident(false), m_onDone(NULL)
+{
+}
+
+void FileWarmer::Add(const std::string& path)
+{
+	m_paths.push_back(path);
+}
+
+bool FileWarmer::Start(bool isPaced, bool isResident, DoneCallback onDone)
+{
+	if (m_paths.empty() || m_thread.IsStarted())
+	{
+		return false;
+	}
+
+	m_isPaced = isPaced;
+	m_isResident = isResident;
+	m_onDone = onDone;
+
+	return m_thread.Start(&FileWarmer::ThreadEntry, this);
+}
+
+void FileWarmer::Stop()
+{
+	OS::Atomic::Exchange(&m_isStopRequested, 1);
+
+	// wake up the worker waiting for the next tick
+	m_idleEvent.Set();
+
+	m_thread.Join();
+
+	for (std::size_t i = 0; i < m_residentViews.size(); i++)
+	{
+		OS::UnlockMemory(m_residentViews[i].address, m_residentViews[i].size);
+		OS::FileMapping::Unmap(m_residentViews[i].address);
+	}
+
+	m_residentViews.clear();
+}
+
+void FileWarmer::ThreadEntry(void* param)
+{
+	static_cast<FileWarmer*>(param)->Run();
+}
+
+void FileWarmer::Run()
+{
+	// reads of the engine itself have priority
+	OS::EnterBackgroundMode();
+
+	const unsigned __int64 startTime = OS::GetPerformanceCounter();
+
+	for (std::size_t i = 0; i < m_paths.size() && !m_isStopRequested; i++)
+	{
+		this->WarmFile(m_paths[i]);
+	}
+
+	const double duration = static_cast<double>(OS::GetPerformanceCounter() - startTime);
+
+	m_stats.duration = (duration * 1000) / OS::GetPerformanceFrequency();
+
+	if (m_onDone && !m_isStopRequested)
+	{
+		m_onDone(m_stats);
+	}
+}
+
+void FileWarmer::WarmFile(const std::string& path)
+{
+	OS::FileMapping mapping;
+	if (!mapping.Open(path.c_str()))
+	{
+		m_stats.failedCount++;
+		return;
+	}
+
+	unsigned __int64 offset = 0;
+
+	while (offset < mapping.size && !m_isStopRequested)
+	{
+		const unsigned __int64 remainingSize = mapping.size - offset;
+		const std::size_t viewSize = (remainingSize < FILE_WARMER_VIEW_SIZE)
+		                           ? static_cast<std::size_t>(remainingSize)
+		                           : FILE_WARMER_VIEW_SIZE;
+
+		const void* view = mapping.Map(offset, viewSize);
+		if (!view)
+		{
+			// most likely out of address space in 32-bit launcher
+			m_stats.failedCount++;
+			return;
+		}
+
+		this->WarmView(view, viewSize);
+
+		bool isKept = false;
+
+		if (m_isResident && !m_isStopRequested)
+		{
+			if (OS::LockMemory(view, viewSize))
+			{
+				View residentView;
+				residentView.address = view;
+				residentView.size = viewSize;
+
+				m_residentViews.push_back(residentView);
+				m_stats.residentBytes += viewSize;
+
+				isKept = true;
+			}
+			else
+			{
+				m_stats.unlockedBytes += viewSize;
+			}
+		}
+
+		if (!isKept)
+		{
+			// the pages stay in the file cache
+			OS::FileMapping::Unmap(view);
+		}
+
+		offset += viewSize;
+	}
+
+	m_stats.fileCount++;
+}
+
+void FileWarmer::WarmView(const void* view, std::size_t size)
+{
+	const volatile unsigned char* bytes = static_cast<const volatile unsigned char*>(view);
+
+	unsigned char dummy = 0;
+
+	for (std::size_t chunkPos = 0; chunkPos < size && !m_isStopRequested; chunkPos += FILE_WARMER_CHUNK_SIZE)
+	{
+		if (m_isPaced)
+		{
+			m_idleEvent.Wait();
+		}
+
+		const std::size_t remainingSize = size - chunkPos;
+		const std::size_t chunkSize = (remainingSize < FILE_WARMER_CHUNK_SIZE) ? remainingSize : FILE_WARMER_CHUNK_SIZE;
+
+		OS::PrefetchMemory(static_cast<const unsigned char*>(view) + chunkPos, chunkSize);
+
+		for (std::size_t pos = 0; pos < chunkSize; pos += FILE_WARMER_PAGE_SIZE)
+		{
+			dummy ^= bytes[chunkPos + pos];
+		}
+
+		m_stats.warmedBytes += chunkSize;
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "OS.h"
+
+/**
+ * Pulls files into memory on a low-priority background thread.
+ *
+ * The files are mapped view by view and their pages are touched, so they end up in the system file cache. Resident
+ * files keep their views mapped and locked, so they stay in memory even when the file cache is trimmed.
+ *
+ * In paced mode, the worker touches one chunk for each OnIdle call, so the reads happen while the main thread waits for
+ * the next tick.
+ */
+class FileWarmer
+{
+public:
+	struct Stats
+	{
+		unsigned int fileCount;
+		unsigned int failedCount;
+		unsigned __int64 warmedBytes;
+		unsigned __int64 residentBytes;
+		unsigned __int64 unlockedBytes;  // failed to stay resident
+		double duration;  // milliseconds
+
+		Stats() : fileCount(0), failedCount(0), warmedBytes(0), residentBytes(0), unlockedBytes(0), duration(0)
+		{
+		}
+	};
+
+	// called by the worker thread once all files are done
+	typedef void (*DoneCallback)(const Stats& stats);
+
+private:
+	struct View
+	{
+		const void* address;
+		std::size_t size;
+	};
+
+	std::vector<std::string> m_paths;
+	std::vector<View> m_residentViews;
+	OS::Thread m_thread;
+	OS::Event m_idleEvent;
+	volatile long m_isStopRequested;
+	bool m_isPaced;
+	bool m_isResident;
+	DoneCallback m_onDone;
+	Stats m_stats;
+
+	// no copies
+	FileWarmer(const FileWarmer&);
+	FileWarmer& operator=(const FileWarmer&);
+
+	static void ThreadEntry(void* param);
+	void Run();
+
+	void WarmFile(const std::string& path);
+	void WarmView(const void* view, std::size_t size);
+
+public:
+	FileWarmer();
+
+	~FileWarmer()
+	{
+		this->Stop();
+	}
+
+	bool IsStarted() const
+	{
+		return m_thread.IsStarted();
+	}
+
+	// not thread-safe, must be done before Start
+	void Add(const std::string& path);
+
+	bool Start(bool isPaced, bool isResident, DoneCallback onDone);
+
+	// allows the worker to touch the next chunk in paced mode
+	void OnIdle()
+	{
+		if (m_isPaced)
+		{
+			m_idleEvent.Set();
+		}
+	}
+
+	// abandons the remaining files and releases the resident ones
+	void Stop();
+};
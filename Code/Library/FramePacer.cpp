@@ -0,0 +1,87 @@
+#include "FramePacer.h"
+
+// how long before the deadline the timer should wake us up
+// the standard timer is much less precise, but spinning for its whole resolution would waste too much CPU
+#define HIGH_RESOLUTION_SPIN_MICROSECONDS 500
+#define STANDARD_SPIN_MICROSECONDS 2000
+
+FramePacer::FramePacer(unsigned int frameRate) : m_timer(), m_timerResolution(),
+  m_frequency(OS::GetPerformanceFrequency()), m_period(0), m_spinTime(0), m_deadline(0), m_frameCount(0),
+  m_missedCount(0)
+{
+	const unsigned int spinMicroseconds = (m_timer.IsHighResolution())
+		? HIGH_RESOLUTION_SPIN_MICROSECONDS
+		: STANDARD_SPIN_MICROSECONDS;
+
+	m_spinTime = (m_frequency * spinMicroseconds) / 1000000;
+
+	this->SetFrameRate(frameRate);
+}
+
+void FramePacer::SetFrameRate(unsigned int frameRate)
+{
+	if (frameRate == 0)
+	{
+		frameRate = 1;
+	}
+
+	m_period = m_frequency / frameRate;
+	m_deadline = 0;
+}
+
+bool FramePacer::RequestTimerResolution(unsigned int milliseconds)
+{
+	if (m_timer.IsHighResolution() || milliseconds == 0)
+	{
+		return false;
+	}
+
+	return m_timerResolution.Request(milliseconds);
+}
+
+bool FramePacer::Wait()
+{
+	const unsigned __int64 now = OS::GetPerformanceCounter();
+
+	m_frameCount++;
+
+	if (m_deadline == 0)
+	{
+		// the first frame has no previous deadline
+		m_deadline = now + m_period;
+	}
+	else if (now >= m_deadline)
+	{
+		m_missedCount++;
+
+		// catch up small delays to keep the average frame rate, but do not rush frames after a long stall
+		if ((now - m_deadline) < m_period)
+		{
+			m_deadline += m_period;
+		}
+		else
+		{
+			m_deadline = now + m_period;
+		}
+
+		return false;
+	}
+
+	const unsigned __int64 remaining = m_deadline - now;
+
+	if (remaining > m_spinTime)
+	{
+		const unsigned __int64 sleepTime = ((remaining - m_spinTime) * 1000000) / m_frequency;
+
+		m_timer.Sleep(static_cast<unsigned int>(sleepTime));
+	}
+
+	while (OS::GetPerformanceCounter() < m_deadline)
+	{
+		OS::YieldCurrentThread();
+	}
+
+	m_deadline += m_period;
+
+	return true;
+}
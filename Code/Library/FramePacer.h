@@ -0,0 +1,68 @@
+#pragma once
+
+#include "OS.h"
+
+/**
+ * Keeps a steady frame rate.
+ *
+ * Most of the remaining frame time is slept away with a waitable timer and only the last moment is spent spinning,
+ * so frames start on time without burning CPU.
+ */
+class FramePacer
+{
+	OS::WaitableTimer m_timer;
+	OS::TimerResolution m_timerResolution;
+
+	// performance counter units
+	unsigned __int64 m_frequency;
+	unsigned __int64 m_period;
+	unsigned __int64 m_spinTime;
+	unsigned __int64 m_deadline;
+
+	unsigned long m_frameCount;
+	unsigned long m_missedCount;
+
+	// no copies
+	FramePacer(const FramePacer&);
+	FramePacer& operator=(const FramePacer&);
+
+public:
+	explicit FramePacer(unsigned int frameRate);
+
+	// the next frame starts a new schedule, so a missed deadline of the old rate is not caught up
+	void SetFrameRate(unsigned int frameRate);
+
+	/**
+	 * Waits until the next frame should begin.
+	 *
+	 * @return False if the deadline has already been missed.
+	 */
+	bool Wait();
+
+	bool IsHighResolution() const
+	{
+		return m_timer.IsHighResolution();
+	}
+
+	/**
+	 * Raises the system timer resolution until released, only if the standard timer is used.
+	 *
+	 * @return False if it is not needed or not possible.
+	 */
+	bool RequestTimerResolution(unsigned int milliseconds);
+
+	void ReleaseTimerResolution()
+	{
+		m_timerResolution.Release();
+	}
+
+	unsigned long GetFrameCount() const
+	{
+		return m_frameCount;
+	}
+
+	unsigned long GetMissedCount() const
+	{
+		return m_missedCount;
+	}
+};
@@ -0,0 +1,126 @@
+#include <cstring>
+
+#include "Histogram.h"
+
+Histogram::Histogram()
+{
+	this->Clear();
+}
+
+/**
+ * Values below 2 * SUB_BUCKET_COUNT have their own buckets. Higher values are shifted right until they fit into
+ * [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT), so each shift adds another SUB_BUCKET_COUNT buckets.
+ */
+unsigned int Histogram::GetBucketIndex(unsigned long value)
+{
+	unsigned int shift = 0;
+
+	while ((value >> shift) >= (2 * SUB_BUCKET_COUNT))
+	{
+		shift++;
+	}
+
+	return (shift * SUB_BUCKET_COUNT) + static_cast<unsigned int>(value >> shift);
+}
+
+unsigned long Histogram::GetBucketUpperBound(unsigned int index)
+{
+	if (index < (2 * SUB_BUCKET_COUNT))
+	{
+		return index;
+	}
+
+	const unsigned int shift = (index / SUB_BUCKET_COUNT) - 1;
+	const unsigned long subBucket = index - (shift * SUB_BUCKET_COUNT);
+
+	return ((subBucket + 1) << shift) - 1;
+}
+
+void Histogram::Add(unsigned long value)
+{
+	m_buckets[GetBucketIndex(value)]++;
+
+	if (m_count == 0 || value < m_min)
+	{
+		m_min = value;
+	}
+
+	if (value > m_max)
+	{
+		m_max = value;
+	}
+
+	m_count++;
+	m_sum += value;
+}
+
+void Histogram::Add(const Histogram& other)
+{
+	if (other.m_count == 0)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < BUCKET_COUNT; i++)
+	{
+		m_buckets[i] += other.m_buckets[i];
+	}
+
+	if (m_count == 0 || other.m_min < m_min)
+	{
+		m_min = other.m_min;
+	}
+
+	if (other.m_max > m_max)
+	{
+		m_max = other.m_max;
+	}
+
+	m_count += other.m_count;
+	m_sum += other.m_sum;
+}
+
+void Histogram::Clear()
+{
+	std::memset(m_buckets, 0, sizeof m_buckets);
+
+	m_count = 0;
+	m_min = 0;
+	m_max = 0;
+	m_sum = 0;
+}
+
+unsigned long Histogram::GetPercentile(double percentile) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+
+	unsigned long rank = static_cast<unsigned long>((percentile / 100) * m_count + 0.5);
+
+	if (rank < 1)
+	{
+		rank = 1;
+	}
+	else if (rank > m_count)
+	{
+		rank = m_count;
+	}
+
+	unsigned long total = 0;
+
+	for (unsigned int i = 0; i < BUCKET_COUNT; i++)
+	{
+		total += m_buckets[i];
+
+		if (total >= rank)
+		{
+			const unsigned long value = GetBucketUpperBound(i);
+
+			return (value < m_max) ? value : m_max;
+		}
+	}
+
+	return m_max;
+}
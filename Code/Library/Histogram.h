@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Log-linear histogram of non-negative integer values in the style of HdrHistogram.
+ *
+ * Every power of two is split into 16 buckets, so any recorded value is reported with at most 1/16 relative error.
+ * Recording is just a few instructions and no memory is allocated.
+ */
+class Histogram
+{
+public:
+	enum
+	{
+		SUB_BUCKET_BITS = 4,
+		SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+		BUCKET_COUNT = SUB_BUCKET_COUNT * (32 - SUB_BUCKET_BITS + 1),  // 32-bit values
+	};
+
+private:
+	unsigned long m_buckets[BUCKET_COUNT];
+	unsigned long m_count;
+	unsigned long m_min;
+	unsigned long m_max;
+	unsigned __int64 m_sum;
+
+	static unsigned int GetBucketIndex(unsigned long value);
+	static unsigned long GetBucketUpperBound(unsigned int index);
+
+public:
+	Histogram();
+
+	void Add(unsigned long value);
+	void Add(const Histogram& other);
+	void Clear();
+
+	unsigned long GetCount() const
+	{
+		return m_count;
+	}
+
+	unsigned long GetMin() const
+	{
+		return (m_count > 0) ? m_min : 0;
+	}
+
+	unsigned long GetMax() const
+	{
+		return m_max;
+	}
+
+	unsigned long GetMean() const
+	{
+		return (m_count > 0) ? static_cast<unsigned long>(m_sum / m_count) : 0;
+	}
+
+	/**
+	 * @param percentile From 0 to 100.
+	 * @return Upper bound of the bucket containing the percentile, but never more than the maximum.
+	 */
+	unsigned long GetPercentile(double percentile) const;
+};
@@ -0,0 +1,212 @@
+#include "HotPathTimer.h"
+#include "OS.h"
+
+struct SectionTotals
+{
+	unsigned long count;
+	unsigned __int64 totalCycles;
+	unsigned __int64 maxCycles;
+};
+
+struct ThreadSlot
+{
+	// seqlock, odd while the owning thread is updating the slot
+	volatile long sequence;
+	volatile long epoch;
+	unsigned long threadID;
+	SectionTotals sections[HotPathTimer::MAX_SECTION_COUNT];
+};
+
+static const char* volatile g_sectionNames[HotPathTimer::MAX_SECTION_COUNT];
+static volatile long g_sectionCount;
+
+static ThreadSlot g_slots[HotPathTimer::MAX_THREAD_COUNT];
+static volatile long g_slotCount;
+
+// threads beyond MAX_THREAD_COUNT are not measured
+static ThreadSlot g_droppedSlot;
+
+static OS::ThreadLocalPointer g_currentSlot;
+
+// slots with an older epoch are cleared by their threads
+static volatile long g_epoch = 1;
+
+static double g_secondsPerCycle;
+
+// only used by the thread calling Reset and Collect
+static unsigned __int64 g_resetTime = OS::GetPerformanceCounter();
+static unsigned __int64 g_resetCycles = HotPathTimer::GetCycles();
+
+static ThreadSlot* AcquireSlot()
+{
+	ThreadSlot* pSlot = static_cast<ThreadSlot*>(g_currentSlot.Get());
+
+	if (!pSlot)
+	{
+		const long index = OS::Atomic::Increment(&g_slotCount) - 1;
+
+		if (index < HotPathTimer::MAX_THREAD_COUNT)
+		{
+			pSlot = &g_slots[index];
+			pSlot->threadID = OS::GetCurrentThreadID();
+		}
+		else
+		{
+			pSlot = &g_droppedSlot;
+		}
+
+		g_currentSlot.Set(pSlot);
+	}
+
+	return pSlot;
+}
+
+HotPathTimer::SectionID HotPathTimer::AddSection(const char* name)
+{
+	const long index = OS::Atomic::Increment(&g_sectionCount) - 1;
+
+	if (index >= MAX_SECTION_COUNT)
+	{
+		return MAX_SECTION_COUNT;
+	}
+
+	g_sectionNames[index] = name;
+
+	return static_cast<SectionID>(index);
+}
+
+void HotPathTimer::Add(SectionID section, unsigned __int64 cycles)
+{
+	ThreadSlot* pSlot = AcquireSlot();
+
+	if (pSlot == &g_droppedSlot || section >= MAX_SECTION_COUNT)
+	{
+		return;
+	}
+
+	OS::Atomic::Increment(&pSlot->sequence);
+
+	const long epoch = g_epoch;
+
+	if (pSlot->epoch != epoch)
+	{
+		for (unsigned int i = 0; i < MAX_SECTION_COUNT; i++)
+		{
+			pSlot->sections[i].count = 0;
+			pSlot->sections[i].totalCycles = 0;
+			pSlot->sections[i].maxCycles = 0;
+		}
+
+		pSlot->epoch = epoch;
+	}
+
+	SectionTotals& totals = pSlot->sections[section];
+	totals.count++;
+	totals.totalCycles += cycles;
+
+	if (totals.maxCycles < cycles)
+	{
+		totals.maxCycles = cycles;
+	}
+
+	OS::Atomic::Increment(&pSlot->sequence);
+}
+
+void HotPathTimer::SetSecondsPerCycle(double secondsPerCycle)
+{
+	g_secondsPerCycle = secondsPerCycle;
+}
+
+double HotPathTimer::GetSecondsPerCycle()
+{
+	if (g_secondsPerCycle > 0)
+	{
+		return g_secondsPerCycle;
+	}
+
+	const unsigned __int64 cycles = GetCycles() - g_resetCycles;
+
+	if (cycles == 0)
+	{
+		return 0;
+	}
+
+	return GetElapsedTime() / static_cast<double>(cycles);
+}
+
+void HotPathTimer::Reset()
+{
+	OS::Atomic::Increment(&g_epoch);
+
+	g_resetTime = OS::GetPerformanceCounter();
+	g_resetCycles = GetCycles();
+}
+
+double HotPathTimer::GetElapsedTime()
+{
+	const unsigned __int64 duration = OS::GetPerformanceCounter() - g_resetTime;
+
+	return static_cast<double>(duration) / static_cast<double>(OS::GetPerformanceFrequency());
+}
+
+void HotPathTimer::Collect(std::vector<Result>& results)
+{
+	const long epoch = g_epoch;
+	const long sectionCount = (g_sectionCount < MAX_SECTION_COUNT) ? g_sectionCount : MAX_SECTION_COUNT;
+	const long slotCount = (g_slotCount < MAX_THREAD_COUNT) ? g_slotCount : MAX_THREAD_COUNT;
+
+	for (long i = 0; i < slotCount; i++)
+	{
+		ThreadSlot& slot = g_slots[i];
+
+		SectionTotals sections[MAX_SECTION_COUNT];
+		long slotEpoch = 0;
+
+		for (;;)
+		{
+			const long sequence = slot.sequence;
+
+			if ((sequence & 1) == 0)
+			{
+				slotEpoch = slot.epoch;
+
+				for (long j = 0; j < sectionCount; j++)
+				{
+					sections[j] = slot.sections[j];
+				}
+
+				// full barrier, so the copy cannot be moved after the check
+				if (OS::Atomic::Add(&slot.sequence, 0) == sequence)
+				{
+					break;
+				}
+			}
+
+			OS::YieldCurrentThread();
+		}
+
+		if (slotEpoch != epoch)
+		{
+			continue;
+		}
+
+		for (long j = 0; j < sectionCount; j++)
+		{
+			const char* name = g_sectionNames[j];
+
+			if (!name || sections[j].count == 0)
+			{
+				continue;
+			}
+
+			Result result;
+			result.name = name;
+			result.threadID = slot.threadID;
+			result.count = sections[j].count;
+			result.totalCycles = sections[j].totalCycles;
+			result.maxCycles = sections[j].maxCycles;
+
+			results.push_back(result);
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>  // __rdtsc
+#endif
+
+/**
+ * Cheap scoped timers for code running every frame.
+ *
+ * Time is measured in CPU cycles with RDTSC and converted to seconds using the engine calibration, see
+ * SetSecondsPerCycle. Each thread adds its measurements to its own slot without any locking. The slots are read by
+ * Collect while the threads keep running.
+ */
+namespace HotPathTimer
+{
+	enum
+	{
+		MAX_SECTION_COUNT = 32,
+		MAX_THREAD_COUNT = 32,
+	};
+
+	typedef unsigned int SectionID;
+
+	struct Result
+	{
+		const char* name;  // static string
+		unsigned long threadID;
+		unsigned long count;
+		unsigned __int64 totalCycles;
+		unsigned __int64 maxCycles;
+	};
+
+	// thread-safe, returns MAX_SECTION_COUNT if there are too many sections
+	SectionID AddSection(const char* name);
+
+	inline unsigned __int64 GetCycles()
+	{
+		return __rdtsc();
+	}
+
+	void Add(SectionID section, unsigned __int64 cycles);
+
+	// zero to calibrate against the performance counter between Reset and Collect
+	void SetSecondsPerCycle(double secondsPerCycle);
+	double GetSecondsPerCycle();
+
+	// each thread drops its measurements the next time it adds one
+	void Reset();
+
+	// seconds since the start or the last Reset
+	double GetElapsedTime();
+
+	// sections with at least one measurement since the last Reset, one result for each thread
+	void Collect(std::vector<Result>& results);
+
+	class Section
+	{
+		SectionID m_id;
+
+		// no copies
+		Section(const Section&);
+		Section& operator=(const Section&);
+
+	public:
+		explicit Section(const char* name) : m_id(AddSection(name))
+		{
+		}
+
+		SectionID GetID() const
+		{
+			return m_id;
+		}
+	};
+
+	class Scope
+	{
+		SectionID m_section;
+		unsigned __int64 m_startTime;
+
+		// no copies
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+	public:
+		explicit Scope(const Section& section) : m_section(section.GetID()), m_startTime(GetCycles())
+		{
+		}
+
+		~Scope()
+		{
+			Add(m_section, GetCycles() - m_startTime);
+		}
+	};
+}
@@ -1,9 +1,18 @@
+#include <fcntl.h>  // _O_APPEND
+#include <io.h>  // _open_osfhandle
+#include <process.h>  // _beginthreadex
 #include <stdlib.h>
 #include <string.h>
 
+#include <deque>
+#include <string>
+#include <vector>
+
 #define WIN32_LEAN_AND_MEAN
 #include <shlobj.h>
 #include <windows.h>
+#include <mmsystem.h>  // timeBeginPeriod
+#include <psapi.h>
 
 #include "OS.h"
 
@@ -11,17 +20,150 @@
 // Command line //
 //////////////////
 
-static int FindArgIndex(const char* arg)
+struct CmdLineArg
+{
+	std::string name;
+	std::string value;
+	bool hasValue;
+	unsigned int hash;
+	int next;  // index of the next argument in the same bucket or -1
+};
+
+struct CmdLineTable
+{
+	// deque keeps the strings in place, so their values can be returned
+	std::deque<CmdLineArg> args;
+	std::vector<int> buckets;  // index of the first argument or -1
+};
+
+static unsigned int HashArgName(const char* name)
+{
+	// FNV-1a of the lowercase name
+	unsigned int hash = 2166136261u;
+
+	for (; *name; name++)
+	{
+		char ch = *name;
+
+		if (ch >= 'A' && ch <= 'Z')
+		{
+			ch += 'a' - 'A';
+		}
+
+		hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619u;
+	}
+
+	return hash;
+}
+
+static const CmdLineArg* FindArg(const CmdLineTable& table, const char* name)
+{
+	if (table.buckets.empty())
+	{
+		return NULL;
+	}
+
+	const unsigned int hash = HashArgName(name);
+
+	int index = table.buckets[hash & (table.buckets.size() - 1)];
+
+	while (index >= 0)
+	{
+		const CmdLineArg& arg = table.args[index];
+
+		if (arg.hash == hash && _stricmp(arg.name.c_str(), name) == 0)
+		{
+			return &arg;
+		}
+
+		index = arg.next;
+	}
+
+	return NULL;
+}
+
+static void RebuildBuckets(CmdLineTable& table, std::size_t bucketCount)
+{
+	table.buckets.assign(bucketCount, -1);
+
+	for (std::size_t i = 0; i < table.args.size(); i++)
+	{
+		CmdLineArg& arg = table.args[i];
+		int& bucket = table.buckets[arg.hash & (bucketCount - 1)];
+
+		arg.next = bucket;
+		bucket = static_cast<int>(i);
+	}
+}
+
+static bool InsertArg(CmdLineTable& table, const char* name, const char* value)
+{
+	if (FindArg(table, name))
+	{
+		return false;
+	}
+
+	table.args.push_back(CmdLineArg());
+
+	CmdLineArg& arg = table.args.back();
+	arg.name = name;
+	arg.value = (value) ? value : "";
+	arg.hasValue = (value != NULL);
+	arg.hash = HashArgName(name);
+	arg.next = -1;
+
+	// keep the load factor at most 1/2
+	std::size_t bucketCount = (table.buckets.empty()) ? 16 : table.buckets.size();
+
+	while (bucketCount < (table.args.size() * 2))
+	{
+		bucketCount *= 2;
+	}
+
+	if (bucketCount != table.buckets.size())
+	{
+		RebuildBuckets(table, bucketCount);
+	}
+	else
+	{
+		int& bucket = table.buckets[arg.hash & (bucketCount - 1)];
+
+		arg.next = bucket;
+		bucket = static_cast<int>(table.args.size() - 1);
+	}
+
+	return true;
+}
+
+static CmdLineTable& GetCmdLineTable()
 {
-	for (int i = 1; i < __argc; i++)
+	static CmdLineTable table;
+	static bool isParsed = false;
+
+	if (!isParsed)
 	{
-		if (_stricmp(__argv[i], arg) == 0)
+		isParsed = true;
+
+		for (int i = 1; i < __argc; i++)
 		{
-			return i;
+			const char* value = NULL;
+
+			if ((i + 1) < __argc)
+			{
+				value = __argv[i + 1];
+
+				// make sure the value is not another argument
+				if (*value == '-' || *value == '+')
+				{
+					value = NULL;
+				}
+			}
+
+			InsertArg(table, __argv[i], value);
 		}
 	}
 
-	return -1;
+	return table;
 }
 
 const char* OS::CmdLine::GetOnlyArgs()
@@ -59,27 +201,24 @@ const char* OS::CmdLine::GetOnlyArgs()
 
 bool OS::CmdLine::HasArg(const char* arg)
 {
-	return FindArgIndex(arg) > 0;
+	return FindArg(GetCmdLineTable(), arg) != NULL;
 }
 
 const char* OS::CmdLine::GetArgValue(const char* arg, const char* defaultValue)
 {
-	const int index = FindArgIndex(arg);
+	const CmdLineArg* pArg = FindArg(GetCmdLineTable(), arg);
 
-	if (index < 0 || (index + 1) >= __argc)
+	if (!pArg || !pArg->hasValue)
 	{
 		return defaultValue;
 	}
 
-	const char* value = __argv[index + 1];
-
-	// make sure the value is not another argument
-	if (*value == '-' || *value == '+')
-	{
-		return defaultValue;
-	}
+	return pArg->value.c_str();
+}
 
-	return value;
+bool OS::CmdLine::AddArg(const char* arg, const char* value)
+{
+	return InsertArg(GetCmdLineTable(), arg, value);
 }
 
 /////////////
@@ -155,226 +294,703 @@ int OS::Module::Version::GetPatch(void* mod)
 	return (fileInfo) ? LOWORD(fileInfo->dwProductVersionLS) : -1;
 }
 
-///////////
-// Hacks //
-///////////
-
-bool OS::Hack::FillNop(void* address, std::size_t size)
+static bool IsReadablePage(DWORD protection)
 {
-	DWORD oldProtection;
-	if (!VirtualProtect(address, size, PAGE_EXECUTE_READWRITE, &oldProtection))
+	if (protection & (PAGE_NOACCESS | PAGE_GUARD))
 	{
 		return false;
 	}
 
-	// 0x90 is the opcode of NOP instruction on both x86 and x86-64
-	memset(address, '\x90', size);
+	return (protection & (PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY
+	                    | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) != 0;
+}
 
-	if (!VirtualProtect(address, size, oldProtection, &oldProtection))
+std::size_t OS::Module::Prefetch(const char* path)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
 	{
-		return false;
+		return 0;
 	}
 
-	return true;
-}
+	// the preferred address is in the headers
+	unsigned char headers[4096];
+	DWORD headersSize = 0;
+	const BOOL isHeadersRead = ReadFile(file, headers, sizeof headers, &headersSize, NULL);
 
-bool OS::Hack::FillMem(void* address, const void* data, std::size_t dataSize)
-{
-	DWORD oldProtection;
-	if (!VirtualProtect(address, dataSize, PAGE_EXECUTE_READWRITE, &oldProtection))
+	HANDLE section = CreateFileMappingA(file, NULL, PAGE_READONLY | SEC_IMAGE, 0, 0, NULL);
+
+	CloseHandle(file);
+
+	if (!section)
 	{
-		return false;
+		return 0;
 	}
 
-	memcpy(address, data, dataSize);
+	void* preferredAddress = NULL;
+	std::size_t imageSize = 0;
+
+	const IMAGE_DOS_HEADER* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(headers);
 
-	if (!VirtualProtect(address, dataSize, oldProtection, &oldProtection))
+	if (isHeadersRead && headersSize >= sizeof(IMAGE_DOS_HEADER) && dosHeader->e_magic == IMAGE_DOS_SIGNATURE
+	 && dosHeader->e_lfanew > 0
+	 && (static_cast<std::size_t>(dosHeader->e_lfanew) + sizeof(IMAGE_NT_HEADERS)) <= headersSize)
 	{
-		return false;
+		const IMAGE_NT_HEADERS* ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS*>(headers + dosHeader->e_lfanew);
+
+		// images of the other architecture cannot be loaded anyway
+		if (ntHeaders->Signature == IMAGE_NT_SIGNATURE
+		 && ntHeaders->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR_MAGIC)
+		{
+			preferredAddress = reinterpret_cast<void*>(ntHeaders->OptionalHeader.ImageBase);
+			imageSize = ntHeaders->OptionalHeader.SizeOfImage;
+		}
 	}
 
-	return true;
-}
+	void* view = NULL;
 
-///////////
-// Files //
-///////////
+	if (preferredAddress)
+	{
+		view = MapViewOfFileEx(section, FILE_MAP_READ, 0, 0, 0, preferredAddress);
+	}
 
-static DWORD ToNativeFileAccessMode(OS::File::Access access)
-{
-	switch (access)
+	// the view keeps the section alive
+	CloseHandle(section);
+
+	if (!view)
 	{
-		case OS::File::READ_ONLY:
+		return 0;
+	}
+
+	// one large read instead of many small ones caused by page faults
+	OS::PrefetchMemory(view, imageSize);
+
+	// touch each page to make sure it is read
+	const unsigned char* begin = static_cast<const unsigned char*>(view);
+	const unsigned char* end = begin + imageSize;
+	const unsigned char* regionBegin = begin;
+
+	unsigned char dummy = 0;
+
+	while (regionBegin < end)
+	{
+		MEMORY_BASIC_INFORMATION info;
+		if (!VirtualQuery(regionBegin, &info, sizeof info))
 		{
-			return GENERIC_READ;
+			break;
 		}
-		case OS::File::WRITE_ONLY:
-		case OS::File::WRITE_ONLY_CREATE:
+
+		const unsigned char* regionEnd = static_cast<const unsigned char*>(info.BaseAddress) + info.RegionSize;
+
+		if (regionEnd > end)
 		{
-			return GENERIC_WRITE;
+			regionEnd = end;
 		}
-		case OS::File::READ_WRITE:
-		case OS::File::READ_WRITE_CREATE:
+
+		if (info.State == MEM_COMMIT && IsReadablePage(info.Protect))
 		{
-			return GENERIC_READ | GENERIC_WRITE;
+			const volatile unsigned char* page = regionBegin;
+
+			for (; page < regionEnd; page += 4096)
+			{
+				dummy ^= *page;
+			}
 		}
+
+		regionBegin = regionEnd;
 	}
 
-	return 0;
+	UnmapViewOfFile(view);
+
+	return imageSize;
 }
 
-static DWORD ToNativeFileCreationDisposition(OS::File::Access access)
+///////////
+// Hacks //
+///////////
+
+bool OS::PumpWindowMessages()
 {
-	switch (access)
+	MSG msg;
+
+	while (PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE))
 	{
-		case OS::File::READ_ONLY:
-		case OS::File::WRITE_ONLY:
-		case OS::File::READ_WRITE:
-		{
-			return OPEN_EXISTING;
-		}
-		case OS::File::WRITE_ONLY_CREATE:
-		case OS::File::READ_WRITE_CREATE:
+		if (msg.message == WM_QUIT)
 		{
-			return OPEN_ALWAYS;
+			return false;
 		}
+
+		TranslateMessage(&msg);
+		DispatchMessageA(&msg);
 	}
 
-	return 0;
+	return true;
 }
 
-static DWORD ToNativeFileSeek(OS::File::SeekBase base)
+bool OS::IsProcessInForeground()
 {
-	switch (base)
+	HWND window = GetForegroundWindow();
+
+	if (!window || IsIconic(window))
 	{
-		case OS::File::BEGIN:   return FILE_BEGIN;
-		case OS::File::CURRENT: return FILE_CURRENT;
-		case OS::File::END:     return FILE_END;
+		return false;
 	}
 
-	return 0;
+	DWORD processID = 0;
+	GetWindowThreadProcessId(window, &processID);
+
+	return processID == GetCurrentProcessId();
 }
 
-bool OS::File::Open(const char* path, OS::File::Access access, bool* pCreated)
+std::size_t OS::Hack::WriteMemory(const Write* writes, std::size_t count)
 {
-	this->Close();
-
-	const DWORD mode = ToNativeFileAccessMode(access);
-	const DWORD share = FILE_SHARE_READ;
-	const DWORD creation = ToNativeFileCreationDisposition(access);
-	const DWORD attributes = FILE_ATTRIBUTE_NORMAL;
+	std::size_t i = 0;
 
-	HANDLE file = CreateFileA(path, mode, share, NULL, creation, attributes, NULL);
-	if (file == INVALID_HANDLE_VALUE)
+	while (i < count)
 	{
-		return false;
-	}
+		MEMORY_BASIC_INFORMATION region = {};
+		if (!VirtualQuery(writes[i].address, &region, sizeof region))
+		{
+			break;
+		}
 
-	if (pCreated)
-	{
-		*pCreated = (GetLastError() != ERROR_ALREADY_EXISTS);
-	}
+		// pages of a region share the same protection, so the following writes inside it can be done together
+		const char* regionEnd = static_cast<const char*>(region.BaseAddress) + region.RegionSize;
 
-	this->handle = file;
+		char* rangeBegin = static_cast<char*>(writes[i].address);
+		char* rangeEnd = rangeBegin + writes[i].size;
+		std::size_t last = i;
 
-	return true;
-}
+		while ((last + 1) < count)
+		{
+			char* begin = static_cast<char*>(writes[last + 1].address);
+			char* end = begin + writes[last + 1].size;
 
-std::size_t OS::File::Read(void* buffer, std::size_t bufferSize, bool* pError)
-{
-	bool isError = false;
+			if (end > regionEnd)
+			{
+				break;
+			}
 
-	DWORD bytesRead;
-	if (!ReadFile(static_cast<HANDLE>(this->handle), buffer, static_cast<DWORD>(bufferSize), &bytesRead, NULL))
-	{
-		isError = true;
-		bytesRead = 0;
-	}
+			if (end > rangeEnd)
+			{
+				rangeEnd = end;
+			}
 
-	if (pError)
-	{
-		*pError = isError;
-	}
+			last++;
+		}
 
-	return bytesRead;
-}
+		const std::size_t rangeSize = rangeEnd - rangeBegin;
 
-std::size_t OS::File::Write(const void* data, std::size_t dataSize, bool* pError)
-{
-#ifdef _WIN64
-	// WriteFile cannot write more than 4 GiB - 1 at once because DWORD is 32-bit even in 64-bit code
-	if (dataSize >= 0xFFFFFFFF)
-	{
-		SetLastError(ERROR_BUFFER_OVERFLOW);
+		DWORD oldProtection;
+		if (!VirtualProtect(rangeBegin, rangeSize, PAGE_EXECUTE_READWRITE, &oldProtection))
+		{
+			break;
+		}
 
-		if (pError)
+		for (std::size_t j = i; j <= last; j++)
 		{
-			*pError = true;
+			memcpy(writes[j].address, writes[j].data, writes[j].size);
 		}
 
-		return 0;
+		if (!VirtualProtect(rangeBegin, rangeSize, oldProtection, &oldProtection))
+		{
+			break;
+		}
+
+		i = last + 1;
 	}
-#endif
 
-	bool isError = false;
+	FlushInstructionCache(GetCurrentProcess(), NULL, 0);
 
-	DWORD bytesWritten;
-	if (!WriteFile(static_cast<HANDLE>(this->handle), data, static_cast<DWORD>(dataSize), &bytesWritten, NULL))
-	{
-		isError = true;
-		bytesWritten = 0;
-	}
+	return i;
+}
 
-	if (pError)
-	{
-		*pError = isError;
-	}
+/////////////
+// Threads //
+/////////////
 
-	return bytesWritten;
+OS::Event::Event(bool manualReset) : m_handle(CreateEventA(NULL, manualReset, FALSE, NULL))
+{
 }
 
-bool OS::File::Seek(OS::File::SeekBase base, __int64 offset, unsigned __int64* pNewPos)
+OS::WaitableTimer::WaitableTimer() : m_handle(NULL), m_isHighResolution(false)
 {
-	const DWORD seek = ToNativeFileSeek(base);
+	typedef HANDLE (WINAPI *TCreateWaitableTimerExW)(LPSECURITY_ATTRIBUTES, LPCWSTR, DWORD, DWORD);
 
-	LARGE_INTEGER offsetValue;
-	offsetValue.QuadPart = offset;
+	// not available in Windows XP
+	FARPROC createEx = GetProcAddress(GetModuleHandleA("kernel32.dll"), "CreateWaitableTimerExW");
 
-	if (!SetFilePointerEx(static_cast<HANDLE>(this->handle), offsetValue, &offsetValue, seek))
+	if (createEx)
 	{
-		return false;
+		const DWORD CREATE_WAITABLE_TIMER_HIGH_RESOLUTION = 0x2;
+
+		m_handle = reinterpret_cast<TCreateWaitableTimerExW>(createEx)(NULL, NULL,
+			CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+			TIMER_ALL_ACCESS
+		);
+
+		m_isHighResolution = (m_handle != NULL);
 	}
 
-	if (pNewPos)
+	if (!m_handle)
 	{
-		*pNewPos = static_cast<unsigned __int64>(offsetValue.QuadPart);
+		m_handle = CreateWaitableTimerA(NULL, TRUE, NULL);
 	}
-
-	return true;
 }
 
-bool OS::File::Resize(unsigned __int64 size)
+void OS::WaitableTimer::Sleep(unsigned int microseconds)
 {
-	// the offset is interpreted as an unsigned value
-	const __int64 offset = static_cast<__int64>(size);
+	if (!m_handle)
+	{
+		::Sleep(microseconds / 1000);
+		return;
+	}
 
-	return this->Seek(OS::File::BEGIN, offset) && SetEndOfFile(static_cast<HANDLE>(this->handle));
+	// negative means relative time in 100-nanosecond intervals
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -static_cast<LONGLONG>(microseconds) * 10;
+
+	if (SetWaitableTimer(m_handle, &dueTime, 0, NULL, NULL, FALSE))
+	{
+		WaitForSingleObject(m_handle, INFINITE);
+	}
 }
 
-bool OS::File::Copy(const char* srcPath, const char* dstPath)
+unsigned int __stdcall OS::Thread::Entry(void* param)
 {
-	const BOOL failIfExists = FALSE;
+	Thread* self = static_cast<Thread*>(param);
 
-	return CopyFile(srcPath, dstPath, failIfExists) == TRUE;
+	self->m_function(self->m_param);
+
+	return 0;
 }
 
-bool OS::Directory::Create(const char* path, bool* pCreated)
+bool OS::Thread::Start(Function function, void* param, unsigned int stackSize)
 {
-	bool created = true;
-
-	if (!CreateDirectoryA(path, NULL))
+	if (m_handle)
 	{
-		if (GetLastError() == ERROR_ALREADY_EXISTS)
+		return false;
+	}
+
+	m_function = function;
+	m_param = param;
+
+	// CRT-aware replacement of CreateThread
+	unsigned int id = 0;
+	const uintptr_t handle = _beginthreadex(NULL, stackSize, &Thread::Entry, this, 0, &id);
+
+	if (!handle)
+	{
+		return false;
+	}
+
+	m_handle = reinterpret_cast<void*>(handle);
+	m_id = id;
+
+	return true;
+}
+
+bool OS::Thread::Join(unsigned int timeoutMilliseconds)
+{
+	if (!m_handle)
+	{
+		return true;
+	}
+
+	if (GetCurrentThreadId() == m_id)
+	{
+		// the thread cannot wait for itself
+		return false;
+	}
+
+	if (WaitForSingleObject(m_handle, timeoutMilliseconds) != WAIT_OBJECT_0)
+	{
+		return false;
+	}
+
+	CloseHandle(m_handle);
+
+	m_handle = NULL;
+	m_id = 0;
+
+	return true;
+}
+
+////////////
+// Memory //
+////////////
+
+void* OS::AllocatePages(std::size_t size)
+{
+	return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void OS::FreePages(void* address)
+{
+	VirtualFree(address, 0, MEM_RELEASE);
+}
+
+std::size_t OS::GetLargePageSize()
+{
+	typedef SIZE_T (WINAPI *TGetLargePageMinimum)();
+
+	// not available on Windows XP
+	TGetLargePageMinimum pGetLargePageMinimum = reinterpret_cast<TGetLargePageMinimum>(
+		GetProcAddress(GetModuleHandleA("kernel32.dll"), "GetLargePageMinimum")
+	);
+
+	return (pGetLargePageMinimum) ? pGetLargePageMinimum() : 0;
+}
+
+void* OS::AllocateLargePages(std::size_t size)
+{
+	return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+}
+
+bool OS::EnableLockMemoryPrivilege()
+{
+	HANDLE token = NULL;
+
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+	{
+		return false;
+	}
+
+	TOKEN_PRIVILEGES privileges = {};
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+	bool success = false;
+
+	if (LookupPrivilegeValueA(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+	 && AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL))
+	{
+		// succeeds even if the privilege is not granted to the user
+		success = (GetLastError() != ERROR_NOT_ALL_ASSIGNED);
+	}
+
+	const DWORD error = GetLastError();
+	CloseHandle(token);
+	SetLastError(error);
+
+	return success;
+}
+
+bool OS::SetWorkingSetSize(std::size_t minSize, std::size_t maxSize)
+{
+	typedef BOOL (WINAPI *TSetProcessWorkingSetSizeEx)(HANDLE, SIZE_T, SIZE_T, DWORD);
+
+	// not available on Windows XP
+	TSetProcessWorkingSetSizeEx pSetProcessWorkingSetSizeEx = reinterpret_cast<TSetProcessWorkingSetSizeEx>(
+		GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetProcessWorkingSetSizeEx")
+	);
+
+	if (pSetProcessWorkingSetSizeEx)
+	{
+		const DWORD flags = QUOTA_LIMITS_HARDWS_MIN_ENABLE | QUOTA_LIMITS_HARDWS_MAX_DISABLE;
+
+		return pSetProcessWorkingSetSizeEx(GetCurrentProcess(), minSize, maxSize, flags) != 0;
+	}
+	else
+	{
+		return SetProcessWorkingSetSize(GetCurrentProcess(), minSize, maxSize) != 0;
+	}
+}
+
+void OS::PrefetchMemory(const void* address, std::size_t size)
+{
+	typedef BOOL (WINAPI *TPrefetchVirtualMemory)(HANDLE, ULONG_PTR, void*, ULONG);
+
+	struct MemoryRange
+	{
+		const void* address;
+		SIZE_T size;
+	};
+
+	// not available before Windows 8
+	static TPrefetchVirtualMemory pPrefetchVirtualMemory = reinterpret_cast<TPrefetchVirtualMemory>(
+		GetProcAddress(GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory")
+	);
+
+	if (pPrefetchVirtualMemory)
+	{
+		MemoryRange range;
+		range.address = address;
+		range.size = size;
+
+		pPrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+}
+
+bool OS::LockMemory(const void* address, std::size_t size)
+{
+	return VirtualLock(const_cast<void*>(address), size) != 0;
+}
+
+void OS::UnlockMemory(const void* address, std::size_t size)
+{
+	VirtualUnlock(const_cast<void*>(address), size);
+}
+
+///////////
+// Files //
+///////////
+
+static DWORD ToNativeFileAccessMode(OS::File::Access access)
+{
+	switch (access)
+	{
+		case OS::File::READ_ONLY:
+		{
+			return GENERIC_READ;
+		}
+		case OS::File::WRITE_ONLY:
+		case OS::File::WRITE_ONLY_CREATE:
+		{
+			return GENERIC_WRITE;
+		}
+		case OS::File::READ_WRITE:
+		case OS::File::READ_WRITE_CREATE:
+		{
+			return GENERIC_READ | GENERIC_WRITE;
+		}
+	}
+
+	return 0;
+}
+
+static DWORD ToNativeFileCreationDisposition(OS::File::Access access)
+{
+	switch (access)
+	{
+		case OS::File::READ_ONLY:
+		case OS::File::WRITE_ONLY:
+		case OS::File::READ_WRITE:
+		{
+			return OPEN_EXISTING;
+		}
+		case OS::File::WRITE_ONLY_CREATE:
+		case OS::File::READ_WRITE_CREATE:
+		{
+			return OPEN_ALWAYS;
+		}
+	}
+
+	return 0;
+}
+
+static DWORD ToNativeFileSeek(OS::File::SeekBase base)
+{
+	switch (base)
+	{
+		case OS::File::BEGIN:   return FILE_BEGIN;
+		case OS::File::CURRENT: return FILE_CURRENT;
+		case OS::File::END:     return FILE_END;
+	}
+
+	return 0;
+}
+
+bool OS::File::Open(const char* path, OS::File::Access access, bool* pCreated)
+{
+	this->Close();
+
+	const DWORD mode = ToNativeFileAccessMode(access);
+	const DWORD share = FILE_SHARE_READ;
+	const DWORD creation = ToNativeFileCreationDisposition(access);
+	const DWORD attributes = FILE_ATTRIBUTE_NORMAL;
+
+	HANDLE file = CreateFileA(path, mode, share, NULL, creation, attributes, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	if (pCreated)
+	{
+		*pCreated = (GetLastError() != ERROR_ALREADY_EXISTS);
+	}
+
+	this->handle = file;
+
+	return true;
+}
+
+std::FILE* OS::File::OpenAppendStream() const
+{
+	HANDLE process = GetCurrentProcess();
+	HANDLE duplicate = NULL;
+
+	if (!this->handle || !DuplicateHandle(process, this->handle, process, &duplicate, 0, FALSE, DUPLICATE_SAME_ACCESS))
+	{
+		return NULL;
+	}
+
+	const int fd = _open_osfhandle(reinterpret_cast<intptr_t>(duplicate), _O_APPEND | _O_WRONLY);
+
+	if (fd < 0)
+	{
+		CloseHandle(duplicate);
+		return NULL;
+	}
+
+	// closes the descriptor and the duplicate handle on failure or once the stream is closed
+	std::FILE* stream = _fdopen(fd, "a");
+
+	if (!stream)
+	{
+		_close(fd);
+	}
+
+	return stream;
+}
+
+std::size_t OS::File::Read(void* buffer, std::size_t bufferSize, bool* pError)
+{
+	bool isError = false;
+
+	DWORD bytesRead;
+	if (!ReadFile(static_cast<HANDLE>(this->handle), buffer, static_cast<DWORD>(bufferSize), &bytesRead, NULL))
+	{
+		isError = true;
+		bytesRead = 0;
+	}
+
+	if (pError)
+	{
+		*pError = isError;
+	}
+
+	return bytesRead;
+}
+
+std::size_t OS::File::Write(const void* data, std::size_t dataSize, bool* pError)
+{
+#ifdef _WIN64
+	// WriteFile cannot write more than 4 GiB - 1 at once because DWORD is 32-bit even in 64-bit code
+	if (dataSize >= 0xFFFFFFFF)
+	{
+		SetLastError(ERROR_BUFFER_OVERFLOW);
+
+		if (pError)
+		{
+			*pError = true;
+		}
+
+		return 0;
+	}
+#endif
+
+	bool isError = false;
+
+	DWORD bytesWritten;
+	if (!WriteFile(static_cast<HANDLE>(this->handle), data, static_cast<DWORD>(dataSize), &bytesWritten, NULL))
+	{
+		isError = true;
+		bytesWritten = 0;
+	}
+
+	if (pError)
+	{
+		*pError = isError;
+	}
+
+	return bytesWritten;
+}
+
+bool OS::File::Seek(OS::File::SeekBase base, __int64 offset, unsigned __int64* pNewPos)
+{
+	const DWORD seek = ToNativeFileSeek(base);
+
+	LARGE_INTEGER offsetValue;
+	offsetValue.QuadPart = offset;
+
+	if (!SetFilePointerEx(static_cast<HANDLE>(this->handle), offsetValue, &offsetValue, seek))
+	{
+		return false;
+	}
+
+	if (pNewPos)
+	{
+		*pNewPos = static_cast<unsigned __int64>(offsetValue.QuadPart);
+	}
+
+	return true;
+}
+
+bool OS::File::Resize(unsigned __int64 size)
+{
+	// the offset is interpreted as an unsigned value
+	const __int64 offset = static_cast<__int64>(size);
+
+	return this->Seek(OS::File::BEGIN, offset) && SetEndOfFile(static_cast<HANDLE>(this->handle));
+}
+
+bool OS::File::Exists(const char* path)
+{
+	const DWORD attributes = GetFileAttributesA(path);
+
+	return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+bool OS::File::Copy(const char* srcPath, const char* dstPath)
+{
+	const BOOL failIfExists = FALSE;
+
+	return CopyFile(srcPath, dstPath, failIfExists) == TRUE;
+}
+
+bool OS::File::Move(const char* srcPath, const char* dstPath)
+{
+	const DWORD flags = MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED;
+
+	return MoveFileExA(srcPath, dstPath, flags) != FALSE;
+}
+
+std::size_t OS::ReadStandardInput(void* buffer, std::size_t bufferSize, bool* pError)
+{
+	bool isError = false;
+
+	HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+
+	DWORD bytesRead = 0;
+	if (input == NULL || input == INVALID_HANDLE_VALUE
+	 || !ReadFile(input, buffer, static_cast<DWORD>(bufferSize), &bytesRead, NULL))
+	{
+		// closed pipe is the normal end of input
+		isError = (GetLastError() != ERROR_BROKEN_PIPE);
+		bytesRead = 0;
+	}
+
+	if (pError)
+	{
+		*pError = isError;
+	}
+
+	return bytesRead;
+}
+
+bool OS::WriteStandardError(const void* data, std::size_t dataSize)
+{
+	HANDLE output = GetStdHandle(STD_ERROR_HANDLE);
+
+	DWORD bytesWritten = 0;
+	if (output == NULL || output == INVALID_HANDLE_VALUE
+	 || !WriteFile(output, data, static_cast<DWORD>(dataSize), &bytesWritten, NULL))
+	{
+		return false;
+	}
+
+	return bytesWritten == dataSize;
+}
+
+bool OS::Directory::Create(const char* path, bool* pCreated)
+{
+	bool created = true;
+
+	if (!CreateDirectoryA(path, NULL))
+	{
+		if (GetLastError() == ERROR_ALREADY_EXISTS)
 		{
 			created = false;
 		}
@@ -384,157 +1000,842 @@ bool OS::Directory::Create(const char* path, bool* pCreated)
 		}
 	}
 
-	if (pCreated)
+	if (pCreated)
+	{
+		*pCreated = created;
+	}
+
+	return true;
+}
+
+bool OS::FileMapping::Open(const char* path)
+{
+	this->Close();
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		// empty files cannot be mapped
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	// the mapping keeps the file open
+	CloseHandle(file);
+
+	if (!mapping)
+	{
+		return false;
+	}
+
+	this->handle = mapping;
+	this->size = fileSize.QuadPart;
+
+	return true;
+}
+
+const void* OS::FileMapping::Map(unsigned __int64 offset, std::size_t viewSize)
+{
+	const DWORD offsetHigh = static_cast<DWORD>(offset >> 32);
+	const DWORD offsetLow = static_cast<DWORD>(offset);
+
+	return MapViewOfFile(static_cast<HANDLE>(this->handle), FILE_MAP_READ, offsetHigh, offsetLow, viewSize);
+}
+
+void OS::FileMapping::Unmap(const void* view)
+{
+	UnmapViewOfFile(view);
+}
+
+bool OS::Directory::ForEachFile(const char* pattern, FileCallback callback, void* param)
+{
+	WIN32_FIND_DATAA data;
+
+	HANDLE search = FindFirstFileA(pattern, &data);
+	if (search == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	do
+	{
+		if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+		{
+			callback(data.cFileName, param);
+		}
+	}
+	while (FindNextFileA(search, &data));
+
+	FindClose(search);
+
+	return true;
+}
+
+std::size_t OS::GetDocumentsPath(char* buffer, std::size_t bufferSize)
+{
+	const int id = CSIDL_PERSONAL | CSIDL_FLAG_CREATE;
+	const DWORD flags = SHGFP_TYPE_CURRENT;
+
+	char* targetBuffer = buffer;
+
+	char safeBuffer[MAX_PATH + 1];
+	if (bufferSize <= MAX_PATH)
+	{
+		targetBuffer = safeBuffer;
+	}
+
+	if (SHGetFolderPathA(NULL, id, NULL, flags, targetBuffer) != S_OK)
+	{
+		SetLastError(ERROR_PATH_NOT_FOUND);
+		return 0;
+	}
+
+	const std::size_t resultLength = strlen(targetBuffer);
+
+	if (targetBuffer != buffer)
+	{
+		if (resultLength >= bufferSize)
+		{
+			SetLastError(ERROR_BUFFER_OVERFLOW);
+			return 0;
+		}
+
+		memcpy(buffer, targetBuffer, resultLength + 1);
+	}
+
+	return resultLength;
+}
+
+//////////
+// Time //
+//////////
+
+static OS::DateTime FromNativeDateTime(const SYSTEMTIME& dateTime)
+{
+	OS::DateTime result;
+	result.year        = dateTime.wYear;
+	result.month       = dateTime.wMonth;
+	result.dayOfWeek   = dateTime.wDayOfWeek;
+	result.day         = dateTime.wDay;
+	result.hour        = dateTime.wHour;
+	result.minute      = dateTime.wMinute;
+	result.second      = dateTime.wSecond;
+	result.millisecond = dateTime.wMilliseconds;
+
+	if (result.dayOfWeek == 0)
+	{
+		result.dayOfWeek = 7;
+	}
+
+	return result;
+}
+
+const char* OS::DateTime::GetDayName()
+{
+	switch (this->dayOfWeek)
+	{
+		case 1: return "Monday";
+		case 2: return "Tuesday";
+		case 3: return "Wednesday";
+		case 4: return "Thursday";
+		case 5: return "Friday";
+		case 6: return "Saturday";
+		case 7: return "Sunday";
+	}
+
+	return "";
+}
+
+const char* OS::DateTime::GetMonthName()
+{
+	switch (this->month)
+	{
+		case 1:  return "January";
+		case 2:  return "February";
+		case 3:  return "March";
+		case 4:  return "April";
+		case 5:  return "May";
+		case 6:  return "June";
+		case 7:  return "July";
+		case 8:  return "August";
+		case 9:  return "September";
+		case 10: return "October";
+		case 11: return "November";
+		case 12: return "December";
+	}
+
+	return "";
+}
+
+OS::DateTime OS::GetCurrentDateTimeUTC()
+{
+	SYSTEMTIME dateTime;
+	GetSystemTime(&dateTime);
+
+	return FromNativeDateTime(dateTime);
+}
+
+OS::DateTime OS::GetCurrentDateTimeLocal()
+{
+	SYSTEMTIME dateTime;
+	GetLocalTime(&dateTime);
+
+	return FromNativeDateTime(dateTime);
+}
+
+unsigned __int64 OS::GetCurrentUnixTimeMilliseconds()
+{
+	FILETIME time;
+	GetSystemTimeAsFileTime(&time);
+
+	const unsigned __int64 value = (static_cast<unsigned __int64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+
+	// 100-nanosecond intervals since 1601-01-01 00:00:00 UTC
+	const unsigned __int64 unixEpoch = 116444736000000000ULL;
+
+	return (value - unixEpoch) / 10000;
+}
+
+unsigned __int64 OS::GetPerformanceCounter()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	return static_cast<unsigned __int64>(counter.QuadPart);
+}
+
+unsigned __int64 OS::GetPerformanceFrequency()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	return static_cast<unsigned __int64>(frequency.QuadPart);
+}
+
+long OS::GetCurrentTimeZoneBias()
+{
+	TIME_ZONE_INFORMATION tz;
+	switch (GetTimeZoneInformation(&tz))
+	{
+		case TIME_ZONE_ID_UNKNOWN:  return tz.Bias;
+		case TIME_ZONE_ID_STANDARD: return tz.Bias + tz.StandardBias;
+		case TIME_ZONE_ID_DAYLIGHT: return tz.Bias + tz.DaylightBias;
+		case TIME_ZONE_ID_INVALID:  return 0;
+	}
+
+	return 0;
+}
+
+///////////////
+// Processes //
+///////////////
+
+static bool CreateProcessFromCmdLine(const char* cmdLine, DWORD flags, PROCESS_INFORMATION& processInfo)
+{
+	// CreateProcessA may modify the command line
+	char buffer[32768];
+	const std::size_t length = strlen(cmdLine);
+
+	if (length >= sizeof buffer)
+	{
+		SetLastError(ERROR_BUFFER_OVERFLOW);
+		return false;
+	}
+
+	memcpy(buffer, cmdLine, length + 1);
+
+	STARTUPINFOA startupInfo = {};
+	startupInfo.cb = sizeof startupInfo;
+
+	return CreateProcessA(NULL, buffer, NULL, NULL, FALSE, flags, NULL, NULL, &startupInfo, &processInfo) != FALSE;
+}
+
+bool OS::StartProcess(const char* cmdLine)
+{
+	PROCESS_INFORMATION processInfo = {};
+
+	if (!CreateProcessFromCmdLine(cmdLine, 0, processInfo))
+	{
+		return false;
+	}
+
+	CloseHandle(processInfo.hThread);
+	CloseHandle(processInfo.hProcess);
+
+	return true;
+}
+
+static HANDLE CreateKillOnCloseJob()
+{
+	HANDLE job = CreateJobObjectA(NULL, NULL);
+
+	if (!job)
+	{
+		return NULL;
+	}
+
+	JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+	limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+
+	if (!SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof limits))
+	{
+		CloseHandle(job);
+		return NULL;
+	}
+
+	return job;
+}
+
+bool OS::ChildProcess::Start(const char* cmdLine)
+{
+	this->Close();
+
+	PROCESS_INFORMATION processInfo = {};
+
+	// suspended until it is in the job, so nothing it starts can escape
+	if (!CreateProcessFromCmdLine(cmdLine, CREATE_SUSPENDED, processInfo))
+	{
+		return false;
+	}
+
+	m_job = CreateKillOnCloseJob();
+
+	if (m_job && !AssignProcessToJobObject(m_job, processInfo.hProcess))
+	{
+		CloseHandle(m_job);
+		m_job = NULL;
+	}
+
+	ResumeThread(processInfo.hThread);
+	CloseHandle(processInfo.hThread);
+
+	m_process = processInfo.hProcess;
+	m_id = processInfo.dwProcessId;
+
+	return true;
+}
+
+bool OS::ChildProcess::IsRunning() const
+{
+	if (!m_process)
+	{
+		return false;
+	}
+
+	if (m_job)
+	{
+		JOBOBJECT_BASIC_ACCOUNTING_INFORMATION info = {};
+
+		if (QueryInformationJobObject(m_job, JobObjectBasicAccountingInformation, &info, sizeof info, NULL))
+		{
+			return info.ActiveProcesses > 0;
+		}
+	}
+
+	return WaitForSingleObject(m_process, 0) == WAIT_TIMEOUT;
+}
+
+bool OS::ChildProcess::GetExitCode(unsigned long& exitCode) const
+{
+	DWORD code = 0;
+
+	if (!m_process || !GetExitCodeProcess(m_process, &code) || code == STILL_ACTIVE)
 	{
-		*pCreated = created;
+		return false;
 	}
 
+	exitCode = code;
+
 	return true;
 }
 
-std::size_t OS::GetDocumentsPath(char* buffer, std::size_t bufferSize)
+void OS::ChildProcess::Terminate(unsigned int exitCode)
 {
-	const int id = CSIDL_PERSONAL | CSIDL_FLAG_CREATE;
-	const DWORD flags = SHGFP_TYPE_CURRENT;
+	if (m_job)
+	{
+		TerminateJobObject(m_job, exitCode);
+	}
+	else if (m_process)
+	{
+		TerminateProcess(m_process, exitCode);
+	}
+}
 
-	char* targetBuffer = buffer;
+void OS::ChildProcess::Close()
+{
+	if (m_job)
+	{
+		// terminates all its processes
+		CloseHandle(m_job);
+		m_job = NULL;
+	}
+	else if (m_process && WaitForSingleObject(m_process, 0) == WAIT_TIMEOUT)
+	{
+		TerminateProcess(m_process, 1);
+	}
 
-	char safeBuffer[MAX_PATH + 1];
-	if (bufferSize <= MAX_PATH)
+	if (m_process)
 	{
-		targetBuffer = safeBuffer;
+		CloseHandle(m_process);
+		m_process = NULL;
 	}
 
-	if (SHGetFolderPathA(NULL, id, NULL, flags, targetBuffer) != S_OK)
+	m_id = 0;
+}
+
+void OS::TerminateCurrentProcess(unsigned int exitCode)
+{
+	TerminateProcess(GetCurrentProcess(), exitCode);
+}
+
+////////////////////////
+// System information //
+////////////////////////
+
+bool OS::IsVistaOrLater()
+{
+	OSVERSIONINFOW info = {};
+	info.dwOSVersionInfoSize = sizeof info;
+	GetVersionExW(&info);
+
+	return info.dwMajorVersion >= 6;
+}
+
+unsigned int OS::GetLogicalProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	return info.dwNumberOfProcessors;
+}
+
+static unsigned int CountBits(ULONG_PTR mask)
+{
+	unsigned int count = 0;
+
+	for (; mask; mask &= mask - 1)
 	{
-		SetLastError(ERROR_PATH_NOT_FOUND);
-		return 0;
+		count++;
 	}
 
-	const std::size_t resultLength = strlen(targetBuffer);
+	return count;
+}
 
-	if (targetBuffer != buffer)
+// SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX is missing in old SDKs
+struct LogicalProcessorInformation
+{
+	DWORD relationship;
+	DWORD size;
+
+	// PROCESSOR_RELATIONSHIP
+	BYTE flags;
+	BYTE efficiencyClass;
+	BYTE reserved[20];
+	WORD groupCount;
+
+	struct GroupAffinity
 	{
-		if (resultLength >= bufferSize)
-		{
-			SetLastError(ERROR_BUFFER_OVERFLOW);
-			return 0;
-		}
+		ULONG_PTR mask;
+		WORD group;
+		WORD reserved[3];
+	};
 
-		memcpy(buffer, targetBuffer, resultLength + 1);
+	GroupAffinity groupMasks[1];
+};
+
+#define RELATION_PROCESSOR_CORE 0
+#define RELATION_PROCESSOR_PACKAGE 3
+#define RELATION_ALL 0xFFFF
+
+// returns NULL if not available, free the result with free()
+static LogicalProcessorInformation* QueryLogicalProcessorInformation(DWORD& size)
+{
+	typedef BOOL (WINAPI *TGetLogicalProcessorInformationEx)(int, LogicalProcessorInformation*, DWORD*);
+
+	// Windows 7+
+	TGetLogicalProcessorInformationEx pGetLogicalProcessorInformationEx =
+		reinterpret_cast<TGetLogicalProcessorInformationEx>(
+			GetProcAddress(GetModuleHandleA("kernel32.dll"), "GetLogicalProcessorInformationEx")
+		);
+
+	size = 0;
+
+	if (!pGetLogicalProcessorInformationEx)
+	{
+		return NULL;
 	}
 
-	return resultLength;
+	pGetLogicalProcessorInformationEx(RELATION_ALL, NULL, &size);
+
+	LogicalProcessorInformation* pInfo = (size > 0) ? static_cast<LogicalProcessorInformation*>(malloc(size)) : NULL;
+
+	if (pInfo && !pGetLogicalProcessorInformationEx(RELATION_ALL, pInfo, &size))
+	{
+		free(pInfo);
+		pInfo = NULL;
+	}
+
+	return pInfo;
 }
 
-//////////
-// Time //
-//////////
+static const LogicalProcessorInformation* NextLogicalProcessorInformation(const LogicalProcessorInformation* pInfo)
+{
+	return reinterpret_cast<const LogicalProcessorInformation*>(reinterpret_cast<const char*>(pInfo) + pInfo->size);
+}
 
-static OS::DateTime FromNativeDateTime(const SYSTEMTIME& dateTime)
+// the process affinity mask applies only to the processor group of the process
+static WORD GetProcessGroup()
 {
-	OS::DateTime result;
-	result.year        = dateTime.wYear;
-	result.month       = dateTime.wMonth;
-	result.dayOfWeek   = dateTime.wDayOfWeek;
-	result.day         = dateTime.wDay;
-	result.hour        = dateTime.wHour;
-	result.minute      = dateTime.wMinute;
-	result.second      = dateTime.wSecond;
-	result.millisecond = dateTime.wMilliseconds;
+	typedef BOOL (WINAPI *TGetThreadGroupAffinity)(HANDLE, LogicalProcessorInformation::GroupAffinity*);
 
-	if (result.dayOfWeek == 0)
+	// Windows 7+
+	TGetThreadGroupAffinity pGetThreadGroupAffinity = reinterpret_cast<TGetThreadGroupAffinity>(
+		GetProcAddress(GetModuleHandleA("kernel32.dll"), "GetThreadGroupAffinity")
+	);
+
+	LogicalProcessorInformation::GroupAffinity affinity = {};
+
+	if (pGetThreadGroupAffinity && pGetThreadGroupAffinity(GetCurrentThread(), &affinity))
 	{
-		result.dayOfWeek = 7;
+		return affinity.group;
 	}
 
-	return result;
+	return 0;
 }
 
-const char* OS::DateTime::GetDayName()
+OS::ProcessorTopology OS::GetProcessorTopology()
 {
-	switch (this->dayOfWeek)
+	ProcessorTopology topology;
+
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+
+	const WORD processGroup = GetProcessGroup();
+
+	DWORD size = 0;
+	LogicalProcessorInformation* pInfoBuffer = QueryLogicalProcessorInformation(size);
+
+	if (pInfoBuffer)
 	{
-		case 1: return "Monday";
-		case 2: return "Tuesday";
-		case 3: return "Wednesday";
-		case 4: return "Thursday";
-		case 5: return "Friday";
-		case 6: return "Saturday";
-		case 7: return "Sunday";
+		const LogicalProcessorInformation* pInfoEnd =
+			reinterpret_cast<const LogicalProcessorInformation*>(reinterpret_cast<const char*>(pInfoBuffer) + size);
+
+		unsigned int maxEfficiencyClass = 0;
+
+		for (const LogicalProcessorInformation* pInfo = pInfoBuffer; pInfo < pInfoEnd;
+		     pInfo = NextLogicalProcessorInformation(pInfo))
+		{
+			if (pInfo->relationship == RELATION_PROCESSOR_PACKAGE)
+			{
+				topology.packageCount++;
+			}
+			else if (pInfo->relationship == RELATION_PROCESSOR_CORE)
+			{
+				unsigned int availableCount = 0;
+
+				for (WORD i = 0; i < pInfo->groupCount; i++)
+				{
+					const LogicalProcessorInformation::GroupAffinity& affinity = pInfo->groupMasks[i];
+
+					topology.logicalCount += CountBits(affinity.mask);
+
+					if (affinity.group == processGroup)
+					{
+						availableCount += CountBits(affinity.mask & processMask);
+					}
+				}
+
+				topology.physicalCount++;
+				topology.availableLogicalCount += availableCount;
+
+				if (availableCount > 0)
+				{
+					topology.availablePhysicalCount++;
+				}
+
+				// only hybrid CPUs have more than one efficiency class
+				if (pInfo->efficiencyClass > maxEfficiencyClass)
+				{
+					maxEfficiencyClass = pInfo->efficiencyClass;
+					topology.performanceCount = 1;
+				}
+				else if (pInfo->efficiencyClass == maxEfficiencyClass)
+				{
+					topology.performanceCount++;
+				}
+			}
+		}
+
+		if (maxEfficiencyClass == 0)
+		{
+			topology.performanceCount = 0;
+		}
+
+		free(pInfoBuffer);
 	}
 
-	return "";
+	if (topology.physicalCount == 0)
+	{
+		topology.packageCount = 1;
+		topology.physicalCount = GetLogicalProcessorCount();
+		topology.logicalCount = topology.physicalCount;
+		topology.availableLogicalCount = CountBits(processMask);
+		topology.availablePhysicalCount = topology.availableLogicalCount;
+	}
+
+	return topology;
 }
 
-const char* OS::DateTime::GetMonthName()
+unsigned int OS::GetProcessorCoreMasks(std::size_t* masks, unsigned int maxCount)
 {
-	switch (this->month)
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+
+	const WORD processGroup = GetProcessGroup();
+
+	unsigned int count = 0;
+
+	DWORD size = 0;
+	LogicalProcessorInformation* pInfoBuffer = QueryLogicalProcessorInformation(size);
+
+	if (pInfoBuffer)
 	{
-		case 1:  return "January";
-		case 2:  return "February";
-		case 3:  return "March";
-		case 4:  return "April";
-		case 5:  return "May";
-		case 6:  return "June";
-		case 7:  return "July";
-		case 8:  return "August";
-		case 9:  return "September";
-		case 10: return "October";
-		case 11: return "November";
-		case 12: return "December";
+		const LogicalProcessorInformation* pInfoEnd =
+			reinterpret_cast<const LogicalProcessorInformation*>(reinterpret_cast<const char*>(pInfoBuffer) + size);
+
+		for (const LogicalProcessorInformation* pInfo = pInfoBuffer; pInfo < pInfoEnd && count < maxCount;
+		     pInfo = NextLogicalProcessorInformation(pInfo))
+		{
+			if (pInfo->relationship != RELATION_PROCESSOR_CORE)
+			{
+				continue;
+			}
+
+			std::size_t mask = 0;
+
+			for (WORD i = 0; i < pInfo->groupCount; i++)
+			{
+				if (pInfo->groupMasks[i].group == processGroup)
+				{
+					mask |= pInfo->groupMasks[i].mask & systemMask;
+				}
+			}
+
+			if (mask)
+			{
+				masks[count++] = mask;
+			}
+		}
+
+		free(pInfoBuffer);
 	}
+	else
+	{
+		// each logical processor is a core
+		for (unsigned int i = 0; i < (sizeof systemMask * 8) && count < maxCount; i++)
+		{
+			const std::size_t mask = static_cast<std::size_t>(1) << i;
 
-	return "";
+			if (systemMask & mask)
+			{
+				masks[count++] = mask;
+			}
+		}
+	}
+
+	return count;
 }
 
-OS::DateTime OS::GetCurrentDateTimeUTC()
+std::size_t OS::GetProcessAffinity()
 {
-	SYSTEMTIME dateTime;
-	GetSystemTime(&dateTime);
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
 
-	return FromNativeDateTime(dateTime);
+	return processMask;
 }
 
-OS::DateTime OS::GetCurrentDateTimeLocal()
+bool OS::SetProcessAffinity(std::size_t mask)
 {
-	SYSTEMTIME dateTime;
-	GetLocalTime(&dateTime);
+	return SetProcessAffinityMask(GetCurrentProcess(), mask) != 0;
+}
 
-	return FromNativeDateTime(dateTime);
+bool OS::SetCurrentThreadAffinity(std::size_t mask)
+{
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
 }
 
-long OS::GetCurrentTimeZoneBias()
+// not defined in older SDKs
+#ifndef THREAD_MODE_BACKGROUND_BEGIN
+#define THREAD_MODE_BACKGROUND_BEGIN 0x00010000
+#endif
+
+bool OS::EnterBackgroundMode()
 {
-	TIME_ZONE_INFORMATION tz;
-	switch (GetTimeZoneInformation(&tz))
+	// supported since Windows Vista
+	if (SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN))
 	{
-		case TIME_ZONE_ID_UNKNOWN:  return tz.Bias;
-		case TIME_ZONE_ID_STANDARD: return tz.Bias + tz.StandardBias;
-		case TIME_ZONE_ID_DAYLIGHT: return tz.Bias + tz.DaylightBias;
-		case TIME_ZONE_ID_INVALID:  return 0;
+		return true;
 	}
 
-	return 0;
+	return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE) != 0;
 }
 
-////////////////////////
-// System information //
-////////////////////////
+bool OS::SetProcessPriority(ProcessPriority priority)
+{
+	// indexed by ProcessPriority
+	const DWORD priorityClasses[] = {
+		IDLE_PRIORITY_CLASS,
+		BELOW_NORMAL_PRIORITY_CLASS,
+		NORMAL_PRIORITY_CLASS,
+		ABOVE_NORMAL_PRIORITY_CLASS,
+		HIGH_PRIORITY_CLASS,
+	};
+
+	return SetPriorityClass(GetCurrentProcess(), priorityClasses[priority]) != 0;
+}
 
-bool OS::IsVistaOrLater()
+// undocumented information classes of NtSetInformationProcess and NtSetInformationThread
+#define PROCESS_INFORMATION_IO_PRIORITY 33
+#define THREAD_INFORMATION_IO_PRIORITY 22
+
+typedef LONG (WINAPI *TNtInformationFunc)(HANDLE, ULONG, PVOID, ULONG);
+typedef LONG (WINAPI *TNtQueryInformationFunc)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+
+static FARPROC GetNTDLLFunction(const char* name)
 {
-	OSVERSIONINFOW info = {};
-	info.dwOSVersionInfoSize = sizeof info;
-	GetVersionExW(&info);
+	HMODULE ntdll = GetModuleHandleA("ntdll.dll");
 
-	return info.dwMajorVersion >= 6;
+	return (ntdll) ? GetProcAddress(ntdll, name) : NULL;
 }
 
-unsigned int OS::GetLogicalProcessorCount()
+static bool SetIOPriority(const char* funcName, HANDLE handle, ULONG infoClass, OS::IOPriority priority)
 {
-	SYSTEM_INFO info;
-	GetSystemInfo(&info);
+	TNtInformationFunc pFunc = reinterpret_cast<TNtInformationFunc>(GetNTDLLFunction(funcName));
 
-	return info.dwNumberOfProcessors;
+	if (!pFunc)
+	{
+		return false;
+	}
+
+	ULONG value = static_cast<ULONG>(priority);
+
+	// NTSTATUS, negative on failure
+	return pFunc(handle, infoClass, &value, sizeof value) >= 0;
+}
+
+bool OS::SetProcessIOPriority(IOPriority priority)
+{
+	return SetIOPriority("NtSetInformationProcess", GetCurrentProcess(), PROCESS_INFORMATION_IO_PRIORITY, priority);
+}
+
+bool OS::SetCurrentThreadIOPriority(IOPriority priority)
+{
+	return SetIOPriority("NtSetInformationThread", GetCurrentThread(), THREAD_INFORMATION_IO_PRIORITY, priority);
+}
+
+OS::IOPriority OS::GetProcessIOPriority()
+{
+	TNtQueryInformationFunc pFunc = reinterpret_cast<TNtQueryInformationFunc>(
+		GetNTDLLFunction("NtQueryInformationProcess"));
+
+	ULONG value = IO_PRIORITY_NORMAL;
+
+	if (!pFunc || pFunc(GetCurrentProcess(), PROCESS_INFORMATION_IO_PRIORITY, &value, sizeof value, NULL) < 0)
+	{
+		return IO_PRIORITY_NORMAL;
+	}
+
+	return (value < IO_PRIORITY_NORMAL) ? static_cast<IOPriority>(value) : IO_PRIORITY_NORMAL;
+}
+
+bool OS::TimerResolution::Request(unsigned int milliseconds)
+{
+	if (milliseconds == m_period)
+	{
+		return true;
+	}
+
+	this->Release();
+
+	if (timeBeginPeriod(milliseconds) != TIMERR_NOERROR)
+	{
+		return false;
+	}
+
+	m_period = milliseconds;
+
+	return true;
+}
+
+void OS::TimerResolution::Release()
+{
+	if (m_period)
+	{
+		timeEndPeriod(m_period);
+		m_period = 0;
+	}
+}
+
+bool OS::GetMemoryUsage(MemoryUsage& usage)
+{
+	typedef BOOL (WINAPI *TGetProcessMemoryInfo)(HANDLE, PROCESS_MEMORY_COUNTERS*, DWORD);
+
+	static TGetProcessMemoryInfo pGetProcessMemoryInfo = NULL;
+
+	if (!pGetProcessMemoryInfo)
+	{
+		// Windows 7 moved the function into kernel32, older systems have it only in psapi
+		HMODULE mod = GetModuleHandleA("kernel32.dll");
+		FARPROC pFunc = (mod) ? GetProcAddress(mod, "K32GetProcessMemoryInfo") : NULL;
+
+		if (!pFunc)
+		{
+			mod = LoadLibraryA("psapi.dll");
+			pFunc = (mod) ? GetProcAddress(mod, "GetProcessMemoryInfo") : NULL;
+		}
+
+		if (!pFunc)
+		{
+			return false;
+		}
+
+		pGetProcessMemoryInfo = reinterpret_cast<TGetProcessMemoryInfo>(pFunc);
+	}
+
+	PROCESS_MEMORY_COUNTERS counters = {};
+	counters.cb = sizeof counters;
+
+	if (!pGetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters))
+	{
+		return false;
+	}
+
+	MEMORYSTATUSEX status = {};
+	status.dwLength = sizeof status;
+
+	if (!GlobalMemoryStatusEx(&status))
+	{
+		return false;
+	}
+
+	usage.workingSet = counters.WorkingSetSize;
+	usage.peakWorkingSet = counters.PeakWorkingSetSize;
+	usage.privateBytes = counters.PagefileUsage;
+	usage.totalPhysical = status.ullTotalPhys;
+	usage.availablePhysical = status.ullAvailPhys;
+	usage.totalVirtual = status.ullTotalVirtual;
+	usage.availableVirtual = status.ullAvailVirtual;
+
+	return true;
 }
@@ -2,6 +2,7 @@
 
 #include <cstdarg>
 #include <cstddef>
+#include <cstdio>
 
 #ifndef _INC_WINDOWS
 typedef unsigned long DWORD;
@@ -61,10 +62,37 @@ extern "C"
 	__declspec(dllimport) void __stdcall DeleteCriticalSection(CRITICAL_SECTION* cs);
 	__declspec(dllimport) void __stdcall EnterCriticalSection(CRITICAL_SECTION* cs);
 	__declspec(dllimport) void __stdcall LeaveCriticalSection(CRITICAL_SECTION* cs);
+	__declspec(dllimport) DWORD __stdcall TlsAlloc();
+	__declspec(dllimport) int __stdcall TlsFree(DWORD index);
+	__declspec(dllimport) void* __stdcall TlsGetValue(DWORD index);
+	__declspec(dllimport) int __stdcall TlsSetValue(DWORD index, void* value);
+	__declspec(dllimport) void __stdcall Sleep(DWORD milliseconds);
+	__declspec(dllimport) int __stdcall SwitchToThread();
+
+	__declspec(dllimport) int __stdcall SetEvent(HANDLE event);
+	__declspec(dllimport) int __stdcall ResetEvent(HANDLE event);
+	__declspec(dllimport) DWORD __stdcall WaitForSingleObject(HANDLE handle, DWORD milliseconds);
 
 	__declspec(dllimport) int __stdcall CloseHandle(HANDLE handle);
+
+	__declspec(dllimport) DWORD __stdcall GetTickCount();
+
+	// compiler intrinsics
+	long __cdecl _InterlockedIncrement(long volatile* value);
+	long __cdecl _InterlockedDecrement(long volatile* value);
+	long __cdecl _InterlockedExchange(long volatile* target, long value);
+	long __cdecl _InterlockedExchangeAdd(long volatile* target, long value);
+	long __cdecl _InterlockedCompareExchange(long volatile* target, long value, long comparand);
 }
 
+#ifdef _MSC_VER
+#pragma intrinsic(_InterlockedIncrement)
+#pragma intrinsic(_InterlockedDecrement)
+#pragma intrinsic(_InterlockedExchange)
+#pragma intrinsic(_InterlockedExchangeAdd)
+#pragma intrinsic(_InterlockedCompareExchange)
+#endif
+
 #define OS_NEWLINE "\r\n"
 #define OS_NEWLINE_LENGTH 2
 
@@ -85,9 +113,17 @@ namespace OS
 
 		const char* GetOnlyArgs();
 
+		/**
+		 * Arguments are parsed into a hash table on first use, which must happen on the main thread. Lookups are
+		 * case-insensitive and only the first occurrence of each argument counts.
+		 */
 		bool HasArg(const char* arg);
 
 		const char* GetArgValue(const char* arg, const char* defaultValue = "");
+
+		// adds an argument unless it is already present, e.g. from a config file
+		// value may be NULL, both strings are copied
+		bool AddArg(const char* arg, const char* value);
 	}
 
 	////////////
@@ -154,6 +190,11 @@ namespace OS
 			int GetTweak(void* mod);
 			int GetPatch(void* mod);
 		}
+
+		// reads the image of a module that is not loaded yet into memory, so loading it later causes no disk reads
+		// the image is mapped only at its preferred address, so it never takes the place of another module
+		// returns the image size or zero if nothing was prefetched
+		std::size_t Prefetch(const char* path);
 	}
 
 	//////////////////
@@ -165,14 +206,35 @@ namespace OS
 		::MessageBoxA(NULL, message, title, 0x0 | 0x10);  // MB_OK | MB_ICONERROR
 	}
 
+	// dispatches all pending messages of the current thread
+	// returns false if WM_QUIT was received
+	bool PumpWindowMessages();
+
+	// the foreground window belongs to the current process and is not minimized
+	bool IsProcessInForeground();
+
 	///////////
 	// Hacks //
 	///////////
 
 	namespace Hack
 	{
-		bool FillNop(void* address, std::size_t size);
-		bool FillMem(void* address, const void* data, std::size_t dataSize);
+		struct Write
+		{
+			void* address;
+			const void* data;
+			std::size_t size;
+		};
+
+		/**
+		 * Writes into read-only or executable memory.
+		 *
+		 * The writes must be sorted by address. Protection is changed only once for each run of writes inside the same
+		 * memory region and the instruction cache is flushed once at the end.
+		 *
+		 * @return Number of completed writes. Less than the count on failure.
+		 */
+		std::size_t WriteMemory(const Write* writes, std::size_t count);
 	}
 
 	/////////////
@@ -231,6 +293,219 @@ namespace OS
 		}
 	};
 
+	class ThreadLocalPointer
+	{
+		unsigned long m_index;
+
+		// no copies
+		ThreadLocalPointer(const ThreadLocalPointer&);
+		ThreadLocalPointer& operator=(const ThreadLocalPointer&);
+
+	public:
+		ThreadLocalPointer() : m_index(::TlsAlloc())
+		{
+		}
+
+		~ThreadLocalPointer()
+		{
+			::TlsFree(m_index);
+		}
+
+		void* Get() const
+		{
+			return ::TlsGetValue(m_index);
+		}
+
+		void Set(void* value)
+		{
+			::TlsSetValue(m_index, value);
+		}
+	};
+
+	const unsigned int WAIT_FOREVER = 0xFFFFFFFF;
+
+	inline void Sleep(unsigned int milliseconds)
+	{
+		::Sleep(milliseconds);
+	}
+
+	inline void YieldCurrentThread()
+	{
+		::SwitchToThread();
+	}
+
+	class Event
+	{
+		void* m_handle;
+
+		// no copies
+		Event(const Event&);
+		Event& operator=(const Event&);
+
+	public:
+		explicit Event(bool manualReset = false);
+
+		~Event()
+		{
+			::CloseHandle(m_handle);
+		}
+
+		void Set()
+		{
+			::SetEvent(m_handle);
+		}
+
+		void Reset()
+		{
+			::ResetEvent(m_handle);
+		}
+
+		// returns false on timeout
+		bool Wait(unsigned int timeoutMilliseconds = WAIT_FOREVER)
+		{
+			return ::WaitForSingleObject(m_handle, timeoutMilliseconds) == 0;  // WAIT_OBJECT_0
+		}
+	};
+
+	/**
+	 * Sleeps with better precision than OS::Sleep if the system supports high-resolution timers (Windows 10 1803+).
+	 * Otherwise, the precision is limited by the system timer resolution.
+	 */
+	class WaitableTimer
+	{
+		void* m_handle;
+		bool m_isHighResolution;
+
+		// no copies
+		WaitableTimer(const WaitableTimer&);
+		WaitableTimer& operator=(const WaitableTimer&);
+
+	public:
+		WaitableTimer();
+
+		~WaitableTimer()
+		{
+			::CloseHandle(m_handle);
+		}
+
+		bool IsHighResolution() const
+		{
+			return m_isHighResolution;
+		}
+
+		void Sleep(unsigned int microseconds);
+	};
+
+	class Thread
+	{
+	public:
+		typedef void (*Function)(void* param);
+
+	private:
+		void* m_handle;
+		unsigned long m_id;
+		Function m_function;
+		void* m_param;
+
+		// no copies
+		Thread(const Thread&);
+		Thread& operator=(const Thread&);
+
+		static unsigned int __stdcall Entry(void* self);
+
+	public:
+		Thread() : m_handle(NULL), m_id(0), m_function(NULL), m_param(NULL)
+		{
+		}
+
+		~Thread()
+		{
+			this->Join();
+		}
+
+		bool IsStarted() const
+		{
+			return m_handle != NULL;
+		}
+
+		unsigned long GetID() const
+		{
+			return m_id;
+		}
+
+		// zero stack size means the default of the executable
+		bool Start(Function function, void* param, unsigned int stackSize = 0);
+
+		// returns false on timeout
+		bool Join(unsigned int timeoutMilliseconds = WAIT_FOREVER);
+	};
+
+	/////////////
+	// Atomics //
+	/////////////
+
+	// MSVC gives volatile reads acquire semantics and volatile writes release semantics
+	// all functions below are full memory barriers and return the new value unless stated otherwise
+
+	namespace Atomic
+	{
+		inline long Increment(volatile long* value)
+		{
+			return ::_InterlockedIncrement(value);
+		}
+
+		inline long Decrement(volatile long* value)
+		{
+			return ::_InterlockedDecrement(value);
+		}
+
+		inline long Add(volatile long* value, long amount)
+		{
+			return ::_InterlockedExchangeAdd(value, amount) + amount;
+		}
+
+		// returns the previous value
+		inline long Exchange(volatile long* target, long value)
+		{
+			return ::_InterlockedExchange(target, value);
+		}
+
+		// returns the previous value
+		inline long CompareExchange(volatile long* target, long value, long comparand)
+		{
+			return ::_InterlockedCompareExchange(target, value, comparand);
+		}
+	}
+
+	////////////
+	// Memory //
+	////////////
+
+	// committed zero-filled memory directly from the OS, aligned to 64 KiB
+	void* AllocatePages(std::size_t size);
+	void FreePages(void* address);
+
+	// zero if large pages are not supported
+	std::size_t GetLargePageSize();
+
+	// the size must be a multiple of the large page size and the lock memory privilege must be enabled
+	// large pages are never paged out, they are freed with FreePages
+	// returns NULL if there is not enough contiguous physical memory
+	void* AllocateLargePages(std::size_t size);
+
+	// fails if the user has not been granted the "Lock pages in memory" right
+	bool EnableLockMemoryPrivilege();
+
+	// the minimum is enforced, so the pages stay resident, and the maximum is only a hint
+	bool SetWorkingSetSize(std::size_t minSize, std::size_t maxSize);
+
+	// asks the system to read the pages in one go, does nothing before Windows 8
+	void PrefetchMemory(const void* address, std::size_t size);
+
+	// keeps the pages in the working set, which must be large enough
+	bool LockMemory(const void* address, std::size_t size);
+	void UnlockMemory(const void* address, std::size_t size);
+
 	///////////
 	// Files //
 	///////////
@@ -295,6 +570,9 @@ namespace OS
 		bool Seek(SeekBase base, __int64 offset = 0, unsigned __int64* pNewPos = NULL);
 		bool Resize(unsigned __int64 size);
 
+		// C stream appending through a duplicate of the handle, the file itself stays open
+		std::FILE* OpenAppendStream() const;
+
 		void Close()
 		{
 			if (this->handle != NULL)
@@ -304,12 +582,78 @@ namespace OS
 			}
 		}
 
+		// false for directories
+		static bool Exists(const char* path);
+
 		static bool Copy(const char* srcPath, const char* dstPath);
+
+		// renames the file, or copies and deletes it if the destination is on another volume
+		// the destination is replaced if it exists
+		static bool Move(const char* srcPath, const char* dstPath);
+	};
+
+	// blocks until some input is available, returns zero at the end of input or on error
+	std::size_t ReadStandardInput(void* buffer, std::size_t bufferSize, bool* pError = NULL);
+
+	// bypasses the C stream and its lock, so it is safe even when another thread hangs while holding it
+	bool WriteStandardError(const void* data, std::size_t dataSize);
+
+	/**
+	 * Read-only mapping of a whole file.
+	 */
+	struct FileMapping
+	{
+		void* handle;
+		unsigned __int64 size;
+
+	private:
+		// no copies
+		FileMapping(const FileMapping&);
+		FileMapping& operator=(const FileMapping&);
+
+	public:
+		FileMapping() : handle(NULL), size(0)
+		{
+		}
+
+		~FileMapping()
+		{
+			this->Close();
+		}
+
+		bool IsOpen() const
+		{
+			return this->handle != NULL;
+		}
+
+		bool Open(const char* path);
+
+		// the offset must be a multiple of the allocation granularity (64 KiB)
+		// returns NULL on failure
+		const void* Map(unsigned __int64 offset, std::size_t viewSize);
+
+		static void Unmap(const void* view);
+
+		void Close()
+		{
+			if (this->handle != NULL)
+			{
+				ReleaseHandle(this->handle);
+				this->handle = NULL;
+				this->size = 0;
+			}
+		}
 	};
 
 	namespace Directory
 	{
 		bool Create(const char* path, bool* pCreated = NULL);
+
+		typedef void (*FileCallback)(const char* fileName, void* param);
+
+		// calls the callback with the name of each file matching the pattern, e.g. Game\*.pak
+		// returns false if there is no such file
+		bool ForEachFile(const char* pattern, FileCallback callback, void* param);
 	}
 
 	std::size_t GetDocumentsPath(char* buffer, std::size_t bufferSize);
@@ -340,8 +684,89 @@ namespace OS
 	DateTime GetCurrentDateTimeUTC();
 	DateTime GetCurrentDateTimeLocal();
 
+	// milliseconds since 1970-01-01 00:00:00 UTC
+	unsigned __int64 GetCurrentUnixTimeMilliseconds();
+
 	long GetCurrentTimeZoneBias();
 
+	/**
+	 * Milliseconds since system start. Wraps around every 49.7 days, so use only differences.
+	 */
+	inline unsigned long GetTickCount()
+	{
+		return ::GetTickCount();
+	}
+
+	// high-resolution monotonic clock
+	unsigned __int64 GetPerformanceCounter();
+	unsigned __int64 GetPerformanceFrequency();  // counts per second
+
+	///////////////
+	// Processes //
+	///////////////
+
+	// starts a new process without waiting for it
+	bool StartProcess(const char* cmdLine);
+
+	/**
+	 * Process started by the current process together with all processes it starts itself, e.g. when the game restarts
+	 * with a different mod. They are kept in a job, so all of them are terminated once the child process is closed or
+	 * the current process exits. If the job cannot be used, e.g. in a job without nesting support, only the first
+	 * process is tracked.
+	 */
+	class ChildProcess
+	{
+		void* m_job;
+		void* m_process;
+		unsigned long m_id;
+
+		// no copies
+		ChildProcess(const ChildProcess&);
+		ChildProcess& operator=(const ChildProcess&);
+
+	public:
+		ChildProcess() : m_job(NULL), m_process(NULL), m_id(0)
+		{
+		}
+
+		~ChildProcess()
+		{
+			this->Close();
+		}
+
+		bool IsStarted() const
+		{
+			return m_process != NULL;
+		}
+
+		unsigned long GetID() const
+		{
+			return m_id;
+		}
+
+		// false if the job could not be set up, only the first process is tracked in such case
+		bool IsInJob() const
+		{
+			return m_job != NULL;
+		}
+
+		bool Start(const char* cmdLine);
+
+		// false once the first process and everything it started are gone
+		bool IsRunning() const;
+
+		// exit code of the first process, false if it is still running
+		bool GetExitCode(unsigned long& exitCode) const;
+
+		void Terminate(unsigned int exitCode);
+
+		// terminates all remaining processes, or just the first one without a job
+		void Close();
+	};
+
+	// ends immediately without any cleanup
+	void TerminateCurrentProcess(unsigned int exitCode);
+
 	////////////////////////
 	// System information //
 	////////////////////////
@@ -349,4 +774,115 @@ namespace OS
 	bool IsVistaOrLater();
 
 	unsigned int GetLogicalProcessorCount();
+
+	struct ProcessorTopology
+	{
+		unsigned int packageCount;
+		unsigned int physicalCount;  // cores
+		unsigned int logicalCount;  // hardware threads
+		unsigned int availablePhysicalCount;  // cores with at least one hardware thread usable by the current process
+		unsigned int availableLogicalCount;  // hardware threads usable by the current process
+		unsigned int performanceCount;  // cores of the fastest class on hybrid CPUs, otherwise zero
+
+		ProcessorTopology() : packageCount(0), physicalCount(0), logicalCount(0), availablePhysicalCount(0),
+		                      availableLogicalCount(0), performanceCount(0)
+		{
+		}
+	};
+
+	// falls back to counting each logical processor as a core on systems older than Windows 7
+	ProcessorTopology GetProcessorTopology();
+
+	// logical processor masks of each core in the processor group of the current process
+	// returns the number of cores
+	unsigned int GetProcessorCoreMasks(std::size_t* masks, unsigned int maxCount);
+
+	std::size_t GetProcessAffinity();
+	bool SetProcessAffinity(std::size_t mask);
+	bool SetCurrentThreadAffinity(std::size_t mask);
+
+	// lowers CPU, I/O and memory priority of the current thread, only CPU priority before Windows Vista
+	bool EnterBackgroundMode();
+
+	enum ProcessPriority
+	{
+		PROCESS_PRIORITY_IDLE,
+		PROCESS_PRIORITY_BELOW_NORMAL,
+		PROCESS_PRIORITY_NORMAL,
+		PROCESS_PRIORITY_ABOVE_NORMAL,
+		PROCESS_PRIORITY_HIGH,
+	};
+
+	bool SetProcessPriority(ProcessPriority priority);
+
+	// high I/O priority requires a privilege, so it is not offered
+	enum IOPriority
+	{
+		IO_PRIORITY_VERY_LOW,
+		IO_PRIORITY_LOW,
+		IO_PRIORITY_NORMAL,
+	};
+
+	// threads use the process I/O priority unless they set their own, both require Windows Vista
+	bool SetProcessIOPriority(IOPriority priority);
+	bool SetCurrentThreadIOPriority(IOPriority priority);
+
+	// normal if unknown
+	IOPriority GetProcessIOPriority();
+
+	/**
+	 * Raises resolution of the system timer, which affects Sleep and standard waitable timers of all processes.
+	 * It costs power, so it should be requested only while needed.
+	 */
+	class TimerResolution
+	{
+		unsigned int m_period;  // milliseconds
+
+		// no copies
+		TimerResolution(const TimerResolution&);
+		TimerResolution& operator=(const TimerResolution&);
+
+	public:
+		TimerResolution() : m_period(0)
+		{
+		}
+
+		~TimerResolution()
+		{
+			this->Release();
+		}
+
+		bool IsRequested() const
+		{
+			return m_period != 0;
+		}
+
+		unsigned int GetPeriod() const
+		{
+			return m_period;
+		}
+
+		// replaces the previous request
+		bool Request(unsigned int milliseconds);
+		void Release();
+	};
+
+	struct MemoryUsage
+	{
+		unsigned __int64 workingSet;
+		unsigned __int64 peakWorkingSet;
+		unsigned __int64 privateBytes;
+		unsigned __int64 totalPhysical;
+		unsigned __int64 availablePhysical;
+		unsigned __int64 totalVirtual;  // address space of the current process
+		unsigned __int64 availableVirtual;
+
+		MemoryUsage() : workingSet(0), peakWorkingSet(0), privateBytes(0), totalPhysical(0), availablePhysical(0),
+		                totalVirtual(0), availableVirtual(0)
+		{
+		}
+	};
+
+	// memory of the current process and of the whole system
+	bool GetMemoryUsage(MemoryUsage& usage);
 }
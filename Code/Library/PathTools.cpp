@@ -14,17 +14,14 @@ StringView PathTools::BaseName(StringView path)
 		path.PopBack();
 	}
 
-	std::size_t length = path.length;
+	std::size_t slashPos = 0;
 
-	// find the beginning of the last path component
-	while (length > 0 && !IsSlash(path[length - 1]))
+	// keep only the last path component
+	if (path.FindLastEither('/', '\\', slashPos))
 	{
-		length--;
+		path.RemovePrefix(slashPos + 1);
 	}
 
-	// keep only the last path component
-	path.RemovePrefix(length);
-
 	return path;
 }
 
@@ -36,10 +33,16 @@ StringView PathTools::DirName(StringView path)
 		path.PopBack();
 	}
 
+	std::size_t slashPos = 0;
+
 	// remove the last path component
-	while (path.IsNotEmpty() && !IsSlash(path.Back()))
+	if (path.FindLastEither('/', '\\', slashPos))
 	{
-		path.PopBack();
+		path.RemoveSuffix(path.length - slashPos);
+	}
+	else
+	{
+		path.RemoveSuffix(path.length);
 	}
 
 	// remove trailing slashes
@@ -0,0 +1,887 @@
+#include <cstring>
+
+#include "OS.h"
+#include "PoolAllocator.h"
+
+#define CLASS_COUNT 40
+#define CLASS_GRANULARITY 16
+
+// span map value of the first region of a large block, zero means the region is not ours
+#define LARGE_BLOCK_MARKER 0xFF
+
+// span map value of all regions of a large block arena
+#define LARGE_ARENA_MARKER 0xFE
+
+// size of the header in front of each large block, keeps the blocks aligned
+#define LARGE_BLOCK_HEADER_SIZE 16
+
+// maximum size of free blocks of a single class cached by a single thread
+#define MAX_THREAD_CACHE_SIZE (64 * 1024)
+#define MAX_THREAD_CACHE_COUNT 64
+#define MIN_THREAD_CACHE_COUNT 2
+
+// the span map covers the whole address space in 64 KiB regions
+// the lower level covers 4 GiB and is allocated on demand
+#ifdef BUILD_64BIT
+#define SPAN_MAP_TOP_COUNT (1 << 15)  // 47-bit user address space
+#else
+#define SPAN_MAP_TOP_COUNT 1
+#endif
+#define SPAN_MAP_BOTTOM_COUNT (1 << 16)
+
+// spans are carved from arenas of at least this size when large pages are enabled
+#define MIN_LARGE_PAGE_ARENA_SIZE (4 * 1024 * 1024)
+
+// large blocks up to this size are carved from arenas, bigger ones are mapped directly from the OS
+#define MAX_ARENA_BLOCK_SIZE (256 * 1024)
+#define LARGE_ARENA_SIZE (4 * 1024 * 1024)
+#define LARGE_ARENA_GRANULARITY 4096
+
+struct FreeBlock
+{
+	FreeBlock* next;
+};
+
+struct SizeClass
+{
+	std::size_t blockSize;
+	unsigned int cacheLimit;
+
+	OS::Mutex mutex;
+	FreeBlock* freeList;
+	char* spanPos;
+	char* spanEnd;
+
+	// modified only with the mutex held, read without it for statistics
+	volatile long spanCount;
+	volatile long usedCount;
+	volatile long freeCount;
+
+	SizeClass() : blockSize(0), cacheLimit(0), freeList(NULL), spanPos(NULL), spanEnd(NULL), spanCount(0),
+	              usedCount(0), freeCount(0)
+	{
+	}
+};
+
+struct ThreadCache
+{
+	FreeBlock* lists[CLASS_COUNT];
+	unsigned int counts[CLASS_COUNT];
+};
+
+struct LargeBlockHeader
+{
+	std::size_t size;  // including the header
+};
+
+static SizeClass g_classes[CLASS_COUNT];
+static unsigned char g_classBySize[(PoolAllocator::MAX_SMALL_SIZE / CLASS_GRANULARITY) + 1];
+
+static unsigned char* volatile g_spanMap[SPAN_MAP_TOP_COUNT];
+static OS::Mutex g_spanMapMutex;
+
+static OS::ThreadLocalPointer g_threadCache;
+
+static volatile long g_largeBlockCount;
+static volatile long g_largeBlockKiB;
+
+struct LargePageArena
+{
+	std::size_t size;  // zero if disabled
+
+	OS::Mutex mutex;
+	char* pos;
+	char* end;
+
+	volatile long totalKiB;
+
+	LargePageArena() : size(0), pos(NULL), end(NULL), totalKiB(0)
+	{
+	}
+};
+
+static LargePageArena g_largePageArena;
+
+struct LargeFreeRun
+{
+	std::size_t size;
+	LargeFreeRun* next;  // sorted by address
+};
+
+struct LargeBlockArena
+{
+	OS::Mutex mutex;
+	LargeFreeRun* freeList;
+
+	volatile long totalKiB;
+
+	LargeBlockArena() : freeList(NULL), totalKiB(0)
+	{
+	}
+};
+
+static LargeBlockArena g_largeBlockArena;
+
+static bool g_isInitialized;
+
+static unsigned char* GetSpanMapEntry(const void* address, bool create)
+{
+	const std::size_t value = reinterpret_cast<std::size_t>(address);
+
+#ifdef BUILD_64BIT
+	const std::size_t topIndex = value >> 32;
+
+	if (topIndex >= SPAN_MAP_TOP_COUNT)
+	{
+		return NULL;
+	}
+#else
+	const std::size_t topIndex = 0;
+#endif
+
+	unsigned char* bottom = g_spanMap[topIndex];
+
+	if (!bottom)
+	{
+		if (!create)
+		{
+			return NULL;
+		}
+
+		OS::LockGuard<OS::Mutex> lock(g_spanMapMutex);
+
+		bottom = g_spanMap[topIndex];
+
+		if (!bottom)
+		{
+			// zero-initialized by the OS
+			bottom = static_cast<unsigned char*>(OS::AllocatePages(SPAN_MAP_BOTTOM_COUNT));
+
+			if (!bottom)
+			{
+				return NULL;
+			}
+
+			g_spanMap[topIndex] = bottom;
+		}
+	}
+
+	return &bottom[(value / PoolAllocator::SPAN_SIZE) % SPAN_MAP_BOTTOM_COUNT];
+}
+
+static unsigned char GetSpanMapValue(const void* address)
+{
+	const unsigned char* entry = GetSpanMapEntry(address, false);
+
+	return (entry) ? *entry : 0;
+}
+
+static void* GetRegionBase(const void* address)
+{
+	const std::size_t value = reinterpret_cast<std::size_t>(address);
+
+	return reinterpret_cast<void*>(value - (value % PoolAllocator::SPAN_SIZE));
+}
+
+static bool AddLargePageArena()
+{
+	char* arena = static_cast<char*>(OS::AllocateLargePages(g_largePageArena.size));
+
+	if (!arena)
+	{
+		return false;
+	}
+
+	g_largePageArena.pos = arena;
+	g_largePageArena.end = arena + g_largePageArena.size;
+	g_largePageArena.totalKiB += static_cast<long>(g_largePageArena.size / 1024);
+
+	return true;
+}
+
+static char* AllocateSpanMemory(bool& isLargePage)
+{
+	isLargePage = false;
+
+	if (g_largePageArena.size)
+	{
+		OS::LockGuard<OS::Mutex> lock(g_largePageArena.mutex);
+
+		// spans are never freed, so the arena is just a bump allocator
+		if (g_largePageArena.pos != g_largePageArena.end || AddLargePageArena())
+		{
+			char* span = g_largePageArena.pos;
+			g_largePageArena.pos += PoolAllocator::SPAN_SIZE;
+			isLargePage = true;
+
+			return span;
+		}
+
+		// physical memory is too fragmented, use normal pages from now on
+		g_largePageArena.size = 0;
+	}
+
+	return static_cast<char*>(OS::AllocatePages(PoolAllocator::SPAN_SIZE));
+}
+
+// the class mutex must be held
+static bool AddSpan(SizeClass& sizeClass, unsigned int index)
+{
+	bool isLargePage = false;
+	char* span = AllocateSpanMemory(isLargePage);
+
+	if (!span)
+	{
+		return false;
+	}
+
+	unsigned char* entry = GetSpanMapEntry(span, true);
+
+	if (!entry)
+	{
+		// arenas cannot be partially freed, so such span is lost
+		if (!isLargePage)
+		{
+			OS::FreePages(span);
+		}
+
+		return false;
+	}
+
+	*entry = static_cast<unsigned char>(index + 1);
+
+	sizeClass.spanPos = span;
+	sizeClass.spanEnd = span + PoolAllocator::SPAN_SIZE;
+	sizeClass.spanCount++;
+
+	return true;
+}
+
+// the class mutex must be held
+static FreeBlock* TakeBlock(SizeClass& sizeClass, unsigned int index)
+{
+	FreeBlock* block = sizeClass.freeList;
+
+	if (block)
+	{
+		sizeClass.freeList = block->next;
+		sizeClass.freeCount--;
+	}
+	else
+	{
+		if ((sizeClass.spanEnd - sizeClass.spanPos) < static_cast<std::ptrdiff_t>(sizeClass.blockSize))
+		{
+			if (!AddSpan(sizeClass, index))
+			{
+				return NULL;
+			}
+		}
+
+		block = reinterpret_cast<FreeBlock*>(sizeClass.spanPos);
+		sizeClass.spanPos += sizeClass.blockSize;
+	}
+
+	sizeClass.usedCount++;
+
+	return block;
+}
+
+// the class mutex must be held
+static void PutBlock(SizeClass& sizeClass, FreeBlock* block)
+{
+	block->next = sizeClass.freeList;
+	sizeClass.freeList = block;
+	sizeClass.freeCount++;
+	sizeClass.usedCount--;
+}
+
+static unsigned int GetClassIndex(std::size_t size)
+{
+	return g_classBySize[(size + CLASS_GRANULARITY - 1) / CLASS_GRANULARITY];
+}
+
+static void* AllocateShared(unsigned int index)
+{
+	SizeClass& sizeClass = g_classes[index];
+
+	OS::LockGuard<OS::Mutex> lock(sizeClass.mutex);
+
+	return TakeBlock(sizeClass, index);
+}
+
+static void FreeShared(unsigned int index, FreeBlock* block)
+{
+	SizeClass& sizeClass = g_classes[index];
+
+	OS::LockGuard<OS::Mutex> lock(sizeClass.mutex);
+
+	PutBlock(sizeClass, block);
+}
+
+static ThreadCache* GetThreadCache()
+{
+	ThreadCache* cache = static_cast<ThreadCache*>(g_threadCache.Get());
+
+	if (!cache)
+	{
+		// caches of finished threads are not reclaimed, the engine creates its threads only once
+		cache = static_cast<ThreadCache*>(AllocateShared(GetClassIndex(sizeof(ThreadCache))));
+
+		if (cache)
+		{
+			std::memset(cache, 0, sizeof(ThreadCache));
+			g_threadCache.Set(cache);
+		}
+	}
+
+	return cache;
+}
+
+static bool RefillThreadCache(ThreadCache* cache, unsigned int index)
+{
+	SizeClass& sizeClass = g_classes[index];
+	const unsigned int count = (sizeClass.cacheLimit + 1) / 2;
+
+	OS::LockGuard<OS::Mutex> lock(sizeClass.mutex);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		FreeBlock* block = TakeBlock(sizeClass, index);
+
+		if (!block)
+		{
+			break;
+		}
+
+		block->next = cache->lists[index];
+		cache->lists[index] = block;
+		cache->counts[index]++;
+	}
+
+	return cache->lists[index] != NULL;
+}
+
+static void DrainThreadCache(ThreadCache* cache, unsigned int index)
+{
+	SizeClass& sizeClass = g_classes[index];
+	const unsigned int count = (sizeClass.cacheLimit + 1) / 2;
+
+	OS::LockGuard<OS::Mutex> lock(sizeClass.mutex);
+
+	for (unsigned int i = 0; i < count && cache->lists[index]; i++)
+	{
+		FreeBlock* block = cache->lists[index];
+		cache->lists[index] = block->next;
+		cache->counts[index]--;
+
+		PutBlock(sizeClass, block);
+	}
+}
+
+// the arena mutex must be held
+static void ReleaseArenaRun(char* base, std::size_t size)
+{
+	LargeFreeRun* prev = NULL;
+	LargeFreeRun* next = g_largeBlockArena.freeList;
+
+	while (next && reinterpret_cast<char*>(next) < base)
+	{
+		prev = next;
+		next = next->next;
+	}
+
+	LargeFreeRun* run = reinterpret_cast<LargeFreeRun*>(base);
+	run->size = size;
+	run->next = next;
+
+	if (next && (base + size) == reinterpret_cast<char*>(next))
+	{
+		run->size += next->size;
+		run->next = next->next;
+	}
+
+	if (prev && (reinterpret_cast<char*>(prev) + prev->size) == base)
+	{
+		prev->size += run->size;
+		prev->next = run->next;
+	}
+	else if (prev)
+	{
+		prev->next = run;
+	}
+	else
+	{
+		g_largeBlockArena.freeList = run;
+	}
+}
+
+// the arena mutex must be held
+static bool AddLargeBlockArena()
+{
+	char* arena = static_cast<char*>(OS::AllocatePages(LARGE_ARENA_SIZE));
+
+	if (!arena)
+	{
+		return false;
+	}
+
+	unsigned char* entries[LARGE_ARENA_SIZE / PoolAllocator::SPAN_SIZE];
+
+	for (std::size_t i = 0; i < (LARGE_ARENA_SIZE / PoolAllocator::SPAN_SIZE); i++)
+	{
+		entries[i] = GetSpanMapEntry(arena + (i * PoolAllocator::SPAN_SIZE), true);
+
+		if (!entries[i])
+		{
+			OS::FreePages(arena);
+			return false;
+		}
+	}
+
+	// any address inside the arena belongs to some large block
+	for (std::size_t i = 0; i < (LARGE_ARENA_SIZE / PoolAllocator::SPAN_SIZE); i++)
+	{
+		*entries[i] = LARGE_ARENA_MARKER;
+	}
+
+	ReleaseArenaRun(arena, LARGE_ARENA_SIZE);
+	g_largeBlockArena.totalKiB += LARGE_ARENA_SIZE / 1024;
+
+	return true;
+}
+
+/**
+ * First fit from the free runs of all arenas. Arenas are never returned to the OS, freed runs are merged with their
+ * neighbours instead.
+ */
+static char* AllocateArenaRun(std::size_t size)
+{
+	OS::LockGuard<OS::Mutex> lock(g_largeBlockArena.mutex);
+
+	for (int attempt = 0; attempt < 2; attempt++)
+	{
+		LargeFreeRun* prev = NULL;
+		LargeFreeRun* run = g_largeBlockArena.freeList;
+
+		while (run && run->size < size)
+		{
+			prev = run;
+			run = run->next;
+		}
+
+		if (run)
+		{
+			LargeFreeRun* rest = run->next;
+
+			if (run->size > size)
+			{
+				rest = reinterpret_cast<LargeFreeRun*>(reinterpret_cast<char*>(run) + size);
+				rest->size = run->size - size;
+				rest->next = run->next;
+			}
+
+			if (prev)
+			{
+				prev->next = rest;
+			}
+			else
+			{
+				g_largeBlockArena.freeList = rest;
+			}
+
+			return reinterpret_cast<char*>(run);
+		}
+
+		if (!AddLargeBlockArena())
+		{
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static void FreeArenaRun(char* base, std::size_t size)
+{
+	OS::LockGuard<OS::Mutex> lock(g_largeBlockArena.mutex);
+
+	ReleaseArenaRun(base, size);
+}
+
+static void* AllocateLarge(std::size_t size)
+{
+	const std::size_t pageSize = 4096;
+	std::size_t totalSize = size + LARGE_BLOCK_HEADER_SIZE;
+
+	if (totalSize < size)
+	{
+		return NULL;
+	}
+
+	totalSize = (totalSize + pageSize - 1) & ~(pageSize - 1);
+
+	if (totalSize <= MAX_ARENA_BLOCK_SIZE)
+	{
+		char* base = AllocateArenaRun(totalSize);
+
+		if (base)
+		{
+			reinterpret_cast<LargeBlockHeader*>(base)->size = totalSize;
+
+			OS::Atomic::Increment(&g_largeBlockCount);
+			OS::Atomic::Add(&g_largeBlockKiB, static_cast<long>(totalSize / 1024));
+
+			return base + LARGE_BLOCK_HEADER_SIZE;
+		}
+
+		// no room for another arena, a smaller mapping may still fit
+	}
+
+	char* base = static_cast<char*>(OS::AllocatePages(totalSize));
+
+	if (!base)
+	{
+		return NULL;
+	}
+
+	unsigned char* entry = GetSpanMapEntry(base, true);
+
+	if (!entry)
+	{
+		OS::FreePages(base);
+		return NULL;
+	}
+
+	reinterpret_cast<LargeBlockHeader*>(base)->size = totalSize;
+	*entry = LARGE_BLOCK_MARKER;
+
+	OS::Atomic::Increment(&g_largeBlockCount);
+	OS::Atomic::Add(&g_largeBlockKiB, static_cast<long>(totalSize / 1024));
+
+	return base + LARGE_BLOCK_HEADER_SIZE;
+}
+
+static void FreeLarge(void* block, unsigned char spanMapValue)
+{
+	char* base = static_cast<char*>(block) - LARGE_BLOCK_HEADER_SIZE;
+	const std::size_t totalSize = reinterpret_cast<LargeBlockHeader*>(base)->size;
+
+	OS::Atomic::Decrement(&g_largeBlockCount);
+	OS::Atomic::Add(&g_largeBlockKiB, -static_cast<long>(totalSize / 1024));
+
+	if (spanMapValue == LARGE_ARENA_MARKER)
+	{
+		FreeArenaRun(base, totalSize);
+		return;
+	}
+
+	// the region must not be marked as ours anymore once the OS may reuse it
+	*GetSpanMapEntry(base, false) = 0;
+
+	OS::FreePages(base);
+}
+
+bool PoolAllocator::Init()
+{
+	if (g_isInitialized)
+	{
+		return true;
+	}
+
+	// 16, 32, ..., 128, then 4 classes per power of two up to MAX_SMALL_SIZE
+	unsigned int count = 0;
+
+	for (std::size_t size = CLASS_GRANULARITY; size <= 128; size += CLASS_GRANULARITY)
+	{
+		g_classes[count++].blockSize = size;
+	}
+
+	for (std::size_t base = 128; base < MAX_SMALL_SIZE; base *= 2)
+	{
+		for (std::size_t step = 1; step <= 4; step++)
+		{
+			g_classes[count++].blockSize = base + ((base * step) / 4);
+		}
+	}
+
+	if (count != CLASS_COUNT || g_classes[CLASS_COUNT - 1].blockSize != MAX_SMALL_SIZE)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < CLASS_COUNT; i++)
+	{
+		unsigned int cacheLimit = static_cast<unsigned int>(MAX_THREAD_CACHE_SIZE / g_classes[i].blockSize);
+
+		if (cacheLimit > MAX_THREAD_CACHE_COUNT)
+		{
+			cacheLimit = MAX_THREAD_CACHE_COUNT;
+		}
+		else if (cacheLimit < MIN_THREAD_CACHE_COUNT)
+		{
+			cacheLimit = MIN_THREAD_CACHE_COUNT;
+		}
+
+		g_classes[i].cacheLimit = cacheLimit;
+	}
+
+	unsigned int index = 0;
+
+	for (std::size_t i = 0; i < (sizeof g_classBySize / sizeof g_classBySize[0]); i++)
+	{
+		while (g_classes[index].blockSize < (i * CLASS_GRANULARITY))
+		{
+			index++;
+		}
+
+		g_classBySize[i] = static_cast<unsigned char>(index);
+	}
+
+	g_isInitialized = true;
+
+	return true;
+}
+
+bool PoolAllocator::IsInitialized()
+{
+	return g_isInitialized;
+}
+
+bool PoolAllocator::EnableLargePages(std::size_t largePageSize)
+{
+	if (largePageSize == 0 || (largePageSize % SPAN_SIZE) != 0)
+	{
+		return false;
+	}
+
+	OS::LockGuard<OS::Mutex> lock(g_largePageArena.mutex);
+
+	std::size_t arenaSize = largePageSize;
+
+	while (arenaSize < MIN_LARGE_PAGE_ARENA_SIZE)
+	{
+		arenaSize += largePageSize;
+	}
+
+	g_largePageArena.size = arenaSize;
+
+	// make sure large pages actually work
+	if (g_largePageArena.pos == g_largePageArena.end && !AddLargePageArena())
+	{
+		g_largePageArena.size = 0;
+		return false;
+	}
+
+	return true;
+}
+
+bool PoolAllocator::IsUsingLargePages()
+{
+	return g_largePageArena.size != 0;
+}
+
+void* PoolAllocator::Allocate(std::size_t size)
+{
+	if (size > MAX_SMALL_SIZE)
+	{
+		return AllocateLarge(size);
+	}
+
+	const unsigned int index = GetClassIndex(size);
+	ThreadCache* cache = GetThreadCache();
+
+	if (!cache)
+	{
+		return AllocateShared(index);
+	}
+
+	if (!cache->lists[index] && !RefillThreadCache(cache, index))
+	{
+		return NULL;
+	}
+
+	FreeBlock* block = cache->lists[index];
+	cache->lists[index] = block->next;
+	cache->counts[index]--;
+
+	return block;
+}
+
+void* PoolAllocator::Reallocate(void* block, std::size_t size)
+{
+	if (!block)
+	{
+		return Allocate(size);
+	}
+
+	if (size == 0)
+	{
+		Free(block);
+		return NULL;
+	}
+
+	const std::size_t oldSize = GetSize(block);
+
+	// keep the block if the new size belongs to the same class or if a large block shrinks only a little
+	if (size <= MAX_SMALL_SIZE && oldSize <= MAX_SMALL_SIZE)
+	{
+		if (GetClassIndex(size) == GetClassIndex(oldSize))
+		{
+			return block;
+		}
+	}
+	else if (size > MAX_SMALL_SIZE && size <= oldSize && size > (oldSize / 2))
+	{
+		return block;
+	}
+
+	void* newBlock = Allocate(size);
+
+	if (newBlock)
+	{
+		std::memcpy(newBlock, block, (size < oldSize) ? size : oldSize);
+		Free(block);
+	}
+
+	return newBlock;
+}
+
+void PoolAllocator::Free(void* block)
+{
+	if (!block)
+	{
+		return;
+	}
+
+	const unsigned char value = GetSpanMapValue(block);
+
+	if (value == 0)
+	{
+		// not ours, leaking it is better than corrupting memory
+		return;
+	}
+
+	if (value == LARGE_BLOCK_MARKER || value == LARGE_ARENA_MARKER)
+	{
+		FreeLarge(block, value);
+		return;
+	}
+
+	const unsigned int index = value - 1;
+	ThreadCache* cache = GetThreadCache();
+
+	if (!cache)
+	{
+		FreeShared(index, static_cast<FreeBlock*>(block));
+		return;
+	}
+
+	FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+	freeBlock->next = cache->lists[index];
+	cache->lists[index] = freeBlock;
+	cache->counts[index]++;
+
+	if (cache->counts[index] > g_classes[index].cacheLimit)
+	{
+		DrainThreadCache(cache, index);
+	}
+}
+
+std::size_t PoolAllocator::GetSize(const void* block)
+{
+	const unsigned char value = GetSpanMapValue(block);
+
+	if (value == LARGE_BLOCK_MARKER || value == LARGE_ARENA_MARKER)
+	{
+		const char* base = static_cast<const char*>(block) - LARGE_BLOCK_HEADER_SIZE;
+
+		return reinterpret_cast<const LargeBlockHeader*>(base)->size - LARGE_BLOCK_HEADER_SIZE;
+	}
+
+	return (value) ? g_classes[value - 1].blockSize : 0;
+}
+
+bool PoolAllocator::IsOwned(const void* block)
+{
+	const unsigned char value = GetSpanMapValue(block);
+
+	if (value == LARGE_BLOCK_MARKER)
+	{
+		const char* base = static_cast<const char*>(GetRegionBase(block));
+
+		// large blocks always start right after the header at the beginning of the region
+		return static_cast<const char*>(block) == (base + LARGE_BLOCK_HEADER_SIZE);
+	}
+
+	return value != 0;
+}
+
+unsigned int PoolAllocator::GetClassCount()
+{
+	return CLASS_COUNT;
+}
+
+PoolAllocator::ClassStats PoolAllocator::GetClassStats(unsigned int index)
+{
+	ClassStats stats = {};
+
+	if (index < CLASS_COUNT)
+	{
+		const SizeClass& sizeClass = g_classes[index];
+
+		stats.blockSize = sizeClass.blockSize;
+		stats.spanCount = sizeClass.spanCount;
+		stats.usedCount = sizeClass.usedCount;
+		stats.freeCount = sizeClass.freeCount;
+	}
+
+	return stats;
+}
+
+PoolAllocator::LargeStats PoolAllocator::GetLargeStats()
+{
+	LargeStats stats = {};
+	stats.blockCount = g_largeBlockCount;
+	stats.totalKiB = g_largeBlockKiB;
+	stats.largePageKiB = g_largePageArena.totalKiB;
+	stats.arenaKiB = g_largeBlockArena.totalKiB;
+
+	return stats;
+}
+
+void PoolAllocator::DumpStats(std::FILE* file)
+{
+	if (!g_isInitialized)
+	{
+		return;
+	}
+
+	unsigned long totalSpanCount = 0;
+
+	std::fprintf(file, "Pool allocator classes (block size: spans, used blocks, free blocks):\n");
+
+	for (unsigned int i = 0; i < CLASS_COUNT; i++)
+	{
+		const ClassStats stats = GetClassStats(i);
+
+		if (stats.spanCount > 0)
+		{
+			std::fprintf(file, "%6u: %lu, %lu, %lu\n",
+				static_cast<unsigned int>(stats.blockSize),
+				stats.spanCount,
+				stats.usedCount,
+				stats.freeCount
+			);
+
+			totalSpanCount += stats.spanCount;
+		}
+	}
+
+	const LargeStats large = GetLargeStats();
+
+	std::fprintf(file, "Pool allocator spans = %.1f MiB\n", (totalSpanCount * (SPAN_SIZE / 1024)) / 1024.0);
+	std::fprintf(file, "Pool allocator large blocks = %lu (%.1f MiB)\n", large.blockCount, large.totalKiB / 1024.0);
+	std::fprintf(file, "Pool allocator large block arenas = %.1f MiB\n", large.arenaKiB / 1024.0);
+	std::fprintf(file, "Pool allocator large pages = %.1f MiB\n", large.largePageKiB / 1024.0);
+	std::fflush(file);
+}
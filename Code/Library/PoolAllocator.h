@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+/**
+ * General purpose allocator with size classes.
+ *
+ * Small blocks are carved from 64 KiB spans. Each span holds blocks of a single size class, so blocks of different
+ * sizes cannot fragment each other. Every thread caches a few free blocks of each class, so most allocations and
+ * deallocations take no lock. Spans are never returned to the OS, they are reused by the same size class.
+ *
+ * Large blocks up to 256 KiB are carved from 4 MiB arenas, which are never returned to the OS. Bigger blocks are
+ * mapped directly from the OS and unmapped when freed.
+ *
+ * Optionally, spans are carved from arenas backed by large pages to reduce TLB misses. Such memory is never paged out.
+ *
+ * Blocks are aligned to 16 bytes.
+ */
+namespace PoolAllocator
+{
+	enum
+	{
+		MAX_SMALL_SIZE = 32768,
+		SPAN_SIZE = 65536,
+	};
+
+	struct ClassStats
+	{
+		std::size_t blockSize;
+		unsigned long spanCount;
+		unsigned long usedCount;  // including free blocks cached by threads
+		unsigned long freeCount;
+	};
+
+	struct LargeStats
+	{
+		unsigned long blockCount;
+		unsigned long totalKiB;
+		unsigned long largePageKiB;  // arenas of spans, not large blocks
+		unsigned long arenaKiB;  // arenas of large blocks, including their free space
+	};
+
+	bool Init();
+	bool IsInitialized();
+
+	// the lock memory privilege must be enabled, see OS::GetLargePageSize
+	// returns false if large pages cannot be allocated, normal pages are used in such case
+	bool EnableLargePages(std::size_t largePageSize);
+	bool IsUsingLargePages();
+
+	// returns NULL if out of memory
+	void* Allocate(std::size_t size);
+	void* Reallocate(void* block, std::size_t size);
+	void Free(void* block);
+
+	// usable size of the block
+	std::size_t GetSize(const void* block);
+
+	// tells whether the block was allocated by this allocator
+	bool IsOwned(const void* block);
+
+	unsigned int GetClassCount();
+	ClassStats GetClassStats(unsigned int index);
+	LargeStats GetLargeStats();
+
+	// reads the counters without taking the allocator locks, so it can be used by the crash logger
+	// the stream itself is locked and may allocate its buffer on the first write, like any other C stream output
+	void DumpStats(std::FILE* file);
+}
@@ -0,0 +1,197 @@
+#include "PathTools.h"
+#include "Prefetcher.h"
+
+#define PREFETCH_READ_SIZE (1024 * 1024)
+
+Prefetcher::Prefetcher()
+: m_isStopRequested(0),
+  m_moduleKiB(0),
+  m_fileKiB(0),
+  m_moduleCount(0),
+  m_fileCount(0),
+  m_startTime(0),
+  m_modulesDoneTime(0)
+{
+}
+
+void Prefetcher::AddModule(const std::string& path)
+{
+	Item item;
+	item.path = path;
+	item.name = PathTools::BaseName(path).ToStdString();
+	item.isModule = true;
+
+	// modules go first
+	std::vector<Item>::iterator it = m_items.begin();
+
+	while (it != m_items.end() && it->isModule)
+	{
+		++it;
+	}
+
+	m_items.insert(it, item);
+}
+
+void Prefetcher::AddFile(const std::string& path)
+{
+	Item item;
+	item.path = path;
+	item.name = PathTools::BaseName(path).ToStdString();
+	item.isModule = false;
+
+	m_items.push_back(item);
+}
+
+bool Prefetcher::Start()
+{
+	if (m_items.empty() || m_thread.IsStarted())
+	{
+		return false;
+	}
+
+	m_startTime = OS::GetPerformanceCounter();
+
+	return m_thread.Start(&Prefetcher::ThreadEntry, this);
+}
+
+void Prefetcher::Stop()
+{
+	OS::Atomic::Exchange(&m_isStopRequested, 1);
+
+	m_thread.Join();
+}
+
+void Prefetcher::WaitForModule(const char* name)
+{
+	for (std::size_t i = 0; i < m_items.size(); i++)
+	{
+		const Item& item = m_items[i];
+
+		if (item.isModule && StringView(item.name).IsEqualNoCase(name))
+		{
+			this->Wait(item);
+		}
+	}
+}
+
+void Prefetcher::WaitForAllModules()
+{
+	for (std::size_t i = 0; i < m_items.size() && m_items[i].isModule; i++)
+	{
+		this->Wait(m_items[i]);
+	}
+}
+
+double Prefetcher::GetModuleTime() const
+{
+	if (m_modulesDoneTime < m_startTime)
+	{
+		return 0;
+	}
+
+	const double duration = static_cast<double>(m_modulesDoneTime - m_startTime);
+
+	return (duration * 1000) / OS::GetPerformanceFrequency();
+}
+
+void Prefetcher::ThreadEntry(void* param)
+{
+	static_cast<Prefetcher*>(param)->Run();
+}
+
+void Prefetcher::Run()
+{
+	for (std::size_t i = 0; i < m_items.size(); i++)
+	{
+		Item& item = m_items[i];
+
+		if (!m_isStopRequested)
+		{
+			this->Prefetch(item);
+		}
+
+		const bool isLastModule = item.isModule && ((i + 1) == m_items.size() || !m_items[i + 1].isModule);
+
+		if (isLastModule)
+		{
+			m_modulesDoneTime = OS::GetPerformanceCounter();
+		}
+
+		OS::Atomic::Exchange(&item.isDone, 1);
+		m_itemDoneEvent.Set();
+	}
+
+	// release the memory as soon as possible
+	std::vector<unsigned char>().swap(m_buffer);
+}
+
+void Prefetcher::Prefetch(Item& item)
+{
+	if (item.isModule)
+	{
+		const std::size_t size = OS::Module::Prefetch(item.path.c_str());
+
+		if (size > 0)
+		{
+			OS::Atomic::Add(&m_moduleKiB, static_cast<long>(size / 1024));
+			OS::Atomic::Increment(&m_moduleCount);
+		}
+	}
+	else
+	{
+		const std::size_t size = this->ReadFile(item.path.c_str());
+
+		if (size > 0)
+		{
+			OS::Atomic::Increment(&m_fileCount);
+		}
+	}
+}
+
+std::size_t Prefetcher::ReadFile(const char* path)
+{
+	OS::File file;
+	if (!file.Open(path, OS::File::READ_ONLY))
+	{
+		return 0;
+	}
+
+	if (m_buffer.empty())
+	{
+		m_buffer.resize(PREFETCH_READ_SIZE);
+	}
+
+	std::size_t totalSize = 0;
+	std::size_t pendingSize = 0;
+
+	while (!m_isStopRequested)
+	{
+		const std::size_t size = file.Read(&m_buffer[0], m_buffer.size());
+		if (size == 0)
+		{
+			break;
+		}
+
+		totalSize += size;
+		pendingSize += size;
+
+		// whole KiB only, the rest is added later
+		OS::Atomic::Add(&m_fileKiB, static_cast<long>(pendingSize / 1024));
+		pendingSize %= 1024;
+	}
+
+	return totalSize;
+}
+
+void Prefetcher::Wait(const Item& item)
+{
+	if (!m_thread.IsStarted())
+	{
+		return;
+	}
+
+	while (!item.isDone)
+	{
+		m_itemDoneEvent.Wait();
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "OS.h"
+
+/**
+ * Reads files on a background thread, so they are already in memory when needed.
+ *
+ * Modules are mapped as executable images, which fills the memory shared with the module once it is loaded. Other files
+ * are read normally, which fills the file cache. All modules are done before any other file.
+ *
+ * A module must not be loaded before it is prefetched, otherwise the loader might find its preferred address taken by
+ * the prefetching view. See WaitForModule.
+ */
+class Prefetcher
+{
+	struct Item
+	{
+		std::string path;
+		std::string name;
+		bool isModule;
+		volatile long isDone;
+
+		Item() : isModule(false), isDone(0)
+		{
+		}
+	};
+
+	std::vector<Item> m_items;
+	std::vector<unsigned char> m_buffer;
+	OS::Thread m_thread;
+	OS::Event m_itemDoneEvent;
+	volatile long m_isStopRequested;
+
+	// KiB, updated by the worker thread
+	volatile long m_moduleKiB;
+	volatile long m_fileKiB;
+	volatile long m_moduleCount;
+	volatile long m_fileCount;
+
+	unsigned __int64 m_startTime;
+	unsigned __int64 m_modulesDoneTime;
+
+	// no copies
+	Prefetcher(const Prefetcher&);
+	Prefetcher& operator=(const Prefetcher&);
+
+	static void ThreadEntry(void* param);
+	void Run();
+
+	void Prefetch(Item& item);
+	std::size_t ReadFile(const char* path);
+
+	void Wait(const Item& item);
+
+public:
+	Prefetcher();
+
+	~Prefetcher()
+	{
+		this->Stop();
+	}
+
+	bool IsStarted() const
+	{
+		return m_thread.IsStarted();
+	}
+
+	// not thread-safe, must be done before Start
+	void AddModule(const std::string& path);
+	void AddFile(const std::string& path);
+
+	bool Start();
+
+	// abandons the remaining files and waits for the worker thread
+	void Stop();
+
+	// does nothing if the module is not in the list, the name is the file name of the module
+	void WaitForModule(const char* name);
+	void WaitForAllModules();
+
+	unsigned int GetModuleCount() const
+	{
+		return static_cast<unsigned int>(m_moduleCount);
+	}
+
+	unsigned int GetFileCount() const
+	{
+		return static_cast<unsigned int>(m_fileCount);
+	}
+
+	// rounded down to KiB
+	unsigned int GetModuleKiB() const
+	{
+		return static_cast<unsigned int>(m_moduleKiB);
+	}
+
+	unsigned int GetFileKiB() const
+	{
+		return static_cast<unsigned int>(m_fileKiB);
+	}
+
+	// milliseconds from start until all modules are done, valid after WaitForAllModules
+	double GetModuleTime() const;
+};
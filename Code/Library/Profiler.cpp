@@ -0,0 +1,464 @@
+#include <cstring>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <dbghelp.h>
+
+#include "CrashLogger.h"
+#include "PathTools.h"
+#include "Profiler.h"
+#include "StringTools.h"
+
+#define PROFILER_MAX_DEPTH 64
+
+// used part of the stack copied for each sample, deeper frames are not captured
+#define PROFILER_STACK_COPY_SIZE (64 * 1024)
+
+// the unwinder may read a bit past the copied part, e.g. the home space of the topmost frame
+#define PROFILER_STACK_COPY_SLACK 4096
+
+#ifndef UNW_FLAG_NHANDLER
+#define UNW_FLAG_NHANDLER 0
+#endif
+
+struct StackRange
+{
+	std::size_t bottom;
+	std::size_t top;
+};
+
+struct StackCopy
+{
+	std::size_t address;  // stack pointer of the profiled thread
+	std::size_t size;
+	unsigned char* data;
+};
+
+static std::size_t GetStackPointer(const CONTEXT& context)
+{
+#ifdef BUILD_64BIT
+	return context.Rsp;
+#else
+	return context.Esp;
+#endif
+}
+
+static bool GetStackRange(const CONTEXT& context, StackRange& range)
+{
+	const std::size_t stackPointer = GetStackPointer(context);
+
+	MEMORY_BASIC_INFORMATION info = {};
+
+	if (!VirtualQuery(reinterpret_cast<void*>(stackPointer), &info, sizeof info) || info.State != MEM_COMMIT)
+	{
+		return false;
+	}
+
+	// the whole stack is a single allocation, its used part ends with the committed region of the stack pointer
+	range.bottom = reinterpret_cast<std::size_t>(info.AllocationBase);
+	range.top = reinterpret_cast<std::size_t>(info.BaseAddress) + info.RegionSize;
+
+	return true;
+}
+
+/**
+ * Copies the used part of the stack while the thread is suspended, so nothing here may allocate or take locks.
+ */
+static bool CopyStack(const CONTEXT& context, const StackRange& range, StackCopy& copy)
+{
+	const std::size_t stackPointer = GetStackPointer(context);
+
+	if (stackPointer < range.bottom || stackPointer >= range.top)
+	{
+		return false;
+	}
+
+	const std::size_t usedSize = range.top - stackPointer;
+
+	copy.address = stackPointer;
+	copy.size = (usedSize < PROFILER_STACK_COPY_SIZE) ? usedSize : PROFILER_STACK_COPY_SIZE;
+
+	std::memcpy(copy.data, reinterpret_cast<const void*>(stackPointer), copy.size);
+
+	return true;
+}
+
+// moves a pointer into the original stack to the same place in the copy
+static void RebaseToCopy(const StackCopy& copy, std::size_t& value)
+{
+	if (value >= copy.address && (value - copy.address) < copy.size)
+	{
+		value = reinterpret_cast<std::size_t>(copy.data) + (value - copy.address);
+	}
+}
+
+/**
+ * Collects return addresses from the stack copy after the thread is resumed.
+ * The 64-bit walker uses the unwind data of the modules. The 32-bit walker follows the frame pointer chain, so functions
+ * compiled without frame pointers are skipped.
+ */
+static unsigned int WalkStack(CONTEXT& context, const StackCopy& copy, std::size_t* frames, unsigned int maxCount)
+{
+	const std::size_t copyBottom = reinterpret_cast<std::size_t>(copy.data);
+	const std::size_t copyTop = copyBottom + copy.size;
+
+	unsigned int count = 0;
+
+#ifdef BUILD_64BIT
+	// registers pointing into the stack now point into the copy, also those restored from it by each unwind step
+	DWORD64* registers[] = {
+		&context.Rsp, &context.Rbp, &context.Rbx, &context.Rsi, &context.Rdi,
+		&context.R12, &context.R13, &context.R14, &context.R15,
+	};
+
+	const std::size_t registerCount = sizeof registers / sizeof registers[0];
+
+	while (count < maxCount && context.Rip != 0)
+	{
+		for (std::size_t i = 0; i < registerCount; i++)
+		{
+			std::size_t value = static_cast<std::size_t>(*registers[i]);
+			RebaseToCopy(copy, value);
+			*registers[i] = value;
+		}
+
+		frames[count++] = context.Rip;
+
+		if (context.Rsp < copyBottom || context.Rsp + sizeof(DWORD64) > copyTop)
+		{
+			break;
+		}
+
+		DWORD64 imageBase = 0;
+		PRUNTIME_FUNCTION function = RtlLookupFunctionEntry(context.Rip, &imageBase, NULL);
+
+		if (function)
+		{
+			void* handlerData = NULL;
+			DWORD64 establisherFrame = 0;
+
+			RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, context.Rip, function, &context, &handlerData,
+			                 &establisherFrame, NULL);
+		}
+		else
+		{
+			// leaf function without unwind data
+			context.Rip = *reinterpret_cast<const DWORD64*>(context.Rsp);
+			context.Rsp += sizeof(DWORD64);
+		}
+	}
+#else
+	frames[count++] = context.Eip;
+
+	std::size_t frame = context.Ebp;
+	std::size_t frameMin = context.Esp;
+
+	while (count < maxCount)
+	{
+		if (frame < frameMin || frame % sizeof(std::size_t))
+		{
+			break;
+		}
+
+		std::size_t copiedFrame = frame;
+		RebaseToCopy(copy, copiedFrame);
+
+		// the frame is not in the copied part of the stack
+		if (copiedFrame == frame || copiedFrame + (2 * sizeof(std::size_t)) > copyTop)
+		{
+			break;
+		}
+
+		const std::size_t* pFrame = reinterpret_cast<const std::size_t*>(copiedFrame);
+		const std::size_t returnAddress = pFrame[1];
+
+		if (!returnAddress)
+		{
+			break;
+		}
+
+		frames[count++] = returnAddress;
+
+		// each frame is above the previous one
+		frameMin = frame + (2 * sizeof(std::size_t));
+		frame = pFrame[0];
+	}
+#endif
+
+	return count;
+}
+
+static std::string ResolveFrame(std::size_t address)
+{
+	HANDLE process = GetCurrentProcess();
+
+	CrashLogger::SymbolLock lock;
+
+	IMAGEHLP_MODULE moduleInfo = {};
+	moduleInfo.SizeOfStruct = sizeof moduleInfo;
+
+	if (!SymGetModuleInfo(process, address, &moduleInfo))
+	{
+		return StringTools::Format("0x%IX", address);
+	}
+
+	const std::string moduleName = PathTools::BaseName(moduleInfo.ImageName).ToStdString();
+
+	unsigned char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME] = {};
+	SYMBOL_INFO& symbol = *reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+	symbol.SizeOfStruct = sizeof(SYMBOL_INFO);
+	symbol.MaxNameLen = MAX_SYM_NAME;
+	DWORD64 symbolOffset = 0;
+
+	if (SymFromAddr(process, address, &symbolOffset, &symbol))
+	{
+		std::string name = moduleName + '!' + symbol.Name;
+
+		// semicolon separates frames in folded stacks
+		for (std::size_t i = 0; i < name.length(); i++)
+		{
+			if (name[i] == ';')
+			{
+				name[i] = ':';
+			}
+		}
+
+		return name;
+	}
+	else
+	{
+		const std::size_t moduleOffset = address - static_cast<std::size_t>(moduleInfo.BaseOfImage);
+
+		return StringTools::Format("%s+0x%IX", moduleName.c_str(), moduleOffset);
+	}
+}
+
+Profiler::Profiler() : m_profiledThread(NULL), m_isRunning(0), m_interval(0), m_onDone(NULL)
+{
+}
+
+Profiler::~Profiler()
+{
+	this->Stop();
+	this->Wait();
+
+	if (m_profiledThread)
+	{
+		CloseHandle(m_profiledThread);
+	}
+}
+
+bool Profiler::Start(unsigned long threadID, unsigned int rate, const std::string& path, DoneCallback onDone)
+{
+	if (m_isRunning || rate == 0)
+	{
+		return false;
+	}
+
+	// the previous run is finished
+	this->Wait();
+
+	if (m_profiledThread)
+	{
+		CloseHandle(m_profiledThread);
+	}
+
+	m_profiledThread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE,
+	                              threadID);
+
+	if (!m_profiledThread)
+	{
+		return false;
+	}
+
+	// loading symbols of all modules takes a while, so it is done only once and not during sampling
+	if (!CrashLogger::AcquireSymbols())
+	{
+		return false;
+	}
+
+	m_interval = 1000000 / rate;
+	m_path = path;
+	m_onDone = onDone;
+	m_stacks.clear();
+	m_stats = Stats();
+
+	m_stopEvent.Reset();
+
+	OS::Atomic::Exchange(&m_isRunning, 1);
+
+	if (!m_thread.Start(&Profiler::ThreadEntry, this))
+	{
+		OS::Atomic::Exchange(&m_isRunning, 0);
+		CrashLogger::ReleaseSymbols();
+		return false;
+	}
+
+	return true;
+}
+
+void Profiler::Stop()
+{
+	m_stopEvent.Set();
+}
+
+void Profiler::Wait()
+{
+	m_thread.Join();
+}
+
+void Profiler::ThreadEntry(void* param)
+{
+	static_cast<Profiler*>(param)->Run();
+}
+
+void Profiler::Run()
+{
+	// samples should be taken on time even when the profiled thread is busy
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+	OS::WaitableTimer timer;
+
+	std::size_t frames[PROFILER_MAX_DEPTH];
+	Stack stack;
+	stack.reserve(PROFILER_MAX_DEPTH);
+
+	// allocated in advance, the suspended thread might be holding the heap lock
+	std::vector<unsigned char> stackBuffer(PROFILER_STACK_COPY_SIZE + PROFILER_STACK_COPY_SLACK);
+
+	StackCopy stackCopy = {};
+	stackCopy.data = &stackBuffer[0];
+
+	StackRange range = {};
+	bool hasRange = false;
+
+	unsigned __int64 suspendTime = 0;
+
+	const unsigned __int64 startTime = OS::GetPerformanceCounter();
+
+	while (!m_stopEvent.Wait(0))
+	{
+		timer.Sleep(m_interval);
+
+		CONTEXT context = {};
+		context.ContextFlags = CONTEXT_FULL;
+
+		bool isCopied = false;
+
+		const unsigned __int64 suspendStartTime = OS::GetPerformanceCounter();
+
+		if (SuspendThread(m_profiledThread) == static_cast<DWORD>(-1))
+		{
+			m_stats.failedCount++;
+			continue;
+		}
+
+		// the unwinder takes the loader and function table locks, so only the raw data is captured here
+		if (GetThreadContext(m_profiledThread, &context))
+		{
+			if (!hasRange)
+			{
+				hasRange = GetStackRange(context, range);
+			}
+
+			if (hasRange)
+			{
+				isCopied = CopyStack(context, range, stackCopy);
+			}
+		}
+
+		ResumeThread(m_profiledThread);
+
+		suspendTime += OS::GetPerformanceCounter() - suspendStartTime;
+
+		const unsigned int frameCount = (isCopied) ? WalkStack(context, stackCopy, frames, PROFILER_MAX_DEPTH) : 0;
+
+		if (frameCount == 0)
+		{
+			m_stats.failedCount++;
+			continue;
+		}
+
+		stack.assign(frames, frames + frameCount);
+		m_stacks[stack]++;
+
+		m_stats.sampleCount++;
+	}
+
+	const unsigned __int64 frequency = OS::GetPerformanceFrequency();
+	const unsigned __int64 duration = OS::GetPerformanceCounter() - startTime;
+	const unsigned int attemptCount = m_stats.sampleCount + m_stats.failedCount;
+
+	m_stats.stackCount = static_cast<unsigned int>(m_stacks.size());
+	m_stats.duration = static_cast<double>(duration) / frequency;
+
+	if (attemptCount > 0)
+	{
+		m_stats.averageSuspendTime = (static_cast<double>(suspendTime) * 1000000) / frequency / attemptCount;
+	}
+
+	if (duration > 0)
+	{
+		m_stats.overhead = (100.0 * suspendTime) / duration;
+	}
+
+	const bool isWritten = this->Write();
+
+	CrashLogger::ReleaseSymbols();
+
+	// release the memory as soon as possible
+	std::map<Stack, unsigned int>().swap(m_stacks);
+
+	if (m_onDone)
+	{
+		m_onDone(m_path, isWritten, m_stats);
+	}
+
+	OS::Atomic::Exchange(&m_isRunning, 0);
+}
+
+bool Profiler::Write()
+{
+	std::map<std::size_t, std::string> names;
+	std::string content;
+
+	for (std::map<Stack, unsigned int>::const_iterator it = m_stacks.begin(); it != m_stacks.end(); ++it)
+	{
+		const Stack& stack = it->first;
+
+		// root frame first
+		for (std::size_t i = stack.size(); i-- > 0;)
+		{
+			// return addresses point after the call, which might already be the next function or line
+			const std::size_t address = (i > 0) ? stack[i] - 1 : stack[i];
+
+			std::map<std::size_t, std::string>::iterator nameIt = names.find(address);
+
+			if (nameIt == names.end())
+			{
+				nameIt = names.insert(std::make_pair(address, ResolveFrame(address))).first;
+			}
+
+			content += nameIt->second;
+			content += (i > 0) ? ';' : ' ';
+		}
+
+		StringTools::FormatTo(content, "%u\n", it->second);
+	}
+
+	OS::File file;
+	if (!file.Open(m_path.c_str(), OS::File::WRITE_ONLY_CREATE))
+	{
+		return false;
+	}
+
+	bool isError = false;
+
+	if (!content.empty())
+	{
+		file.Write(content.c_str(), content.length(), &isError);
+	}
+
+	// truncate any remains of a larger previous profile
+	return !isError && file.Resize(content.length());
+}
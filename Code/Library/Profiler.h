@@ -0,0 +1,77 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OS.h"
+
+/**
+ * Sampling profiler of a single thread.
+ *
+ * The sampler thread periodically suspends the profiled thread and copies its context and the used part of its stack.
+ * The stack is walked once the thread is resumed, because the unwinder takes locks the suspended thread might hold.
+ * Symbols are resolved once the profiling is stopped. The result is written as folded stacks, one unique stack per
+ * line with root frame first, suitable for flame graphs.
+ */
+class Profiler
+{
+public:
+	struct Stats
+	{
+		unsigned int sampleCount;
+		unsigned int failedCount;
+		unsigned int stackCount;  // unique stacks
+		double duration;  // seconds
+		double averageSuspendTime;  // microseconds the profiled thread was suspended for each sample
+		double overhead;  // percentage of time the profiled thread was suspended
+
+		Stats() : sampleCount(0), failedCount(0), stackCount(0), duration(0), averageSuspendTime(0), overhead(0)
+		{
+		}
+	};
+
+	// called by the sampler thread once the result is written
+	typedef void (*DoneCallback)(const std::string& path, bool isWritten, const Stats& stats);
+
+private:
+	typedef std::vector<std::size_t> Stack;
+
+	OS::Thread m_thread;
+	OS::Event m_stopEvent;
+	void* m_profiledThread;
+	volatile long m_isRunning;
+	unsigned int m_interval;  // microseconds
+	std::string m_path;
+	DoneCallback m_onDone;
+
+	std::map<Stack, unsigned int> m_stacks;
+	Stats m_stats;
+
+	// no copies
+	Profiler(const Profiler&);
+	Profiler& operator=(const Profiler&);
+
+	static void ThreadEntry(void* param);
+	void Run();
+
+	bool Write();
+
+public:
+	Profiler();
+	~Profiler();
+
+	// sampling or writing the result
+	bool IsRunning() const
+	{
+		return m_isRunning != 0;
+	}
+
+	bool Start(unsigned long threadID, unsigned int rate, const std::string& path, DoneCallback onDone);
+
+	// does not wait for the result
+	void Stop();
+
+	// waits until the result is written
+	void Wait();
+};
@@ -0,0 +1,443 @@
+#ifdef _MSC_VER
+#include <intrin.h>  // _BitScanForward
+#endif
+
+#include "CPUID.h"
+#include "SIMD.h"
+
+#ifdef SIMD_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef SIMD_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+SIMD::Level SIMD::GetLevel()
+{
+	if (g_cpuid.HasAVX2())
+	{
+		return LEVEL_AVX2;
+	}
+
+	if (g_cpuid.HasSSE2())
+	{
+		return LEVEL_SSE2;
+	}
+
+	return LEVEL_SCALAR;
+}
+
+const char* SIMD::GetLevelName(Level level)
+{
+	switch (level)
+	{
+		case LEVEL_SCALAR: return "Scalar";
+		case LEVEL_SSE2:   return "SSE2";
+		case LEVEL_AVX2:   return "AVX2";
+	}
+
+	return "";
+}
+
+//////////
+// Find //
+//////////
+
+typedef std::size_t (*TFind)(const char* text, std::size_t length, char ch);
+
+static std::size_t FindScalar(const char* text, std::size_t length, char ch)
+{
+	std::size_t i = 0;
+
+	for (; i < length; i++)
+	{
+		if (text[i] == ch)
+		{
+			break;
+		}
+	}
+
+	return i;
+}
+
+#ifdef SIMD_HAS_SSE2
+static std::size_t FindSSE2(const char* text, std::size_t length, char ch)
+{
+	const __m128i vch = _mm_set1_epi8(ch);
+
+	std::size_t i = 0;
+
+	for (; (i + 16) <= length; i += 16)
+	{
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+		const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vch));
+
+		if (mask)
+		{
+			unsigned long index;
+			_BitScanForward(&index, static_cast<unsigned long>(mask));
+
+			return i + index;
+		}
+	}
+
+	return i + FindScalar(text + i, length - i, ch);
+}
+#else
+#define FindSSE2 NULL
+#endif
+
+#ifdef SIMD_HAS_AVX2
+static std::size_t FindAVX2(const char* text, std::size_t length, char ch)
+{
+	const __m256i vch = _mm256_set1_epi8(ch);
+
+	std::size_t i = 0;
+
+	for (; (i + 32) <= length; i += 32)
+	{
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+		const int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vch));
+
+		if (mask)
+		{
+			unsigned long index;
+			_BitScanForward(&index, static_cast<unsigned int>(mask));
+
+			// avoid the penalty of mixing AVX and legacy SSE code
+			_mm256_zeroupper();
+
+			return i + index;
+		}
+	}
+
+	_mm256_zeroupper();
+
+	return i + FindScalar(text + i, length - i, ch);
+}
+#else
+#define FindAVX2 NULL
+#endif
+
+std::size_t SIMD::Find(const char* text, std::size_t length, char ch)
+{
+	// a race is harmless, all threads select the same kernel
+	static TFind pKernel = NULL;
+
+	if (!pKernel)
+	{
+		pKernel = Select<TFind>(&FindScalar, FindSSE2, FindAVX2);
+	}
+
+	return pKernel(text, length, ch);
+}
+
+////////////////
+// FindEither //
+////////////////
+
+typedef std::size_t (*TFindEither)(const char* text, std::size_t length, char a, char b);
+
+static std::size_t FindEitherScalar(const char* text, std::size_t length, char a, char b)
+{
+	std::size_t i = 0;
+
+	for (; i < length; i++)
+	{
+		if (text[i] == a || text[i] == b)
+		{
+			break;
+		}
+	}
+
+	return i;
+}
+
+#ifdef SIMD_HAS_SSE2
+static std::size_t FindEitherSSE2(const char* text, std::size_t length, char a, char b)
+{
+	const __m128i va = _mm_set1_epi8(a);
+	const __m128i vb = _mm_set1_epi8(b);
+
+	std::size_t i = 0;
+
+	for (; (i + 16) <= length; i += 16)
+	{
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+		const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+		const int mask = _mm_movemask_epi8(matches);
+
+		if (mask)
+		{
+			unsigned long index;
+			_BitScanForward(&index, static_cast<unsigned long>(mask));
+
+			return i + index;
+		}
+	}
+
+	return i + FindEitherScalar(text + i, length - i, a, b);
+}
+#else
+#define FindEitherSSE2 NULL
+#endif
+
+#ifdef SIMD_HAS_AVX2
+static std::size_t FindEitherAVX2(const char* text, std::size_t length, char a, char b)
+{
+	const __m256i va = _mm256_set1_epi8(a);
+	const __m256i vb = _mm256_set1_epi8(b);
+
+	std::size_t i = 0;
+
+	for (; (i + 32) <= length; i += 32)
+	{
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+		const __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb));
+		const int mask = _mm256_movemask_epi8(matches);
+
+		if (mask)
+		{
+			unsigned long index;
+			_BitScanForward(&index, static_cast<unsigned long>(mask));
+
+			// avoid the penalty of mixing AVX and legacy SSE code
+			_mm256_zeroupper();
+
+			return i + index;
+		}
+	}
+
+	_mm256_zeroupper();
+
+	return i + FindEitherScalar(text + i, length - i, a, b);
+}
+#else
+#define FindEitherAVX2 NULL
+#endif
+
+std::size_t SIMD::FindEither(const char* text, std::size_t length, char a, char b)
+{
+	// a race is harmless, all threads select the same kernel
+	static TFindEither pKernel = NULL;
+
+	if (!pKernel)
+	{
+		pKernel = Select<TFindEither>(&FindEitherScalar, FindEitherSSE2, FindEitherAVX2);
+	}
+
+	return pKernel(text, length, a, b);
+}
+
+////////////////////
+// FindLastEither //
+////////////////////
+
+static std::size_t FindLastEitherScalar(const char* text, std::size_t length, char a, char b)
+{
+	for (std::size_t i = length; i-- > 0;)
+	{
+		if (text[i] == a || text[i] == b)
+		{
+			return i;
+		}
+	}
+
+	return length;
+}
+
+#ifdef SIMD_HAS_SSE2
+static std::size_t FindLastEitherSSE2(const char* text, std::size_t length, char a, char b)
+{
+	const __m128i va = _mm_set1_epi8(a);
+	const __m128i vb = _mm_set1_epi8(b);
+
+	std::size_t end = length;
+
+	for (; end >= 16; end -= 16)
+	{
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + end - 16));
+		const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+		const int mask = _mm_movemask_epi8(matches);
+
+		if (mask)
+		{
+			unsigned long index;
+			_BitScanReverse(&index, static_cast<unsigned long>(mask));
+
+			return end - 16 + index;
+		}
+	}
+
+	const std::size_t pos = FindLastEitherScalar(text, end, a, b);
+
+	return (pos < end) ? pos : length;
+}
+#else
+#define FindLastEitherSSE2 NULL
+#endif
+
+#ifdef SIMD_HAS_AVX2
+static std::size_t FindLastEitherAVX2(const char* text, std::size_t length, char a, char b)
+{
+	const __m256i va = _mm256_set1_epi8(a);
+	const __m256i vb = _mm256_set1_epi8(b);
+
+	std::size_t end = length;
+
+	for (; end >= 32; end -= 32)
+	{
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + end - 32));
+		const __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb));
+		const int mask = _mm256_movemask_epi8(matches);
+
+		if (mask)
+		{
+			unsigned long index;
+			_BitScanReverse(&index, static_cast<unsigned int>(mask));
+
+			// avoid the penalty of mixing AVX and legacy SSE code
+			_mm256_zeroupper();
+
+			return end - 32 + index;
+		}
+	}
+
+	_mm256_zeroupper();
+
+	const std::size_t pos = FindLastEitherScalar(text, end, a, b);
+
+	return (pos < end) ? pos : length;
+}
+#else
+#define FindLastEitherAVX2 NULL
+#endif
+
+std::size_t SIMD::FindLastEither(const char* text, std::size_t length, char a, char b)
+{
+	// a race is harmless, all threads select the same kernel
+	static TFindEither pKernel = NULL;
+
+	if (!pKernel)
+	{
+		pKernel = Select<TFindEither>(&FindLastEitherScalar, FindLastEitherSSE2, FindLastEitherAVX2);
+	}
+
+	return pKernel(text, length, a, b);
+}
+
+////////////////////////
+// FindMismatchNoCase //
+////////////////////////
+
+typedef std::size_t (*TFindMismatchNoCase)(const char* textA, const char* textB, std::size_t length);
+
+static char ToLowerASCII(char ch)
+{
+	return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch + ('a' - 'A')) : ch;
+}
+
+static std::size_t FindMismatchNoCaseScalar(const char* textA, const char* textB, std::size_t length)
+{
+	std::size_t i = 0;
+
+	for (; i < length; i++)
+	{
+		if (ToLowerASCII(textA[i]) != ToLowerASCII(textB[i]))
+		{
+			break;
+		}
+	}
+
+	return i;
+}
+
+#ifdef SIMD_HAS_SSE2
+static __m128i ToLowerASCII(const __m128i& chunk)
+{
+	// moves 'A' to 'Z' to the bottom of the signed range, so a single signed comparison finds them
+	const __m128i shifted = _mm_add_epi8(chunk, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+	const __m128i isUpper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+
+	return _mm_or_si128(chunk, _mm_and_si128(isUpper, _mm_set1_epi8('a' - 'A')));
+}
+
+static std::size_t FindMismatchNoCaseSSE2(const char* textA, const char* textB, std::size_t length)
+{
+	std::size_t i = 0;
+
+	for (; (i + 16) <= length; i += 16)
+	{
+		const __m128i chunkA = ToLowerASCII(_mm_loadu_si128(reinterpret_cast<const __m128i*>(textA + i)));
+		const __m128i chunkB = ToLowerASCII(_mm_loadu_si128(reinterpret_cast<const __m128i*>(textB + i)));
+		const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunkA, chunkB));
+
+		if (mask != 0xFFFF)
+		{
+			unsigned long index;
+			_BitScanForward(&index, static_cast<unsigned long>(~mask & 0xFFFF));
+
+			return i + index;
+		}
+	}
+
+	return i + FindMismatchNoCaseScalar(textA + i, textB + i, length - i);
+}
+#else
+#define FindMismatchNoCaseSSE2 NULL
+#endif
+
+#ifdef SIMD_HAS_AVX2
+static __m256i ToLowerASCII(const __m256i& chunk)
+{
+	// moves 'A' to 'Z' to the bottom of the signed range, so a single signed comparison finds them
+	const __m256i shifted = _mm256_add_epi8(chunk, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+	const __m256i isUpper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+
+	return _mm256_or_si256(chunk, _mm256_and_si256(isUpper, _mm256_set1_epi8('a' - 'A')));
+}
+
+static std::size_t FindMismatchNoCaseAVX2(const char* textA, const char* textB, std::size_t length)
+{
+	std::size_t i = 0;
+
+	for (; (i + 32) <= length; i += 32)
+	{
+		const __m256i chunkA = ToLowerASCII(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(textA + i)));
+		const __m256i chunkB = ToLowerASCII(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(textB + i)));
+		const int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunkA, chunkB));
+
+		// all bits set means all characters are equal
+		if (mask != -1)
+		{
+			unsigned long index;
+			_BitScanForward(&index, static_cast<unsigned int>(~mask));
+
+			// avoid the penalty of mixing AVX and legacy SSE code
+			_mm256_zeroupper();
+
+			return i + index;
+		}
+	}
+
+	_mm256_zeroupper();
+
+	return i + FindMismatchNoCaseScalar(textA + i, textB + i, length - i);
+}
+#else
+#define FindMismatchNoCaseAVX2 NULL
+#endif
+
+std::size_t SIMD::FindMismatchNoCase(const char* textA, const char* textB, std::size_t length)
+{
+	// a race is harmless, all threads select the same kernel
+	static TFindMismatchNoCase pKernel = NULL;
+
+	if (!pKernel)
+	{
+		pKernel = Select<TFindMismatchNoCase>(&FindMismatchNoCaseScalar, FindMismatchNoCaseSSE2, FindMismatchNoCaseAVX2);
+	}
+
+	return pKernel(textA, textB, length);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Runtime selection of vectorized code.
+ *
+ * Each kernel has a scalar version and optionally versions for newer instruction sets. The best one supported by both
+ * the CPU and the OS is selected on first use, so the launcher keeps working on any host.
+ *
+ * Kernels for newer instruction sets can be compiled only if the compiler supports them, see SIMD_HAS_* macros.
+ */
+namespace SIMD
+{
+	enum Level
+	{
+		LEVEL_SCALAR,
+		LEVEL_SSE2,
+		LEVEL_AVX2,
+	};
+
+	// do not use during static initialization, it depends on g_cpuid
+	Level GetLevel();
+
+	const char* GetLevelName(Level level);
+
+	// returns the kernel for the highest supported level, missing kernels are NULL
+	template<class TFunction>
+	TFunction Select(TFunction scalar, TFunction sse2, TFunction avx2 = NULL)
+	{
+		const Level level = GetLevel();
+
+		if (avx2 && level >= LEVEL_AVX2)
+		{
+			return avx2;
+		}
+
+		if (sse2 && level >= LEVEL_SSE2)
+		{
+			return sse2;
+		}
+
+		return scalar;
+	}
+
+	/////////////
+	// Kernels //
+	/////////////
+
+	// returns the position of the first ch in the text, or length if there is none
+	std::size_t Find(const char* text, std::size_t length, char ch);
+
+	// returns the position of the first a or b in the text, or length if there is none
+	std::size_t FindEither(const char* text, std::size_t length, char a, char b);
+
+	// returns the position of the last a or b in the text, or length if there is none
+	std::size_t FindLastEither(const char* text, std::size_t length, char a, char b);
+
+	// returns the position of the first character that differs in ASCII case-insensitive comparison, or length if none
+	std::size_t FindMismatchNoCase(const char* textA, const char* textB, std::size_t length);
+}
+
+#ifdef _MSC_VER
+// SSE2 intrinsics are available in all supported compilers
+#define SIMD_HAS_SSE2
+#if _MSC_VER >= 1700
+#define SIMD_HAS_AVX2
+#endif
+#endif
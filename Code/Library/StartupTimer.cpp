@@ -0,0 +1,131 @@
+#include "OS.h"
+#include "StartupTimer.h"
+
+struct StepRecord
+{
+	const char* name;
+	unsigned int depth;
+	unsigned __int64 beginTime;  // OS::GetPerformanceCounter
+	unsigned __int64 endTime;
+};
+
+static StepRecord g_steps[StartupTimer::MAX_STEP_COUNT];
+static unsigned int g_stepCount;
+
+// indexes of the running steps
+static unsigned int g_stack[StartupTimer::MAX_STEP_COUNT];
+static unsigned int g_stackSize;
+
+// steps beyond MAX_STEP_COUNT are not recorded, but their nesting still has to be tracked
+static unsigned int g_droppedDepth;
+
+static unsigned __int64 g_startTime;
+static unsigned __int64 g_finishTime;
+static bool g_isFinished;
+
+static double ToMilliseconds(unsigned __int64 duration)
+{
+	return (static_cast<double>(duration) * 1000) / static_cast<double>(OS::GetPerformanceFrequency());
+}
+
+void StartupTimer::Start()
+{
+	g_stepCount = 0;
+	g_stackSize = 0;
+	g_droppedDepth = 0;
+	g_startTime = OS::GetPerformanceCounter();
+	g_finishTime = 0;
+	g_isFinished = false;
+}
+
+void StartupTimer::BeginStep(const char* name)
+{
+	if (g_isFinished)
+	{
+		return;
+	}
+
+	if (g_stepCount >= MAX_STEP_COUNT || g_droppedDepth > 0)
+	{
+		g_droppedDepth++;
+		return;
+	}
+
+	StepRecord& step = g_steps[g_stepCount];
+	step.name = name;
+	step.depth = g_stackSize;
+	step.beginTime = OS::GetPerformanceCounter();
+	step.endTime = 0;
+
+	g_stack[g_stackSize++] = g_stepCount++;
+}
+
+void StartupTimer::EndStep()
+{
+	if (g_isFinished)
+	{
+		return;
+	}
+
+	if (g_droppedDepth > 0)
+	{
+		g_droppedDepth--;
+		return;
+	}
+
+	if (g_stackSize > 0)
+	{
+		g_steps[g_stack[--g_stackSize]].endTime = OS::GetPerformanceCounter();
+	}
+}
+
+void StartupTimer::Finish()
+{
+	if (g_isFinished)
+	{
+		return;
+	}
+
+	g_droppedDepth = 0;
+
+	while (g_stackSize > 0)
+	{
+		EndStep();
+	}
+
+	g_finishTime = OS::GetPerformanceCounter();
+	g_isFinished = true;
+}
+
+bool StartupTimer::IsFinished()
+{
+	return g_isFinished;
+}
+
+double StartupTimer::GetTotalTime()
+{
+	const unsigned __int64 finishTime = (g_isFinished) ? g_finishTime : OS::GetPerformanceCounter();
+
+	return ToMilliseconds(finishTime - g_startTime);
+}
+
+unsigned int StartupTimer::GetStepCount()
+{
+	return g_stepCount;
+}
+
+StartupTimer::Step StartupTimer::GetStep(unsigned int index)
+{
+	Step result = {};
+
+	if (index < g_stepCount)
+	{
+		const StepRecord& step = g_steps[index];
+
+		result.name = step.name;
+		result.depth = step.depth;
+		result.duration = (step.endTime) ? ToMilliseconds(step.endTime - step.beginTime) : -1;
+	}
+
+	return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+/**
+ * Records how long each startup step takes, so slow restarts can be explained.
+ *
+ * Steps can be nested. Everything is expected to run on the main thread.
+ */
+namespace StartupTimer
+{
+	enum
+	{
+		MAX_STEP_COUNT = 64,
+	};
+
+	struct Step
+	{
+		const char* name;  // static string
+		unsigned int depth;
+		double duration;  // milliseconds, negative if the step is still running
+	};
+
+	void Start();
+
+	void BeginStep(const char* name);
+	void EndStep();
+
+	// ends all running steps
+	void Finish();
+	bool IsFinished();
+
+	// time between Start and Finish in milliseconds
+	double GetTotalTime();
+
+	unsigned int GetStepCount();
+	Step GetStep(unsigned int index);
+
+	class Scope
+	{
+		// no copies
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+	public:
+		explicit Scope(const char* name)
+		{
+			BeginStep(name);
+		}
+
+		~Scope()
+		{
+			EndStep();
+		}
+	};
+}
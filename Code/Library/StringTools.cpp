@@ -8,6 +8,20 @@
 #define va_copy(dest, src) ((dest) = (src))
 #endif
 
+// spare capacity ensured before formatting, most formatted pieces fit into it
+#define FORMAT_MIN_SPARE_CAPACITY 256
+
+static void ReserveGrown(std::string& result, std::size_t requiredCapacity)
+{
+	if (result.capacity() < requiredCapacity)
+	{
+		// grow geometrically like push_back does
+		const std::size_t grownCapacity = result.capacity() + (result.capacity() / 2);
+
+		result.reserve((grownCapacity > requiredCapacity) ? grownCapacity : requiredCapacity);
+	}
+}
+
 std::string StringTools::Format(const char* format, ...)
 {
 	va_list args;
@@ -38,35 +52,61 @@ std::size_t StringTools::FormatTo(std::string& result, const char* format, ...)
 
 std::size_t StringTools::FormatToV(std::string& result, const char* format, va_list args)
 {
+	if (!format)
+	{
+		return 0;
+	}
+
 	va_list argsCopy;
 	va_copy(argsCopy, args);
 
-	char buffer[1024];
-	std::size_t length = FormatToV(buffer, sizeof buffer, format, args);
+	const std::size_t existingLength = result.length();
+
+	if ((result.capacity() - existingLength) < FORMAT_MIN_SPARE_CAPACITY)
+	{
+		ReserveGrown(result, existingLength + FORMAT_MIN_SPARE_CAPACITY);
+	}
+
+	// format directly into the spare capacity
+	// only part of it is used, resize fills the whole added range with zeros first
+	result.resize(existingLength + FORMAT_MIN_SPARE_CAPACITY);
 
-	// make sure the resulting string is not truncated
-	if (length < sizeof buffer)
+	std::size_t space = result.length() - existingLength;
+	int status = _vsnprintf(&result[existingLength], space, format, args);
+
+	std::size_t length = 0;
+
+	if (status >= 0 && static_cast<std::size_t>(status) < space)
 	{
-		// do not overwrite the existing content
-		result.append(buffer, length);
+		length = static_cast<std::size_t>(status);
 	}
 	else
 	{
-		const std::size_t existingLength = result.length();
+		va_list argsSizeCopy;
+		va_copy(argsSizeCopy, argsCopy);
 
-		result.resize(existingLength + length);
+		// only counts the characters
+		status = _vscprintf(format, argsSizeCopy);
 
-		// format string again with proper buffer size
-		length = FormatToV(const_cast<char*>(result.data() + existingLength), length + 1, format, argsCopy);
+		va_end(argsSizeCopy);
 
-		if (length < result.length())
+		if (status > 0)
 		{
-			result.resize(length);
+			length = static_cast<std::size_t>(status);
+
+			// room for the terminating null character as well
+			ReserveGrown(result, existingLength + length + 1);
+			result.resize(existingLength + length + 1);
+
+			space = result.length() - existingLength;
+			_vsnprintf(&result[existingLength], space, format, argsCopy);
 		}
 	}
 
 	va_end(argsCopy);
 
+	result.resize(existingLength + length);
+
 	return length;
 }
 
@@ -127,6 +167,75 @@ std::size_t StringTools::FormatToV(char* buffer, std::size_t bufferSize, const c
 	return length;
 }
 
+void StringTools::AppendDecimal(std::string& result, unsigned long value, unsigned int width)
+{
+	char buffer[32];
+	std::size_t pos = sizeof buffer;
+
+	do
+	{
+		buffer[--pos] = static_cast<char>('0' + (value % 10));
+		value /= 10;
+	}
+	while (value > 0);
+
+	while ((sizeof buffer - pos) < width && pos > 0)
+	{
+		buffer[--pos] = '0';
+	}
+
+	result.append(buffer + pos, sizeof buffer - pos);
+}
+
+void StringTools::AppendDecimal64(std::string& result, unsigned __int64 value, unsigned int width)
+{
+	// 64-bit division is slow in 32-bit code
+	if (value <= 0xFFFFFFFF)
+	{
+		AppendDecimal(result, static_cast<unsigned long>(value), width);
+		return;
+	}
+
+	char buffer[32];
+	std::size_t pos = sizeof buffer;
+
+	do
+	{
+		buffer[--pos] = static_cast<char>('0' + static_cast<unsigned int>(value % 10));
+		value /= 10;
+	}
+	while (value > 0);
+
+	while ((sizeof buffer - pos) < width && pos > 0)
+	{
+		buffer[--pos] = '0';
+	}
+
+	result.append(buffer + pos, sizeof buffer - pos);
+}
+
+void StringTools::AppendHex(std::string& result, unsigned long value, unsigned int width)
+{
+	const char* digits = "0123456789abcdef";
+
+	char buffer[32];
+	std::size_t pos = sizeof buffer;
+
+	do
+	{
+		buffer[--pos] = digits[value & 0xF];
+		value >>= 4;
+	}
+	while (value > 0);
+
+	while ((sizeof buffer - pos) < width && pos > 0)
+	{
+		buffer[--pos] = '0';
+	}
+
+	result.append(buffer + pos, sizeof buffer - pos);
+}
+
 std::runtime_error StringTools::Error(const char* format, ...)
 {
 	va_list args;
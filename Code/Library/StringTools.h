@@ -10,12 +10,19 @@ namespace StringTools
 	std::string Format(const char* format, ...);
 	std::string FormatV(const char* format, va_list args);
 
+	// formats directly into the spare capacity of the result, which grows only if the output does not fit
+	// reusing the same string avoids any allocation and copying
 	std::size_t FormatTo(std::string& result, const char* format, ...);
 	std::size_t FormatToV(std::string& result, const char* format, va_list args);
 
 	std::size_t FormatTo(char* buffer, std::size_t bufferSize, const char* format, ...);
 	std::size_t FormatToV(char* buffer, std::size_t bufferSize, const char* format, va_list args);
 
+	// faster replacements of %0*lu, %0*I64u and %0*lx, numbers with fewer digits than width are padded with zeros
+	void AppendDecimal(std::string& result, unsigned long value, unsigned int width = 0);
+	void AppendDecimal64(std::string& result, unsigned __int64 value, unsigned int width = 0);
+	void AppendHex(std::string& result, unsigned long value, unsigned int width = 0);
+
 	std::runtime_error Error(const char* format, ...);
 	std::runtime_error ErrorV(const char* format, va_list args);
 
@@ -1,5 +1,6 @@
 #include <cctype>
 
+#include "SIMD.h"
 #include "StringView.h"
 
 int StringView::Compare(const StringView& other) const
@@ -24,15 +25,14 @@ int StringView::CompareNoCase(const StringView& other) const
 {
 	const std::size_t commonLength = (this->length <= other.length) ? this->length : other.length;
 
-	for (std::size_t i = 0; i < commonLength; i++)
+	const std::size_t i = SIMD::FindMismatchNoCase(this->string, other.string, commonLength);
+
+	if (i < commonLength)
 	{
 		char chA = std::toupper(this->string[i]);
 		char chB = std::toupper(other.string[i]);
 
-		if (chA != chB)
-		{
-			return (chA < chB) ? -1 : 1;
-		}
+		return (chA < chB) ? -1 : 1;
 	}
 
 	if (this->length != other.length)
@@ -50,14 +50,47 @@ bool StringView::Find(char ch, std::size_t& pos) const
 		return false;
 	}
 
-	const void* location = std::memchr(this->string + pos, ch, this->length - pos);
+	const std::size_t location = pos + SIMD::Find(this->string + pos, this->length - pos, ch);
+
+	if (location >= this->length)
+	{
+		return false;
+	}
+
+	pos = location;
+
+	return true;
+}
+
+bool StringView::FindEither(char a, char b, std::size_t& pos) const
+{
+	if (pos >= this->length)
+	{
+		return false;
+	}
+
+	const std::size_t location = pos + SIMD::FindEither(this->string + pos, this->length - pos, a, b);
+
+	if (location >= this->length)
+	{
+		return false;
+	}
+
+	pos = location;
+
+	return true;
+}
+
+bool StringView::FindLastEither(char a, char b, std::size_t& pos) const
+{
+	const std::size_t location = SIMD::FindLastEither(this->string, this->length, a, b);
 
-	if (!location)
+	if (location >= this->length)
 	{
 		return false;
 	}
 
-	pos = static_cast<const char*>(location) - this->string;
+	pos = location;
 
 	return true;
 }
@@ -113,6 +113,12 @@ struct StringView
 	}
 
 	bool Find(char ch, std::size_t& pos) const;
+
+	// finds the first a or b at or after pos
+	bool FindEither(char a, char b, std::size_t& pos) const;
+
+	// finds the last a or b in the whole string
+	bool FindLastEither(char a, char b, std::size_t& pos) const;
 };
 
 inline bool operator==(const StringView& a, const StringView& b) { return a.Compare(b) == 0; }
@@ -0,0 +1,173 @@
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+
+#include "TCPSocket.h"
+
+static bool InitSockets()
+{
+	// Winsock keeps its own reference count, so there is no harm in calling this more than once
+	static bool isInitialized = false;
+
+	if (!isInitialized)
+	{
+		WSADATA data;
+		const int status = WSAStartup(MAKEWORD(2, 2), &data);
+
+		if (status != 0)
+		{
+			SetLastError(status);
+			return false;
+		}
+
+		isInitialized = true;
+	}
+
+	return true;
+}
+
+static bool WaitForSocket(SOCKET handle, unsigned int timeoutMilliseconds)
+{
+	fd_set set;
+	FD_ZERO(&set);
+	FD_SET(handle, &set);
+
+	timeval timeout;
+	timeout.tv_sec = timeoutMilliseconds / 1000;
+	timeout.tv_usec = (timeoutMilliseconds % 1000) * 1000;
+
+	return select(0, &set, NULL, NULL, &timeout) > 0;
+}
+
+OS::TCPSocket::TCPSocket() : m_handle(INVALID_SOCKET)
+{
+}
+
+bool OS::TCPSocket::IsOpen() const
+{
+	return m_handle != INVALID_SOCKET;
+}
+
+bool OS::TCPSocket::Listen(const char* address, unsigned short port)
+{
+	this->Close();
+
+	if (!InitSockets())
+	{
+		return false;
+	}
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = inet_addr(address);
+
+	if (addr.sin_addr.s_addr == INADDR_NONE)
+	{
+		SetLastError(WSAEINVAL);
+		return false;
+	}
+
+	const SOCKET handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	if (handle == INVALID_SOCKET)
+	{
+		SetLastError(WSAGetLastError());
+		return false;
+	}
+
+	m_handle = handle;
+
+	// do not let restarted processes inherit the socket and keep the port busy
+	SetHandleInformation(reinterpret_cast<HANDLE>(handle), HANDLE_FLAG_INHERIT, 0);
+
+	// prevent other processes from stealing the port
+	const BOOL isExclusive = TRUE;
+	setsockopt(handle, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&isExclusive), sizeof isExclusive);
+
+	if (bind(handle, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0 || listen(handle, SOMAXCONN) != 0)
+	{
+		const int error = WSAGetLastError();
+		this->Close();
+		SetLastError(error);
+		return false;
+	}
+
+	return true;
+}
+
+bool OS::TCPSocket::IsAddressInUseError(unsigned long errorCode)
+{
+	return errorCode == WSAEADDRINUSE;
+}
+
+bool OS::TCPSocket::Accept(TCPSocket& client, unsigned int timeoutMilliseconds)
+{
+	client.Close();
+
+	if (!WaitForSocket(m_handle, timeoutMilliseconds))
+	{
+		return false;
+	}
+
+	const SOCKET handle = accept(m_handle, NULL, NULL);
+
+	if (handle == INVALID_SOCKET)
+	{
+		SetLastError(WSAGetLastError());
+		return false;
+	}
+
+	SetHandleInformation(reinterpret_cast<HANDLE>(handle), HANDLE_FLAG_INHERIT, 0);
+
+	client.m_handle = handle;
+
+	return true;
+}
+
+std::size_t OS::TCPSocket::Receive(void* buffer, std::size_t bufferSize, unsigned int timeoutMilliseconds)
+{
+	if (!WaitForSocket(m_handle, timeoutMilliseconds))
+	{
+		return 0;
+	}
+
+	const int length = recv(m_handle, static_cast<char*>(buffer), static_cast<int>(bufferSize), 0);
+
+	if (length <= 0)
+	{
+		SetLastError(WSAGetLastError());
+		return 0;
+	}
+
+	return static_cast<std::size_t>(length);
+}
+
+bool OS::TCPSocket::Send(const void* data, std::size_t dataSize)
+{
+	const char* pos = static_cast<const char*>(data);
+
+	while (dataSize > 0)
+	{
+		const int length = send(m_handle, pos, static_cast<int>(dataSize), 0);
+
+		if (length <= 0)
+		{
+			SetLastError(WSAGetLastError());
+			return false;
+		}
+
+		pos += length;
+		dataSize -= length;
+	}
+
+	return true;
+}
+
+void OS::TCPSocket::Close()
+{
+	if (m_handle != INVALID_SOCKET)
+	{
+		closesocket(m_handle);
+		m_handle = INVALID_SOCKET;
+	}
+}
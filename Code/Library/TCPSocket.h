@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+namespace OS
+{
+	/**
+	 * Minimal blocking TCP socket. Winsock is initialized on first use.
+	 *
+	 * Kept out of OS.cpp, so only executables that use sockets have to link ws2_32.
+	 */
+	class TCPSocket
+	{
+		std::size_t m_handle;  // SOCKET
+
+		// no copies
+		TCPSocket(const TCPSocket&);
+		TCPSocket& operator=(const TCPSocket&);
+
+	public:
+		TCPSocket();
+
+		~TCPSocket()
+		{
+			this->Close();
+		}
+
+		bool IsOpen() const;
+
+		void Swap(TCPSocket& other)
+		{
+			const std::size_t tmp = m_handle;
+			m_handle = other.m_handle;
+			other.m_handle = tmp;
+		}
+
+		// address is an IPv4 address in dotted notation, e.g. 0.0.0.0 for all interfaces
+		bool Listen(const char* address, unsigned short port);
+
+		// tells whether Listen failed because another socket has the port
+		static bool IsAddressInUseError(unsigned long errorCode);
+
+		// returns false on timeout or error
+		bool Accept(TCPSocket& client, unsigned int timeoutMilliseconds);
+
+		// returns zero on timeout, error or closed connection
+		std::size_t Receive(void* buffer, std::size_t bufferSize, unsigned int timeoutMilliseconds);
+
+		// sends all data
+		bool Send(const void* data, std::size_t dataSize);
+
+		void Close();
+	};
+}
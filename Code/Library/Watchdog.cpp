@@ -0,0 +1,131 @@
+#include "CrashLogger.h"
+#include "StringTools.h"
+#include "Watchdog.h"
+
+// the watched thread is checked several times within the timeout
+#define WATCHDOG_CHECK_COUNT 4
+#define WATCHDOG_MIN_CHECK_INTERVAL 100
+
+// same as abort
+#define WATCHDOG_EXIT_CODE 3
+
+Watchdog::Watchdog() : m_heartbeat(0), m_suspendCount(0), m_watchedThreadID(0), m_timeout(0), m_isFatal(false),
+  m_openLogFile(NULL), m_onHang(NULL)
+{
+}
+
+bool Watchdog::Start(unsigned int timeout, bool isFatal, CrashLogger::Handler openLogFile, HangCallback onHang)
+{
+	if (timeout == 0 || m_thread.IsStarted())
+	{
+		return false;
+	}
+
+	m_watchedThreadID = OS::GetCurrentThreadID();
+	m_timeout = timeout;
+	m_isFatal = isFatal;
+	m_openLogFile = openLogFile;
+	m_onHang = onHang;
+
+	return m_thread.Start(&Watchdog::ThreadEntry, this);
+}
+
+void Watchdog::Stop()
+{
+	m_stopEvent.Set();
+
+	m_thread.Join();
+}
+
+void Watchdog::ThreadEntry(void* param)
+{
+	static_cast<Watchdog*>(param)->Run();
+}
+
+void Watchdog::Run()
+{
+	unsigned int checkInterval = m_timeout / WATCHDOG_CHECK_COUNT;
+
+	if (checkInterval < WATCHDOG_MIN_CHECK_INTERVAL)
+	{
+		checkInterval = WATCHDOG_MIN_CHECK_INTERVAL;
+	}
+
+	const unsigned __int64 frequency = OS::GetPerformanceFrequency();
+
+	long lastHeartbeat = m_heartbeat;
+	unsigned __int64 lastHeartbeatTime = OS::GetPerformanceCounter();
+	bool isReported = false;
+
+	while (!m_stopEvent.Wait(checkInterval))
+	{
+		const long heartbeat = m_heartbeat;
+		const unsigned __int64 now = OS::GetPerformanceCounter();
+
+		if (heartbeat != lastHeartbeat || m_suspendCount > 0)
+		{
+			lastHeartbeat = heartbeat;
+			lastHeartbeatTime = now;
+			isReported = false;
+			continue;
+		}
+
+		const unsigned int duration = static_cast<unsigned int>(((now - lastHeartbeatTime) * 1000) / frequency);
+
+		if (duration >= m_timeout && !isReported)
+		{
+			this->ReportHang(duration);
+
+			isReported = true;
+		}
+	}
+}
+
+void Watchdog::ReportHang(unsigned int duration)
+{
+	const std::string message = StringTools::Format("Thread %lu not responding for %.1f seconds",
+		m_watchedThreadID, duration / 1000.0
+	);
+
+	if (m_isFatal)
+	{
+		if (!CrashLogger::ReportHang(m_watchedThreadID, message.c_str(), m_openLogFile, NULL))
+		{
+			this->WriteToLogFile(message + " (failed to capture the call stack)\n");
+		}
+
+		if (m_onHang)
+		{
+			m_onHang(message + "\n");
+		}
+
+		OS::TerminateCurrentProcess(WATCHDOG_EXIT_CODE);
+	}
+	else
+	{
+		std::string report;
+
+		if (!CrashLogger::ReportHang(m_watchedThreadID, message.c_str(), NULL, &report))
+		{
+			report = message + " (failed to capture the call stack)\n";
+		}
+
+		this->WriteToLogFile(report);
+
+		if (m_onHang)
+		{
+			m_onHang(report);
+		}
+	}
+}
+
+void Watchdog::WriteToLogFile(const std::string& text)
+{
+	std::FILE* file = (m_openLogFile) ? m_openLogFile() : NULL;
+
+	if (file)
+	{
+		std::fwrite(text.c_str(), 1, text.length(), file);
+		std::fclose(file);
+	}
+}
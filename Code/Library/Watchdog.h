@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+
+#include "CrashLogger.h"
+#include "OS.h"
+
+/**
+ * Detects a thread that stopped responding.
+ *
+ * The watched thread calls Heartbeat regularly. If no heartbeat arrives within the timeout, the watchdog thread reports
+ * the call stack of the watched thread, once for each hang. The report is appended to the log file and passed to the
+ * callback. A fatal hang is written like a crash and the process is terminated, so a supervisor can restart it.
+ *
+ * The watched thread might be hung while holding any lock, so the log file must be opened without taking them.
+ *
+ * Known long operations of the watched thread suspend the watchdog meanwhile.
+ */
+class Watchdog
+{
+public:
+	// called by the watchdog thread, the report ends with a newline
+	typedef void (*HangCallback)(const std::string& report);
+
+private:
+	OS::Thread m_thread;
+	OS::Event m_stopEvent;
+	volatile long m_heartbeat;
+	volatile long m_suspendCount;
+	unsigned long m_watchedThreadID;
+	unsigned int m_timeout;
+	bool m_isFatal;
+	CrashLogger::Handler m_openLogFile;
+	HangCallback m_onHang;
+
+	// no copies
+	Watchdog(const Watchdog&);
+	Watchdog& operator=(const Watchdog&);
+
+	static void ThreadEntry(void* param);
+	void Run();
+
+	void ReportHang(unsigned int duration);
+	void WriteToLogFile(const std::string& text);
+
+public:
+	Watchdog();
+
+	~Watchdog()
+	{
+		this->Stop();
+	}
+
+	bool IsStarted() const
+	{
+		return m_thread.IsStarted();
+	}
+
+	// watches the calling thread, the timeout is in milliseconds
+	bool Start(unsigned int timeout, bool isFatal, CrashLogger::Handler openLogFile, HangCallback onHang);
+
+	void Stop();
+
+	void Heartbeat()
+	{
+		OS::Atomic::Increment(&m_heartbeat);
+	}
+
+	// nested calls are allowed, the timeout starts again after the last Resume
+	void Suspend()
+	{
+		OS::Atomic::Increment(&m_suspendCount);
+	}
+
+	void Resume()
+	{
+		OS::Atomic::Decrement(&m_suspendCount);
+	}
+
+	class SuspendScope
+	{
+		Watchdog& m_watchdog;
+
+		// no copies
+		SuspendScope(const SuspendScope&);
+		SuspendScope& operator=(const SuspendScope&);
+
+	public:
+		explicit SuspendScope(Watchdog& watchdog) : m_watchdog(watchdog)
+		{
+			m_watchdog.Suspend();
+		}
+
+		~SuspendScope()
+		{
+			m_watchdog.Resume();
+		}
+	};
+};